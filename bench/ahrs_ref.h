@@ -0,0 +1,124 @@
+#pragma once
+#include <math.h>
+#include <stdint.h>
+#include <algorithm>
+#include <array>
+#include <vector>
+#include "stridera_packet.h"
+#include "mahony_ahrs.h"
+
+// AHRS references shared by the ahrs_mahony stage and test/test_ahrs
+
+// Double-precision Mahony with the same gains, gate, start-up boost and gravity alignment
+// as MahonyAhrs: the fixed-point filter should track it to well under a degree.
+struct MahonyRef {
+  double q[4] = { 1, 0, 0, 0 }, b[3] = { 0, 0, 0 };
+  double dt = 0.005, kp = 1, ki = 0, lo = 0, hi = 0;
+  uint32_t n = 0, settleN = 0;
+  bool aligned = false;
+
+  void begin(const AhrsConfig& c) {
+    dt = 1.0 / c.rate_hz; kp = c.kp_milli / 1000.0; ki = c.ki_milli / 1000.0;
+    lo = c.accel_gate_mg < 1000 ? 1000.0 - c.accel_gate_mg : 0.0; hi = 1000.0 + c.accel_gate_mg;
+    settleN = (uint32_t)(c.settle_ms * (double)c.rate_hz / 1000.0);
+  }
+
+  void update(double ax, double ay, double az, double gx, double gy, double gz) {   // mg, rad/s
+    ++n;
+    const double norm = sqrt(ax * ax + ay * ay + az * az);
+    if (norm > 0 && !aligned) {
+      aligned = true;
+      double c[3] = { norm + az, ay, -ax };
+      if (c[0] * 64 < norm) { c[0] = 0; c[1] = 1; c[2] = 0; }
+      const double m = sqrt(c[0] * c[0] + c[1] * c[1] + c[2] * c[2]);
+      q[0] = c[0] / m; q[1] = c[1] / m; q[2] = c[2] / m; q[3] = 0;
+    }
+    double g[3] = { gx, gy, gz };
+    if (norm > 0 && norm >= lo && norm <= hi) {
+      const double a[3] = { ax / norm, ay / norm, az / norm };
+      const double w = q[0], x = q[1], y = q[2], z = q[3];
+      const double v[3] = { 2 * (x * z - w * y), 2 * (w * x + y * z), w * w - x * x - y * y + z * z };
+      const double e[3] = { a[1] * v[2] - a[2] * v[1], a[2] * v[0] - a[0] * v[2], a[0] * v[1] - a[1] * v[0] };
+      const double k = n <= settleN ? kp * 10 : kp;
+      for (int i = 0; i < 3; ++i) {
+        b[i] = std::min(0.25, std::max(-0.25, b[i] + ki * e[i] * dt));
+        g[i] += k * e[i] + b[i];
+      }
+    } else {
+      for (int i = 0; i < 3; ++i) g[i] += b[i];
+    }
+    const double h[3] = { g[0] * dt / 2, g[1] * dt / 2, g[2] * dt / 2 };
+    const double w = q[0], x = q[1], y = q[2], z = q[3];
+    q[0] = w - x * h[0] - y * h[1] - z * h[2];
+    q[1] = x + w * h[0] + y * h[2] - z * h[1];
+    q[2] = y + w * h[1] - x * h[2] + z * h[0];
+    q[3] = z + w * h[2] + x * h[1] - y * h[0];
+    const double m = sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+    for (double& c : q) c /= m;
+  }
+};
+
+// Rotation between two orientations; inputs need not be exactly unit (Q14 packing)
+static inline double quat_angle_deg(const double* a, const double* b) {
+  const double na = sqrt(a[0] * a[0] + a[1] * a[1] + a[2] * a[2] + a[3] * a[3]);
+  const double nb = sqrt(b[0] * b[0] + b[1] * b[1] + b[2] * b[2] + b[3] * b[3]);
+  const double d  = fabs(a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3]) / (na * nb);
+  return 2.0 * acos(d > 1.0 ? 1.0 : d) * 180.0 / M_PI;
+}
+
+// Angle between the gravity directions two orientations imply (roll/pitch error, yaw ignored)
+static inline double tilt_err_deg(const double* a, const double* b) {
+  auto up = [](const double* q, double* v) {
+    v[0] = 2 * (q[1] * q[3] - q[0] * q[2]);
+    v[1] = 2 * (q[0] * q[1] + q[2] * q[3]);
+    v[2] = q[0] * q[0] - q[1] * q[1] - q[2] * q[2] + q[3] * q[3];
+  };
+  double u[3], v[3];
+  up(a, u); up(b, v);
+  const double d = u[0] * v[0] + u[1] * v[1] + u[2] * v[2];
+  return acos(d > 1.0 ? 1.0 : d < -1.0 ? -1.0 : d) * 180.0 / M_PI;
+}
+
+// Known rotation (sway + turning) at 200 Hz with what an MPU6886 would report: gravity plus
+// stride bumps and noise in mg, gyro with a constant bias and noise in 0.1 dps
+static inline void synth_imu(size_t n, uint16_t rate_hz, std::vector<StrideraSample>& out, std::vector<std::array<double, 4>>& truth) {
+  double q[4] = { 0.9659, 0.2588, 0, 0 };          // starts rolled 30 deg
+  const double dt = 1.0 / rate_hz;
+  const double bias[3] = { 0.02, -0.015, 0.01 };  // rad/s
+  uint32_t rng = 777;
+  auto noise = [&](double amp) {
+    rng = rng * 1103515245u + 12345u;
+    return ((double)((rng >> 8) & 0xFFFF) / 32768.0 - 1.0) * amp;
+  };
+  out.resize(n);
+  truth.resize(n);
+  for (size_t i = 0; i < n; ++i) {
+    const double t = i * dt;
+    const double w[3] = { 0.8 * sin(2 * M_PI * 0.5 * t), 0.6 * sin(2 * M_PI * 0.3 * t + 1.0), 0.3 + 0.2 * sin(2 * M_PI * 0.05 * t) };
+    for (int k = 0; k < 10; ++k) {                 // true orientation, 10 substeps
+      const double h[3] = { w[0] * dt / 20, w[1] * dt / 20, w[2] * dt / 20 };
+      const double a = q[0], x = q[1], y = q[2], z = q[3];
+      q[0] = a - x * h[0] - y * h[1] - z * h[2];
+      q[1] = x + a * h[0] + y * h[2] - z * h[1];
+      q[2] = y + a * h[1] - x * h[2] + z * h[0];
+      q[3] = z + a * h[2] + x * h[1] - y * h[0];
+      const double m = sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+      for (double& c : q) c /= m;
+    }
+    truth[i] = { q[0], q[1], q[2], q[3] };
+    const double g[3] = { 2 * (q[1] * q[3] - q[0] * q[2]), 2 * (q[0] * q[1] + q[2] * q[3]),
+                          q[0] * q[0] - q[1] * q[1] - q[2] * q[2] + q[3] * q[3] };
+    const double bump = 150.0 * sin(2 * M_PI * 1.8 * t);   // stride, along the gravity axis
+    StrideraSample& s = out[i];
+    s = StrideraSample{};
+    s.v1 = StrideraAccelPacket{(uint32_t)(i * 1000 / rate_hz),
+                               (int16_t)lrint(g[0] * (1000 + bump) + noise(20)),
+                               (int16_t)lrint(g[1] * (1000 + bump) + noise(20)),
+                               (int16_t)lrint(g[2] * (1000 + bump) + noise(20)), (uint8_t)rate_hz, 0};
+    for (int k = 0; k < 3; ++k) s.gyro[k] = (int16_t)lrint((w[k] + bias[k]) * 1800.0 / M_PI + noise(3));
+    s.seq = (uint16_t)i;
+    s.ts_us = (uint32_t)((uint64_t)i * 1000000 / rate_hz);
+    s.rate_hz = rate_hz;
+    s.chan_mask = STRIDERA_CH_ACCEL | STRIDERA_CH_GYRO;
+  }
+}
@@ -0,0 +1,20 @@
+// Counts every global operator new so stages can report allocations per sample.
+#include <stdlib.h>
+#include <new>
+#include <atomic>
+#include <stdint.h>
+
+static std::atomic<uint64_t> s_allocs{0};
+
+uint64_t bench_alloc_count() { return s_allocs.load(std::memory_order_relaxed); }
+
+void* operator new(size_t n) {
+  s_allocs.fetch_add(1, std::memory_order_relaxed);
+  if (void* p = malloc(n ? n : 1)) return p;
+  throw std::bad_alloc();
+}
+void* operator new[](size_t n) { return operator new(n); }
+void  operator delete(void* p) noexcept { free(p); }
+void  operator delete[](void* p) noexcept { free(p); }
+void  operator delete(void* p, size_t) noexcept { free(p); }
+void  operator delete[](void* p, size_t) noexcept { free(p); }
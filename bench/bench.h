@@ -0,0 +1,116 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <algorithm>
+
+/**
+ * Minimal benchmark harness for the native env (no external deps).
+ *
+ * A stage processes `samples` samples per repetition and returns the bytes it
+ * produced. The harness reports, per stage:
+ *   ns_per_sample      median over repetitions
+ *   ns_per_sample_min  best repetition (least scheduler noise)
+ *   bytes_per_sample   output size / samples (0 if the stage produces none)
+ *   allocs_per_sample  heap allocations seen during the timed runs / samples
+ *   ok                 stage-specific correctness check (equality, round trip, accuracy)
+ * as one JSON document, so a Linux box can diff it against a baseline
+ * (tools/bench_compare.py).
+ */
+
+// Heap allocation counter (bench/alloc_counter.cpp replaces global new/delete)
+uint64_t bench_alloc_count();
+
+// Keeps results observable so the optimizer cannot drop the work
+extern volatile uint64_t g_bench_sink;
+
+struct BenchResult {
+  std::string stage;
+  uint64_t    samples           = 0;
+  double      ns_per_sample     = 0;
+  double      ns_per_sample_min = 0;
+  double      bytes_per_sample  = 0;
+  double      allocs_per_sample = 0;
+  bool        ok                = true;
+  std::string note;
+};
+
+class Bench {
+public:
+  Bench(int reps, const char* filter) : reps_(reps < 1 ? 1 : reps), filter_(filter) {}
+
+  bool wants(const char* stage) const { return !filter_ || strstr(stage, filter_); }
+
+  // fn() processes `samples` samples and returns bytes produced
+  template <typename Fn>
+  BenchResult& run(const char* stage, uint64_t samples, Fn&& fn) {
+    BenchResult r;
+    r.stage   = stage;
+    r.samples = samples;
+    std::vector<double> ns;
+    ns.reserve(reps_);                            // not counted as the stage's allocation
+    uint64_t bytes = 0;
+    const uint64_t allocs0 = bench_alloc_count();
+    for (int i = 0; i < reps_; ++i) {
+      const auto t0 = std::chrono::steady_clock::now();
+      bytes = fn();
+      const auto t1 = std::chrono::steady_clock::now();
+      ns.push_back(std::chrono::duration<double, std::nano>(t1 - t0).count() / (double)samples);
+    }
+    const uint64_t allocs = bench_alloc_count() - allocs0;
+    std::sort(ns.begin(), ns.end());
+    r.ns_per_sample     = ns[ns.size() / 2];
+    r.ns_per_sample_min = ns.front();
+    r.bytes_per_sample  = (double)bytes / (double)samples;
+    r.allocs_per_sample = (double)allocs / ((double)samples * reps_);
+    results_.push_back(r);
+    return results_.back();
+  }
+
+  bool allOk() const {
+    for (const auto& r : results_) if (!r.ok) return false;
+    return true;
+  }
+
+  void writeJson(FILE* f) const {
+    fprintf(f, "{\n  \"suite\": \"stridera-bench\",\n  \"version\": 1,\n  \"reps\": %d,\n  \"ok\": %s,\n  \"stages\": [\n",
+            reps_, allOk() ? "true" : "false");
+    for (size_t i = 0; i < results_.size(); ++i) {
+      const auto& r = results_[i];
+      fprintf(f, "    {\"stage\": \"%s\", \"samples\": %llu, \"ns_per_sample\": %.3f, \"ns_per_sample_min\": %.3f, "
+                 "\"bytes_per_sample\": %.3f, \"allocs_per_sample\": %.6f, \"ok\": %s, \"note\": \"%s\"}%s\n",
+              r.stage.c_str(), (unsigned long long)r.samples, r.ns_per_sample, r.ns_per_sample_min,
+              r.bytes_per_sample, r.allocs_per_sample, r.ok ? "true" : "false", r.note.c_str(),
+              i + 1 < results_.size() ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+  }
+
+  // Human-readable table on stderr while running
+  static void print(const BenchResult& r) {
+    fprintf(stderr, "%-22s %10.2f ns/sample (min %8.2f) %7.3f B/sample %8.4f allocs/sample  %s %s\n",
+            r.stage.c_str(), r.ns_per_sample, r.ns_per_sample_min, r.bytes_per_sample,
+            r.allocs_per_sample, r.ok ? "ok  " : "FAIL", r.note.c_str());
+  }
+
+private:
+  int reps_;
+  const char* filter_;
+  std::vector<BenchResult> results_;
+};
+
+// Stage groups (one file each)
+struct BenchOptions {
+  const char* gaitTrace      = nullptr;   // recorded CSV (ts_ms, ax_g, ay_g, az_g)
+  int         gaitTraceSteps = -1;        // hand-counted steps in that trace
+  const char* imuTrace       = nullptr;   // recorded CSV with gyro columns (ahrs_mahony)
+};
+
+void bench_proto(Bench& b, const BenchOptions& o);
+void bench_replay(Bench& b, const BenchOptions& o);
+void bench_dsp(Bench& b, const BenchOptions& o);
+void bench_io(Bench& b, const BenchOptions& o);
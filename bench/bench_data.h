@@ -0,0 +1,46 @@
+#pragma once
+#include <vector>
+#include "stridera_packet.h"
+#include "fakes/fake_accel.h"
+
+// Deterministic 200 Hz walking trace shared by the stages (built outside the timed region)
+static inline std::vector<StrideraAccelPacket> bench_walk_packets(size_t n, uint16_t rate_hz = 200) {
+  FakeAccelerometer acc;
+  acc.set_odr_hz(rate_hz);
+  acc.vib_hz = 0.0f;
+  acc.begin();
+  std::vector<StrideraAccelPacket> v(n);
+  for (size_t i = 0; i < n; ++i) {
+    AccelSample s;
+    acc.read_batch(&s, 1);
+    v[i] = StrideraAccelPacket{(uint32_t)(i * 1000 / rate_hz), s.ax_mg, s.ay_mg, s.az_mg, (uint8_t)rate_hz, 0};
+  }
+  return v;
+}
+
+// Same trace as pipeline samples (v1 packet + seq / us), as ImuService queues them
+static inline std::vector<StrideraSample> bench_walk_samples(size_t n, uint16_t rate_hz = 200) {
+  const auto pk = bench_walk_packets(n, rate_hz);
+  std::vector<StrideraSample> v(n);
+  for (size_t i = 0; i < n; ++i) {
+    v[i].v1        = pk[i];
+    v[i].ts_us     = (uint32_t)((uint64_t)i * 1000000 / rate_hz);
+    v[i].seq       = (uint16_t)i;
+    v[i].rate_hz   = rate_hz;
+    v[i].chan_mask = STRIDERA_CH_ACCEL;
+  }
+  return v;
+}
+
+// Same walk with gyro (a sway derived from the accel trace) and a drifting die temperature
+static inline std::vector<StrideraSample> bench_walk_imu_samples(size_t n, uint16_t rate_hz = 200) {
+  auto v = bench_walk_samples(n, rate_hz);
+  for (size_t i = 0; i < n; ++i) {
+    v[i].gyro[0]   = (int16_t)(v[i].v1.ay_mg * 3);
+    v[i].gyro[1]   = (int16_t)(-v[i].v1.ax_mg * 2);
+    v[i].gyro[2]   = (int16_t)((v[i].v1.az_mg - 1000) * 4);
+    v[i].temp      = (int16_t)(3100 + (i / 1000) % 200);
+    v[i].chan_mask = STRIDERA_CH_ACCEL | STRIDERA_CH_GYRO | STRIDERA_CH_TEMP;
+  }
+  return v;
+}
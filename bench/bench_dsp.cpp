@@ -0,0 +1,279 @@
+// Sample processing: anti-alias decimation, gait detection, orientation fusion, and the whole live path.
+#include <stdlib.h>
+#include <math.h>
+#include <array>
+#include <string>
+#include "bench.h"
+#include "bench_data.h"
+#include "ahrs_ref.h"
+#include "fakes/fake_accel.h"
+#include "fakes/fake_nimble.h"
+#include "fir_decimator.h"
+#include "gait_detector.h"
+#include "mahony_ahrs.h"
+#include "spsc_ring.h"
+#include "stridera_batch.h"
+#include "stridera_csv.h"
+
+namespace {
+
+constexpr size_t kTaps  = 64;
+constexpr size_t kBlock = 36;    // ImuService::kMaxBatch
+
+struct Soa {
+  std::vector<int16_t> x, y, z;
+};
+
+Soa fifo_trace(size_t n, uint16_t rate_hz) {
+  FakeAccelerometer acc;
+  acc.set_odr_hz(rate_hz);
+  acc.begin();
+  Soa s;
+  s.x.resize(n); s.y.resize(n); s.z.resize(n);
+  for (size_t i = 0; i < n; ++i) {
+    AccelSample a;
+    acc.read_batch(&a, 1);
+    s.x[i] = a.ax_mg; s.y[i] = a.ay_mg; s.z[i] = a.az_mg;
+  }
+  return s;
+}
+
+bool read_file(const char* path, std::string& text) {
+  FILE* f = fopen(path, "rb");
+  if (!f) return false;
+  char chunk[4096];
+  size_t n;
+  while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) text.append(chunk, n);
+  fclose(f);
+  return true;
+}
+
+// Recorded trace: (ts_ms, ax_g, ay_g, az_g) rows parsed with the device parser
+bool load_trace(const char* path, std::vector<StrideraAccelPacket>& out) {
+  std::string text;
+  if (!read_file(path, text)) return false;
+  MemSource src(reinterpret_cast<const uint8_t*>(text.data()), text.size());
+  StrideraCsvLineReader<MemSource> lines;
+  lines.begin(&src);
+  const char *s, *e;
+  (void)lines.next(s, e);
+  StrideraAccelPacket p;
+  while (lines.next(s, e)) if (stridera_parse_csv_row(s, e, p, 0)) out.push_back(p);
+  return !out.empty();
+}
+
+// Recorded multi-channel trace; only accepted if its header names the gyro columns
+bool load_imu_trace(const char* path, std::vector<StrideraSample>& out) {
+  std::string text;
+  if (!read_file(path, text)) return false;
+  MemSource src(reinterpret_cast<const uint8_t*>(text.data()), text.size());
+  StrideraCsvLineReader<MemSource> lines;
+  lines.begin(&src);
+  const char *s, *e;
+  const uint8_t cols = lines.next(s, e) ? stridera_csv_columns(s, e) : 0;
+  if (!(cols & STRIDERA_CH_GYRO)) return false;
+  StrideraSample p;
+  while (lines.next(s, e)) if (stridera_parse_csv_sample(s, e, p, 0, cols)) out.push_back(p);
+  return out.size() > 1;
+}
+
+}  // namespace
+
+void bench_dsp(Bench& b, const BenchOptions& o) {
+  const size_t N = 400000;                         // input frames at 1 kHz
+  const Soa in = fifo_trace(N, 1000);
+  int16_t h[kTaps];
+  stridera_fir_lowpass_q15(h, kTaps, 50.0f, 1000.0f);
+
+  std::vector<int16_t> blockOut, refOut;
+  if (b.wants("decimate_block")) {
+    FirDecimator<3, kTaps, kBlock> d;
+    auto& r = b.run("decimate_block", N, [&] {
+      d.beginWith(h, 5);
+      blockOut.clear();
+      int16_t ox[kBlock], oy[kBlock], oz[kBlock];
+      int16_t* out[3] = { ox, oy, oz };
+      for (size_t i = 0; i < N; i += kBlock) {
+        const size_t n = N - i < kBlock ? N - i : kBlock;
+        const int16_t* src[3] = { &in.x[i], &in.y[i], &in.z[i] };
+        const size_t m = d.process(src, n, out);
+        for (size_t k = 0; k < m; ++k) { blockOut.push_back(ox[k]); blockOut.push_back(oy[k]); blockOut.push_back(oz[k]); }
+      }
+      return (uint64_t)(blockOut.size() * sizeof(int16_t));
+    });
+    r.note = "1 kHz -> 200 Hz, 64 taps, 3 ch, per input frame";
+    Bench::print(r);
+  }
+
+  if (b.wants("decimate_ref")) {
+    FirDecimatorRef<3, kTaps> d;
+    auto& r = b.run("decimate_ref", N, [&] {
+      d.beginWith(h, 5);
+      refOut.clear();
+      for (size_t i = 0; i < N; ++i) {
+        const int16_t f[3] = { in.x[i], in.y[i], in.z[i] };
+        int16_t o[3];
+        if (d.push(f, o)) { refOut.push_back(o[0]); refOut.push_back(o[1]); refOut.push_back(o[2]); }
+      }
+      return (uint64_t)(refOut.size() * sizeof(int16_t));
+    });
+    r.note = "scalar circular-buffer reference";
+    if (!blockOut.empty()) {
+      r.ok = blockOut == refOut;
+      r.note += blockOut == refOut ? ", block kernel bit-exact" : ", block kernel MISMATCH";
+    }
+    Bench::print(r);
+  }
+
+  if (b.wants("gait_detect")) {
+    // Stand / walk / stand / run / stand, 200 Hz, or a recorded trace with a known step count
+    std::vector<StrideraAccelPacket> pk;
+    int truth = -1;
+    if (o.gaitTrace && load_trace(o.gaitTrace, pk)) {
+      truth = o.gaitTraceSteps;
+    } else {
+      FakeAccelerometer acc;
+      acc.set_odr_hz(200);
+      acc.vib_hz = 0.0f;
+      acc.begin();
+      const struct { float secs, hz, mg; } phases[] = { {5, 0, 0}, {60, 1.8f, 350}, {4, 0, 0}, {40, 2.8f, 900}, {5, 0, 0} };
+      uint32_t t = 0;
+      for (const auto& ph : phases) {
+        acc.step_hz = ph.hz;
+        acc.step_mg = ph.mg;
+        for (int i = 0; i < (int)(ph.secs * 200); ++i, t += 5) {
+          AccelSample s;
+          acc.read_batch(&s, 1);
+          pk.push_back({t, s.ax_mg, s.ay_mg, s.az_mg, 200, 0});
+        }
+      }
+      truth = (int)acc.trueSteps();
+    }
+
+    GaitDetector g;
+    uint32_t events = 0;
+    auto& r = b.run("gait_detect", pk.size(), [&] {
+      GaitConfig c;
+      c.rate_hz = pk.size() > 1 && pk[1].ts_ms > pk[0].ts_ms ? (uint16_t)(1000 / (pk[1].ts_ms - pk[0].ts_ms)) : 200;
+      g.begin(c);
+      events = 0;
+      for (const auto& p : pk) events += g.push(p);
+      return (uint64_t)events * sizeof(StrideraGaitPacket);
+    });
+    const int got = (int)g.steps();
+    const int tol = truth > 0 ? (truth * 3 / 100 > 2 ? truth * 3 / 100 : 2) : 0;
+    r.ok   = truth < 0 || abs(got - truth) <= tol;
+    r.note = std::string(o.gaitTrace ? "trace" : "synthetic") + " steps " + std::to_string(got) + "/" +
+             (truth < 0 ? std::string("?") : std::to_string(truth));
+    Bench::print(r);
+  }
+
+  if (b.wants("ahrs_mahony")) {
+    // Fixed-point filter vs the double reference on the same quantized input, and both vs
+    // the true orientation of a synthetic trace (or only vs each other on a recorded one)
+    std::vector<StrideraSample> sm;
+    std::vector<std::array<double, 4>> truth;
+    const bool trace = o.imuTrace && load_imu_trace(o.imuTrace, sm);
+    if (!trace) synth_imu(120 * 200, 200, sm, truth);
+    AhrsConfig c;
+    c.rate_hz = sm.size() > 1 && sm[1].v1.ts_ms > sm[0].v1.ts_ms ? (uint16_t)(1000 / (sm[1].v1.ts_ms - sm[0].v1.ts_ms)) : 200;
+
+    MahonyAhrs f;
+    uint64_t acc = 0;
+    auto& r = b.run("ahrs_mahony", sm.size(), [&] {
+      f.begin(c);
+      for (const auto& s : sm) {
+        f.update(s.v1.ax_mg, s.v1.ay_mg, s.v1.az_mg, s.gyro[0], s.gyro[1], s.gyro[2]);
+        acc += (uint32_t)f.q()[0];
+      }
+      return (uint64_t)0;
+    });
+    g_bench_sink = acc;
+
+    // Untimed replay: report the worst errors after the start-up window (bounds: test/test_ahrs)
+    MahonyRef ref;
+    ref.begin(c);
+    f.begin(c);
+    double maxRef = 0, maxTilt = 0, sumTilt = 0, maxQ14 = 0;
+    size_t m = 0;
+    const size_t skip = (size_t)c.settle_ms * c.rate_hz / 1000 * 2;
+    for (size_t i = 0; i < sm.size(); ++i) {
+      const StrideraSample& s = sm[i];
+      f.update(s.v1.ax_mg, s.v1.ay_mg, s.v1.az_mg, s.gyro[0], s.gyro[1], s.gyro[2]);
+      const double k = M_PI / 1800.0;
+      ref.update(s.v1.ax_mg, s.v1.ay_mg, s.v1.az_mg, s.gyro[0] * k, s.gyro[1] * k, s.gyro[2] * k);
+      if (i < skip) continue;
+      double q[4], q14[4];
+      int16_t p[4];
+      f.quatQ14(p);
+      for (int j = 0; j < 4; ++j) { q[j] = f.q()[j] / 1073741824.0; q14[j] = p[j] / 16384.0; }
+      maxRef = std::max(maxRef, quat_angle_deg(q, ref.q));
+      maxQ14 = std::max(maxQ14, quat_angle_deg(q, q14));
+      if (!truth.empty()) {
+        const double t = tilt_err_deg(q, truth[i].data());
+        maxTilt = std::max(maxTilt, t);
+        sumTilt += t;
+        ++m;
+      }
+    }
+    char note[160];
+    if (truth.empty()) {
+      snprintf(note, sizeof(note), "trace; max %.3f deg from double ref, Q14 packing %.3f deg", maxRef, maxQ14);
+    } else {
+      snprintf(note, sizeof(note), "synthetic; max %.3f deg from double ref, tilt err avg %.2f max %.2f deg, Q14 %.4f",
+               maxRef, sumTilt / (double)m, maxTilt, maxQ14);
+    }
+    r.note = note;
+    Bench::print(r);
+  }
+
+  if (b.wants("imu_pipeline")) {
+    // Live path as ImuService + System run it: FIFO burst -> SoA -> decimate ->
+    // ring -> gait -> batch frame -> notify
+    const size_t ticks = 20000;                      // 10 ms ticks, 10 frames each at 1 kHz
+    std::vector<AccelSample> fifo(ticks * 10);       // sensor output, generated up front
+    for (size_t i = 0; i < fifo.size(); ++i) fifo[i] = AccelSample{in.x[i % N], in.y[i % N], in.z[i % N]};
+    FirDecimator<3, kTaps, kBlock> d;
+    SpscRing<StrideraAccelPacket, 256> ring;
+    GaitDetector g;
+    StrideraBatchEncoder enc;
+    uint8_t frame[stridera_att_payload(247)];
+    FakeNotifyCharacteristic chr(247);
+    uint64_t outSamples = 0;
+
+    auto& r = b.run("imu_pipeline", ticks * 2, [&] {
+      d.beginWith(h, 5);
+      GaitConfig c;
+      g.begin(c);
+      enc.begin(frame, sizeof(frame));
+      chr.clear();
+      outSamples = 0;
+      uint32_t ts = 0;
+      for (size_t t = 0; t < ticks; ++t) {
+        AccelSample batch[kBlock];
+        const size_t n = 10;                         // one FIFO burst
+        memcpy(batch, &fifo[t * n], n * sizeof(AccelSample));
+        int16_t x[kBlock], y[kBlock], z[kBlock], ox[kBlock], oy[kBlock], oz[kBlock];
+        for (size_t i = 0; i < n; ++i) { x[i] = batch[i].ax_mg; y[i] = batch[i].ay_mg; z[i] = batch[i].az_mg; }
+        const int16_t* src[3] = { x, y, z };
+        int16_t* dst[3] = { ox, oy, oz };
+        const size_t m = d.process(src, n, dst);
+        for (size_t k = 0; k < m; ++k) {
+          const StrideraAccelPacket p{ts += 5, ox[k], oy[k], oz[k], 200, 0};
+          ring.push(p);
+          g.push(p);
+        }
+        StrideraAccelPacket p;
+        while (ring.pop(p)) {
+          ++outSamples;
+          if (!enc.push(p)) { chr.notify(enc.data(), enc.size()); enc.reset(); enc.push(p); }
+          if (enc.full())   { chr.notify(enc.data(), enc.size()); enc.reset(); }
+        }
+      }
+      return chr.bytes();
+    });
+    r.ok   = outSamples == ticks * 2 && chr.rejected() == 0;
+    r.note = "per 200 Hz output sample";
+    Bench::print(r);
+  }
+}
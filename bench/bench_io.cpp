@@ -0,0 +1,424 @@
+// Hand-off and control paths: IMU ring, UI snapshot, SD recorder, bulk download, event capture,
+// link policy, multi-central fan-out, congestion control, runtime stream control, system FSM,
+// power policy, perf probes.
+#include <stdlib.h>
+#include <string>
+#include "bench.h"
+#include "bench_data.h"
+#include "fakes/fake_nimble.h"
+#include "spsc_ring.h"
+#include "seqlock.h"
+#include "session_recorder.h"
+#include "stridera_session.h"
+#include "bulk_loopback.h"
+#include "capture_buffer.h"
+#include "link_fake.h"
+#include "fanout.h"
+#include "congestion_sim.h"
+#include "stridera_control.h"
+#include "stream_analyzer.h"
+#include "perf_probe.h"
+#include "system_fsm.h"
+#include "fsm_events.h"
+#include "power_policy.h"
+
+// SystemFsm against a scripted port on a virtual clock; every action costs 250 us
+static uint32_t s_vclock_us = 0;
+
+class FakeSystemPort : public ISystemPort {
+public:
+  bool connected() const override { return true; }
+  bool recorderBusy() const override { return false; }
+  void startStreaming() override          { s_vclock_us += 250; }
+  void stopStreaming(bool) override       { s_vclock_us += 250; }
+  bool startRecording() override          { s_vclock_us += 250; return true; }
+  void stopRecording() override           { s_vclock_us += 250; }
+  void beginShutdown() override           { s_vclock_us += 250; }
+  void finishShutdown() override          {}
+  void onTransition(SystemState, SystemState, uint32_t) override {}
+};
+
+void bench_io(Bench& b, const BenchOptions&) {
+  const size_t N = 200000;
+  const auto pk  = bench_walk_packets(N);
+
+  if (b.wants("ring_push_pop")) {
+    static SpscRing<StrideraAccelPacket, 256> ring;
+    uint64_t sum = 0;
+    auto& r = b.run("ring_push_pop", N, [&] {
+      sum = 0;
+      StrideraAccelPacket p;
+      for (size_t i = 0; i < N; i += 10) {           // one 10-sample tick, then the consumer drains it
+        for (size_t k = i; k < i + 10 && k < N; ++k) ring.push(pk[k]);
+        while (ring.pop(p)) sum += p.ts_ms;
+      }
+      g_bench_sink += sum;
+      return (uint64_t)0;
+    });
+    r.ok   = ring.overruns() == 0;
+    r.note = "single thread, 10-sample bursts";
+    Bench::print(r);
+  }
+
+  if (b.wants("seqlock_publish")) {
+    // IMU task publishes the newest sample per tick; the UI task reads it now and then
+    static Seqlock<StrideraAccelPacket> latest;
+    size_t reads = 0, bad = 0;
+    auto& r = b.run("seqlock_publish", N, [&] {
+      StrideraAccelPacket p;
+      for (size_t i = 0; i < N; ++i) {
+        latest.write(pk[i]);
+        if ((i & 63) == 0 && latest.read(p)) { ++reads; bad += p.ts_ms != pk[i].ts_ms; }
+      }
+      return (uint64_t)0;
+    });
+    r.ok   = reads > 0 && bad == 0;
+    r.note = "write per sample, read every 64th";
+    Bench::print(r);
+  }
+
+  if (b.wants("recorder_append")) {
+    static SessionRecorder<4096, 2048> rec;          // large: keep it off the stack
+    MemBlockFile file;
+    static bool woken = false;
+    rec.setWake([](void*) { woken = true; }, nullptr);
+    uint32_t dropped = 0;
+    auto& r = b.run("recorder_append", N, [&] {
+      rec.begin(&file, "bench.ssn", 200, 0, 512);
+      for (const auto& p : pk) {
+        rec.append(p);
+        if (woken) { woken = false; rec.service(); }   // the writer task, run inline
+      }
+      rec.requestStop();
+      rec.service();
+      dropped = rec.stats().dropped;
+      return (uint64_t)file.data.size();
+    });
+    // Read back through the replay reader
+    MemSource src(file.data.data(), file.data.size());
+    StrideraSessionReader<MemSource> rd;
+    size_t rows = 0, bad = 0;
+    StrideraAccelPacket p;
+    if (rd.begin(&src)) {
+      while (rd.next(p, 200)) {
+        bad += p.ts_ms != pk[rows].ts_ms || p.az_mg != pk[rows].az_mg;
+        ++rows;
+      }
+    }
+    r.ok   = rec.closed() && dropped == 0 && rows == N && bad == 0;
+    r.note = "double-buffered .ssn into RAM, read back";
+    Bench::print(r);
+  }
+
+  if (b.wants("bulk_loopback")) {
+    // 200k records worth of session file through credit-windowed chunks, one disconnect
+    std::vector<uint8_t> file(N * sizeof(StrideraSessionRecord));
+    for (size_t i = 0; i < file.size(); ++i) file[i] = (uint8_t)(i * 131 + 7);
+    std::vector<uint8_t> got(file.size());
+    MemSource src(file.data(), file.size());
+    bool complete = false;
+    uint64_t linkBytes = 0;
+    auto& r = b.run("bulk_loopback", N, [&] {
+      BulkReceiver rx;
+      rx.begin(got.data(), (uint32_t)got.size(), 32);
+      BulkLoopbackLink link(rx, 244, 6);
+      BulkSender<> tx;
+      uint32_t t = 0;
+      tx.start(&src, 0, 32, t);
+      link.disconnectAfter(2000);
+      while (!rx.complete() && t < 600000000) {
+        t += 7500;
+        link.connectionEvent();
+        tx.pump(link, t, 16);
+        tx.addCredits(link.takeCredits());
+        if (!link.connected()) {
+          link.reconnect();
+          rx.resume();
+          tx.start(&src, rx.contiguous(), 32, t);
+        }
+      }
+      complete  = rx.complete();
+      linkBytes = link.bytes();
+      return linkBytes;
+    });
+    r.ok   = complete && got == file;
+    r.note = "per 10-byte record, MTU 247, resume once";
+    Bench::print(r);
+  }
+
+  if (b.wants("capture_trigger")) {
+    // 200 Hz 6-axis walk (|a| 0.5..1.3 g) with a 7 g impact every 10000 samples into a 4096-record
+    // ring (20 s); the reader takes each frozen window and re-arms at once (windows, triggers and
+    // dumps: test/test_capture_buffer)
+    auto smp = bench_walk_imu_samples(N);
+    auto impact = [&](size_t i, int16_t az) { smp[i].v1.ax_mg = 1200; smp[i].v1.ay_mg = -900; smp[i].v1.az_mg = az; };
+    for (size_t i = 5000; i < N; i += 10000) impact(i, 6900);
+    std::vector<StrideraCaptureRecord> mem(4096);
+    StrideraCaptureConfig cc{};
+    cc.accel_high_mg = 6000;
+    cc.pre_ms        = 3000;
+    cc.post_ms       = 1000;
+    CaptureBuffer cap;
+    uint32_t windows = 0;
+    auto& r = b.run("capture_trigger", N, [&] {
+      cap.begin(mem.data(), (uint32_t)mem.size(), cc);
+      windows = 0;
+      for (size_t i = 0; i < N; ++i) {
+        cap.push(smp[i]);
+        if (cap.frozen()) { windows += cap.header().record_count == 801; cap.rearm(); }
+      }
+      return (uint64_t)N * sizeof(StrideraCaptureRecord);
+    });
+    r.note = "per sample, 16-byte record + trigger test; " + std::to_string(windows) + " impacts frozen";
+    Bench::print(r);
+  }
+
+  if (b.wants("link_policy_tick")) {
+    const size_t ticks = 200000;
+    LinkPolicy pol;
+    FakeLinkControl ctl;
+    auto& r = b.run("link_policy_tick", ticks, [&] {
+      pol.onConnect(1, 48, 0, 500, 0);
+      pol.setProfile(STRIDERA_LINK_PROFILE_STREAMING, 0);
+      for (uint32_t t = 0; t < ticks; ++t) {
+        if (t == ticks / 2) pol.setProfile(STRIDERA_LINK_PROFILE_IDLE, t * 10);
+        pol.countNotify(true);
+        pol.tick(ctl, t * 10);
+        ctl.deliver(pol);
+      }
+      return (uint64_t)0;
+    });
+    r.ok   = pol.settled() && pol.profile() == STRIDERA_LINK_PROFILE_IDLE;
+    r.note = "per loop() tick incl. fake controller events";
+    Bench::print(r);
+  }
+
+  if (b.wants("fanout_centrals")) {
+    // 200 Hz to four centrals at once: fast batch, delta on a 30 ms link, a legacy
+    // v2 client that can take ~1/10 of the rate, and one that reconnects halfway
+    const auto smp = bench_walk_samples(N);
+    using Fan = FanOut<4, 8, 244>;
+    static Fan fan;                                   // ~8 KB: keep it off the stack
+    FakeCentrals sink;
+    FanOutStats ended{};
+    auto& r = b.run("fanout_centrals", N, [&] {
+      sink = FakeCentrals{};
+      sink.add(1, 247, 8, 6);
+      sink.add(2, 185, 30, 2);
+      sink.add(3, 23, 50, 1);
+      sink.add(4, 247, 15, 4);
+      for (size_t i = 0; i < 4; ++i) fan.at(i).close();
+      fan.open(1, 247)->setBatch(true);
+      Fan::Stream* d = fan.open(2, 185);
+      d->setFormat(STRIDERA_FORMAT_DELTA);
+      d->setBatch(true);
+      Fan::Stream* v2 = fan.open(3, 23);
+      v2->setVersion(STRIDERA_PACKET_V2);
+      v2->setCrc(true);
+      v2->setLegacy(true);
+      fan.open(4, 247)->setBatch(true);
+      uint32_t now = 0;
+      for (size_t i = 0; i < N; ++i) {
+        now = (uint32_t)i * 5;
+        if (i == N / 2) fan.close(4);                 // link lost; back 1 s later as a new handle
+        if (i == N / 2 + 200) { sink.at(3).conn = 5; fan.open(5, 247)->setBatch(true); }
+        fan.sync([&](uint16_t, const FanOutStats& st) { ended = st; });
+        fan.push(smp[i], now);
+        if ((i & 3) == 3) {                           // loop wake every 20 ms
+          sink.advance(now);
+          fan.flushDue(now, 50);
+          fan.pump(sink, 8);
+        }
+      }
+      for (int k = 0; k < 200; ++k) {                 // drain what is still queued
+        now += 20;
+        sink.advance(now);
+        fan.flushDue(now, 0);
+        fan.pump(sink, 8);
+      }
+      return (uint64_t)0;
+    });
+    // Delivery, reconnect and MTU checks: test/test_fanout
+    const double secs = N * 0.005;
+    const FanOutStats& slow = fan.at(2).stats();
+    const FanOutStats& back = fan.at(3).stats();
+    char note[160];
+    snprintf(note, sizeof(note), "per sample; samples/s (drop %%): batch %.0f (%.0f), delta %.0f (%.0f), "
+             "single v2 %.0f (%.0f), reconnect %.0f (%.0f)",
+             sink.at(0).samples / secs, 100.0 * fan.at(0).stats().dropped_samples / N,
+             sink.at(1).samples / secs, 100.0 * fan.at(1).stats().dropped_samples / N,
+             sink.at(2).samples / secs, 100.0 * slow.dropped_samples / N,
+             sink.at(3).samples / secs, 100.0 * back.dropped_samples / N);
+    r.note = note;
+    Bench::print(r);
+  }
+
+  if (b.wants("link_congestion")) {
+    // 10 s on a good link, 20 s squeezed, 10 s good again. Full plain batches need
+    // ~7 notifies/s at MTU 247, delta ~5/s: "tight" allows 6.7/s, "choked" 3.3/s.
+    std::vector<StrideraSample> run = bench_walk_samples(8000);
+    const LinkPhase tight[]  = {{30, 4}, {150, 1}, {150, 1}, {30, 4}};
+    const LinkPhase choked[] = {{30, 4}, {300, 1}, {300, 1}, {30, 4}};
+    CongestionRun adaptive;
+    auto& r = b.run("link_congestion", run.size(), [&] {
+      adaptive = run_congestion(run, tight, 4, STRIDERA_FORMAT_BATCH, STRIDERA_CONG_QUARTER);
+      return (uint64_t)0;
+    });
+    // Policy off and the choked link for the note (exact checks: test/test_link_congestion)
+    const CongestionRun fixedTight = run_congestion(run, tight, 4, STRIDERA_FORMAT_BATCH, STRIDERA_CONG_NONE);
+    const CongestionRun deep       = run_congestion(run, choked, 4, STRIDERA_FORMAT_BATCH, STRIDERA_CONG_QUARTER);
+    const CongestionRun fixedDeep  = run_congestion(run, choked, 4, STRIDERA_FORMAT_BATCH, STRIDERA_CONG_NONE);
+    char note[200];
+    snprintf(note, sizeof(note),
+             "per sample; tight: dropped %u (off: %u), peak level %u; choked: dropped %u + decimated %u "
+             "(off: dropped %u), peak %u",
+             adaptive.st.dropped_samples, fixedTight.st.dropped_samples, adaptive.cong.peak_level,
+             deep.st.dropped_samples, deep.st.decimated_samples, fixedDeep.st.dropped_samples, deep.cong.peak_level);
+    r.note = note;
+    Bench::print(r);
+  }
+
+  if (b.wants("stream_control")) {
+    // One v2 central; a third of the way in it writes a control request (5-sample
+    // frames, 50 Hz, gyro that this source lacks), the sampler switches, the stream
+    // goes on. Every frame must carry one rate and the new limit, with no seq gap.
+    struct FrameCheck : IFanOutSink {
+      StreamAnalyzer a;
+      uint64_t frames = 0, mixed = 0, over = 0;
+      uint8_t  limit = 255;
+      uint64_t from  = UINT64_MAX;                  // the frame open at the write closes first
+      bool notify(uint16_t, FanOutChannel, const uint8_t* d, size_t len) override {
+        StrideraSample s[32];
+        const size_t n = stridera_v2_decode_samples(d, len, s, 32);
+        for (size_t i = 1; i < n; ++i) mixed += s[i].rate_hz != s[0].rate_hz;
+        over += frames > from && n > limit;         // frames opened after the write
+        a.addPayload(d, len, 0);
+        ++frames;
+        return true;
+      }
+    };
+    using Fan = FanOut<1, 8, 244>;
+    static Fan fan;
+    FrameCheck sink;
+    StrideraControl reply{}, bad{}, older{};
+    auto& r = b.run("stream_control", N, [&] {
+      sink = FrameCheck{};
+      fan.at(0).close();
+      Fan::Stream* st = fan.open(1, 247);
+      st->setFormat(STRIDERA_FORMAT_V2);
+      st->setBatch(true);
+      fan.sync([](uint16_t, const FanOutStats&) {});
+      StrideraSample smp{};
+      uint32_t ts = 0;
+      uint16_t rate = 200;
+      for (size_t i = 0; i < N; ++i) {
+        if (i == N / 3) {
+          StrideraControl cur{};
+          cur.rate_hz = rate; cur.format = st->format(); cur.packet_version = st->version();
+          cur.channels = st->channels();
+          const uint8_t shortWrite[3] = { STRIDERA_CONTROL_VERSION, STRIDERA_CTL_RATE, 50 };
+          bad = stridera_control_resolve(shortWrite, sizeof(shortWrite), cur, STRIDERA_CH_ACCEL);
+          StrideraControl req{};
+          req.version = STRIDERA_CONTROL_VERSION;
+          req.fields  = STRIDERA_CTL_RATE | STRIDERA_CTL_BATCH | STRIDERA_CTL_FLAGS | STRIDERA_CTL_CHANNELS;
+          req.rate_hz = 50; req.batch_samples = 5; req.flags = STRIDERA_V2_F_CRC;
+          req.channels = STRIDERA_CH_ACCEL | STRIDERA_CH_GYRO;
+          reply = stridera_control_resolve(reinterpret_cast<const uint8_t*>(&req), sizeof(req), cur, STRIDERA_CH_ACCEL);
+          req.fields |= STRIDERA_CTL_QUAT;           // a write from before quat_hz: the flag is ignored
+          older = stridera_control_resolve(reinterpret_cast<const uint8_t*>(&req), STRIDERA_CONTROL_MIN_SIZE, cur,
+                                           STRIDERA_CH_ACCEL);
+          st->setBatchLimit(reply.batch_samples);    // what BleService::applyControl does
+          st->setCrc(reply.flags & STRIDERA_V2_F_CRC);
+          st->setChannels(reply.channels);
+          sink.limit = reply.batch_samples;
+          sink.from  = sink.frames;
+        }
+        if (i == N / 3 + 3) rate = reply.rate_hz;     // the IMU task switches a tick later
+        smp.seq = (uint16_t)i;
+        smp.ts_us = ts += 1000000u / rate;
+        smp.rate_hz = rate;
+        smp.chan_mask = STRIDERA_CH_ACCEL;
+        fan.push(smp, ts / 1000);
+        fan.pump(sink, 8);
+      }
+      fan.flushDue(0, 0);
+      fan.pump(sink, 8);
+      return (uint64_t)0;
+    });
+    const StreamReport rep = sink.a.report();
+    r.ok = bad.status == STRIDERA_CTL_REJECTED && reply.status == STRIDERA_CTL_ADJUSTED &&
+           reply.channels == STRIDERA_CH_ACCEL && reply.rate_hz == 50 && sink.mixed == 0 && sink.over == 0 &&
+           older.status == STRIDERA_CTL_ADJUSTED && older.rate_hz == 50 && !(older.fields & STRIDERA_CTL_QUAT) &&
+           rep.received == N && rep.lost == 0 && rep.invalid == 0;
+    r.note = "per sample; rate/batch/CRC switched mid-stream, " + std::to_string(sink.frames) + " frames, none mixed";
+    Bench::print(r);
+  }
+
+  if (b.wants("fsm_step")) {
+    // Cost of one step() with an event that toggles streaming (scenario: test/test_system_fsm)
+    FakeSystemPort port;
+    SystemFsm fsm;
+    s_vclock_us = 0;
+    fsm.begin(&port, [] { return s_vclock_us; });
+    s_vclock_us = 2000000;
+    fsm.step(0, s_vclock_us);                         // past the boot grace: IDLE
+    const size_t n = 200000;
+    auto& r = b.run("fsm_step", n, [&] {
+      for (size_t i = 0; i < n; ++i) {
+        s_vclock_us += 10000;
+        fsm.step(i & 1 ? FSM_EV_UNSUBSCRIBE : FSM_EV_SUBSCRIBE, s_vclock_us);
+      }
+      return (uint64_t)0;
+    });
+    r.note = "per event incl. transition + latency stat";
+    Bench::print(r);
+  }
+
+  if (b.wants("power_policy")) {
+    // Cost of one policy decision per loop wake, plus a meter reading every 100th
+    // (timeline checks: test/test_power_policy)
+    PowerConfig cfg;
+    PowerPolicy pol;
+    pol.begin(cfg, 0);
+    const size_t n = 200000;
+    auto& r = b.run("power_policy", n, [&] {
+      EnergyMeter m;
+      uint32_t acc = 0;
+      for (size_t i = 0; i < n; ++i) {
+        const uint32_t now = (uint32_t)i * 10;
+        const PowerPlan p = pol.plan(i & 4096 ? PowerMode::Streaming : PowerMode::Idle, now);
+        acc += p.cpu_mhz + p.backlight;
+        if (i % 100 == 0) m.addReading(now, 4000, -50, 200);
+      }
+      g_bench_sink += acc + m.microjoulesPerSample();
+      return (uint64_t)0;
+    });
+    r.note = "per loop wake, a meter reading every 100th";
+    Bench::print(r);
+  }
+
+  if (b.wants("perf_scope")) {
+    // Cost of one probe (two clock reads + histogram update) around trivial work
+    const size_t n = 200000;
+    PerfStat stat;
+    auto& r = b.run("perf_scope", n, [&] {
+      stat.reset();
+      for (size_t i = 0; i < n; ++i) {
+        STRIDERA_PERF_SCOPE(stat);
+        g_bench_sink += i;
+      }
+      return (uint64_t)0;
+    });
+    // Histogram p99 against the exact p99 of a known spread of durations
+    PerfStat acc;
+    std::vector<uint32_t> d(n);
+    uint32_t x = 12345;
+    for (auto& v : d) { x = x * 1664525u + 1013904223u; v = 200 + (x >> 8) % 48000; acc.record(v); }
+    std::sort(d.begin(), d.end());
+    const uint32_t exact = d[(d.size() * 99 + 99) / 100 - 1];
+    const uint32_t est   = acc.percentile(99);
+    r.ok   = stat.count() == n && est >= exact && est <= exact + exact / 8;
+    r.note = STRIDERA_PERF ? "per STRIDERA_PERF_SCOPE" : "STRIDERA_PERF=0: probes compiled out";
+    Bench::print(r);
+  }
+}
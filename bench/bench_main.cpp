@@ -0,0 +1,43 @@
+// Stridera host benchmarks — `pio run -e native -t exec`, or run the binary directly:
+//   .pio/build/native/program [--reps N] [--filter substr] [--out results.json]
+//                             [--gait-trace walk.csv --gait-steps N] [--imu-trace imu.csv]
+// JSON goes to stdout (or --out); the table goes to stderr. Exit code 1 if a
+// stage's correctness check failed.
+#include <stdlib.h>
+#include <string.h>
+#include "bench.h"
+
+volatile uint64_t g_bench_sink = 0;
+
+int main(int argc, char** argv) {
+  int reps = 5;
+  const char* filter = nullptr;
+  const char* outPath = nullptr;
+  BenchOptions opt;
+  for (int i = 1; i < argc; ++i) {
+    const bool more = i + 1 < argc;
+    if      (!strcmp(argv[i], "--reps") && more)       reps = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--filter") && more)     filter = argv[++i];
+    else if (!strcmp(argv[i], "--out") && more)        outPath = argv[++i];
+    else if (!strcmp(argv[i], "--gait-trace") && more) opt.gaitTrace = argv[++i];
+    else if (!strcmp(argv[i], "--gait-steps") && more) opt.gaitTraceSteps = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--imu-trace") && more)  opt.imuTrace = argv[++i];
+    else {
+      fprintf(stderr, "usage: %s [--reps N] [--filter substr] [--out file.json] "
+                      "[--gait-trace file.csv --gait-steps N] [--imu-trace file.csv]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  Bench b(reps, filter);
+  bench_proto(b, opt);
+  bench_replay(b, opt);
+  bench_dsp(b, opt);
+  bench_io(b, opt);
+
+  FILE* f = outPath ? fopen(outPath, "w") : stdout;
+  if (!f) { perror(outPath); return 2; }
+  b.writeJson(f);
+  if (f != stdout) fclose(f);
+  return b.allOk() ? 0 : 1;
+}
@@ -0,0 +1,211 @@
+// Framing cost of the BLE encodings (legacy single packet, batch, delta, packet v2 with and
+// without a channel mask) and the host-side stream analyzer.
+#include "bench.h"
+#include "bench_data.h"
+#include "fakes/fake_nimble.h"
+#include "stridera_batch.h"
+#include "stridera_delta.h"
+#include "stream_analyzer.h"
+
+void bench_proto(Bench& b, const BenchOptions&) {
+  const size_t N = 200000;
+  const auto pk = bench_walk_packets(N);
+  FakeNotifyCharacteristic chr(247);
+
+  if (b.wants("packet_legacy")) {
+    auto& r = b.run("packet_legacy", N, [&] {
+      chr.clear();
+      for (const auto& p : pk) {
+        StrideraAccelPacket out = p;                 // what sendImu() copies into the characteristic
+        chr.notify(reinterpret_cast<const uint8_t*>(&out), sizeof(out));
+      }
+      return chr.bytes();
+    });
+    r.note = "12-byte notify per sample";
+    Bench::print(r);
+  }
+
+  uint8_t buf[stridera_att_payload(247)];
+
+  if (b.wants("batch_encode")) {
+    StrideraBatchEncoder enc;
+    auto& r = b.run("batch_encode", N, [&] {
+      chr.clear();
+      enc.begin(buf, sizeof(buf));
+      for (const auto& p : pk) {
+        if (!enc.push(p)) { chr.notify(enc.data(), enc.size()); enc.reset(); enc.push(p); }
+        if (enc.full())   { chr.notify(enc.data(), enc.size()); enc.reset(); }
+      }
+      if (!enc.empty()) chr.notify(enc.data(), enc.size());
+      return chr.bytes();
+    });
+    // Round trip one frame
+    enc.begin(buf, sizeof(buf));
+    size_t n = 0;
+    while (n < pk.size() && enc.push(pk[n])) ++n;
+    StrideraAccelPacket back[64];
+    const size_t got = stridera_batch_decode(enc.data(), enc.size(), back, 64);
+    r.ok = got == n;
+    for (size_t i = 0; r.ok && i < got; ++i)
+      r.ok = back[i].ts_ms == pk[i].ts_ms && back[i].ax_mg == pk[i].ax_mg && back[i].az_mg == pk[i].az_mg;
+    r.note = std::to_string(n) + " samples/frame @MTU247";
+    Bench::print(r);
+  }
+
+  if (b.wants("delta_encode")) {
+    StrideraDeltaEncoder enc;
+    auto& r = b.run("delta_encode", N, [&] {
+      chr.clear();
+      enc.begin(buf, sizeof(buf));
+      for (const auto& p : pk) {
+        if (!enc.push(p)) { chr.notify(enc.data(), enc.finish()); enc.reset(); enc.push(p); }
+        if (enc.full())   { chr.notify(enc.data(), enc.finish()); enc.reset(); }
+      }
+      if (!enc.empty()) chr.notify(enc.data(), enc.finish());
+      return chr.bytes();
+    });
+    r.note = "synthetic trace carries +-20 mg noise";
+    Bench::print(r);
+  }
+
+  if (b.wants("delta_decode")) {
+    // Pre-encode all frames, then time decoding; ok = lossless
+    std::vector<std::vector<uint8_t>> frames;
+    StrideraDeltaEncoder enc;
+    enc.begin(buf, sizeof(buf));
+    for (const auto& p : pk) {
+      if (!enc.push(p)) {
+        frames.emplace_back(enc.data(), enc.data() + enc.finish());
+        enc.reset();
+        enc.push(p);
+      }
+    }
+    if (!enc.empty()) frames.emplace_back(enc.data(), enc.data() + enc.finish());
+
+    std::vector<StrideraAccelPacket> out(N);
+    size_t total = 0;
+    auto& r = b.run("delta_decode", N, [&] {
+      total = 0;
+      for (const auto& f : frames) total += stridera_delta_decode(f.data(), f.size(), &out[total], N - total);
+      return (uint64_t)0;
+    });
+    r.ok = total == N;
+    for (size_t i = 0; r.ok && i < N; ++i)
+      r.ok = out[i].ts_ms == pk[i].ts_ms && out[i].ax_mg == pk[i].ax_mg &&
+             out[i].ay_mg == pk[i].ay_mg && out[i].az_mg == pk[i].az_mg;
+    r.note = "lossless vs input";
+    Bench::print(r);
+  }
+
+  if (b.wants("packet_v2")) {
+    // Back-to-back v2 packets with CRC, 12 per MTU-247 notification (STRIDERA_FORMAT_V2)
+    const auto smp = bench_walk_samples(N);
+    const size_t per = sizeof(buf) / sizeof(StrideraAccelPacketV2);
+    auto& r = b.run("packet_v2", N, [&] {
+      chr.clear();
+      size_t n = 0;
+      for (size_t i = 0; i < N; ++i) {
+        const StrideraAccelPacketV2 p = stridera_packet_v2(smp[i], true);
+        memcpy(buf + n * sizeof(p), &p, sizeof(p));
+        if (++n == per || i + 1 == N) {
+          chr.notify(buf, n * sizeof(p));
+          n = 0;
+        }
+      }
+      return chr.bytes();
+    });
+    // Round trip, CRC and the us wrap: test/test_stream_analyzer
+    r.note = "20 B/sample incl. seq, us ts and CRC-16";
+    Bench::print(r);
+  }
+
+  if (b.wants("packet_v2_masked")) {
+    // Accel + gyro with CRC per sample, packed back to back into MTU-247 frames
+    const auto smp = bench_walk_imu_samples(N);
+    const uint8_t mask = STRIDERA_CH_ACCEL | STRIDERA_CH_GYRO;
+    const size_t size = stridera_packet_v2_size(mask);
+    auto encode = [&](std::vector<std::vector<uint8_t>>* keep) {
+      size_t len = 0;
+      for (size_t i = 0; i < N; ++i) {
+        len += stridera_packet_v2_encode(smp[i], mask, true, buf + len);
+        if (len + size > sizeof(buf) || i + 1 == N) {
+          chr.notify(buf, len);
+          if (keep) keep->emplace_back(buf, buf + len);
+          len = 0;
+        }
+      }
+    };
+    auto& r = b.run("packet_v2_masked", N, [&] {
+      chr.clear();
+      encode(nullptr);
+      return chr.bytes();
+    });
+    std::vector<std::vector<uint8_t>> frames;
+    encode(&frames);
+    // Lossless round trip through the analyzer's decoder, nothing else carried
+    StrideraSample back[32];
+    uint32_t invalid = 0;
+    size_t total = 0;
+    r.ok = true;
+    for (const auto& f : frames) {
+      const size_t got = stridera_v2_decode_samples(f.data(), f.size(), back, 32, &invalid);
+      for (size_t i = 0; r.ok && i < got; ++i) {
+        const StrideraSample& s = smp[total + i];
+        r.ok = back[i].seq == s.seq && back[i].ts_us == s.ts_us && back[i].chan_mask == mask &&
+               back[i].v1.ax_mg == s.v1.ax_mg && back[i].v1.az_mg == s.v1.az_mg &&
+               back[i].gyro[0] == s.gyro[0] && back[i].gyro[2] == s.gyro[2] && back[i].temp == 0;
+      }
+      total += got;
+    }
+    // Gyro only and nine axes; accel only keeps the fixed 0xA2 layout
+    uint8_t one[64];
+    const size_t gyro = stridera_packet_v2_encode(smp[0], STRIDERA_CH_GYRO, false, one);
+    const bool sizes  = gyro == 20 && stridera_packet_v2_size(STRIDERA_CH_ACCEL | STRIDERA_CH_GYRO | STRIDERA_CH_MAG) == 32 &&
+                        stridera_packet_v2_encode(smp[0], STRIDERA_CH_ACCEL, false, one) == 20 &&
+                        one[0] == STRIDERA_FRAME_ACCEL_V2;
+    r.ok = r.ok && total == N && invalid == 0 && sizes;
+    r.note = std::to_string(size) + " B/sample accel+gyro, gyro only " + std::to_string(gyro) +
+             ", " + std::to_string(sizeof(buf) / size) + "/frame @MTU247";
+    Bench::print(r);
+  }
+
+  if (b.wants("stream_analyze")) {
+    // Single-packet capture with known impairments: lost, corrupted, duplicated and swapped
+    // notifications, device clock stalls, 0..2 ms arrival delay; seq and the us clock both wrap
+    // (what each is reported as: test/test_stream_analyzer)
+    struct Captured { StrideraAccelPacketV2 p; uint64_t arrival_us; };
+    std::vector<Captured> cap;
+    cap.reserve(N + N / 2000);
+    uint32_t rng = 12345, stall_us = 0;
+    const uint32_t ts0 = 0xFFFFFFFFu - 5000000u;       // wraps 5 s in
+    for (size_t i = 0; i < N; ++i) {
+      if (i && i % 10000 == 900) stall_us += 100000;
+      StrideraSample s{};
+      s.v1        = pk[i];
+      s.seq       = (uint16_t)(65000 + i);
+      s.rate_hz   = 200;
+      s.chan_mask = STRIDERA_CH_ACCEL;
+      s.ts_us     = ts0 + (uint32_t)(i * 5000) + stall_us;
+      rng = rng * 1103515245u + 12345u;
+      const uint64_t arrival = 10000000ull + i * 5000ull + stall_us + (rng >> 16) % 2000;
+      Captured c{stridera_packet_v2(s, true), arrival};
+      if (i % 1000 == 100) continue;
+      if (i % 5000 == 300) c.p.az_mg ^= 1;
+      cap.push_back(c);
+      if (i % 2000 == 500) cap.push_back(c);
+      if (i % 3000 == 701) std::swap(cap[cap.size() - 1], cap[cap.size() - 2]);
+    }
+    StreamReport rep;
+    auto& r = b.run("stream_analyze", cap.size(), [&] {
+      StreamAnalyzer a;
+      for (const auto& c : cap) a.addPayload(reinterpret_cast<const uint8_t*>(&c.p), sizeof(c.p), c.arrival_us);
+      rep = a.report();
+      return (uint64_t)0;
+    });
+    char note[120];
+    snprintf(note, sizeof(note), "per notification; loss %.2f%%, jitter %.0f us (max %u), %llu stalls told apart",
+             rep.loss_pct, rep.jitter_us, rep.jitter_max_us, (unsigned long long)rep.timing_gaps);
+    r.note = note;
+    Bench::print(r);
+  }
+}
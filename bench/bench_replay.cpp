@@ -0,0 +1,290 @@
+// Replay input paths: CSV (in-place fixed-point vs strtof baseline), .ssn sessions,
+// timestamp pacing under a virtual clock and read-ahead over slow storage.
+#include <stdlib.h>
+#include <math.h>
+#include <string>
+#include <memory>
+#include "bench.h"
+#include "bench_data.h"
+#include "fakes/fake_nimble.h"
+#include "stridera_csv.h"
+#include "stridera_session.h"
+#include "replay_scheduler.h"
+#include "read_ahead.h"
+#include "replay_sim.h"
+
+namespace {
+
+std::string make_csv(const std::vector<StrideraAccelPacket>& pk) {
+  std::string s = "ts_ms,ax_g,ay_g,az_g\n";
+  char line[64];
+  for (const auto& p : pk) {
+    snprintf(line, sizeof(line), "%u,%.3f,%.3f,%.3f\n", p.ts_ms, p.ax_mg / 1000.0, p.ay_mg / 1000.0, p.az_mg / 1000.0);
+    s += line;
+  }
+  return s;
+}
+
+std::vector<uint8_t> make_session(const std::vector<StrideraAccelPacket>& pk, uint32_t stride) {
+  StrideraSessionHeader h;
+  stridera_session_header_init(h, 200, sizeof(h), stride);
+  std::vector<uint8_t> f(sizeof(h));
+  std::vector<StrideraSessionIndexEntry> idx;
+  for (uint32_t i = 0; i < pk.size(); ++i) {
+    if (i % stride == 0) idx.push_back({pk[i].ts_ms, i});
+    const StrideraSessionRecord r = stridera_session_record(pk[i]);
+    const uint8_t* b = reinterpret_cast<const uint8_t*>(&r);
+    f.insert(f.end(), b, b + sizeof(r));
+  }
+  h.record_count = (uint32_t)pk.size();
+  h.first_ts_ms  = pk.front().ts_ms;
+  h.last_ts_ms   = pk.back().ts_ms;
+  h.index_offset = (uint32_t)f.size();
+  h.index_count  = (uint32_t)idx.size();
+  const uint8_t* ib = reinterpret_cast<const uint8_t*>(idx.data());
+  f.insert(f.end(), ib, ib + idx.size() * sizeof(StrideraSessionIndexEntry));
+  memcpy(f.data(), &h, sizeof(h));
+  return f;
+}
+
+// CsvReplay's reader interface over an in-memory CSV
+struct MemCsvReplay {
+  const std::string* text = nullptr;
+  MemSource src;
+  StrideraCsvLineReader<MemSource> lines;
+  uint8_t columns = STRIDERA_CH_ACCEL;
+
+  bool rewind() {
+    src.assign(reinterpret_cast<const uint8_t*>(text->data()), text->size());
+    lines.begin(&src);
+    const char *s, *e;
+    columns = lines.next(s, e) ? stridera_csv_columns(s, e) : STRIDERA_CH_ACCEL;
+    return true;
+  }
+  bool readNext(StrideraSample& out, uint16_t rate) {
+    const char *s, *e;
+    while (lines.next(s, e)) if (stridera_parse_csv_sample(s, e, out, rate, columns)) return true;
+    return false;
+  }
+};
+
+// Virtual clock: 10 ms ticks with +-2 ms jitter and one 300 ms stall 5 s in
+struct PacingRun {
+  std::vector<uint32_t> ts;        // released ts_us, in order
+  ReplayStats st;
+};
+
+PacingRun run_pacing(const std::string& csv, const ReplayConfig& cfg, uint32_t secs) {
+  MemCsvReplay src;
+  src.text = &csv;
+  src.rewind();
+  ReplayScheduler<MemCsvReplay> sch;
+  PacingRun out;
+  if (!sch.begin(&src, cfg)) return out;
+  uint64_t now = 1000000, rng = 99;
+  const uint64_t start = now, end = start + secs * 1000000ull;
+  sch.start(now);
+  auto emit = [&](StrideraSample& s) { out.ts.push_back(s.ts_us); };
+  bool stalled = false;
+  while (now < end) {
+    rng = rng * 6364136223846793005ull + 1442695040888963407ull;
+    now += 10000 + (int)((rng >> 33) % 4001) - 2000;
+    if (!stalled && now > start + 5000000) { now += 300000; stalled = true; }
+    if (now > end) now = end;
+    sch.poll(now, emit);
+  }
+  while (sch.poll(end, emit) == cfg.max_burst) {}
+  out.st = sch.stats();
+  return out;
+}
+
+bool same(const StrideraAccelPacket& a, const StrideraAccelPacket& b) {
+  return a.ts_ms == b.ts_ms && a.ax_mg == b.ax_mg && a.ay_mg == b.ay_mg && a.az_mg == b.az_mg;
+}
+
+}  // namespace
+
+void bench_replay(Bench& b, const BenchOptions&) {
+  const size_t N = 200000;
+  const auto pk  = bench_walk_packets(N);
+  const std::string csv = make_csv(pk);
+
+  if (b.wants("csv_parse")) {
+    MemSource src;
+    StrideraCsvLineReader<MemSource> lines;
+    size_t rows = 0, bad = 0;
+    auto& r = b.run("csv_parse", N, [&] {
+      src.assign(reinterpret_cast<const uint8_t*>(csv.data()), csv.size());
+      lines.begin(&src);
+      const char *s, *e;
+      (void)lines.next(s, e);                        // header
+      rows = bad = 0;
+      StrideraAccelPacket p;
+      while (lines.next(s, e)) {
+        if (stridera_parse_csv_row(s, e, p, 200)) { bad += !same(p, pk[rows]); ++rows; }
+      }
+      return (uint64_t)0;
+    });
+    r.ok   = rows == N && bad == 0;
+    r.note = "in-place fixed point, exact vs source mg";
+    Bench::print(r);
+  }
+
+  if (b.wants("csv_parse_imu")) {
+    // Multi-channel recording: the header picks the column groups
+    const auto sm = bench_walk_imu_samples(N);
+    const std::string imu = make_imu_csv(sm);
+    MemSource src;
+    StrideraCsvLineReader<MemSource> lines;
+    size_t rows = 0, bad = 0;
+    uint8_t cols = 0;
+    auto& r = b.run("csv_parse_imu", N, [&] {
+      src.assign(reinterpret_cast<const uint8_t*>(imu.data()), imu.size());
+      lines.begin(&src);
+      const char *s, *e;
+      cols = lines.next(s, e) ? stridera_csv_columns(s, e) : 0;
+      rows = bad = 0;
+      StrideraSample p;
+      while (lines.next(s, e)) {
+        if (!stridera_parse_csv_sample(s, e, p, 200, cols)) continue;
+        const StrideraSample& q = sm[rows++];
+        bad += !same(p.v1, q.v1) || memcmp(p.gyro, q.gyro, sizeof(p.gyro)) || p.temp != q.temp;
+      }
+      return (uint64_t)0;
+    });
+    // A row short of the gyro columns the header promised is malformed
+    const char row[] = "5,0.1,0.2,1.0,3.5\n";
+    StrideraSample p;
+    const bool shortRow = !stridera_parse_csv_sample(row, row + sizeof(row) - 2, p, 200, cols);
+    r.ok   = cols == (STRIDERA_CH_ACCEL | STRIDERA_CH_GYRO | STRIDERA_CH_TEMP) && rows == N && bad == 0 && shortRow;
+    r.note = "accel + gyro + temp columns, exact vs source";
+    Bench::print(r);
+  }
+
+  if (b.wants("csv_strtof")) {
+    // Baseline: copy each line into a string and strtof() the fields
+    size_t rows = 0, bad = 0;
+    auto& r = b.run("csv_strtof", N, [&] {
+      rows = bad = 0;
+      size_t pos = csv.find('\n') + 1;
+      while (pos < csv.size()) {
+        const size_t nl = csv.find('\n', pos);
+        std::string line = csv.substr(pos, nl - pos);
+        pos = nl + 1;
+        char* p = &line[0];
+        const uint32_t ts = (uint32_t)strtoul(p, &p, 10);
+        const float ax = strtof(p + 1, &p), ay = strtof(p + 1, &p), az = strtof(p + 1, &p);
+        const StrideraAccelPacket q{ts, (int16_t)lrintf(ax * 1000.0f), (int16_t)lrintf(ay * 1000.0f),
+                                    (int16_t)lrintf(az * 1000.0f), 200, 0};
+        bad += !same(q, pk[rows]);
+        ++rows;
+      }
+      return (uint64_t)0;
+    });
+    r.ok   = rows == N && bad == 0;
+    r.note = "baseline: std::string + strtof per row";
+    Bench::print(r);
+  }
+
+  const std::vector<uint8_t> ssn = make_session(pk, 256);
+
+  if (b.wants("session_read")) {
+    MemSource src(ssn.data(), ssn.size());
+    StrideraSessionReader<MemSource> rd;
+    size_t rows = 0, bad = 0;
+    auto& r = b.run("session_read", N, [&] {
+      rd.begin(&src);
+      rows = bad = 0;
+      StrideraAccelPacket p;
+      while (rd.next(p, 200)) { bad += !same(p, pk[rows]); ++rows; }
+      return (uint64_t)0;
+    });
+    r.ok = rows == N && bad == 0;
+    r.bytes_per_sample = (double)ssn.size() / N;     // file size per sample
+    r.note = "bytes = file size incl. header/index";
+    Bench::print(r);
+  }
+
+  if (b.wants("session_seek")) {
+    MemSource src(ssn.data(), ssn.size());
+    StrideraSessionReader<MemSource> rd;
+    rd.begin(&src);
+    const size_t seeks = 20000;
+    size_t bad = 0;
+    auto& r = b.run("session_seek", seeks, [&] {
+      bad = 0;
+      uint32_t x = 1;
+      for (size_t i = 0; i < seeks; ++i) {
+        x = x * 1664525u + 1013904223u;
+        const size_t want = x % N;
+        StrideraAccelPacket p;
+        if (!rd.seekMs(pk[want].ts_ms) || !rd.next(p, 200) || !same(p, pk[want])) ++bad;
+      }
+      return (uint64_t)0;
+    });
+    r.ok   = bad == 0;
+    r.note = "per seekMs (index binary search + stride scan)";
+    Bench::print(r);
+  }
+
+  if (b.wants("replay_pacing")) {
+    // 10 s at 200 Hz played at 4x (10 loops) for 25 s of virtual time, through one stall
+    const std::string clip = make_csv(std::vector<StrideraAccelPacket>(pk.begin(), pk.begin() + 2000));
+    ReplayConfig cfg;
+    cfg.speed_x100 = 400;
+    cfg.loop       = true;
+    PacingRun catchUp;
+    auto& r = b.run("replay_pacing", 25 * 800, [&] {
+      catchUp = run_pacing(clip, cfg, 25);
+      return (uint64_t)0;
+    });
+    // The same stall under DROP and SLIP (exact checks: test/test_replay_scheduler)
+    cfg.policy = STRIDERA_REPLAY_DROP;
+    const PacingRun drop = run_pacing(clip, cfg, 25);
+    cfg.policy = STRIDERA_REPLAY_SLIP;
+    const PacingRun slip = run_pacing(clip, cfg, 25);
+    char note[160];
+    snprintf(note, sizeof(note), "per row @4x; %.1f/%.1f Hz, stall: catch-up late %u ms, drop %u rows, slip %u",
+             catchUp.st.achieved_mhz / 1000.0, catchUp.st.target_mhz / 1000.0, catchUp.st.late_max_us / 1000,
+             drop.st.dropped, slip.st.slips);
+    r.note = note;
+    Bench::print(r);
+  }
+
+  if (b.wants("replay_prefetch")) {
+    // 2000-row 6-axis clip (~110 KB) looped at 4x for 20 s of virtual time. Storage:
+    // 2 MB/s plus a 150 ms stall every 64 KB (~350 KB/s average, 8x what 4x needs).
+    std::vector<StrideraSample> sm(2000);
+    for (size_t i = 0; i < sm.size(); ++i) {
+      sm[i] = {};
+      sm[i].v1 = pk[i];
+      sm[i].gyro[0] = (int16_t)(i % 900);
+      sm[i].gyro[1] = (int16_t)-(int)(i % 700);
+      sm[i].gyro[2] = 12;
+      sm[i].temp    = 2531;
+    }
+    const std::string clip = make_imu_csv(sm);
+    SlowFile spiky;
+    spiky.us_per_kb = 500;
+    spiky.spike_us  = 150000;
+    SlowFile slow;                                  // 100 KB/s: less than 20x needs (~230 KB/s)
+    slow.us_per_kb = 10000;
+
+    PrefetchRun ahead;
+    auto& r = b.run("replay_prefetch", 20 * 800, [&] {
+      ahead = run_prefetch(clip, spiky, 400, 20, true);
+      return (uint64_t)0;
+    });
+    // Inline reads and starved storage for the note (bounds: test/test_read_ahead)
+    const PrefetchRun direct  = run_prefetch(clip, spiky, 400, 20, false);
+    const PrefetchRun starved = run_prefetch(clip, slow, 2000, 5, true);
+    char note[200];
+    snprintf(note, sizeof(note),
+             "per row @4x; read-ahead: %u stalls, depth min %u/%u, late max %u ms, read %u KB/s; "
+             "inline: late max %u ms; starved: %u stalls",
+             ahead.ra.stalls, ahead.ra.depth_min, (unsigned)BenchAhead::capacity(), ahead.st.late_max_us / 1000,
+             ahead.ra.kbps(), direct.st.late_max_us / 1000, starved.ra.stalls);
+    r.note = note;
+    Bench::print(r);
+  }
+}
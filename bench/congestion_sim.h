@@ -0,0 +1,67 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+#include "fakes/fake_nimble.h"
+#include "fanout.h"
+
+// Congestion scenario shared by the link_congestion stage and test/test_link_congestion
+
+// One 200 Hz central on a FakeCentrals link whose capacity changes every 10 s
+struct LinkPhase { uint32_t interval_ms; uint16_t per_event; };
+
+struct CongestionRun {
+  FanOutStats     st{};
+  CongestionStats cong{};
+  uint64_t        delivered   = 0;
+  uint32_t        lateDropped = 0;          // dropped after the first 2 s of a squeeze (policy settled)
+  bool            ordered     = true;
+  uint64_t        rejected    = 0;
+};
+
+static inline CongestionRun run_congestion(const std::vector<StrideraSample>& smp, const LinkPhase* phases, size_t nPhases,
+                                           uint8_t format, uint8_t max_level) {
+  static CentralStream<8, 244> s;                   // ~2 KB of frames: keep it off the stack
+  FakeCentrals link;
+  link.add(1, 247, phases[0].interval_ms, phases[0].per_event);
+  CongestionConfig cfg;
+  cfg.max_level = max_level;
+  s.close();
+  s.setCongestion(cfg);
+  s.open(1, 247);
+  s.setFormat(format);
+  s.setBatch(true);
+  FanOutStats ended;
+  uint16_t endedConn;
+  s.sync(ended, endedConn);
+
+  CongestionRun out;
+  const size_t n = nPhases * 2000;                  // 10 s per phase at 200 Hz
+  uint32_t now = 0;
+  for (size_t i = 0; i < n; ++i) {
+    now = (uint32_t)i * 5;
+    const LinkPhase& ph = phases[i / 2000];
+    link.at(0).interval_ms = ph.interval_ms;
+    link.at(0).per_event   = ph.per_event;
+    const uint32_t before = s.stats().dropped_samples;
+    s.push(smp[i], now);
+    if ((i & 3) == 3) {                             // loop wake every 20 ms
+      link.advance(now);
+      s.flushDue(now, 50);
+      s.pump(link, 8);
+    }
+    const bool squeezed = ph.per_event * phases[0].interval_ms < phases[0].per_event * ph.interval_ms;
+    if (squeezed && i % 2000 >= 400) out.lateDropped += s.stats().dropped_samples - before;
+  }
+  for (int k = 0; k < 400; ++k) {                   // drain
+    now += 20;
+    link.advance(now);
+    s.flushDue(now, 0);
+    s.pump(link, 8);
+  }
+  out.st        = s.stats();
+  out.cong      = s.congestion();
+  out.delivered = link.at(0).samples;
+  out.ordered   = link.at(0).ordered;
+  out.rejected  = link.at(0).rejected;
+  return out;
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include <stdint.h>
+#include <math.h>
+#include "iaccelerometer.h"
+
+/**
+ * FakeAccelerometer — stands in for AccelM5Unified on the host.
+ * Produces a deterministic walking signal (gravity on z, step bumps at
+ * `step_hz`, sensor noise and an optional high-frequency vibration that
+ * aliases if not filtered) and hands it out FIFO-style through read_batch().
+ */
+class FakeAccelerometer : public IAccelerometer {
+public:
+  float step_hz   = 1.8f;     // 0 = standing still
+  float step_mg   = 350.0f;
+  float vib_hz    = 430.0f;   // vibration tone (0 = none)
+  float vib_mg    = 150.0f;
+  uint32_t frames_per_batch = 5;
+
+  bool begin() override { n_ = 0; phase_ = 0; steps_ = 0; seed_ = 12345; return true; }
+
+  void read_mg(int16_t& ax, int16_t& ay, int16_t& az) override {
+    AccelSample s;
+    next(s);
+    ax = s.ax_mg; ay = s.ay_mg; az = s.az_mg;
+  }
+
+  uint16_t sample_rate_hz() const override { return rate_; }
+  uint16_t set_odr_hz(uint16_t hz) override { rate_ = hz ? hz : 1; return rate_; }
+  bool has_fifo() const override { return true; }
+
+  size_t read_batch(AccelSample* out, size_t max) override {
+    const size_t n = frames_per_batch < max ? frames_per_batch : max;
+    for (size_t i = 0; i < n; ++i) next(out[i]);
+    return n;
+  }
+
+  uint32_t trueSteps() const { return steps_; }      // step peaks generated so far
+
+private:
+  void next(AccelSample& s) {
+    const float t = (float)n_++ / (float)rate_;
+    float bump = 0.0f;
+    if (step_hz > 0.0f) {
+      const float prev = phase_;
+      phase_ += 2.0f * (float)M_PI * step_hz / (float)rate_;
+      if (floorf((prev - (float)M_PI / 2) / (2.0f * (float)M_PI)) !=
+          floorf((phase_ - (float)M_PI / 2) / (2.0f * (float)M_PI))) ++steps_;
+      bump = step_mg * sinf(phase_) + 0.3f * step_mg * sinf(2.0f * phase_ + 1.0f);
+    }
+    const float vib = vib_hz > 0.0f ? vib_mg * sinf(2.0f * (float)M_PI * vib_hz * t) : 0.0f;
+    s.ax_mg = (int16_t)(20 + noise());
+    s.ay_mg = (int16_t)(-30 + noise() + vib);
+    s.az_mg = (int16_t)(1000 + bump + noise() + vib);
+  }
+
+  float noise() {                                      // cheap deterministic +-20 mg
+    seed_ = seed_ * 1103515245u + 12345u;
+    return (float)((int32_t)((seed_ >> 16) & 0x7FFF) % 41 - 20);
+  }
+
+  uint16_t rate_  = 200;
+  uint32_t n_     = 0;
+  float    phase_ = 0.0f;
+  uint32_t steps_ = 0;
+  uint32_t seed_  = 12345;
+};
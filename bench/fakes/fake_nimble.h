@@ -0,0 +1,153 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <vector>
+#include "block_file.h"
+#include "bulk_transfer.h"
+#include "fanout.h"
+
+/**
+ * Host stand-ins for the NimBLE and storage sides of the data path.
+ * - FakeNotifyCharacteristic: what BleService calls notify() on; counts
+ *   notifications and payload bytes, rejects payloads over MTU - 3.
+ * - MemBlockFile: IBlockFile in RAM (SessionRecorder target).
+ * - MemSource: read/seek file cursor for the replay readers, IBulkSource for
+ *   the bulk sender.
+ * - FakeCentrals: IFanOutSink for several centrals, each taking at most
+ *   `per_event` notifications per connection interval (what the host's
+ *   buffers drain at); decodes what it accepts so the bench can check it.
+ */
+class FakeNotifyCharacteristic {
+public:
+  explicit FakeNotifyCharacteristic(uint16_t mtu = 247) : mtu_(mtu) {}
+  bool notify(const uint8_t* buf, size_t len) {
+    if (len > (size_t)(mtu_ - 3)) { ++rejected_; return false; }
+    ++notifies_;
+    bytes_ += len;
+    last_ = buf[0];
+    return true;
+  }
+  uint16_t mtu() const      { return mtu_; }
+  uint64_t notifies() const { return notifies_; }
+  uint64_t bytes() const    { return bytes_; }
+  uint64_t rejected() const { return rejected_; }
+  void     clear()          { notifies_ = bytes_ = rejected_ = 0; }
+
+private:
+  uint16_t mtu_;
+  uint64_t notifies_ = 0;
+  uint64_t bytes_    = 0;
+  uint64_t rejected_ = 0;
+  uint8_t  last_     = 0;
+};
+
+class MemBlockFile : public IBlockFile {
+public:
+  bool create(const char*) override { data.clear(); return true; }
+  bool preallocate(uint32_t bytes) override { data.reserve(bytes); return true; }
+  bool writeAt(uint32_t offset, const uint8_t* buf, size_t len) override {
+    if (data.size() < offset + len) data.resize(offset + len);
+    memcpy(data.data() + offset, buf, len);
+    return true;
+  }
+  bool truncate(uint32_t bytes) override { data.resize(bytes); return true; }
+  void close() override {}
+
+  std::vector<uint8_t> data;
+};
+
+class MemSource : public IBulkSource {
+public:
+  MemSource() = default;
+  MemSource(const uint8_t* d, size_t n) : d_(d), n_(n) {}
+  void assign(const uint8_t* d, size_t n) { d_ = d; n_ = n; pos_ = 0; }
+
+  // cursor API (StrideraCsvLineReader / StrideraSessionReader)
+  size_t read(uint8_t* buf, size_t len) {
+    if (pos_ >= n_) return 0;
+    if (len > n_ - pos_) len = n_ - pos_;
+    memcpy(buf, d_ + pos_, len);
+    pos_ += len;
+    return len;
+  }
+  bool seek(uint32_t off) { if (off > n_) return false; pos_ = off; return true; }
+
+  // IBulkSource
+  uint32_t size() const override { return (uint32_t)n_; }
+  size_t readAt(uint32_t off, uint8_t* buf, size_t len) override {
+    if (off >= n_) return 0;
+    if (len > n_ - off) len = n_ - off;
+    memcpy(buf, d_ + off, len);
+    return len;
+  }
+
+private:
+  const uint8_t* d_ = nullptr;
+  size_t n_   = 0;
+  size_t pos_ = 0;
+};
+
+class FakeCentrals : public IFanOutSink {
+public:
+  struct Central {
+    uint16_t conn        = STRIDERA_CONN_NONE;
+    uint16_t mtu         = 247;
+    uint32_t interval_ms = 15;
+    uint16_t per_event   = 4;
+    uint32_t next_ms     = 0;
+    uint16_t credits     = 0;
+    uint64_t samples     = 0;                    // decoded from accepted notifications
+    uint64_t rejected    = 0;                    // over MTU - 3 or not a valid frame
+    uint32_t last_ts     = 0;
+    StrideraUsClock clock;                       // v2: ms keep counting across the µs wrap
+    bool     ordered     = true;                 // timestamps never go backwards
+  };
+
+  Central& add(uint16_t conn, uint16_t mtu, uint32_t interval_ms, uint16_t per_event) {
+    Central c;
+    c.conn = conn; c.mtu = mtu; c.interval_ms = interval_ms; c.per_event = per_event;
+    centrals_.push_back(c);
+    return centrals_.back();
+  }
+  Central& at(size_t i) { return centrals_[i]; }
+
+  // Connection events up to now_ms refill each central's buffer credits
+  void advance(uint32_t now_ms) {
+    for (auto& c : centrals_) {
+      if (now_ms >= c.next_ms) { c.credits = c.per_event; c.next_ms = now_ms + c.interval_ms; }
+    }
+  }
+
+  bool notify(uint16_t conn, FanOutChannel ch, const uint8_t* data, size_t len) override {
+    Central* c = find(conn);
+    if (!c) return true;                         // disconnected: the host drops it
+    if (!c->credits) return false;
+    --c->credits;
+    StrideraAccelPacket p[256];
+    size_t n = 0;
+    if (len > (size_t)(c->mtu - 3)) { ++c->rejected; return true; }
+    if ((data[0] == STRIDERA_FRAME_ACCEL_V2 || data[0] == STRIDERA_FRAME_IMU_V2) && len != sizeof(StrideraAccelPacket)) {
+      StrideraSample v2[32];                     // either v2 layout, any channel mask
+      n = stridera_v2_decode_samples(data, len, v2, 32, nullptr, &c->clock);
+      for (size_t i = 0; i < n; ++i) p[i] = v2[i].v1;
+    }
+    else if (ch == FanOutChannel::Legacy) { memcpy(&p[0], data, sizeof(p[0])); n = 1; }
+    else if (data[0] == STRIDERA_FRAME_BATCH) n = stridera_batch_decode(data, len, p, 256);
+    else n = stridera_delta_decode(data, len, p, 256);
+    if (!n) ++c->rejected;
+    for (size_t i = 0; i < n; ++i) {
+      if (p[i].ts_ms < c->last_ts) c->ordered = false;
+      c->last_ts = p[i].ts_ms;
+    }
+    c->samples += n;
+    return true;
+  }
+
+private:
+  Central* find(uint16_t conn) {
+    for (auto& c : centrals_) if (c.conn == conn) return &c;
+    return nullptr;
+  }
+  std::vector<Central> centrals_;
+};
@@ -0,0 +1,173 @@
+#pragma once
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "stridera_csv.h"
+#include "replay_scheduler.h"
+#include "read_ahead.h"
+
+// Replay over slow storage on a virtual clock, shared by the replay_prefetch
+// stage and test/test_read_ahead
+
+// With gyro (dps) and temperature (degC) columns
+static inline std::string make_imu_csv(const std::vector<StrideraSample>& sm) {
+  std::string s = "ts_ms,ax_g,ay_g,az_g,gx_dps,gy_dps,gz_dps,temp_c\n";
+  char line[128];
+  for (const auto& p : sm) {
+    snprintf(line, sizeof(line), "%u,%.3f,%.3f,%.3f,%.1f,%.1f,%.1f,%.2f\n", p.v1.ts_ms, p.v1.ax_mg / 1000.0,
+             p.v1.ay_mg / 1000.0, p.v1.az_mg / 1000.0, p.gyro[0] / 10.0, p.gyro[1] / 10.0, p.gyro[2] / 10.0,
+             p.temp / 100.0);
+    s += line;
+  }
+  return s;
+}
+
+inline uint64_t g_nowUs = 0;                       // both sides' virtual clock
+static inline uint32_t vclock() { return (uint32_t)g_nowUs; }
+
+// In-memory file that costs time: us_per_kb per byte read plus a spike_us
+// stall whenever a read crosses a spike_bytes boundary (FAT cluster chain
+// walks, SD garbage collection). Reads advance g_nowUs.
+struct SlowFile {
+  const uint8_t* d = nullptr;
+  size_t   n = 0, pos = 0;
+  uint32_t us_per_kb   = 500;
+  uint32_t spike_us    = 0;
+  uint32_t spike_bytes = 65536;
+
+  uint32_t latency(size_t at, size_t len) const {
+    if (at >= n) return us_per_kb / 8;                 // EOF probe: a directory lookup
+    if (len > n - at) len = n - at;
+    uint32_t us = (uint32_t)(len * us_per_kb / 1024);
+    if (spike_us && (at / spike_bytes != (at + len - 1) / spike_bytes || (at && at % spike_bytes == 0))) us += spike_us;
+    return us;
+  }
+  size_t read(uint8_t* buf, size_t len) {
+    g_nowUs += latency(pos, len);
+    if (pos >= n) return 0;
+    if (len > n - pos) len = n - pos;
+    memcpy(buf, d + pos, len);
+    pos += len;
+    return len;
+  }
+  bool seek(uint32_t p) { pos = p; return p <= n; }
+};
+
+// CsvReplay's reader interface over any cursor source
+template <typename Src>
+struct SrcCsvReplay {
+  Src* src = nullptr;
+  StrideraCsvLineReader<Src> lines;
+  uint8_t columns = STRIDERA_CH_ACCEL;
+
+  bool rewind() {
+    if (!src->seek(0)) return false;
+    lines.begin(src);
+    const char *s, *e;
+    columns = lines.next(s, e) ? stridera_csv_columns(s, e) : STRIDERA_CH_ACCEL;
+    return true;
+  }
+  bool readNext(StrideraSample& out, uint16_t rate) {
+    const char *s, *e;
+    while (lines.next(s, e)) if (stridera_parse_csv_sample(s, e, out, rate, columns)) return true;
+    return false;
+  }
+};
+
+using BenchAhead = ReadAhead<SlowFile, 4096, 8>;
+
+// The fill task as an actor on the virtual clock: it may start a block once
+// the previous one is done and a slot is free (freed at the last parser tick),
+// and the block is visible once its read finishes.
+struct FillSim {
+  BenchAhead* ra   = nullptr;
+  SlowFile*   file = nullptr;
+  uint64_t    freeAt   = 0;                        // fill side idle from
+  uint64_t    freedAt  = 0;                        // parser's last tick (slots freed by then)
+  uint64_t    inflight = UINT64_MAX;               // start of the block being read
+
+  uint64_t nextDone() {
+    if (inflight == UINT64_MAX) inflight = freeAt > freedAt ? freeAt : freedAt;
+    return inflight + file->latency(ra->fillPosition(), 4096);
+  }
+  void finish() {                                  // complete the in-flight block
+    const uint64_t parser = g_nowUs;
+    g_nowUs = inflight;
+    ra->service();                                 // SlowFile::read advances g_nowUs
+    freeAt   = g_nowUs;
+    inflight = UINT64_MAX;
+    g_nowUs  = parser > freeAt ? parser : freeAt;
+  }
+  void runUntil(uint64_t t) {
+    while (ra->fillPending() && nextDone() <= t) finish();
+  }
+  // ReadAhead WaitFn: the parser is blocked until the next block lands
+  static void wait(void* arg) {
+    auto* f = static_cast<FillSim*>(arg);
+    if (!f->ra->fillPending()) return;
+    f->freedAt = g_nowUs;
+    f->nextDone();
+    f->finish();
+  }
+};
+
+struct PrefetchRun {
+  std::vector<uint32_t> ts;
+  ReplayStats    st{};
+  ReadAheadStats ra{};
+};
+
+// 10 ms parser ticks over `secs` of virtual time; a stalled tick delays the next one.
+// ahead = false reads the slow file directly from the parser (the old CsvReplay).
+static inline PrefetchRun run_prefetch(const std::string& csv, SlowFile file, uint16_t speed_x100, uint32_t secs, bool ahead) {
+  PrefetchRun out;
+  file.d = reinterpret_cast<const uint8_t*>(csv.data());
+  file.n = csv.size();
+  g_nowUs = 1000000;
+
+  std::unique_ptr<BenchAhead> ra(new BenchAhead);
+  FillSim fill;
+  fill.ra   = ra.get();
+  fill.file = &file;
+  ra->setClock(&vclock);
+  ra->setWait(&FillSim::wait, &fill);
+
+  ReplayConfig cfg;
+  cfg.speed_x100 = speed_x100;
+  cfg.loop       = true;
+  cfg.max_burst  = 256;
+  auto emit = [&](StrideraSample& s) { out.ts.push_back(s.ts_us); };
+  auto play = [&](auto& player) {
+    ReplayScheduler<typename std::remove_reference<decltype(player)>::type> sch;
+    if (!player.rewind() || !sch.begin(&player, cfg)) return;
+    uint64_t t = g_nowUs;
+    const uint64_t end = t + secs * 1000000ull;
+    fill.freeAt = fill.freedAt = t;
+    sch.start(t);
+    while (t < end) {
+      if (ahead) fill.runUntil(t);
+      g_nowUs = t;
+      fill.freedAt = t;
+      sch.poll(t, emit);
+      t = t + 10000 > g_nowUs ? t + 10000 : g_nowUs;   // the IMU task was blocked until g_nowUs
+    }
+    out.st = sch.stats();
+  };
+  if (ahead) {
+    ra->begin(&file);                              // head block read at setup, before the clock starts
+    g_nowUs = 1000000;
+    SrcCsvReplay<BenchAhead> player;
+    player.src = ra.get();
+    play(player);
+    out.ra = ra->stats();
+  } else {
+    SrcCsvReplay<SlowFile> player;
+    player.src = &file;
+    play(player);
+  }
+  return out;
+}
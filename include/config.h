@@ -3,19 +3,113 @@
 // ===== BLE UUIDs (kept same as your current firmware) =====
 #define STRIDERA_SERVICE_UUID "7b9d1f00-8d2a-4b3a-94c1-6b8a1a9b7c10"
 #define STRIDERA_CHAR_UUID    "7b9d1f01-8d2a-4b3a-94c1-6b8a1a9b7c10"
+#define STRIDERA_BATCH_CHAR_UUID "7b9d1f02-8d2a-4b3a-94c1-6b8a1a9b7c10"  // batched frames (stridera_batch.h / stridera_delta.h)
+#define STRIDERA_FORMAT_CHAR_UUID "7b9d1f03-8d2a-4b3a-94c1-6b8a1a9b7c10" // R/W: [STRIDERA_FORMAT_*, single-sample packet version, v2 flags, v2 channel mask], per connection
+#define STRIDERA_LINK_DIAG_CHAR_UUID "7b9d1f04-8d2a-4b3a-94c1-6b8a1a9b7c10" // R/N: StrideraLinkDiag (stridera_link_diag.h)
+#define STRIDERA_GAIT_CHAR_UUID   "7b9d1f05-8d2a-4b3a-94c1-6b8a1a9b7c10" // R/N: StrideraGaitPacket per step (stridera_gait.h)
+#define STRIDERA_PERF_CHAR_UUID   "7b9d1f06-8d2a-4b3a-94c1-6b8a1a9b7c10" // R/N: hot-path timing (stridera_perf.h), STRIDERA_PERF builds only
+#define STRIDERA_CONTROL_CHAR_UUID "7b9d1f07-8d2a-4b3a-94c1-6b8a1a9b7c10" // R/W/N: StrideraControl (stridera_control.h), reply = applied
+#define STRIDERA_QUAT_CHAR_UUID   "7b9d1f08-8d2a-4b3a-94c1-6b8a1a9b7c10" // R/N: StrideraQuatPacket (stridera_quat.h) at the control's quat_hz
+
+// Bulk session download (stridera_bulk.h)
+#define STRIDERA_BULK_SERVICE_UUID "7b9d1f10-8d2a-4b3a-94c1-6b8a1a9b7c10"
+#define STRIDERA_BULK_CTRL_UUID    "7b9d1f11-8d2a-4b3a-94c1-6b8a1a9b7c10"  // W: LIST / GET / CREDIT / ABORT / CAPTURE
+#define STRIDERA_BULK_DATA_UUID    "7b9d1f12-8d2a-4b3a-94c1-6b8a1a9b7c10"  // N: LIST / CHUNK / STATUS frames
 
 // ===== App identity =====
 #ifndef STRIDERA_DEVICE_NAME
   #define STRIDERA_DEVICE_NAME "Stridera-Unknown"
 #endif
 
+// ===== BLE streaming =====
+#define BLE_PREFERRED_MTU        247
+#define BLE_BATCH_MAX_LATENCY_MS 50    // flush a partial batch after this long
+#define BLE_LINK_DIAG_PERIOD_MS  1000  // diagnostics characteristic refresh
+#define BLE_LINK_POLL_MS         100   // link policy tick while PHY/params are being negotiated
+#define BLE_MAX_CENTRALS         3     // simultaneous centrals (<= CONFIG_BT_NIMBLE_MAX_CONNECTIONS)
+#define BLE_FANOUT_QUEUE         8     // finished frames queued per central before the oldest is dropped
+#define BLE_FANOUT_BURST         8     // notifications per central per pump, round-robin
+#define BLE_FANOUT_RETRY_MS      10    // re-pump after the host stack refused a notification
+#define BLE_CONG_WINDOW_MS       250   // congestion control evaluates each central's queue this often
+#define BLE_CONG_CALM_WINDOWS    8     // calm windows in a row before easing off one level
+#define BLE_CONG_MAX_LEVEL       STRIDERA_CONG_QUARTER   // worst reaction allowed (congestion_policy.h), NONE = off
+
+// ===== Hot-path probes (build with -D STRIDERA_PERF=1) =====
+#define PERF_SERIAL_PERIOD_MS    10000 // [PERF] table on serial while sampling
+
 // ===== Tasking =====
-#define IMU_TASK_STACK   4096
+#define IMU_TASK_STACK   6144   // a tick holds a 36-frame 6-axis burst plus its SoA copies
 #define IMU_TASK_PRIO    2
 #define IMU_TASK_CORE    1
+#define IMU_RING_CAPACITY 256   // samples queued between IMU task and BLE (power of two)
+#define GAIT_RING_CAPACITY 16   // step events queued between IMU task and BLE (power of two)
+#define QUAT_RING_CAPACITY 16   // orientation packets queued between IMU task and BLE (power of two)
+
+// ===== SD recording (STRIDERA_HAS_SD) =====
+#define REC_TASK_STACK     4096
+#define REC_TASK_PRIO      1       // below IMU and loop: FAT stalls only delay the writer
+#define REC_TASK_CORE      0
+#define REC_BUFFER_BYTES   4096    // per buffer, two buffers (whole sectors)
+#define REC_PREALLOC_BYTES (4UL * 1024 * 1024)  // ~35 min @200 Hz, file grows past it if needed
+
+// ===== Bulk download =====
+#define BULK_TASK_STACK       4096
+#define BULK_TASK_PRIO        1       // background: never competes with sampling
+#define BULK_TASK_CORE        0
+#define BULK_CHUNKS_PER_PUMP  8       // notifies queued per wakeup
+#define BULK_RETRY_MS         2       // back-off when the controller is out of buffers
+#define BULK_SEND_TIMEOUT_MS  1000    // LIST frame refused this long: abort the listing
+
+// ===== Sampling =====
+#define IMU_SAMPLE_RATE_HZ 200  // output rate (ring / BLE / SD)
+#define IMU_OVERSAMPLE     5    // FIFO sensors run at IMU_SAMPLE_RATE_HZ x this (MPU6886: <= 1000 Hz), then decimate
+#define IMU_DECIM_TAPS     64   // anti-alias FIR length (multiple of 4)
+#define IMU_DECIM_CUTOFF_HZ 50  // <= output/4: stride content is < 20 Hz, the rest is vibration
+#define IMU_TICK_MS        10   // esp_timer period; each tick drains the sensor FIFO
+#define IMU_RATE_MIN_HZ    10   // runtime rate range (control characteristic)
+#define IMU_RATE_MAX_HZ    500
+
+// ===== Replay (/snapchat.ssn or /snapchat.csv instead of the sensor) =====
+#define REPLAY_SPEED_X100  100    // 25..2000 = 0.25x..20x the recorded rate (the control rate scales it too)
+#define REPLAY_LOOP        1      // rewind at the end of the file
+#define REPLAY_POLICY      STRIDERA_REPLAY_CATCH_UP   // behind schedule: CATCH_UP / DROP / SLIP (replay_scheduler.h)
+#define REPLAY_MAX_LAG_MS  100    // DROP / SLIP kick in beyond this
+#define REPLAY_MAX_BURST   64     // rows per IMU tick at most (ring: IMU_RING_CAPACITY)
+#define REPLAY_PREFETCH_BLOCK_BYTES 4096   // read-ahead block (whole sectors); the first one stays resident
+#define REPLAY_PREFETCH_BLOCKS      8      // blocks read ahead of the parser (power of two): ~2.5 s of 200 Hz 6-axis CSV at 1x
+#define REPLAY_PREFETCH_TASK_STACK  3072
+#define REPLAY_PREFETCH_TASK_PRIO   1      // below IMU and loop: storage stalls only cost ring depth
+#define REPLAY_PREFETCH_TASK_CORE   0
+
+// ===== Orientation (gyro sensors only) =====
+#define AHRS_QUAT_HZ       50     // quaternion notify rate, 0 = off (control characteristic: quat_hz)
+#define AHRS_KP_MILLI      1000   // Mahony proportional gain x1000 (1/s): pull towards gravity
+#define AHRS_KI_MILLI      20     // Mahony integral gain x1000 (1/s^2): gyro bias tracking
+#define AHRS_ACCEL_GATE_MG 300    // no gravity correction while ||a| - 1 g| is larger (impacts)
+
+// ===== Event capture (pre-trigger ring, fetched as capture.cap over bulk) =====
+#define CAPTURE_RECORDS          16384  // ring in PSRAM (power of two), 16 B each: ~80 s @200 Hz, ~32 s @500 Hz
+#define CAPTURE_RECORDS_NO_PSRAM 1024   // internal RAM fallback (power of two, 0 = no capture without PSRAM)
+#define CAPTURE_PRE_MS           5000   // kept before the trigger (clamped to the ring)
+#define CAPTURE_POST_MS          2000   // recorded after it, then the window freezes until fetched
+#define CAPTURE_ACCEL_HIGH_MG    6000   // |a| at or above fires (impact), 0 = off
+#define CAPTURE_ACCEL_LOW_MG     0      // |a| at or below fires (free fall), 0 = off
+#define CAPTURE_GYRO_DPS         0      // |w| at or above fires, 0 = off
+
+// ===== System loop =====
+#define SYSTEM_BUSY_POLL_MS 100  // loop wake period while the recorder is closing a file
 
 // ===== Power / input (we’ll wire deep sleep later) =====
 #define POWER_LONG_PRESS_MS 1500
+#define POWER_MIN_MHZ       40      // DFS floor when esp_pm is available
+#define POWER_METER_MS      1000    // battery V/I reading while streaming
+#define POWER_REPORT_MS     10000   // [PWR] energy line while streaming
 
 // ===== UI =====
 #define UI_REFRESH_MS 1000
+#define UI_POLL_MS    50      // UI task checks the snapshots this often
+#define UI_TASK_STACK 4096
+#define UI_TASK_PRIO  1       // lowest: the display only gets idle time
+#define UI_TASK_CORE  0       // away from the IMU task and loop()
+#define UI_BACKLIGHT_ON         160
+#define UI_BACKLIGHT_TIMEOUT_MS 30000  // no button / state / central activity -> backlight off
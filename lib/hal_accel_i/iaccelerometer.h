@@ -1,9 +1,25 @@
 #pragma once
 #include <stdint.h>
+#include <stddef.h>
+
+// One accelerometer reading in milli-g
+struct AccelSample {
+  int16_t ax_mg;
+  int16_t ay_mg;
+  int16_t az_mg;
+};
 
 class IAccelerometer {
 public:
   virtual bool begin() = 0;
   virtual void read_mg(int16_t& ax, int16_t& ay, int16_t& az) = 0;
-  virtual uint8_t sample_rate_hz() const = 0;
+  virtual uint16_t sample_rate_hz() const = 0;
+
+  // Request an output data rate; returns the rate the sensor actually runs at.
+  virtual uint16_t set_odr_hz(uint16_t hz) = 0;
+  // Drain buffered samples (oldest first) in as few bus transactions as possible.
+  // Returns the number written to `out`. Sensors without a FIFO return one fresh reading.
+  virtual size_t read_batch(AccelSample* out, size_t max) = 0;
+  // True if samples are paced by the sensor's own clock (read_batch may return > 1).
+  virtual bool has_fifo() const = 0;
 };
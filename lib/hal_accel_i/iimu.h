@@ -0,0 +1,37 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include "iaccelerometer.h"
+
+// Channels an IImu can deliver (same bits as STRIDERA_CH_* on the wire)
+#define IMU_CH_ACCEL 0x07
+#define IMU_CH_GYRO  0x38
+#define IMU_CH_MAG   0x40
+#define IMU_CH_TEMP  0x80
+
+// One IMU reading; fields outside IImu::channels() are 0
+struct ImuSample {
+  int16_t ax_mg;
+  int16_t ay_mg;
+  int16_t az_mg;
+  int16_t gx_dps10;    // 0.1 deg/s
+  int16_t gy_dps10;
+  int16_t gz_dps10;
+  int16_t mx_ut10;     // 0.1 uT
+  int16_t my_ut10;
+  int16_t mz_ut10;
+  int16_t temp_c100;   // 0.01 degC
+};
+
+/**
+ * IImu — accelerometer plus whatever else the chip measures (gyro, magnetometer,
+ * die temperature), read together: read_imu() returns every channel of a
+ * sample from the same bus transaction, never one round-trip per axis.
+ */
+class IImu : public IAccelerometer {
+public:
+  // IMU_CH_* this sensor delivers (valid after begin())
+  virtual uint8_t channels() const = 0;
+  // As read_batch(), with all channels
+  virtual size_t read_imu(ImuSample* out, size_t max) = 0;
+};
@@ -1,13 +1,59 @@
 #include "accel_m5unified.h"
 #include <math.h>  // lrintf
+#include "m5_bus_lock.h"
+
+// MPU6886 registers used for ODR + FIFO (M5Unified does the rest of the init)
+namespace {
+  constexpr uint8_t  kMpuAddr         = 0x68;
+  constexpr uint32_t kI2cFreq         = 400000;
+  constexpr uint8_t  REG_SMPLRT_DIV   = 0x19;
+  constexpr uint8_t  REG_CONFIG       = 0x1A;
+  constexpr uint8_t  REG_GYRO_CONFIG  = 0x1B;
+  constexpr uint8_t  REG_ACCEL_CONFIG = 0x1C;
+  constexpr uint8_t  REG_ACCEL_CONFIG2= 0x1D;
+  constexpr uint8_t  REG_FIFO_EN      = 0x23;
+  constexpr uint8_t  REG_INT_STATUS   = 0x3A;
+  constexpr uint8_t  REG_USER_CTRL    = 0x6A;
+  constexpr uint8_t  REG_FIFO_COUNTH  = 0x72;
+  constexpr uint8_t  REG_FIFO_R_W     = 0x74;
+
+  constexpr uint16_t kInternalRateHz  = 1000;  // with DLPF enabled
+  constexpr uint16_t kFifoBytes       = 1024;
+  constexpr int32_t  kLsbPerG         = 4096;  // +-8 g
+  constexpr int      kLsbShift        = 12;    // log2(kLsbPerG), rounds half up for both signs
+  constexpr int32_t  kGyroLsbPerDps10 = 164;   // +-2000 dps: 16.4 LSB per deg/s
+  constexpr int32_t  kTempLsbPerC100  = 3268;  // 326.8 LSB per degC, 0 LSB = 25 degC
+
+  // ODR = 1 kHz / (1 + SMPLRT_DIV)
+  inline uint8_t smplrt_div(uint16_t hz) {
+    if (hz < 4)    hz = 4;
+    if (hz > 1000) hz = 1000;
+    return (uint8_t)((kInternalRateHz + hz / 2) / hz - 1);
+  }
+
+  inline int32_t div_round(int32_t num, int32_t den) {
+    return (num >= 0 ? num + den / 2 : num - den / 2) / den;
+  }
+}
 
 bool AccelM5Unified::begin() {
   M5.begin();
+  _fifo = (M5.Imu.getType() == m5::imu_t::imu_mpu6886);
+  if (_fifo) {
+    _channels = IMU_CH_ACCEL | IMU_CH_GYRO | IMU_CH_TEMP;   // all in the FIFO frame
+  } else {
+    const auto got = M5.Imu.update();
+    _channels = IMU_CH_ACCEL;
+    if (got & m5::IMU_Class::sensor_mask_gyro) _channels |= IMU_CH_GYRO;
+    if (got & m5::IMU_Class::sensor_mask_mag)  _channels |= IMU_CH_MAG;
+  }
+  set_odr_hz(_rate_hz);
   return true;
 }
 
 void AccelM5Unified::read_mg(int16_t& ax_mg, int16_t& ay_mg, int16_t& az_mg) {
   float ax_g, ay_g, az_g;
+  M5BusLock bus;
   if (!M5.Imu.getAccel(&ax_g, &ay_g, &az_g)) {
     ax_mg = ay_mg = az_mg = 0;
     return;
@@ -18,6 +64,123 @@ void AccelM5Unified::read_mg(int16_t& ax_mg, int16_t& ay_mg, int16_t& az_mg) {
   return;
 }
 
+uint16_t AccelM5Unified::odr_for(uint16_t hz) const {
+  if (!_fifo) return hz < 4 ? 4 : hz > 1000 ? 1000 : hz;
+  return (uint16_t)(kInternalRateHz / (1 + smplrt_div(hz)));
+}
+
+uint16_t AccelM5Unified::set_odr_hz(uint16_t hz) {
+  if (!_fifo) {
+    _rate_hz = odr_for(hz);
+    return _rate_hz;
+  }
+
+  const uint8_t div = smplrt_div(hz);
+  M5BusLock bus;
+  M5.In_I2C.writeRegister8(kMpuAddr, REG_USER_CTRL,     0x00, kI2cFreq);  // FIFO off while reconfiguring
+  M5.In_I2C.writeRegister8(kMpuAddr, REG_SMPLRT_DIV,    div,  kI2cFreq);
+  M5.In_I2C.writeRegister8(kMpuAddr, REG_CONFIG,        0x01, kI2cFreq);  // gyro DLPF 176 Hz, 1 kHz internal
+  M5.In_I2C.writeRegister8(kMpuAddr, REG_GYRO_CONFIG,   0x18, kI2cFreq);  // +-2000 dps
+  M5.In_I2C.writeRegister8(kMpuAddr, REG_ACCEL_CONFIG,  0x10, kI2cFreq);  // +-8 g
+  M5.In_I2C.writeRegister8(kMpuAddr, REG_ACCEL_CONFIG2, 0x00, kI2cFreq);  // accel DLPF 218 Hz
+  M5.In_I2C.writeRegister8(kMpuAddr, REG_FIFO_EN,       0x18, kI2cFreq);  // accel + gyro (+temp)
+  fifo_reset();
+
+  _rate_hz = (uint16_t)(kInternalRateHz / (1 + div));
+  return _rate_hz;
+}
+
+void AccelM5Unified::fifo_reset() {
+  M5BusLock bus;
+  M5.In_I2C.writeRegister8(kMpuAddr, REG_USER_CTRL, 0x44, kI2cFreq);  // FIFO_EN | FIFO_RST
+}
+
+size_t AccelM5Unified::fifo_drain(size_t max) {
+  M5BusLock bus;                                 // count, status and burst as one transaction
+  uint8_t hdr[2];
+  if (!M5.In_I2C.readRegister(kMpuAddr, REG_FIFO_COUNTH, hdr, 2, kI2cFreq)) return 0;
+  const uint16_t bytes = (uint16_t)((hdr[0] << 8) | hdr[1]) & 0x1FFF;
+
+  // Overflowed FIFO has lost frame alignment: drop it and start clean
+  uint8_t status = 0;
+  M5.In_I2C.readRegister(kMpuAddr, REG_INT_STATUS, &status, 1, kI2cFreq);
+  if ((status & 0x10) || bytes >= kFifoBytes - kFifoFrame) {
+    ++_fifo_overflows;
+    fifo_reset();
+    return 0;
+  }
+
+  size_t n = bytes / kFifoFrame;
+  if (n > max)            n = max;
+  if (n > kFifoMaxFrames) n = kFifoMaxFrames;
+  if (n == 0) return 0;
+
+  // One burst for all frames
+  if (!M5.In_I2C.readRegister(kMpuAddr, REG_FIFO_R_W, _burst, n * kFifoFrame, kI2cFreq)) return 0;
+  return n;
+}
+
+size_t AccelM5Unified::read_batch(AccelSample* out, size_t max) {
+  if (!out || max == 0) return 0;
+  if (!_fifo) {
+    read_mg(out[0].ax_mg, out[0].ay_mg, out[0].az_mg);
+    return 1;
+  }
+
+  const size_t n = fifo_drain(max);
+  for (size_t i = 0; i < n; ++i) {
+    const uint8_t* f = _burst + i * kFifoFrame;
+    const int32_t rx = (int16_t)((f[0] << 8) | f[1]);
+    const int32_t ry = (int16_t)((f[2] << 8) | f[3]);
+    const int32_t rz = (int16_t)((f[4] << 8) | f[5]);
+    out[i].ax_mg = clamp16((rx * 1000 + kLsbPerG / 2) >> kLsbShift);
+    out[i].ay_mg = clamp16((ry * 1000 + kLsbPerG / 2) >> kLsbShift);
+    out[i].az_mg = clamp16((rz * 1000 + kLsbPerG / 2) >> kLsbShift);
+  }
+  return n;
+}
+
+size_t AccelM5Unified::read_imu(ImuSample* out, size_t max) {
+  if (!out || max == 0) return 0;
+  if (!_fifo) {
+    // One update() reads every sensor M5Unified knows on this board
+    {
+      M5BusLock bus;
+      M5.Imu.update();
+    }
+    const auto d = M5.Imu.getImuData();
+    ImuSample& s = out[0];
+    s.ax_mg     = mg_from_g(d.accel.x);
+    s.ay_mg     = mg_from_g(d.accel.y);
+    s.az_mg     = mg_from_g(d.accel.z);
+    s.gx_dps10  = clamp16((int32_t)lrintf(d.gyro.x * 10.0f));
+    s.gy_dps10  = clamp16((int32_t)lrintf(d.gyro.y * 10.0f));
+    s.gz_dps10  = clamp16((int32_t)lrintf(d.gyro.z * 10.0f));
+    const bool mag = _channels & IMU_CH_MAG;
+    s.mx_ut10   = mag ? clamp16((int32_t)lrintf(d.mag.x * 10.0f)) : 0;
+    s.my_ut10   = mag ? clamp16((int32_t)lrintf(d.mag.y * 10.0f)) : 0;
+    s.mz_ut10   = mag ? clamp16((int32_t)lrintf(d.mag.z * 10.0f)) : 0;
+    s.temp_c100 = 0;
+    return 1;
+  }
+
+  // Same burst as read_batch(); the rest of each 14-byte frame is decoded too
+  const size_t n = fifo_drain(max);
+  for (size_t i = 0; i < n; ++i) {
+    const uint8_t* f = _burst + i * kFifoFrame;
+    ImuSample& s = out[i];
+    s.ax_mg     = clamp16(((int32_t)(int16_t)((f[0] << 8) | f[1]) * 1000 + kLsbPerG / 2) >> kLsbShift);
+    s.ay_mg     = clamp16(((int32_t)(int16_t)((f[2] << 8) | f[3]) * 1000 + kLsbPerG / 2) >> kLsbShift);
+    s.az_mg     = clamp16(((int32_t)(int16_t)((f[4] << 8) | f[5]) * 1000 + kLsbPerG / 2) >> kLsbShift);
+    s.temp_c100 = clamp16(div_round((int16_t)((f[6] << 8) | f[7]) * 1000, kTempLsbPerC100) + 2500);
+    s.gx_dps10  = clamp16(div_round((int16_t)((f[8] << 8) | f[9]) * 100, kGyroLsbPerDps10));
+    s.gy_dps10  = clamp16(div_round((int16_t)((f[10] << 8) | f[11]) * 100, kGyroLsbPerDps10));
+    s.gz_dps10  = clamp16(div_round((int16_t)((f[12] << 8) | f[13]) * 100, kGyroLsbPerDps10));
+    s.mx_ut10 = s.my_ut10 = s.mz_ut10 = 0;
+  }
+  return n;
+}
+
 int16_t AccelM5Unified::mg_from_g(float g) {
   // Round to nearest mg, clamp into int16 range
   const int32_t mg = (int32_t)lrintf(g * 1000.0f);
@@ -1,23 +1,40 @@
 #pragma once
 #include <M5Unified.h>
-#include "iaccelerometer.h"
+#include "iimu.h"
 
 /**
- * AccelM5Unified — IAccelerometer implementation for M5Stack Unified built-in IMU lib.
- * - Uses M5Unified; no chip-specific code needed (MPU6886/SH200Q abstracted).
+ * AccelM5Unified — IImu implementation for M5Stack Unified built-in IMU lib.
+ * - Uses M5Unified for bring-up and single reads (MPU6886/SH200Q abstracted).
  * - Outputs accelerations in milli-g (mg) rounded to int16.
- * - The "rate" is a target for your app loop timing (no HW ODR control here).
+ * - On MPU6886 (Core2, StickC Plus 2) the ODR is programmed into the chip and
+ *   read_batch() drains its 1 KB FIFO in one I2C burst. Other IMUs fall back
+ *   to one getAccel() per call and the rate is only a target for the caller.
+ * - read_imu(): the MPU6886 FIFO frame already holds gyro (+-2000 dps) and die
+ *   temperature next to accel, so they come out of the same burst; other IMUs
+ *   get one M5.Imu.update() (accel + gyro + mag if fitted) per call.
+ * - Every In_I2C access holds M5BusLock (m5_bus_lock.h): the bus is shared
+ *   with buttons/touch, the backlight and the PMIC readings on other tasks.
  */
-class AccelM5Unified : public IAccelerometer {
+class AccelM5Unified : public IImu {
   public:
     AccelM5Unified() = default;
 
     // IAccelerometer
     bool begin() override;
     void read_mg(int16_t& ax_mg, int16_t& ay_mg, int16_t& az_mg) override;
-    uint8_t sample_rate_hz() const override { return _rate_hz; }
+    uint16_t sample_rate_hz() const override { return _rate_hz; }
+    uint16_t set_odr_hz(uint16_t hz) override;
+    uint16_t odr_for(uint16_t hz) const;   // what set_odr_hz(hz) would give, nothing touched
+    size_t read_batch(AccelSample* out, size_t max) override;
+    bool has_fifo() const override { return _fifo; }
+
+    // IImu
+    uint8_t channels() const override { return _channels; }
+    size_t read_imu(ImuSample* out, size_t max) override;
+
     // Not part of the interface; provide as a convenience (no override).
-    inline void set_sample_rate_hz(uint16_t hz) { _rate_hz = (uint8_t)hz; }
+    inline void set_sample_rate_hz(uint16_t hz) { set_odr_hz(hz); }
+    uint32_t fifo_overflows() const { return _fifo_overflows; }
 
   private:
     static inline int16_t mg_from_g(float g);
@@ -26,6 +43,16 @@ class AccelM5Unified : public IAccelerometer {
       if (v < -32768) return -32768;
       return (int16_t)v;
     }
+    void fifo_reset();
+    size_t fifo_drain(size_t max);   // frames now in _burst
+
+    // MPU6886 FIFO frame: accel(6) + temp(2) + gyro(6), big-endian
+    static constexpr size_t kFifoFrame     = 14;
+    static constexpr size_t kFifoMaxFrames = 36;   // per burst (504 bytes)
 
-    uint8_t _rate_hz = 100;  // app loop target (Hz)
+    uint16_t _rate_hz = 100;  // sensor ODR (or app loop target without FIFO)
+    bool     _fifo    = false;
+    uint8_t  _channels = IMU_CH_ACCEL;
+    uint32_t _fifo_overflows = 0;
+    uint8_t  _burst[kFifoFrame * kFifoMaxFrames];
 };
@@ -0,0 +1,27 @@
+#pragma once
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+/**
+ * M5BusLock — scoped lock for the internal I2C bus (M5.In_I2C).
+ *
+ * The IMU FIFO drain (IMU task), M5.update() and the Core2 backlight on the
+ * AXP192 (UI task) and the PMIC battery readings (loop task) all share one
+ * bus, and M5Unified does not serialise them. Hold one of these around every
+ * In_I2C user: a FIFO burst, M5.update(), M5.Power.*, M5.Display.setBrightness().
+ * Recursive, so a locked helper may call another locked helper.
+ */
+class M5BusLock {
+public:
+  M5BusLock()  { xSemaphoreTakeRecursive(handle(), portMAX_DELAY); }
+  ~M5BusLock() { xSemaphoreGiveRecursive(handle()); }
+  M5BusLock(const M5BusLock&) = delete;
+  M5BusLock& operator=(const M5BusLock&) = delete;
+
+private:
+  static SemaphoreHandle_t handle() {
+    static StaticSemaphore_t buf;
+    static const SemaphoreHandle_t h = xSemaphoreCreateRecursiveMutexStatic(&buf);
+    return h;
+  }
+};
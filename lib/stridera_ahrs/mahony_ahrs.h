@@ -0,0 +1,153 @@
+#pragma once
+#include <stdint.h>
+#include <math.h>
+
+struct AhrsConfig {
+  uint16_t rate_hz        = 200;
+  uint16_t kp_milli       = 1000;   // proportional gain (1/s) x1000: how hard gravity pulls
+  uint16_t ki_milli       = 20;     // integral gain (1/s^2) x1000: gyro bias estimate
+  uint16_t accel_gate_mg  = 300;    // skip the correction when ||a| - 1 g| is larger (steps, impacts)
+  uint16_t settle_ms      = 1000;   // start-up window with 10x kp
+};
+
+static inline uint64_t stridera_isqrt64(uint64_t v) {
+  uint64_t r = 0, bit = 1ULL << 62;
+  while (bit > v) bit >>= 2;
+  while (bit) {                                  // <= 32 iterations
+    if (v >= r + bit) { v -= r + bit; r = (r >> 1) + bit; }
+    else              { r >>= 1; }
+    bit >>= 2;
+  }
+  return r;
+}
+
+/**
+ * MahonyAhrs — Mahony complementary filter (accel + gyro), integer only
+ * after begin().
+ *
+ *   e = a_unit x v(q)                     (v = gravity as q predicts it)
+ *   b += ki * e * dt,  w = gyro + kp * e + b
+ *   q += 0.5 * q (x) (0, w) * dt,  then renormalised
+ *
+ * Quaternion Q30 in int32 (products in int64), unit vectors and error Q15,
+ * rates Q16 rad/s, gyro bias Q30 rad/s (ki * e * dt is a tiny step). Renormalisation is one Newton step of 1/sqrt around 1
+ * (the quaternion never drifts far from unit in one update), so update() has
+ * no data-dependent loops besides the bounded isqrt: a fixed cost per sample
+ * for the IMU task. The first sample aligns q with gravity (yaw 0).
+ *
+ * Inputs: accel in mg, gyro in 0.1 deg/s (StrideraSample units).
+ */
+class MahonyAhrs {
+public:
+  void begin(const AhrsConfig& cfg) {
+    cfg_ = cfg;
+    const double fs = cfg.rate_hz ? cfg.rate_hz : 100.0;
+    halfDt_   = (int32_t)lrint(0.5 / fs * 1073741824.0);                 // Q30 s
+    kp_       = (int32_t)lrint(cfg.kp_milli / 1000.0 * 65536.0);         // Q16
+    kiDt_     = (int32_t)lrint(cfg.ki_milli / 1000.0 / fs * 2147483648.0);  // Q31
+    settleN_  = (uint32_t)(cfg.settle_ms * fs / 1000.0);
+    gateLo_   = cfg.accel_gate_mg < 1000 ? 1000u - cfg.accel_gate_mg : 0u;
+    gateHi_   = 1000u + cfg.accel_gate_mg;
+    reset();
+  }
+
+  void reset() {
+    q_[0] = kOne; q_[1] = q_[2] = q_[3] = 0;
+    bias_[0] = bias_[1] = bias_[2] = 0;
+    n_ = 0;
+    aligned_ = false;
+  }
+
+  void update(int16_t ax_mg, int16_t ay_mg, int16_t az_mg, int16_t gx_dps10, int16_t gy_dps10, int16_t gz_dps10) {
+    ++n_;
+    // Gyro 0.1 dps -> Q16 rad/s (pi / 1800 in Q24)
+    int32_t g[3] = { (int32_t)(((int64_t)gx_dps10 * kDps10ToRadQ24) >> 8),
+                     (int32_t)(((int64_t)gy_dps10 * kDps10ToRadQ24) >> 8),
+                     (int32_t)(((int64_t)gz_dps10 * kDps10ToRadQ24) >> 8) };
+
+    const int32_t ax = ax_mg, ay = ay_mg, az = az_mg;
+    const uint32_t norm = stridera_isqrt64((uint64_t)((int64_t)ax * ax + (int64_t)ay * ay + (int64_t)az * az));
+    if (norm && !aligned_) align(ax, ay, az, norm);
+    if (norm && norm >= gateLo_ && norm <= gateHi_) {
+      const int32_t a[3] = { (ax << 15) / (int32_t)norm, (ay << 15) / (int32_t)norm, (az << 15) / (int32_t)norm };
+      const int64_t w = q_[0], x = q_[1], y = q_[2], z = q_[3];
+      const int32_t v[3] = { (int32_t)((x * z - w * y) >> 44),                 // 2(xz - wy), Q60 -> Q15
+                             (int32_t)((w * x + y * z) >> 44),
+                             (int32_t)((w * w - x * x - y * y + z * z) >> 45) };
+      const int32_t e[3] = { (int32_t)(((int64_t)a[1] * v[2] - (int64_t)a[2] * v[1]) >> 15),
+                             (int32_t)(((int64_t)a[2] * v[0] - (int64_t)a[0] * v[2]) >> 15),
+                             (int32_t)(((int64_t)a[0] * v[1] - (int64_t)a[1] * v[0]) >> 15) };
+      const int64_t kp = n_ <= settleN_ ? (int64_t)kp_ * 10 : kp_;
+      for (int i = 0; i < 3; ++i) {
+        if (kiDt_) {                               // Q30: per-sample steps are far below a Q16 LSB
+          bias_[i] += (int32_t)(((int64_t)e[i] * kiDt_) >> 16);
+          if (bias_[i] >  kBiasMax) bias_[i] =  kBiasMax;
+          if (bias_[i] < -kBiasMax) bias_[i] = -kBiasMax;
+        }
+        g[i] += (int32_t)((kp * e[i]) >> 15) + (bias_[i] >> 14);
+      }
+    } else {
+      for (int i = 0; i < 3; ++i) g[i] += bias_[i] >> 14;
+    }
+
+    // q += q (x) (0, h), h = w * dt / 2 in Q30
+    const int64_t hx = ((int64_t)g[0] * halfDt_) >> 16;
+    const int64_t hy = ((int64_t)g[1] * halfDt_) >> 16;
+    const int64_t hz = ((int64_t)g[2] * halfDt_) >> 16;
+    const int64_t w = q_[0], x = q_[1], y = q_[2], z = q_[3];
+    const int64_t qw = w + ((-x * hx - y * hy - z * hz) >> 30);
+    const int64_t qx = x + (( w * hx + y * hz - z * hy) >> 30);
+    const int64_t qy = y + (( w * hy - x * hz + z * hx) >> 30);
+    const int64_t qz = z + (( w * hz + x * hy - y * hx) >> 30);
+
+    // 1/sqrt(n) ~ (3 - n) / 2 near n = 1
+    const int64_t n2 = (qw * qw + qx * qx + qy * qy + qz * qz) >> 30;   // Q30
+    const int64_t s  = (3 * (int64_t)kOne - n2) >> 1;
+    q_[0] = (int32_t)((qw * s) >> 30);
+    q_[1] = (int32_t)((qx * s) >> 30);
+    q_[2] = (int32_t)((qy * s) >> 30);
+    q_[3] = (int32_t)((qz * s) >> 30);
+  }
+
+  // Q14, w >= 0 (q and -q are the same rotation)
+  void quatQ14(int16_t out[4]) const {
+    const int32_t sign = q_[0] < 0 ? -1 : 1;
+    for (int i = 0; i < 4; ++i) {
+      int32_t v = (sign * q_[i] + (1 << 15)) >> 16;
+      if (v >  16384) v =  16384;
+      if (v < -16384) v = -16384;
+      out[i] = (int16_t)v;
+    }
+  }
+
+  const int32_t* q() const { return q_; }          // Q30 w, x, y, z
+  const int32_t* bias() const { return bias_; }    // Q30 rad/s
+  bool settled() const { return n_ > settleN_; }
+  const AhrsConfig& config() const { return cfg_; }
+
+private:
+  static constexpr int32_t kOne           = 1 << 30;
+  static constexpr int32_t kDps10ToRadQ24 = 29281;   // pi / 1800 * 2^24
+  static constexpr int32_t kBiasMax       = kOne / 4;   // 0.25 rad/s (~14 deg/s)
+
+  // Shortest rotation taking earth z onto the measured gravity: (1 + az, ay, -ax, 0) normalised
+  void align(int32_t ax, int32_t ay, int32_t az, uint32_t norm) {
+    aligned_ = true;
+    int64_t c[4] = { (int64_t)norm + az, ay, -ax, 0 };
+    if (c[0] * 64 < (int64_t)norm) { c[0] = 0; c[1] = 1; c[2] = 0; }    // upside down: turn about x
+    const uint64_t n = stridera_isqrt64((uint64_t)(c[0] * c[0] + c[1] * c[1] + c[2] * c[2]));
+    for (int i = 0; i < 4; ++i) q_[i] = (int32_t)((c[i] << 30) / (int64_t)n);
+  }
+
+  AhrsConfig cfg_;
+  int32_t  q_[4]    = { kOne, 0, 0, 0 };
+  int32_t  bias_[3] = { 0, 0, 0 };       // Q30 rad/s
+  int32_t  halfDt_  = 0;
+  int32_t  kp_      = 0;
+  int32_t  kiDt_    = 0;
+  uint32_t settleN_ = 0;
+  uint32_t gateLo_  = 0;
+  uint32_t gateHi_  = 0;
+  uint32_t n_       = 0;
+  bool     aligned_ = false;
+};
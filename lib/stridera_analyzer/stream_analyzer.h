@@ -0,0 +1,135 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include "stridera_packet.h"
+
+/**
+ * StreamAnalyzer — loss, reordering and jitter of a captured v2 stream
+ * (host side, one analyzer per connection).
+ *
+ * Feed every notification payload with the time the capture saw it:
+ * a single v2 packet or back-to-back packets (STRIDERA_FORMAT_V2), accel-only
+ * or channel-masked.
+ *
+ * - lost:        expected - received, where expected spans the lowest to the
+ *                highest sequence number seen (16-bit seq is unwrapped); a
+ *                late arrival fills its gap instead of counting as loss.
+ * - reordered:   arrived after a higher sequence number.
+ * - duplicates:  a sequence number seen again (within the last 64).
+ * - timing_gaps: consecutive sequence numbers whose timestamps are more than
+ *                1.5 nominal periods apart: the device clock stalled or the
+ *                sensor skipped, but nothing was dropped on the way.
+ * - jitter_us:   RFC 3550 interarrival jitter, J += (|D| - J) / 16 with
+ *                D = arrival step - timestamp step, plus the largest |D|.
+ *                Batched transport shows up here as one frame period.
+ * - ts_step_*:   |timestamp step - nominal period| between consecutive
+ *                samples (the device's sampling jitter).
+ * - invalid:     wrong kind byte or CRC mismatch (packet ignored; an unknown
+ *                kind ends that payload).
+ */
+struct StreamReport {
+  uint64_t received           = 0;   // unique, valid samples
+  uint64_t expected           = 0;
+  uint64_t lost               = 0;
+  uint64_t reordered          = 0;
+  uint64_t duplicates         = 0;
+  uint64_t timing_gaps        = 0;
+  uint32_t invalid            = 0;
+  double   loss_pct           = 0;
+  double   jitter_us          = 0;
+  uint32_t jitter_max_us      = 0;
+  double   ts_step_dev_avg_us = 0;
+  uint32_t ts_step_dev_max_us = 0;
+  uint32_t nominal_period_us  = 0;
+};
+
+class StreamAnalyzer {
+public:
+  void reset() { *this = StreamAnalyzer{}; }
+
+  // One notification payload; returns valid samples in it
+  size_t addPayload(const uint8_t* buf, size_t len, uint64_t arrival_us) {
+    StrideraSample s[32];                          // a full MTU-517 notification of 16-byte packets
+    const size_t n = stridera_v2_decode_samples(buf, len, s, 32, &r_.invalid);
+    for (size_t i = 0; i < n; ++i) add(s[i], arrival_us);
+    return n;
+  }
+
+  // One decoded, valid packet
+  void add(const StrideraAccelPacketV2& p, uint64_t arrival_us) { add(p.seq, p.ts_us, p.rate_hz, arrival_us); }
+  void add(const StrideraSample& s, uint64_t arrival_us)        { add(s.seq, s.ts_us, s.rate_hz, arrival_us); }
+
+  void add(uint16_t seq, uint32_t ts_us, uint16_t rate_hz, uint64_t arrival_us) {
+    if (rate_hz) r_.nominal_period_us = 1000000UL / rate_hz;
+
+    if (!started_) {
+      started_  = true;
+      base_     = maxExt_ = 65536u + seq;        // headroom for late packets from before the first
+      window_   = 1;
+      lastTs_   = ts_us;
+      lastArr_  = arrival_us;
+      ++r_.received;
+      return;
+    }
+
+    const int32_t delta = (int16_t)(uint16_t)(seq - (uint16_t)maxExt_);
+    if (delta <= 0) {                              // at or behind the newest: duplicate or late
+      const uint32_t back = (uint32_t)-delta;
+      if (back < 64) {
+        const uint64_t bit = 1ULL << back;
+        if (window_ & bit) { ++r_.duplicates; return; }
+        window_ |= bit;
+      }
+      if (maxExt_ - back < base_) base_ = maxExt_ - back;   // older than the first one seen
+      ++r_.reordered;
+      ++r_.received;
+      return;
+    }
+
+    // New highest sequence number
+    window_  = (uint32_t)delta >= 64 ? 1 : (window_ << delta) | 1;
+    maxExt_ += (uint32_t)delta;
+    ++r_.received;
+
+    const uint32_t tsStep = ts_us - lastTs_;     // unsigned: survives the 32-bit µs wrap
+    if (delta == 1 && r_.nominal_period_us) {
+      const uint32_t nom = r_.nominal_period_us;
+      const uint32_t dev = tsStep > nom ? tsStep - nom : nom - tsStep;
+      if ((uint64_t)tsStep * 2 > (uint64_t)nom * 3) ++r_.timing_gaps;
+      else {
+        devSum_ += dev;
+        ++devN_;
+        if (dev > r_.ts_step_dev_max_us) r_.ts_step_dev_max_us = dev;
+      }
+    }
+
+    const int64_t d   = (int64_t)(arrival_us - lastArr_) - (int64_t)tsStep;
+    const uint32_t ad = (uint32_t)(d < 0 ? -d : d);
+    jitter_ += ((double)ad - jitter_) / 16.0;
+    if (ad > r_.jitter_max_us) r_.jitter_max_us = ad;
+    lastTs_  = ts_us;
+    lastArr_ = arrival_us;
+  }
+
+  StreamReport report() const {
+    StreamReport r = r_;
+    r.expected           = started_ ? maxExt_ - base_ + 1 : 0;
+    r.lost               = r.expected > r.received ? r.expected - r.received : 0;
+    r.loss_pct           = r.expected ? 100.0 * (double)r.lost / (double)r.expected : 0;
+    r.jitter_us          = jitter_;
+    r.ts_step_dev_avg_us = devN_ ? (double)devSum_ / (double)devN_ : 0;
+    return r;
+  }
+
+private:
+  StreamReport r_;
+  bool     started_ = false;
+  uint64_t base_    = 0;     // lowest unwrapped seq seen
+  uint64_t maxExt_  = 0;     // highest unwrapped seq seen
+  uint64_t window_  = 0;     // bit k: maxExt_ - k was seen
+  uint32_t lastTs_  = 0;     // of the highest seq
+  uint64_t lastArr_ = 0;
+  double   jitter_  = 0;
+  uint64_t devSum_  = 0;
+  uint64_t devN_    = 0;
+};
@@ -0,0 +1,47 @@
+#pragma once
+#include "bulk_transfer.h"
+
+/**
+ * BulkLoopbackLink — in-memory stand-in for the radio on a host.
+ * - Frames go straight into a BulkReceiver; the credits it hands back queue
+ *   up until the driver applies them to the sender (takeCredits()).
+ * - At most framesPerEvent notifications fit per connection event, like the
+ *   controller's buffer; connectionEvent() opens the next one.
+ * - disconnectAfter(n) drops the link after n frames to exercise resume.
+ */
+class BulkLoopbackLink : public IBulkLink {
+public:
+  BulkLoopbackLink(BulkReceiver& rx, size_t payload, size_t framesPerEvent)
+    : rx_(rx), payload_(payload), perEvent_(framesPerEvent) {}
+
+  size_t maxPayload() const override { return payload_; }
+
+  bool send(const uint8_t* buf, size_t len) override {
+    if (!connected_ || inEvent_ >= perEvent_ || len > payload_) return false;
+    ++inEvent_;
+    ++frames_;
+    bytes_   += len;
+    credits_ += rx_.onFrame(buf, len);
+    if (dropAfter_ && frames_ >= dropAfter_) connected_ = false;
+    return true;
+  }
+
+  void     connectionEvent()        { inEvent_ = 0; }
+  void     disconnectAfter(size_t n){ dropAfter_ = frames_ + n; }
+  void     reconnect()              { connected_ = true; dropAfter_ = 0; inEvent_ = 0; }
+  bool     connected() const        { return connected_; }
+  uint16_t takeCredits()            { const uint16_t c = credits_; credits_ = 0; return c; }
+  size_t   frames() const           { return frames_; }
+  size_t   bytes()  const           { return bytes_; }
+
+private:
+  BulkReceiver& rx_;
+  size_t   payload_;
+  size_t   perEvent_;
+  size_t   inEvent_   = 0;
+  size_t   frames_    = 0;
+  size_t   bytes_     = 0;
+  size_t   dropAfter_ = 0;
+  bool     connected_ = true;
+  uint16_t credits_   = 0;
+};
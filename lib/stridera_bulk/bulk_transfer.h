@@ -0,0 +1,176 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "stridera_bulk.h"
+
+/**
+ * Credit-windowed bulk transfer engines (protocol in stridera_bulk.h).
+ * - BulkSender: device side; reads from an IBulkSource, sends MTU-sized chunks
+ *   through an IBulkLink while the central has granted credits.
+ * - BulkReceiver: reference central; reassembles chunks, tracks the resume
+ *   offset and hands credits back in batches.
+ * Neither side depends on NimBLE, so a loopback link can drive both on a host.
+ */
+
+class IBulkSource {
+public:
+  virtual ~IBulkSource() = default;
+  virtual uint32_t size() const = 0;
+  virtual size_t readAt(uint32_t offset, uint8_t* buf, size_t len) = 0;
+};
+
+class IBulkLink {
+public:
+  virtual ~IBulkLink() = default;
+  virtual size_t maxPayload() const = 0;                   // ATT payload (MTU - 3)
+  virtual bool send(const uint8_t* buf, size_t len) = 0;   // false = no buffer now, retry later
+};
+
+template <size_t MaxPayload = 244>
+class BulkSender {
+public:
+  void start(IBulkSource* src, uint32_t offset, uint32_t credits, uint32_t now_us) {
+    src_      = src;
+    size_     = src ? src->size() : 0;
+    offset_   = offset > size_ ? size_ : offset;
+    startOff_ = offset_;
+    credits_  = credits;
+    startUs_  = lastUs_ = now_us;
+    stalls_   = 0;
+    code_     = STRIDERA_BULK_OK_EOF;
+    state_    = src ? State::Sending : State::Idle;
+  }
+
+  void addCredits(uint32_t n) { credits_ += n; }
+  void abort()                { if (state_ != State::Idle) state_ = State::Aborting; }
+  void reset()                { state_ = State::Idle; src_ = nullptr; }   // drop silently (link gone)
+
+  // Send while credits and the link allow, at most maxChunks. Returns frames sent.
+  size_t pump(IBulkLink& link, uint32_t now_us, size_t maxChunks = 16) {
+    size_t sent = 0;
+    lastUs_ = now_us;
+
+    while (state_ == State::Sending && credits_ > 0 && sent < maxChunks) {
+      if (offset_ >= size_) { state_ = State::Finishing; break; }
+
+      size_t payload = link.maxPayload() < MaxPayload ? link.maxPayload() : MaxPayload;
+      if (payload <= sizeof(StrideraBulkChunkHeader)) return sent;
+      payload -= sizeof(StrideraBulkChunkHeader);
+      if (payload > size_ - offset_) payload = size_ - offset_;
+
+      StrideraBulkChunkHeader h{STRIDERA_BULK_FRAME_CHUNK, offset_};
+      memcpy(frame_, &h, sizeof(h));
+      const size_t got = src_->readAt(offset_, frame_ + sizeof(h), payload);
+      if (got == 0) { code_ = STRIDERA_BULK_ERR_IO; state_ = State::Finishing; break; }
+
+      if (!link.send(frame_, sizeof(h) + got)) { ++stalls_; return sent; }
+      offset_ += (uint32_t)got;
+      --credits_;
+      ++sent;
+      if (offset_ >= size_) { code_ = STRIDERA_BULK_OK_EOF; state_ = State::Finishing; }
+    }
+
+    if (state_ == State::Aborting) { code_ = STRIDERA_BULK_ABORTED; state_ = State::Finishing; }
+    if (state_ == State::Finishing) {
+      const StrideraBulkStatus st = status(code_);
+      if (link.send(reinterpret_cast<const uint8_t*>(&st), sizeof(st))) { state_ = State::Idle; ++sent; }
+    }
+    return sent;
+  }
+
+  StrideraBulkStatus status(uint8_t code) const {
+    return StrideraBulkStatus{STRIDERA_BULK_FRAME_STATUS, code, size_, offset_, bytesPerSec()};
+  }
+
+  bool     active()  const { return state_ != State::Idle; }
+  bool     waitingForCredits() const { return state_ == State::Sending && credits_ == 0; }
+  uint32_t offset()  const { return offset_; }
+  uint32_t size()    const { return size_; }
+  uint32_t credits() const { return credits_; }
+  uint32_t stalls()  const { return stalls_; }             // link refused a chunk (buffers full)
+  uint32_t bytesPerSec() const {
+    const uint32_t us = lastUs_ - startUs_;
+    return us ? (uint32_t)((uint64_t)(offset_ - startOff_) * 1000000ULL / us) : 0;
+  }
+
+private:
+  enum class State : uint8_t { Idle, Sending, Aborting, Finishing };
+
+  IBulkSource* src_      = nullptr;
+  State        state_    = State::Idle;
+  uint8_t      code_     = STRIDERA_BULK_OK_EOF;
+  uint32_t     size_     = 0;
+  uint32_t     offset_   = 0;
+  uint32_t     startOff_ = 0;
+  uint32_t     credits_  = 0;
+  uint32_t     startUs_  = 0;
+  uint32_t     lastUs_   = 0;
+  uint32_t     stalls_   = 0;
+  uint8_t      frame_[MaxPayload];
+};
+
+/**
+ * BulkReceiver — reference central for one transfer into a caller buffer.
+ * onFrame() returns the credits to grant back now (0 = none yet); credits are
+ * returned once half the window has been consumed.
+ */
+class BulkReceiver {
+public:
+  void begin(uint8_t* dst, uint32_t cap, uint16_t window) {
+    dst_ = dst; cap_ = cap; window_ = window;
+    contiguous_ = 0; owed_ = 0; done_ = false; code_ = 0; size_ = 0; bps_ = 0;
+    outOfOrder_ = 0; duplicates_ = 0;
+  }
+
+  // Resume after a disconnect: keep what arrived, re-request from contiguous()
+  void resume() { owed_ = 0; done_ = false; }
+
+  uint16_t onFrame(const uint8_t* buf, size_t len) {
+    if (!buf || len == 0) return 0;
+    if (buf[0] == STRIDERA_BULK_FRAME_CHUNK && len >= sizeof(StrideraBulkChunkHeader)) {
+      StrideraBulkChunkHeader h;
+      memcpy(&h, buf, sizeof(h));
+      const size_t n = len - sizeof(h);
+      if (h.offset < contiguous_)      ++duplicates_;
+      else if (h.offset > contiguous_) ++outOfOrder_;       // a gap: resume will refill it
+      else if (h.offset + n <= cap_) {
+        memcpy(dst_ + h.offset, buf + sizeof(h), n);
+        contiguous_ += (uint32_t)n;
+      }
+      if (++owed_ >= (window_ + 1) / 2) { const uint16_t c = owed_; owed_ = 0; return c; }
+      return 0;
+    }
+    if (buf[0] == STRIDERA_BULK_FRAME_STATUS && len >= sizeof(StrideraBulkStatus)) {
+      StrideraBulkStatus st;
+      memcpy(&st, buf, sizeof(st));
+      code_ = st.code;
+      size_ = st.size;
+      bps_  = st.bytes_per_s;
+      done_ = true;
+    }
+    return 0;
+  }
+
+  bool     done()       const { return done_; }
+  bool     complete()   const { return done_ && code_ == STRIDERA_BULK_OK_EOF && contiguous_ == size_; }
+  uint8_t  code()       const { return code_; }
+  uint32_t contiguous() const { return contiguous_; }      // resume offset for the next GET
+  uint32_t size()       const { return size_; }
+  uint32_t reportedBytesPerSec() const { return bps_; }
+  uint32_t outOfOrder() const { return outOfOrder_; }
+  uint32_t duplicates() const { return duplicates_; }
+
+private:
+  uint8_t* dst_        = nullptr;
+  uint32_t cap_        = 0;
+  uint16_t window_     = 0;
+  uint32_t contiguous_ = 0;
+  uint16_t owed_       = 0;
+  bool     done_       = false;
+  uint8_t  code_       = 0;
+  uint32_t size_       = 0;
+  uint32_t bps_        = 0;
+  uint32_t outOfOrder_ = 0;
+  uint32_t duplicates_ = 0;
+};
@@ -0,0 +1,262 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <atomic>
+#include "stridera_packet.h"
+#include "stridera_capture.h"
+#include "seqlock.h"
+#include "bulk_transfer.h"
+
+struct CaptureStats {
+  uint8_t  state;          // CaptureBuffer::State
+  uint32_t captures;       // windows frozen since begin()
+  uint32_t ignored;        // triggers while a capture was running or frozen
+  uint32_t skipped;        // samples not kept while frozen
+  uint32_t capacity;       // records in the ring
+};
+
+/**
+ * CaptureBuffer — pre-trigger event capture over a ring of compact records.
+ *
+ * Writer (IMU task): push() every sample. Armed, the record goes into the ring
+ * (overwriting the oldest) and the sample is tested against the triggers:
+ *   |a| >= accel_high_mg, |a| <= accel_low_mg, |w| >= gyro_dps, or trigger().
+ * A hit keeps pre_ms before it, records post_ms more, then freezes that window
+ * (pre + post clamped to the ring, ms converted at the trigger's rate). Frozen,
+ * samples are only counted until the reader re-arms.
+ *
+ * Per sample that is one 16-byte store, a squared magnitude compared against
+ * squared thresholds (integer only) and two atomic loads; divisions
+ * and square roots happen once per trigger.
+ *
+ * Reader (one task, e.g. the bulk pump): frozen(), then size() / readAt() on
+ * the dump (StrideraCaptureHeader + records, stridera_capture.h) — the writer
+ * does not touch the window until rearm(). configure() and trigger() may be
+ * called from any task; the writer picks them up on its next sample.
+ *
+ * Memory is the caller's (PSRAM on the device); records must be a power of two.
+ */
+class CaptureBuffer {
+public:
+  enum State : uint8_t { Armed = 0, Post = 1, Frozen = 2 };
+
+  // Called on the writer when a window freezes (e.g. wake the bulk task)
+  using WakeFn = void (*)(void* arg);
+  void setWake(WakeFn fn, void* arg) { wake_ = fn; wakeArg_ = arg; }
+
+  // Writer must not be inside push(). False if records is not a power of two.
+  bool begin(StrideraCaptureRecord* mem, uint32_t records, const StrideraCaptureConfig& cfg) {
+    buf_  = nullptr;
+    mask_ = 0;
+    if (!mem || records < 2 || (records & (records - 1))) return false;
+    buf_   = mem;
+    mask_  = records - 1;
+    head_  = 0;
+    filled_ = 0;
+    state_ = Armed;
+    pub_.store(Armed, std::memory_order_release);
+    manual_.store(false, std::memory_order_relaxed);
+    rearm_.store(false, std::memory_order_relaxed);
+    captures_ = ignored_ = skipped_ = 0;
+    cfgLock_.write(cfg);
+    cfgSeen_ = cfgLock_.version();
+    apply(cfg);
+    return true;
+  }
+
+  // ---- any task ----
+  void configure(const StrideraCaptureConfig& cfg) { cfgLock_.write(cfg); }   // one writer of config at a time
+  void trigger() { manual_.store(true, std::memory_order_relaxed); }
+  StrideraCaptureConfig config() const { StrideraCaptureConfig c{}; cfgLock_.read(c); return c; }
+  State state() const { return (State)pub_.load(std::memory_order_acquire); }
+  CaptureStats stats() const {
+    return CaptureStats{(uint8_t)state(), captures_, ignored_, skipped_, buf_ ? mask_ + 1 : 0};
+  }
+
+  // ---- writer ----
+  void push(const StrideraSample& s) {
+    if (!buf_) return;
+    if (cfgLock_.version() != cfgSeen_) reload();
+    const bool manual = manual_.load(std::memory_order_relaxed) && manual_.exchange(false, std::memory_order_relaxed);
+
+    if (state_ == Frozen) {
+      if (!rearm_.load(std::memory_order_acquire)) {
+        ++skipped_;
+        if (manual) ++ignored_;
+        return;
+      }
+      rearm_.store(false, std::memory_order_relaxed);
+      filled_ = 0;                                   // the pre-trigger part starts now
+      state_  = Armed;
+      pub_.store(Armed, std::memory_order_release);
+    }
+
+    StrideraCaptureRecord& r = buf_[head_ & mask_];
+    r.ts_us = s.ts_us;
+    r.ax_mg = s.v1.ax_mg;
+    r.ay_mg = s.v1.ay_mg;
+    r.az_mg = s.v1.az_mg;
+    const bool gyro = (s.chan_mask & STRIDERA_CH_GYRO) != 0;
+    r.gx = gyro ? s.gyro[0] : 0;
+    r.gy = gyro ? s.gyro[1] : 0;
+    r.gz = gyro ? s.gyro[2] : 0;
+    ++head_;
+    if (filled_ <= mask_) ++filled_;
+
+    if (state_ == Post) {
+      if (manual) ++ignored_;
+      if (--postLeft_ == 0) freeze();
+      return;
+    }
+
+    uint8_t cause = manual ? STRIDERA_CAPTURE_CAUSE_MANUAL : 0;
+    uint32_t m2 = 0;
+    if (!cause && (hi2_ || lo2_)) {
+      m2 = sq(s.v1.ax_mg) + sq(s.v1.ay_mg) + sq(s.v1.az_mg);
+      if (hi2_ && m2 >= hi2_)      cause = STRIDERA_CAPTURE_CAUSE_ACCEL_HIGH;
+      else if (lo2_ && m2 <= lo2_) cause = STRIDERA_CAPTURE_CAUSE_ACCEL_LOW;
+    }
+    if (!cause && gyro2_ && gyro) {
+      m2 = sq(s.gyro[0]) + sq(s.gyro[1]) + sq(s.gyro[2]);
+      if (m2 >= gyro2_) cause = STRIDERA_CAPTURE_CAUSE_GYRO;
+    }
+    if (cause) fire(cause, m2, s);
+  }
+
+  // ---- reader ----
+  bool frozen() const { return state() == Frozen && !rearm_.load(std::memory_order_relaxed); }
+
+  // Drop the frozen window; the writer records again from its next sample
+  void rearm() { if (state() == Frozen) rearm_.store(true, std::memory_order_release); }
+
+  const StrideraCaptureHeader& header() const { return hdr_; }   // valid while frozen()
+  uint32_t size() const {
+    return frozen() ? (uint32_t)(sizeof(StrideraCaptureHeader) + hdr_.record_count * sizeof(StrideraCaptureRecord)) : 0;
+  }
+
+  size_t readAt(uint32_t offset, uint8_t* buf, size_t len) const {
+    const uint32_t total = size();
+    size_t done = 0;
+    while (done < len && offset < total) {
+      size_t n;
+      const uint8_t* src;
+      if (offset < sizeof(StrideraCaptureHeader)) {
+        src = reinterpret_cast<const uint8_t*>(&hdr_) + offset;
+        n   = sizeof(StrideraCaptureHeader) - offset;
+      } else {
+        const uint32_t rel  = offset - (uint32_t)sizeof(StrideraCaptureHeader);
+        const uint32_t slot = (start_ + rel / sizeof(StrideraCaptureRecord)) & mask_;
+        const uint32_t in   = rel % sizeof(StrideraCaptureRecord);
+        src = reinterpret_cast<const uint8_t*>(&buf_[slot]) + in;
+        n   = (size_t)(mask_ + 1 - slot) * sizeof(StrideraCaptureRecord) - in;   // up to the end of the ring
+      }
+      if (n > len - done)      n = len - done;
+      if (n > total - offset)  n = total - offset;
+      memcpy(buf + done, src, n);
+      done   += n;
+      offset += (uint32_t)n;
+    }
+    return done;
+  }
+
+private:
+  static uint32_t sq(int32_t v) { const uint32_t u = (uint32_t)(v < 0 ? -v : v); return u * u; }
+
+  static uint16_t isqrt(uint32_t v) {
+    uint32_t r = 0, bit = 1u << 30;
+    while (bit > v) bit >>= 2;
+    while (bit) {
+      if (v >= r + bit) { v -= r + bit; r = (r >> 1) + bit; }
+      else              { r >>= 1; }
+      bit >>= 2;
+    }
+    return r > 0xFFFF ? 0xFFFF : (uint16_t)r;
+  }
+
+  void apply(const StrideraCaptureConfig& c) {
+    hi2_    = sq(c.accel_high_mg);
+    lo2_    = sq(c.accel_low_mg);
+    gyro2_  = sq((c.gyro_dps < 3276 ? c.gyro_dps : 3276) * 10);   // samples carry 0.1 dps (int16)
+    preMs_  = c.pre_ms;
+    postMs_ = c.post_ms;
+  }
+
+  void reload() {
+    StrideraCaptureConfig c;
+    const uint32_t v = cfgLock_.version();
+    if (cfgLock_.read(c)) { apply(c); cfgSeen_ = v; }   // collided: next sample
+  }
+
+  void fire(uint8_t cause, uint32_t m2, const StrideraSample& s) {
+    const uint32_t cap  = mask_ + 1;
+    const uint32_t rate = s.rate_hz ? s.rate_hz : 1;
+    uint32_t post = postMs_ * rate / 1000;
+    uint32_t pre  = preMs_ * rate / 1000;
+    if (post > cap - 1)       post = cap - 1;
+    if (pre > cap - 1 - post) pre  = cap - 1 - post;
+    if (pre > filled_ - 1)    pre  = filled_ - 1;   // re-armed recently: what is there
+
+    start_ = head_ - 1 - pre;
+    memcpy(hdr_.magic, STRIDERA_CAPTURE_MAGIC, 4);
+    hdr_.version        = STRIDERA_CAPTURE_VERSION;
+    hdr_.header_size    = sizeof(StrideraCaptureHeader);
+    hdr_.record_size    = sizeof(StrideraCaptureRecord);
+    hdr_.rate_hz        = s.rate_hz;
+    hdr_.record_count   = pre + 1 + post;
+    hdr_.trigger_record = pre;
+    hdr_.trigger_ts_us  = s.ts_us;
+    hdr_.cause          = cause;
+    hdr_.chan_mask      = s.chan_mask;
+    hdr_.trigger_value  = cause == STRIDERA_CAPTURE_CAUSE_MANUAL ? 0
+                        : cause == STRIDERA_CAPTURE_CAUSE_GYRO   ? (uint16_t)((isqrt(m2) + 5) / 10)
+                                                                 : isqrt(m2);
+    hdr_.capture        = captures_ + 1;
+
+    postLeft_ = post;
+    if (!post) { freeze(); return; }
+    state_ = Post;
+    pub_.store(Post, std::memory_order_release);
+  }
+
+  void freeze() {
+    ++captures_;
+    state_ = Frozen;
+    pub_.store(Frozen, std::memory_order_release);   // header + window visible to the reader
+    if (wake_) wake_(wakeArg_);
+  }
+
+  StrideraCaptureRecord* buf_ = nullptr;
+  uint32_t mask_ = 0;
+  WakeFn   wake_    = nullptr;
+  void*    wakeArg_ = nullptr;
+
+  // Writer
+  uint32_t head_     = 0;                            // records written (wraps)
+  uint32_t filled_   = 0;                            // records since the last arm, up to the ring size
+  uint32_t start_    = 0;                            // first record of the window
+  uint32_t postLeft_ = 0;
+  uint8_t  state_    = Armed;
+  uint32_t hi2_ = 0, lo2_ = 0, gyro2_ = 0;           // squared thresholds, 0 = off
+  uint32_t preMs_ = 0, postMs_ = 0;
+  uint32_t cfgSeen_  = 0;
+  uint32_t captures_ = 0, ignored_ = 0, skipped_ = 0;
+  StrideraCaptureHeader hdr_{};
+
+  // Shared
+  std::atomic<uint8_t> pub_{Armed};                  // state_ as the reader sees it
+  std::atomic<bool>    manual_{false};               // trigger() -> writer
+  std::atomic<bool>    rearm_{false};                // rearm() -> writer
+  Seqlock<StrideraCaptureConfig> cfgLock_;           // configure() -> writer
+};
+
+// A frozen capture as a bulk transfer source (BulkSender streams it like a file)
+class CaptureSource : public IBulkSource {
+public:
+  explicit CaptureSource(const CaptureBuffer* cap = nullptr) : cap_(cap) {}
+  void attach(const CaptureBuffer* cap) { cap_ = cap; }
+  uint32_t size() const override { return cap_ ? cap_->size() : 0; }
+  size_t readAt(uint32_t offset, uint8_t* buf, size_t len) override { return cap_ ? cap_->readAt(offset, buf, len) : 0; }
+private:
+  const CaptureBuffer* cap_;
+};
@@ -0,0 +1,163 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "fir_design.h"
+
+// Opt-in: -D STRIDERA_USE_ESP_DSP=1 runs the dot product through ESP-DSP's
+// dsps_dotprod_s16 (MAC16 loop on ESP32 / SIMD on S3). ESP-DSP rounds with
+// +0x7fff and does not saturate, so outputs may differ from the portable
+// kernel by 1 LSB; the portable kernel is the bit-exact reference.
+#if defined(STRIDERA_USE_ESP_DSP) && STRIDERA_USE_ESP_DSP && __has_include(<esp_dsp.h>)
+  #include <esp_dsp.h>
+  #define STRIDERA_FIR_ESP_DSP 1
+#else
+  #define STRIDERA_FIR_ESP_DSP 0
+#endif
+
+/**
+ * FirDecimator<Channels, Taps, MaxBlock> — block FIR + decimate-by-M in Q15.
+ *
+ * - Structure of arrays: one contiguous int16 history per channel.
+ * - Polyphase in the cheap sense: only every M-th output is computed, so the
+ *   cost is Taps MACs per channel per *output* sample.
+ * - Each channel's history holds [Taps-1 tail | current block], so the inner
+ *   loop is a straight int16 x int16 -> int32 dot product over contiguous
+ *   memory with the coefficients stored reversed: no modulo, no branches, and
+ *   a shape GCC vectorizes on the host (and ESP-DSP replaces on the chip).
+ * - Accumulation is exact in int32 (|acc| <= 2^15 * sum|h|, and a low-pass
+ *   has sum|h| well under 2^16), so the order of the MACs does not matter:
+ *   every kernel and the scalar reference give identical outputs.
+ *
+ * Not thread-safe; one instance per producer.
+ */
+template <size_t Channels = 3, size_t Taps = 64, size_t MaxBlock = 64>
+class FirDecimator {
+  static_assert(Taps >= 2 && Channels >= 1, "FirDecimator needs taps and channels");
+
+public:
+  // cutoff_hz usually <= 0.25 * fs_in / M so everything folding onto the output band is in the stopband
+  void begin(uint16_t factor, float cutoff_hz, float fs_in_hz) {
+    int16_t h[Taps];
+    stridera_fir_lowpass_q15(h, Taps, cutoff_hz, fs_in_hz);
+    beginWith(h, factor);
+  }
+
+  void beginWith(const int16_t* h, uint16_t factor) {
+    for (size_t i = 0; i < Taps; ++i) hr_[i] = h[Taps - 1 - i];
+    factor_ = factor ? factor : 1;
+    reset();
+  }
+
+  void reset() {
+    memset(hist_, 0, sizeof(hist_));
+    phase_ = factor_ - 1;                         // first output after M inputs
+    primed_ = false;
+  }
+
+  uint16_t factor()       const { return factor_; }
+  static constexpr size_t taps()  { return Taps; }
+  // Output k of a block is aligned with input at[k]; its content is centred
+  // groupDelay() input samples earlier.
+  static constexpr float groupDelay() { return (Taps - 1) * 0.5f; }
+
+  /**
+   * in[c][0..n) -> out[c][0..return). n <= MaxBlock (larger blocks are split
+   * by the caller). `at`, if given, receives the input index each output
+   * lines up with (for timestamping).
+   */
+  size_t process(const int16_t* const* in, size_t n, int16_t* const* out, uint16_t* at = nullptr) {
+    if (n > MaxBlock) n = MaxBlock;
+    if (!primed_ && n) prime(in);
+
+    for (size_t c = 0; c < Channels; ++c) memcpy(&hist_[c][Taps - 1], in[c], n * sizeof(int16_t));
+
+    size_t produced = 0;
+    size_t i = phase_;
+    for (; i < n; i += factor_) {
+      for (size_t c = 0; c < Channels; ++c) {
+        out[c][produced] = mac(&hist_[c][i], hr_);
+      }
+      if (at) at[produced] = (uint16_t)i;
+      ++produced;
+    }
+    // Carry the phase and the last Taps-1 inputs into the next block
+    phase_ = (uint16_t)(i - n);
+    if (n) for (size_t c = 0; c < Channels; ++c) memmove(&hist_[c][0], &hist_[c][n], (Taps - 1) * sizeof(int16_t));
+    return produced;
+  }
+
+private:
+  // Start from a settled state instead of ringing up from zero (1 g on z)
+  void prime(const int16_t* const* in) {
+    for (size_t c = 0; c < Channels; ++c)
+      for (size_t i = 0; i < Taps - 1; ++i) hist_[c][i] = in[c][0];
+    primed_ = true;
+  }
+
+#if STRIDERA_FIR_ESP_DSP
+  static_assert(Taps % 4 == 0, "ESP-DSP dot product wants a multiple of 4 taps");
+  static inline int16_t mac(const int16_t* x, const int16_t* h) {
+    int16_t r = 0;
+    dsps_dotprod_s16(x, h, &r, (int)Taps, 0);
+    return r;
+  }
+#else
+  static inline int16_t mac(const int16_t* x, const int16_t* h) {
+    int32_t acc = 0;
+    for (size_t i = 0; i < Taps; ++i) acc += (int32_t)x[i] * (int32_t)h[i];
+    return stridera_q15_round_sat(acc);
+  }
+#endif
+
+  int16_t  hr_[Taps] = {0};                               // reversed coefficients
+  int16_t  hist_[Channels][Taps - 1 + MaxBlock];
+  uint16_t factor_ = 1;
+  uint16_t phase_  = 0;                                   // inputs to skip before the next output
+  bool     primed_ = false;
+};
+
+/**
+ * FirDecimatorRef — sample-at-a-time scalar reference (circular delay line,
+ * natural coefficient order). Slow on purpose; block kernels must match it
+ * bit for bit.
+ */
+template <size_t Channels = 3, size_t Taps = 64>
+class FirDecimatorRef {
+public:
+  void beginWith(const int16_t* h, uint16_t factor) {
+    memcpy(h_, h, sizeof(h_));
+    factor_ = factor ? factor : 1;
+    memset(dl_, 0, sizeof(dl_));
+    pos_ = 0;
+    count_ = 0;
+    primed_ = false;
+  }
+
+  // One input frame; true when `out` holds an output frame.
+  bool push(const int16_t* in, int16_t* out) {
+    if (!primed_) {
+      for (size_t c = 0; c < Channels; ++c) for (size_t i = 0; i < Taps; ++i) dl_[c][i] = in[c];
+      primed_ = true;
+    }
+    for (size_t c = 0; c < Channels; ++c) dl_[c][pos_] = in[c];
+    const size_t newest = pos_;
+    pos_ = (pos_ + 1) % Taps;
+    if (++count_ < factor_) return false;
+    count_ = 0;
+    for (size_t c = 0; c < Channels; ++c) {
+      int32_t acc = 0;
+      for (size_t k = 0; k < Taps; ++k) acc += (int32_t)h_[k] * dl_[c][(newest + Taps - k) % Taps];
+      out[c] = stridera_q15_round_sat(acc);
+    }
+    return true;
+  }
+
+private:
+  int16_t  h_[Taps];
+  int16_t  dl_[Channels][Taps];
+  size_t   pos_ = 0;
+  uint16_t factor_ = 1;
+  uint16_t count_ = 0;
+  bool     primed_ = false;
+};
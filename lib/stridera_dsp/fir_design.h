@@ -0,0 +1,36 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <math.h>
+
+/**
+ * Hamming-windowed sinc low-pass in Q15, unity DC gain exactly
+ * (the rounding residue goes into the centre tap). Runs once at setup;
+ * the filters themselves are integer-only.
+ */
+static inline void stridera_fir_lowpass_q15(int16_t* h, size_t taps, float cutoff_hz, float fs_hz) {
+  const float fc = cutoff_hz / fs_hz;                  // cycles/sample
+  const float mid = (taps - 1) * 0.5f;
+  float sum = 0.0f;
+  for (size_t i = 0; i < taps; ++i) {
+    const float t = (float)i - mid;
+    const float sinc = t == 0.0f ? 2.0f * fc : sinf(2.0f * (float)M_PI * fc * t) / ((float)M_PI * t);
+    const float w = 0.54f - 0.46f * cosf(2.0f * (float)M_PI * (float)i / (float)(taps - 1));
+    sum += sinc * w;
+  }
+  int32_t total = 0;
+  for (size_t i = 0; i < taps; ++i) {
+    const float t = (float)i - mid;
+    const float sinc = t == 0.0f ? 2.0f * fc : sinf(2.0f * (float)M_PI * fc * t) / ((float)M_PI * t);
+    const float w = 0.54f - 0.46f * cosf(2.0f * (float)M_PI * (float)i / (float)(taps - 1));
+    h[i] = (int16_t)lrintf(sinc * w / sum * 32768.0f);
+    total += h[i];
+  }
+  h[taps / 2] = (int16_t)(h[taps / 2] + (32768 - total));
+}
+
+// Q15 accumulator -> int16, round half up, saturate (shared by every kernel so they agree bit for bit)
+static inline int16_t stridera_q15_round_sat(int32_t acc) {
+  acc = (acc + (1 << 14)) >> 15;
+  return (int16_t)(acc > 32767 ? 32767 : acc < -32768 ? -32768 : acc);
+}
@@ -0,0 +1,409 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <atomic>
+#include "stridera_packet.h"
+#include "stridera_batch.h"
+#include "stridera_delta.h"
+#include "congestion_policy.h"
+
+/**
+ * Per-central streaming state and sample fan-out.
+ *
+ * - CentralStream: one connected central — subscriptions, negotiated MTU,
+ *   stream format, packet version and channel mask, its own batch/delta/v2
+ *   frame and a small queue of finished frames waiting for the host stack.
+ *   The channel mask only shapes v2 packets; v1, batch and delta are accel.
+ * - FanOut<N>: up to N centrals. push() feeds every subscribed central,
+ *   pump() hands queued frames to the sink, a bounded burst per central,
+ *   round-robin. When a central's queue is full its oldest frame is dropped
+ *   and counted: a slow client loses data, the others never wait for it.
+ * - Each central has a CongestionPolicy fed with its queue depth, refusals
+ *   and drops; under backpressure it fills whole frames, switches plain
+ *   batches to delta and finally sends every 2nd / 4th sample (counted as
+ *   decimated, not dropped) until the queue stays short again.
+ *
+ * A frame never mixes settings: a new MTU, format, CRC flag, channel mask,
+ * batch limit or sample rate closes the open frame first, so a central sees
+ * every change land between two notifications.
+ *
+ * Threading: the link fields (open/close/subscribe/MTU/format/version/channels) are written by
+ * the BLE host task, everything else runs on the consumer (loop) side. A
+ * connect or disconnect bumps an epoch; sync() on the loop side picks it up
+ * and discards the old link's frames before anything else touches the slot.
+ */
+
+#define STRIDERA_CONN_NONE 0xFFFF
+
+// Characteristic a queued frame goes out on
+enum class FanOutChannel : uint8_t { Legacy, Batch };
+
+class IFanOutSink {
+public:
+  virtual ~IFanOutSink() = default;
+  // false: host out of buffers / link congested — the frame stays queued for the next pump()
+  virtual bool notify(uint16_t conn, FanOutChannel ch, const uint8_t* data, size_t len) = 0;
+};
+
+struct FanOutStats {
+  uint32_t samples          = 0;   // samples delivered to the host stack
+  uint32_t frames           = 0;   // notifications accepted
+  uint64_t bytes            = 0;   // payload bytes accepted
+  uint32_t dropped_frames   = 0;   // evicted from a full queue
+  uint32_t dropped_samples  = 0;
+  uint32_t decimated_samples = 0;  // left out on purpose by congestion control (HALF / QUARTER)
+  uint32_t busy             = 0;   // notify() refused, retried later
+  uint16_t queue_high_water = 0;
+};
+
+template <size_t Q = 8, size_t FrameBytes = 244>
+class CentralStream {
+  static_assert(Q >= 1, "CentralStream needs a queue");
+  static_assert(FrameBytes >= sizeof(StrideraAccelPacket) && FrameBytes <= 65535, "Bad frame size");
+  static constexpr size_t kMaxV2 = sizeof(StrideraImuHeaderV2) + 2 * STRIDERA_CH_MAX_VALUES + 2;
+
+public:
+  // ---- link side (BLE host task) ----
+  void open(uint16_t conn, uint16_t mtu) {
+    subLegacy_ = subBatch_ = subGait_ = subQuat_ = false;
+    mtu_     = mtu;
+    format_  = STRIDERA_FORMAT_BATCH;              // encoding and packet version are per connection
+    version_ = STRIDERA_PACKET_V1;
+    crc_     = false;
+    chans_   = STRIDERA_CH_ACCEL;
+    limit_   = 0;
+    conn_    = conn;
+    epoch_.fetch_add(1, std::memory_order_release);
+  }
+  void close() {
+    subLegacy_ = subBatch_ = subGait_ = subQuat_ = false;
+    conn_ = STRIDERA_CONN_NONE;
+    epoch_.fetch_add(1, std::memory_order_release);
+  }
+  void setMtu(uint16_t mtu)    { mtu_ = mtu; }        // applied at the next frame boundary
+  void setFormat(uint8_t fmt)  { format_ = fmt; }     // likewise
+  void setVersion(uint8_t v)   { version_ = v; }      // single-sample characteristic: v1 or v2
+  void setCrc(bool on)         { crc_ = on; }         // CRC in v2 packets (single and STRIDERA_FORMAT_V2)
+  void setChannels(uint8_t m)  { chans_ = m ? m : STRIDERA_CH_ACCEL; }   // STRIDERA_CH_* in v2 packets
+  void setBatchLimit(uint8_t n){ limit_ = n; }       // samples per batch frame, 0 = as many as the MTU allows
+  void setLegacy(bool on)      { subLegacy_ = on; }
+  void setBatch(bool on)       { subBatch_ = on; }
+  void setGait(bool on)        { subGait_ = on; }
+  void setQuat(bool on)        { subQuat_ = on; }
+  void unsubscribeAll()        { subLegacy_ = subBatch_ = subGait_ = subQuat_ = false; }
+  void setCongestion(const CongestionConfig& c) { cong_.setConfig(c); }   // before streaming starts
+
+  uint16_t conn()       const { return conn_; }
+  bool     used()       const { return conn_ != STRIDERA_CONN_NONE; }
+  uint16_t mtu()        const { return mtu_; }
+  uint8_t  format()     const { return format_; }
+  uint8_t  version()    const { return version_; }
+  bool     crc()        const { return crc_; }
+  uint8_t  channels()   const { return chans_; }
+  uint8_t  batchLimit() const { return limit_; }
+  bool     legacy()     const { return subLegacy_; }
+  bool     batch()      const { return subBatch_; }
+  bool     gait()       const { return subGait_; }
+  bool     quat()       const { return subQuat_; }
+  bool     subscribed() const { return subLegacy_ || subBatch_ || subGait_ || subQuat_; }
+
+  // ---- consumer side (loop) ----
+  // Adopt a connect/disconnect; true if a session ended (`ended` = its totals, `endedConn` = its handle)
+  bool sync(FanOutStats& ended, uint16_t& endedConn) {
+    const uint8_t e = epoch_.load(std::memory_order_acquire);
+    if (e == seen_) return false;
+    seen_      = e;
+    ended      = stats_;
+    endedConn  = streamConn_;
+    const bool had = streamConn_ != STRIDERA_CONN_NONE;
+    streamConn_ = conn_;
+    stats_      = FanOutStats{};
+    discard();
+    cong_.reset(lastMs_);                          // a new central starts uncongested
+    return had;
+  }
+
+  void push(const StrideraSample& in, uint32_t now_ms) {
+    if (streamConn_ == STRIDERA_CONN_NONE) return;
+    lastMs_ = now_ms;
+    cong_.update(now_ms);
+    const uint8_t keep = cong_.keepEvery();
+    StrideraSample thinned;
+    const StrideraSample* src = &in;
+    if (keep > 1) {                                // congested: a lower rate the central can take
+      if (subLegacy_ || subBatch_) {
+        if (skip_++ % keep) { ++stats_.decimated_samples; return; }
+      }
+      thinned            = in;
+      thinned.rate_hz    = (uint16_t)(in.rate_hz / keep);
+      thinned.v1.rate_hz = (uint8_t)(thinned.rate_hz > 255 ? 255 : thinned.rate_hz);
+      src = &thinned;
+    } else {
+      skip_ = 0;
+    }
+    const StrideraSample& p = *src;
+    if (subLegacy_) {
+      if (version_ == STRIDERA_PACKET_V2) {
+        uint8_t v2[kMaxV2];
+        enqueue(FanOutChannel::Legacy, v2, stridera_packet_v2_encode(p, chans_, crc_, v2), 1);
+      } else {
+        enqueue(FanOutChannel::Legacy, reinterpret_cast<const uint8_t*>(&p.v1), sizeof(p.v1), 1);
+      }
+    }
+    if (!subBatch_) return;
+    if (count_ && (frameMtu_ != mtu_ || frameFormat_ != sendFormat() || frameCrc_ != crc_ || frameChans_ != chans_ ||
+                   frameLimit_ != sendLimit() || frameRate_ != p.rate_hz)) {
+      finishFrame();                               // renegotiated mid-stream
+    }
+    if (count_ == 0) openFrame(p, now_ms);
+    if (!framePush(p)) {
+      finishFrame();
+      openFrame(p, now_ms);
+      if (!framePush(p)) ++stats_.dropped_samples;   // v2 packet larger than this MTU allows
+    }
+    if (frameFull()) finishFrame();
+  }
+
+  // Close a partial frame that has waited max_latency_ms (or any partial frame with 0);
+  // congestion stretches the deadline so frames go out fuller
+  void flushDue(uint32_t now_ms, uint32_t max_latency_ms) {
+    if (streamConn_ != STRIDERA_CONN_NONE) { lastMs_ = now_ms; cong_.update(now_ms); }
+    if (count_ && now_ms - openedMs_ >= cong_.flushLatencyMs(max_latency_ms)) finishFrame();
+  }
+
+  // Up to `burst` queued frames to the sink; stops at the first refusal
+  size_t pump(IFanOutSink& sink, size_t burst) {
+    size_t sent = 0;
+    while (qCount_ && sent < burst) {
+      const Frame& f = q_[qHead_];
+      if (!sink.notify(streamConn_, f.ch, f.data, f.len)) { ++stats_.busy; cong_.onBusy(); break; }
+      ++stats_.frames;
+      stats_.bytes   += f.len;
+      stats_.samples += f.samples;
+      qHead_ = (qHead_ + 1) % Q;
+      --qCount_;
+      ++sent;
+    }
+    cong_.onQueue(qCount_, Q);
+    return sent;
+  }
+
+  void discard() {
+    qHead_ = qCount_ = 0;
+    count_ = 0;
+  }
+
+  bool   frameOpen()  const { return count_ != 0; }
+  uint32_t frameAgeMs(uint32_t now_ms) const { return now_ms - openedMs_; }
+  uint32_t flushLatencyMs(uint32_t base_ms) const { return cong_.flushLatencyMs(base_ms); }
+  CongestionStats congestion() const { return cong_.stats(); }
+  size_t queued()     const { return qCount_; }
+  uint16_t streamConn() const { return streamConn_; }
+  const FanOutStats& stats() const { return stats_; }
+
+private:
+  struct Frame {
+    uint16_t      len;
+    uint8_t       samples;
+    FanOutChannel ch;
+    uint8_t       data[FrameBytes];
+  };
+
+  // Format and batch limit after congestion control: COMPACT turns plain batches
+  // into delta frames, BATCH and up ignore the central's batch limit
+  uint8_t sendFormat() const {
+    return cong_.compact() && format_ == STRIDERA_FORMAT_BATCH ? STRIDERA_FORMAT_DELTA : format_;
+  }
+  uint8_t sendLimit() const { return cong_.fullFrames() ? 0 : limit_; }
+
+  void openFrame(const StrideraSample& p, uint32_t now_ms) {
+    size_t cap = stridera_att_payload(mtu_);
+    if (cap > FrameBytes) cap = FrameBytes;
+    frameMtu_    = mtu_;
+    frameFormat_ = sendFormat();
+    frameCrc_    = crc_;
+    frameChans_  = chans_;
+    frameLimit_  = sendLimit();
+    frameRate_   = p.rate_hz;
+    openedMs_    = now_ms;
+    if (frameFormat_ == STRIDERA_FORMAT_DELTA)   delta_.begin(buf_, cap);
+    else if (frameFormat_ == STRIDERA_FORMAT_V2) { v2Cap_ = cap; v2Max_ = stridera_packet_v2_max_size(frameChans_); }
+    else                                         batch_.begin(buf_, cap);
+    count_ = 0;
+    v2Len_ = 0;
+  }
+
+  bool framePush(const StrideraSample& p) {
+    bool ok;
+    switch (frameFormat_) {
+      case STRIDERA_FORMAT_DELTA: ok = delta_.push(p.v1); break;
+      case STRIDERA_FORMAT_V2:
+        ok = v2Len_ + v2Max_ <= v2Cap_;            // room for the longest packet this sample could take
+        if (ok) v2Len_ += stridera_packet_v2_encode(p, frameChans_, frameCrc_, buf_ + v2Len_);
+        break;
+      default: ok = batch_.push(p.v1); break;
+    }
+    if (ok) ++count_;
+    return ok;
+  }
+
+  bool frameFull() const {
+    if (frameLimit_ && count_ >= frameLimit_) return true;
+    switch (frameFormat_) {
+      case STRIDERA_FORMAT_DELTA: return delta_.full();
+      case STRIDERA_FORMAT_V2:    return v2Len_ + v2Max_ > v2Cap_;
+      default:                    return batch_.full();
+    }
+  }
+
+  void finishFrame() {
+    if (count_ == 0) return;
+    const size_t len = frameFormat_ == STRIDERA_FORMAT_DELTA ? delta_.finish()
+                     : frameFormat_ == STRIDERA_FORMAT_V2    ? v2Len_
+                                                             : batch_.size();
+    enqueue(FanOutChannel::Batch, buf_, len, (uint8_t)count_);
+    count_ = 0;
+  }
+
+  void enqueue(FanOutChannel ch, const uint8_t* data, size_t len, uint8_t samples) {
+    if (qCount_ == Q) {                            // slow central: lose its oldest frame, not the newest
+      ++stats_.dropped_frames;
+      cong_.onDrop();
+      stats_.dropped_samples += q_[qHead_].samples;
+      qHead_ = (qHead_ + 1) % Q;
+      --qCount_;
+    }
+    Frame& f  = q_[(qHead_ + qCount_) % Q];
+    f.len     = (uint16_t)len;
+    f.samples = samples;
+    f.ch      = ch;
+    memcpy(f.data, data, len);
+    ++qCount_;
+    if (qCount_ > stats_.queue_high_water) stats_.queue_high_water = (uint16_t)qCount_;
+    cong_.onQueue(qCount_, Q);
+  }
+
+  // Link side
+  volatile uint16_t conn_      = STRIDERA_CONN_NONE;
+  volatile uint16_t mtu_       = 23;
+  volatile uint8_t  format_    = STRIDERA_FORMAT_BATCH;
+  volatile uint8_t  version_   = STRIDERA_PACKET_V1;
+  volatile bool     crc_       = false;
+  volatile uint8_t  chans_     = STRIDERA_CH_ACCEL;
+  volatile uint8_t  limit_     = 0;
+  volatile bool     subLegacy_ = false;
+  volatile bool     subBatch_  = false;
+  volatile bool     subGait_   = false;
+  volatile bool     subQuat_   = false;
+  std::atomic<uint8_t> epoch_{0};
+
+  // Consumer side
+  uint8_t              seen_       = 0;
+  uint16_t             streamConn_ = STRIDERA_CONN_NONE;
+  uint8_t              buf_[FrameBytes];
+  StrideraBatchEncoder batch_;
+  StrideraDeltaEncoder delta_;
+  size_t               count_       = 0;   // samples in the open frame
+  uint32_t             openedMs_    = 0;
+  uint16_t             frameMtu_    = 0;
+  uint8_t              frameFormat_ = STRIDERA_FORMAT_BATCH;
+  bool                 frameCrc_    = false;
+  uint8_t              frameChans_  = STRIDERA_CH_ACCEL;
+  uint8_t              frameLimit_  = 0;
+  uint16_t             frameRate_   = 0;
+  size_t               v2Cap_       = 0;   // STRIDERA_FORMAT_V2 frame: bytes available,
+  size_t               v2Max_       = 0;   // largest packet for frameChans_,
+  size_t               v2Len_       = 0;   // bytes used
+  Frame                q_[Q];
+  size_t               qHead_  = 0;
+  size_t               qCount_ = 0;
+  FanOutStats          stats_;
+  CongestionPolicy     cong_;
+  uint32_t             skip_   = 0;        // samples since the last one kept while decimating
+  uint32_t             lastMs_ = 0;
+};
+
+template <size_t N = 3, size_t Q = 8, size_t FrameBytes = 244>
+class FanOut {
+public:
+  using Stream = CentralStream<Q, FrameBytes>;
+  static constexpr size_t capacity() { return N; }
+
+  // ---- link side ----
+  Stream* open(uint16_t conn, uint16_t mtu) {
+    for (auto& s : s_) if (!s.used()) { s.open(conn, mtu); return &s; }
+    return nullptr;                                // more centrals than slots
+  }
+  void close(uint16_t conn) { if (Stream* s = find(conn)) s->close(); }
+
+  Stream* find(uint16_t conn) {
+    for (auto& s : s_) if (s.used() && s.conn() == conn) return &s;
+    return nullptr;
+  }
+  int indexOf(uint16_t conn) const {
+    for (size_t i = 0; i < N; ++i) if (s_[i].used() && s_[i].conn() == conn) return (int)i;
+    return -1;
+  }
+
+  Stream&       at(size_t i)       { return s_[i]; }
+  const Stream& at(size_t i) const { return s_[i]; }
+
+  size_t connected() const {
+    size_t n = 0;
+    for (const auto& s : s_) n += s.used();
+    return n;
+  }
+  size_t subscribed() const {
+    size_t n = 0;
+    for (const auto& s : s_) n += s.used() && s.subscribed();
+    return n;
+  }
+
+  // ---- consumer side ----
+  // onEnded(conn, stats) for every session that closed since the last call
+  template <typename Fn>
+  void sync(Fn&& onEnded) {
+    FanOutStats st;
+    uint16_t conn;
+    for (auto& s : s_) if (s.sync(st, conn)) onEnded(conn, st);
+  }
+
+  void push(const StrideraSample& p, uint32_t now_ms) {
+    for (auto& s : s_) s.push(p, now_ms);
+  }
+
+  void flushDue(uint32_t now_ms, uint32_t max_latency_ms) {
+    for (auto& s : s_) s.flushDue(now_ms, max_latency_ms);
+  }
+
+  // Bounded burst per central; the starting central rotates so none is always served last
+  size_t pump(IFanOutSink& sink, size_t burst) {
+    size_t sent = 0;
+    for (size_t k = 0; k < N; ++k) sent += s_[(next_ + k) % N].pump(sink, burst);
+    next_ = (next_ + 1) % N;
+    return sent;
+  }
+
+  // ms until flushDue()/pump() has work: retry_ms while frames wait, else the oldest open frame's deadline
+  uint32_t dueMs(uint32_t now_ms, uint32_t max_latency_ms, uint32_t retry_ms) const {
+    uint32_t due = UINT32_MAX;
+    for (const auto& s : s_) {
+      if (s.queued() && retry_ms < due) due = retry_ms;
+      if (s.frameOpen()) {
+        const uint32_t age = s.frameAgeMs(now_ms);
+        const uint32_t lat = s.flushLatencyMs(max_latency_ms);
+        const uint32_t d   = age >= lat ? 0 : lat - age;
+        if (d < due) due = d;
+      }
+    }
+    return due;
+  }
+
+  void discard() { for (auto& s : s_) s.discard(); }
+  void setCongestion(const CongestionConfig& c) { for (auto& s : s_) s.setCongestion(c); }
+
+private:
+  Stream s_[N];
+  size_t next_ = 0;
+};
@@ -0,0 +1,34 @@
+#pragma once
+#include <stdint.h>
+#include <atomic>
+
+/**
+ * FsmEventLatch — event bits raised from any task / callback, taken by one consumer.
+ * - raise() ORs bits in and remembers when the oldest pending batch was raised,
+ *   so the consumer can report event -> transition latency.
+ * - take() atomically collects and clears everything pending.
+ * - Lock-free; the waking itself (task notification) is the caller's business,
+ *   which keeps this usable on a host with a virtual clock.
+ */
+class FsmEventLatch {
+public:
+  void raise(uint32_t mask, uint32_t now_us) {
+    if (pending_.load(std::memory_order_acquire) == 0) {
+      since_.store(now_us, std::memory_order_relaxed);   // first of a batch (a racing raiser is equivalent)
+    }
+    pending_.fetch_or(mask, std::memory_order_release);
+  }
+
+  // 0 if nothing is pending; otherwise the bits and when the oldest was raised
+  uint32_t take(uint32_t& since_us) {
+    const uint32_t ev = pending_.exchange(0, std::memory_order_acq_rel);
+    since_us = since_.load(std::memory_order_relaxed);
+    return ev;
+  }
+
+  bool pending() const { return pending_.load(std::memory_order_acquire) != 0; }
+
+private:
+  std::atomic<uint32_t> pending_{0};
+  std::atomic<uint32_t> since_{0};
+};
@@ -0,0 +1,181 @@
+#pragma once
+#include <stdint.h>
+#include "perf_probe.h"
+
+/**
+ * SystemFsm — the device's top-level state machine, free of Arduino/FreeRTOS.
+ *
+ * The owner collects events (FSM_EV_*), calls step() with them and then waits
+ * until the next event or until the returned deadline; with nothing pending
+ * in IDLE the deadline is "never", so the owner can block indefinitely.
+ * Side effects go through ISystemPort, time through a ClockFn, so a host can
+ * drive it with a fake port and a virtual clock.
+ *
+ * Every transition records event -> transition-done latency (us): from when
+ * the oldest event of the batch was raised, or from the deadline for timed
+ * transitions, to after the port actions ran.
+ */
+
+enum class SystemState : uint8_t { BOOTING, IDLE, STREAMING, RECORDING, SHUTTING_DOWN };
+
+// FSM inputs (bit mask; several may arrive in one step)
+#define FSM_EV_SUBSCRIBE    (1u << 0)   // a central subscribed to a stream characteristic
+#define FSM_EV_UNSUBSCRIBE  (1u << 1)   // last stream subscription dropped (or the link went)
+#define FSM_EV_BTN_RECORD   (1u << 2)   // BtnA click: toggle SD recording
+#define FSM_EV_BTN_POWER    (1u << 3)   // power button released after a long press
+#define FSM_EV_LINK         (1u << 4)   // connection state changed: re-check port.connected()
+#define FSM_EV_MASK         0xFFFFu     // bits above are free for the owner's own wake reasons
+
+static inline const char* system_state_name(SystemState s) {
+  switch (s) {
+    case SystemState::BOOTING:       return "BOOTING";
+    case SystemState::IDLE:          return "IDLE";
+    case SystemState::STREAMING:     return "STREAMING";
+    case SystemState::RECORDING:     return "RECORDING";
+    case SystemState::SHUTTING_DOWN: return "SHUTTING_DOWN";
+  }
+  return "?";
+}
+
+// What the IMU task feeds per state: IDLE keeps the sensor on for the event
+// capture ring alone (no BLE / recorder rings), the data states feed everything
+enum class SensorOutput : uint8_t { Off, Capture, Full };
+
+static inline SensorOutput system_sensor_output(SystemState s) {
+  switch (s) {
+    case SystemState::IDLE:      return SensorOutput::Capture;
+    case SystemState::STREAMING:
+    case SystemState::RECORDING: return SensorOutput::Full;
+    default:                     return SensorOutput::Off;
+  }
+}
+
+struct FsmTiming {
+  uint32_t boot_grace_ms = 2000;   // BOOTING banner; buttons are ignored meanwhile
+  uint32_t shutdown_ms   = 2000;   // SHUTTING_DOWN window before power-off
+  uint32_t busy_poll_ms  = 100;    // re-check a busy recorder while shutting down
+};
+
+class ISystemPort {
+public:
+  virtual ~ISystemPort() = default;
+  virtual bool connected() const = 0;
+  virtual bool recorderBusy() const = 0;                 // recording or still closing the file
+  virtual void startStreaming() = 0;
+  virtual void stopStreaming(bool unsubscribed) = 0;     // false: the link is gone
+  virtual bool startRecording() = 0;
+  virtual void stopRecording() = 0;                      // closes in the background
+  virtual void beginShutdown() = 0;                      // stop sampling, keep queued data
+  virtual void finishShutdown() = 0;                     // flush, BLE off, power off (may not return)
+  virtual void onTransition(SystemState from, SystemState to, uint32_t latency_us) = 0;
+};
+
+class SystemFsm {
+public:
+  using ClockFn = uint32_t (*)();                        // microseconds, wraps
+  static constexpr uint32_t kNever = UINT32_MAX;
+
+  void begin(ISystemPort* port, ClockFn clock, const FsmTiming& t = FsmTiming()) {
+    port_    = port;
+    clock_   = clock;
+    t_       = t;
+    state_   = SystemState::BOOTING;
+    pending_ = 0;
+    bootUs_  = clock_();
+    transitions_ = 0;
+    latency_.reset();
+  }
+
+  // Apply `events` (raised at `raised_us`, the oldest of them). Returns the
+  // microseconds until step() must run again without new events, or kNever.
+  uint32_t step(uint32_t events, uint32_t raised_us) {
+    const uint32_t now = clock_();
+    events &= FSM_EV_MASK;
+    if (events && !pending_) since_ = raised_us;
+    pending_ |= events;
+
+    if (state_ == SystemState::BOOTING) {
+      pending_ &= ~(FSM_EV_BTN_RECORD | FSM_EV_BTN_POWER);
+      const uint32_t grace = t_.boot_grace_ms * 1000;
+      if (now - bootUs_ < grace) return grace - (now - bootUs_);
+      enter(SystemState::IDLE, bootUs_ + grace);          // events that came in meanwhile apply now
+    }
+
+    const uint32_t ev    = pending_;
+    const uint32_t since = since_;
+    pending_ = 0;
+
+    if ((ev & FSM_EV_BTN_POWER) && state_ != SystemState::SHUTTING_DOWN) {
+      if (state_ == SystemState::RECORDING) port_->stopRecording();   // closed during the window
+      port_->beginShutdown();
+      shutdownUs_ = clock_();
+      enter(SystemState::SHUTTING_DOWN, since);
+    }
+
+    if (state_ == SystemState::SHUTTING_DOWN) {
+      const uint32_t window = t_.shutdown_ms * 1000;
+      const uint32_t inWin  = clock_() - shutdownUs_;
+      if (inWin < window) return window - inWin;
+      if (port_->recorderBusy()) return t_.busy_poll_ms * 1000;
+      port_->finishShutdown();                            // usually never returns
+      enter(SystemState::IDLE, shutdownUs_ + window);     // fallback if it ever does
+      return kNever;
+    }
+
+    if (ev & FSM_EV_BTN_RECORD) {
+      if (state_ == SystemState::RECORDING) {
+        port_->stopRecording();
+        enter(SystemState::IDLE, since);
+      } else if (state_ == SystemState::IDLE && !port_->recorderBusy()) {
+        if (port_->startRecording()) enter(SystemState::RECORDING, since);
+      }
+    }
+
+    if (ev & FSM_EV_SUBSCRIBE) {
+      if (state_ == SystemState::RECORDING) {             // a central wants the live stream
+        port_->stopRecording();
+        enter(SystemState::IDLE, since);
+      }
+      if (state_ == SystemState::IDLE && port_->connected()) {
+        port_->startStreaming();
+        enter(SystemState::STREAMING, since);
+      }
+    }
+
+    if ((ev & FSM_EV_UNSUBSCRIBE) && state_ == SystemState::STREAMING) {
+      port_->stopStreaming(true);
+      enter(SystemState::IDLE, since);
+    }
+
+    if (state_ == SystemState::STREAMING && !port_->connected()) {
+      port_->stopStreaming(false);
+      enter(SystemState::IDLE, since);
+    }
+    return kNever;
+  }
+
+  SystemState     state()       const { return state_; }
+  uint32_t        transitions() const { return transitions_; }
+  const PerfStat& latency()     const { return latency_; }   // us per transition
+
+private:
+  void enter(SystemState to, uint32_t since_us) {
+    const SystemState from = state_;
+    state_ = to;
+    const uint32_t lat = clock_() - since_us;
+    latency_.record(lat);
+    ++transitions_;
+    port_->onTransition(from, to, lat);
+  }
+
+  ISystemPort* port_  = nullptr;
+  ClockFn      clock_ = nullptr;
+  FsmTiming    t_{};
+  SystemState  state_ = SystemState::BOOTING;
+  uint32_t     pending_    = 0;
+  uint32_t     since_      = 0;
+  uint32_t     bootUs_     = 0;
+  uint32_t     shutdownUs_ = 0;
+  uint32_t     transitions_ = 0;
+  PerfStat     latency_;
+};
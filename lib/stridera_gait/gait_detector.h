@@ -0,0 +1,185 @@
+#pragma once
+#include <stdint.h>
+#include <math.h>
+#include "stridera_packet.h"
+#include "stridera_gait.h"
+
+struct GaitConfig {
+  uint16_t rate_hz     = 200;
+  uint16_t hp_mhz      = 500;    // gravity / posture removal
+  uint16_t lp_mhz      = 4000;   // above the fastest running cadence
+  uint16_t min_step_ms = 250;    // refractory period (max 4 steps/s)
+  uint16_t max_step_ms = 2000;   // longer gap = stopped
+  uint16_t min_p2p_mg  = 120;    // absolute floor of the adaptive threshold
+};
+
+static inline uint32_t stridera_isqrt32(uint32_t v) {
+  uint32_t r = 0, bit = 1UL << 30;
+  while (bit > v) bit >>= 2;
+  while (bit) {                                  // <= 16 iterations
+    if (v >= r + bit) { v -= r + bit; r = (r >> 1) + bit; }
+    else              { r >>= 1; }
+    bit >>= 2;
+  }
+  return r;
+}
+
+/**
+ * GaitDetector — per-sample step detection on |a|, integer only after begin().
+ *
+ *   |a| (isqrt) -> 1-pole high-pass (drop 1 g) -> 2x 1-pole low-pass
+ *   -> local maximum whose rise from the preceding valley beats
+ *      max(min_p2p_mg, half the recent step amplitude) outside the refractory window.
+ *
+ * Signal path is Q4 mg in int32; filter coefficients are Q15 and computed
+ * once in begin(). push() is O(1) with no data-dependent loops besides the
+ * bounded isqrt, so it can run inside the IMU task for every sample.
+ */
+class GaitDetector {
+public:
+  void begin(const GaitConfig& cfg) {
+    cfg_ = cfg;
+    const float fs = cfg.rate_hz ? (float)cfg.rate_hz : 100.0f;
+    aHp_ = coeff(cfg.hp_mhz / 1000.0f, fs);
+    aLp_ = coeff(cfg.lp_mhz / 1000.0f, fs);
+    // Envelope decays with tau ~4 s regardless of the rate
+    decayShift_ = 0;
+    while ((1UL << decayShift_) < 4UL * (uint32_t)fs && decayShift_ < 16) ++decayShift_;
+    reset();
+  }
+
+  void reset() {
+    primed_ = false;
+    dc_ = lp1_ = lp2_ = 0;
+    s1_ = s2_ = 0;
+    ts1_ = 0;
+    valley_ = 0;
+    env_ = 0;
+    steps_ = 0;
+    lastStepTs_ = 0;
+    haveStep_ = false;
+    walking_ = false;
+    for (auto& i : intervals_) i = 0;
+    nIntervals_ = 0;
+  }
+
+  // Feed one sample; true when event() holds a new packet (step or stop).
+  bool push(const StrideraAccelPacket& p) {
+    const int32_t ax = p.ax_mg, ay = p.ay_mg, az = p.az_mg;
+    const int32_t mag = (int32_t)stridera_isqrt32((uint32_t)(ax * ax) + (uint32_t)(ay * ay) + (uint32_t)(az * az)) << 4;
+
+    if (!primed_) {                              // start the high-pass at the current |a|
+      primed_ = true;
+      dc_ = mag;
+      ts1_ = p.ts_ms;
+      return false;
+    }
+    dc_  += (int32_t)(((int64_t)(mag - dc_) * aHp_) >> 15);
+    const int32_t hp = mag - dc_;
+    lp1_ += (int32_t)(((int64_t)(hp - lp1_) * aLp_) >> 15);
+    lp2_ += (int32_t)(((int64_t)(lp1_ - lp2_) * aLp_) >> 15);
+    const int32_t s = lp2_;
+
+    env_ -= env_ >> decayShift_;
+    bool ev = false;
+
+    // Local maximum at the previous sample
+    if (s1_ > s2_ && s1_ >= s) {
+      const int32_t p2p = s1_ - valley_;
+      const int32_t floor = (int32_t)cfg_.min_p2p_mg << 4;
+      const int32_t thr = (env_ >> 1) > floor ? (env_ >> 1) : floor;
+      const bool refractory = haveStep_ && (uint32_t)(ts1_ - lastStepTs_) < cfg_.min_step_ms;
+      if (p2p >= thr && !refractory) {
+        ev = onStep(ts1_, p2p);
+        valley_ = s1_;
+      }
+    }
+    if (s < valley_) valley_ = s;
+
+    // Stopped: no step for max_step_ms
+    if (walking_ && (uint32_t)(p.ts_ms - lastStepTs_) > cfg_.max_step_ms) {
+      walking_ = false;
+      nIntervals_ = 0;
+      fill(0, p.ts_ms, 0, 0);
+      ev = true;
+    }
+
+    s2_ = s1_;
+    s1_ = s;
+    ts1_ = p.ts_ms;
+    return ev;
+  }
+
+  const StrideraGaitPacket& event() const { return event_; }
+  uint32_t steps()   const { return steps_; }
+  bool     walking() const { return walking_; }
+
+private:
+  static int32_t coeff(float fc, float fs) {     // 1-pole smoothing factor, Q15
+    const float a = 1.0f - expf(-2.0f * (float)M_PI * fc / fs);
+    return (int32_t)(a * 32768.0f + 0.5f);
+  }
+
+  bool onStep(uint32_t ts, int32_t p2p) {
+    const uint32_t dt = haveStep_ ? ts - lastStepTs_ : 0;
+    const bool continuing = haveStep_ && dt <= cfg_.max_step_ms;
+
+    env_ = env_ ? env_ + ((p2p - env_) >> 2) : p2p;
+    ++steps_;
+    haveStep_   = true;
+    lastStepTs_ = ts;
+
+    uint16_t step_ms = 0, stride_ms = 0;
+    if (continuing) {
+      step_ms = (uint16_t)dt;
+      if (nIntervals_) stride_ms = (uint16_t)(dt + intervals_[(nIntervals_ - 1) & 3]);
+      intervals_[nIntervals_ & 3] = (uint16_t)dt;
+      ++nIntervals_;
+    } else {
+      nIntervals_ = 0;
+    }
+    walking_ = nIntervals_ >= 2;
+
+    fill(STRIDERA_GAIT_F_STEP, ts, step_ms, stride_ms);
+    event_.peak_mg = (uint16_t)((p2p >> 4) > 0xFFFF ? 0xFFFF : (p2p >> 4));
+    return true;
+  }
+
+  void fill(uint8_t flags, uint32_t ts, uint16_t step_ms, uint16_t stride_ms) {
+    uint32_t cadence = 0;
+    if (walking_ && nIntervals_) {
+      const uint32_t n = nIntervals_ < 4 ? nIntervals_ : 4;
+      uint32_t sum = 0;
+      for (uint32_t i = 0; i < n; ++i) sum += intervals_[i];
+      cadence = sum ? 600000UL * n / sum : 0;    // steps/min x10
+    }
+    event_.kind            = STRIDERA_FRAME_GAIT;
+    event_.flags           = flags | (walking_ ? STRIDERA_GAIT_F_WALKING : 0);
+    event_.step_count      = (uint16_t)steps_;
+    event_.ts_ms           = ts;
+    event_.step_ms         = step_ms;
+    event_.stride_ms       = stride_ms;
+    event_.cadence_spm_x10 = (uint16_t)(cadence > 0xFFFF ? 0xFFFF : cadence);
+    event_.peak_mg         = 0;
+  }
+
+  GaitConfig cfg_{};
+  int32_t  aHp_ = 0, aLp_ = 0;
+  uint8_t  decayShift_ = 10;
+
+  bool     primed_ = false;
+  int32_t  dc_ = 0, lp1_ = 0, lp2_ = 0;          // Q4 mg
+  int32_t  s1_ = 0, s2_ = 0;                     // previous two filtered samples
+  uint32_t ts1_ = 0;
+  int32_t  valley_ = 0;                          // lowest point since the last step
+  int32_t  env_ = 0;                             // recent step peak-to-valley
+
+  uint32_t steps_ = 0;
+  uint32_t lastStepTs_ = 0;
+  bool     haveStep_ = false;
+  bool     walking_ = false;
+  uint16_t intervals_[4] = {0};
+  uint32_t nIntervals_ = 0;
+
+  StrideraGaitPacket event_{};
+};
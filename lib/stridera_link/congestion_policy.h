@@ -0,0 +1,143 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * CongestionPolicy — per-central backpressure control for the sample stream.
+ *
+ * Watches one central's send queue: the deepest it got in each window,
+ * notifications the host stack refused (busy) and frames evicted from a full
+ * queue (drops). Each congested window steps one level up, calm_windows calm
+ * windows in a row step one level down:
+ *
+ *   0 NONE     the central's own settings; the bounded queue absorbs bursts
+ *   1 BATCH    full frames only (batch limit ignored), 4x flush deadline
+ *              (x2 / x4 again while decimating, so thinned frames still fill)
+ *   2 COMPACT  delta encoding instead of plain batches (accel batches only)
+ *   3 HALF     every 2nd sample
+ *   4 QUARTER  every 4th sample
+ *
+ * A window is congested when the queue is backed up — a frame was dropped,
+ * it peaked at high_pct of its capacity, or notifications were refused
+ * with it past halfway between low_pct and high_pct — and it is still not
+ * draining: depth growth plus drops over this and the previous window is
+ * above zero. A backlog that shrinks means the current level is enough, so
+ * the policy holds while it drains instead of escalating again; a queue that
+ * rises and falls with sparse connection events is not congestion either.
+ * After a step up the next one waits hold_windows (a thinned stream takes
+ * a while to fill its first frames) unless frames are being dropped.
+ * A window is calm with no drops and a peak at or below low_pct.
+ * A level that does not apply to a central's format (COMPACT on v2 frames or
+ * single packets) changes nothing for it; if the queue keeps growing the next
+ * window escalates again. Samples left out by HALF / QUARTER are counted
+ * separately from drops.
+ */
+
+#define STRIDERA_CONG_NONE    0
+#define STRIDERA_CONG_BATCH   1
+#define STRIDERA_CONG_COMPACT 2
+#define STRIDERA_CONG_HALF    3
+#define STRIDERA_CONG_QUARTER 4
+
+struct CongestionConfig {
+  uint16_t window_ms    = 250;
+  uint8_t  high_pct     = 75;                       // queue peak (% of capacity) that is congestion by itself
+  uint8_t  low_pct      = 25;                       // peak at or below this is calm
+  uint8_t  calm_windows = 8;                        // calm windows before stepping down a level
+  uint8_t  hold_windows = 4;                        // windows after a step up before the next (no drops)
+  uint8_t  max_level    = STRIDERA_CONG_QUARTER;    // STRIDERA_CONG_NONE = off
+};
+
+struct CongestionStats {
+  uint8_t  level;          // current STRIDERA_CONG_*
+  uint8_t  peak_level;     // highest level since reset()
+  uint16_t escalations;    // windows that stepped up
+  uint32_t busy;           // notify() refusals seen
+};
+
+class CongestionPolicy {
+public:
+  void setConfig(const CongestionConfig& c) { cfg_ = c; if (level_ > cfg_.max_level) level_ = cfg_.max_level; }
+  const CongestionConfig& config() const { return cfg_; }
+
+  void reset(uint32_t now_ms) {
+    level_ = peakLevel_ = 0;
+    escalations_ = 0;
+    busyTotal_   = 0;
+    calm_  = hold_ = 0;
+    busy_  = drops_ = 0;
+    peak_  = startDepth_ = lastDepth_ = prevStart_ = 0;
+    prevDrops_ = 0;
+    windowMs_ = now_ms;
+  }
+
+  // ---- signals (consumer side) ----
+  void onQueue(size_t depth, size_t cap) {
+    lastDepth_ = (uint16_t)depth;
+    cap_       = (uint16_t)cap;
+    if (depth > peak_) peak_ = (uint16_t)depth;
+  }
+  void onBusy() { ++busy_; ++busyTotal_; }
+  void onDrop() { ++drops_; }
+
+  // Closes the window once window_ms has passed; true if the level changed
+  bool update(uint32_t now_ms) {
+    if (now_ms - windowMs_ < cfg_.window_ms) return false;
+    windowMs_ = now_ms;
+
+    const uint32_t peakPct = cap_ ? (uint32_t)peak_ * 100 / cap_ : 0;
+    const bool backlog   = drops_ || peakPct >= cfg_.high_pct ||
+                           (busy_ && peakPct >= (cfg_.low_pct + cfg_.high_pct) / 2u);
+    const int32_t trend  = (int32_t)lastDepth_ - (int32_t)prevStart_ + drops_ + prevDrops_;
+    const bool congested = backlog && trend > 0;
+    const bool calm      = !drops_ && peakPct <= cfg_.low_pct;
+
+    const uint8_t before = level_;
+    if (hold_) --hold_;
+    if (congested) {
+      calm_ = 0;
+      if (level_ < cfg_.max_level && (!hold_ || drops_)) {
+        ++level_;
+        ++escalations_;
+        if (level_ > peakLevel_) peakLevel_ = level_;
+        hold_ = cfg_.hold_windows;
+      }
+    } else if (calm) {
+      if (level_ && ++calm_ >= cfg_.calm_windows) { --level_; calm_ = 0; }
+    } else {
+      calm_ = 0;                                    // in between: hold
+    }
+    prevStart_ = startDepth_;
+    prevDrops_ = drops_;
+    busy_ = drops_ = 0;
+    peak_ = startDepth_ = lastDepth_;               // the next window starts where this one ended
+    return level_ != before;
+  }
+
+  // ---- what the stream does at this level ----
+  uint8_t level()      const { return level_; }
+  bool    fullFrames() const { return level_ >= STRIDERA_CONG_BATCH; }
+  bool    compact()    const { return level_ >= STRIDERA_CONG_COMPACT; }
+  uint8_t keepEvery()  const { return level_ >= STRIDERA_CONG_QUARTER ? 4 : level_ >= STRIDERA_CONG_HALF ? 2 : 1; }
+  uint32_t flushLatencyMs(uint32_t base_ms) const { return fullFrames() ? base_ms * 4 * keepEvery() : base_ms; }
+
+  CongestionStats stats() const { return CongestionStats{level_, peakLevel_, escalations_, busyTotal_}; }
+
+private:
+  CongestionConfig cfg_;
+  uint8_t  level_       = 0;
+  uint8_t  peakLevel_   = 0;
+  uint16_t escalations_ = 0;
+  uint32_t busyTotal_   = 0;
+  uint8_t  calm_        = 0;                        // consecutive calm windows
+  uint8_t  hold_        = 0;                        // windows left before another step up
+  uint16_t busy_        = 0;                        // this window
+  uint16_t drops_       = 0;
+  uint16_t peak_        = 0;
+  uint16_t startDepth_  = 0;
+  uint16_t prevStart_   = 0;                        // previous window: depth at its start, drops
+  uint16_t prevDrops_   = 0;
+  uint16_t lastDepth_   = 0;
+  uint16_t cap_         = 0;
+  uint32_t windowMs_    = 0;
+};
@@ -0,0 +1,66 @@
+#pragma once
+#include <stdint.h>
+#include "link_policy.h"
+
+/**
+ * FakeLinkControl — stands in for NimBLE + a central when running LinkPolicy on a host.
+ * Requests are recorded and answered on the next deliver(), like the
+ * controller events that arrive asynchronously on the device. The central's
+ * behaviour is configurable: minimum interval it grants, whether it supports
+ * 2M, whether it silently ignores parameter requests.
+ */
+class FakeLinkControl : public ILinkControl {
+public:
+  bool     has2M        = true;
+  uint16_t centralMinItvl = 12;      // e.g. 15 ms on phones that refuse 7.5 ms
+  uint16_t centralMaxItvl = 3200;
+  bool     ignoreParams = false;     // central never answers update requests
+  bool     failCalls    = false;     // host stack rejects the call itself
+
+  uint32_t phyRequests = 0, dleRequests = 0, paramRequests = 0;
+  LinkParams lastParams{};
+
+  bool supports2M() const override { return has2M; }
+
+  bool requestPhy(uint16_t, bool phy_2m) override {
+    ++phyRequests;
+    if (failCalls) return false;
+    phyPending_ = true;
+    phyWant2M_  = phy_2m && has2M;
+    return true;
+  }
+
+  bool requestDataLen(uint16_t, uint16_t) override {
+    ++dleRequests;
+    return !failCalls;
+  }
+
+  bool requestParams(uint16_t, const LinkParams& p) override {
+    ++paramRequests;
+    if (failCalls) return false;
+    lastParams     = p;
+    paramsPending_ = !ignoreParams;
+    return true;
+  }
+
+  // Controller events for everything requested since the last call
+  void deliver(LinkPolicy& policy) {
+    if (phyPending_) {
+      phyPending_ = false;
+      const uint8_t phy = phyWant2M_ ? 2 : 1;
+      policy.onPhy(phy, phy);
+    }
+    if (paramsPending_) {
+      paramsPending_ = false;
+      uint16_t itvl = lastParams.max_interval;        // central picks within [min, max] if it can
+      if (itvl < centralMinItvl) itvl = centralMinItvl;
+      if (itvl > centralMaxItvl) itvl = centralMaxItvl;
+      policy.onParams(itvl, lastParams.latency, lastParams.timeout);
+    }
+  }
+
+private:
+  bool phyPending_    = false;
+  bool phyWant2M_     = false;
+  bool paramsPending_ = false;
+};
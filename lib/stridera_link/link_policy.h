@@ -0,0 +1,245 @@
+#pragma once
+#include <stdint.h>
+#include "stridera_link_diag.h"
+
+/**
+ * LinkPolicy — decides which PHY, data length and connection parameters to
+ * ask the central for, given what the device is doing right now.
+ *
+ * - Streaming: short interval, no slave latency (one batch frame per event).
+ * - Bulk:      shortest interval the phones accept, for downloads.
+ * - Idle:      long interval + slave latency, the radio sleeps between events.
+ * 2M PHY and DLE (251 octets) are asked for once per connection: they only
+ * shorten airtime, which helps every profile.
+ *
+ * The central has the final say. Requests are spaced and bounded; a refusal
+ * is counted and the policy stops asking for that profile instead of looping.
+ * All NimBLE access goes through ILinkControl, so the policy runs on a host.
+ */
+
+struct LinkParams {
+  uint16_t min_interval;   // 1.25 ms units
+  uint16_t max_interval;
+  uint16_t latency;        // connection events the peripheral may skip
+  uint16_t timeout;        // 10 ms units
+};
+
+struct LinkTarget {
+  bool       phy_2m;
+  uint16_t   data_len;     // LL TX octets (27..251)
+  LinkParams params;
+};
+
+struct LinkTiming {
+  uint32_t settle_ms    = 1000;  // let the central finish discovery/MTU exchange first
+  uint32_t retry_ms     = 2000;  // spacing between attempts / confirm timeout
+  uint32_t idle_hold_ms = 3000;  // stay fast this long after streaming stops (no flapping)
+  uint8_t  max_attempts = 3;     // per item and profile
+};
+
+// Default table. Intervals are multiples of 15 ms where phones are picky about it.
+static inline LinkTarget stridera_link_target(uint8_t profile) {
+  switch (profile) {
+    case STRIDERA_LINK_PROFILE_BULK:      return LinkTarget{true, 251, {6, 12, 0, 400}};     // 7.5..15 ms
+    case STRIDERA_LINK_PROFILE_STREAMING: return LinkTarget{true, 251, {12, 24, 0, 400}};    // 15..30 ms
+    default:                              return LinkTarget{true, 251, {72, 96, 4, 600}};    // 90..120 ms, skip 4
+  }
+}
+
+class ILinkControl {
+public:
+  virtual ~ILinkControl() = default;
+  virtual bool supports2M() const = 0;
+  virtual bool requestPhy(uint16_t conn, bool phy_2m) = 0;
+  virtual bool requestDataLen(uint16_t conn, uint16_t octets) = 0;
+  virtual bool requestParams(uint16_t conn, const LinkParams& p) = 0;
+};
+
+class LinkPolicy {
+public:
+  void setTiming(const LinkTiming& t) { timing_ = t; }
+
+  // ---- events (BLE callbacks) ----
+  void onConnect(uint16_t conn, uint16_t interval, uint16_t latency, uint16_t timeout, uint32_t now_ms) {
+    connected_ = true;
+    conn_      = conn;
+    connectMs_ = now_ms;
+    mtu_       = 23;
+    phyTx_ = phyRx_ = 1;
+    dataLen_   = 27;
+    interval_  = interval;
+    latency_   = latency;
+    timeout_   = timeout;
+    flags_     = 0;
+    phy_       = Item{};
+    dle_       = Item{};
+    params_    = Item{};
+    notifyOk_ = notifyFailed_ = windowCount_ = 0;
+    notifyPerSec_ = 0;
+    windowMs_  = now_ms;
+  }
+
+  void onDisconnect() { connected_ = false; }
+  void onMtu(uint16_t mtu) { mtu_ = mtu; }
+
+  void onPhy(uint8_t tx, uint8_t rx) {
+    phyTx_ = tx;
+    phyRx_ = rx;
+    phy_.pending = false;
+    phy_.done    = true;                         // whatever the central chose is final
+  }
+
+  void onParams(uint16_t interval, uint16_t latency, uint16_t timeout) {
+    interval_ = interval;
+    latency_  = latency;
+    timeout_  = timeout;
+    params_.pending = false;
+    if (satisfied(applied_)) params_.done = true;
+  }
+
+  // What the device is doing; Idle only takes effect after idle_hold_ms.
+  void setProfile(uint8_t profile, uint32_t now_ms) {
+    if (profile == wanted_) return;
+    wanted_   = profile;
+    wantedMs_ = now_ms;
+  }
+
+  void countNotify(bool ok) {
+    if (ok) { ++notifyOk_; ++windowCount_; }
+    else    ++notifyFailed_;
+  }
+
+  // ---- driver (loop task) ----
+  void tick(ILinkControl& ctl, uint32_t now_ms) {
+    if (!connected_) return;
+
+    if (now_ms - windowMs_ >= 1000) {
+      notifyPerSec_ = (uint16_t)((uint64_t)windowCount_ * 1000 / (now_ms - windowMs_));
+      windowCount_  = 0;
+      windowMs_     = now_ms;
+    }
+    if (now_ms - connectMs_ < timing_.settle_ms) return;
+
+    if (wanted_ != applied_ &&
+        (wanted_ != STRIDERA_LINK_PROFILE_IDLE || now_ms - wantedMs_ >= timing_.idle_hold_ms)) {
+      applied_ = wanted_;
+      params_  = Item{};                         // new targets, fresh attempts
+      flags_  &= ~STRIDERA_LINK_F_PARAMS_REJECTED;
+    }
+    const LinkTarget t = stridera_link_target(applied_);
+
+    // One request per tick, cheapest first
+    if (!dle_.done && t.data_len > 27 && due(dle_, now_ms)) {
+      ++dle_.attempts;
+      dle_.lastMs = now_ms;
+      if (ctl.requestDataLen(conn_, t.data_len)) {
+        dle_.done = true;                        // no completion event; the LL negotiates down if needed
+        dataLen_  = t.data_len;
+        flags_   |= STRIDERA_LINK_F_DLE;
+      } else if (dle_.attempts >= timing_.max_attempts) {
+        dle_.done = true;                        // refused every time: stay at 27 octets
+      }
+      return;
+    }
+
+    if (!phy_.done && t.phy_2m) {
+      if (!ctl.supports2M()) {
+        phy_.done = true;
+        flags_   |= STRIDERA_LINK_F_NO_2M;
+      } else if (due(phy_, now_ms)) {
+        ++phy_.attempts;
+        phy_.lastMs  = now_ms;
+        phy_.pending = ctl.requestPhy(conn_, true);
+        return;
+      } else if (phy_.attempts >= timing_.max_attempts &&
+                 (!phy_.pending || now_ms - phy_.lastMs >= timing_.retry_ms)) {
+        phy_.pending = false;                    // refused or never answered: stay on 1M
+        phy_.done    = true;
+      }
+    }
+
+    if (!params_.done && satisfied(applied_)) params_.done = true;
+    if (!params_.done) {
+      if (params_.attempts >= timing_.max_attempts) {
+        if (!params_.pending || now_ms - params_.lastMs >= timing_.retry_ms) {
+          params_.pending = false;                 // refused or never answered: stop asking
+          params_.done    = true;                  // until the profile changes
+          flags_ |= STRIDERA_LINK_F_PARAMS_REJECTED;
+        }
+      } else if (due(params_, now_ms)) {
+        ++params_.attempts;
+        params_.lastMs  = now_ms;
+        params_.pending = ctl.requestParams(conn_, t.params);
+      }
+    }
+  }
+
+  // ---- status ----
+  bool     connected()    const { return connected_; }
+  uint8_t  profile()      const { return applied_; }
+  uint16_t notifyPerSec() const { return notifyPerSec_; }
+  // Nothing left to ask for this profile (granted, or given up after max_attempts)
+  bool     settled()      const { return dle_.done && phy_.done && params_.done; }
+
+  StrideraLinkDiag diag() const {
+    StrideraLinkDiag d{};
+    d.version       = STRIDERA_LINK_DIAG_VERSION;
+    d.profile       = applied_;
+    d.mtu           = mtu_;
+    d.phy_tx        = phyTx_;
+    d.phy_rx        = phyRx_;
+    d.data_len      = dataLen_;
+    d.interval      = interval_;
+    d.latency       = latency_;
+    d.timeout       = timeout_;
+    d.flags         = flags_ | (phy_.pending ? STRIDERA_LINK_F_PHY_PENDING : 0)
+                             | (params_.pending ? STRIDERA_LINK_F_PARAMS_PENDING : 0);
+    d.notify_per_s  = notifyPerSec_;
+    d.notify_ok     = notifyOk_;
+    d.notify_failed = notifyFailed_;
+    return d;
+  }
+
+private:
+  struct Item {
+    bool     done     = false;
+    bool     pending  = false;                   // requested, waiting for the controller event
+    uint8_t  attempts = 0;
+    uint32_t lastMs   = 0;
+  };
+
+  // Not done, attempts left, and either never tried or the last try timed out
+  bool due(const Item& it, uint32_t now_ms) const {
+    if (it.done || it.attempts >= timing_.max_attempts) return false;
+    return it.attempts == 0 || now_ms - it.lastMs >= timing_.retry_ms;
+  }
+
+  bool satisfied(uint8_t profile) const {
+    const LinkParams& p = stridera_link_target(profile).params;
+    return interval_ >= p.min_interval && interval_ <= p.max_interval && latency_ == p.latency;
+  }
+
+  LinkTiming timing_{};
+  bool       connected_ = false;
+  uint16_t   conn_      = 0;
+  uint32_t   connectMs_ = 0;
+  uint8_t    wanted_    = STRIDERA_LINK_PROFILE_IDLE;
+  uint8_t    applied_   = STRIDERA_LINK_PROFILE_IDLE;
+  uint32_t   wantedMs_  = 0;
+
+  uint16_t   mtu_      = 23;
+  uint8_t    phyTx_    = 1;
+  uint8_t    phyRx_    = 1;
+  uint16_t   dataLen_  = 27;
+  uint16_t   interval_ = 0;
+  uint16_t   latency_  = 0;
+  uint16_t   timeout_  = 0;
+  uint8_t    flags_    = 0;
+  Item       phy_, dle_, params_;
+
+  uint32_t   notifyOk_     = 0;
+  uint32_t   notifyFailed_ = 0;
+  uint32_t   windowCount_  = 0;
+  uint32_t   windowMs_     = 0;
+  uint16_t   notifyPerSec_ = 0;
+};
@@ -0,0 +1,193 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <atomic>
+#include "stridera_perf.h"
+
+/**
+ * Scoped hot-path probes.
+ *
+ *   STRIDERA_PERF_SCOPE(stat);    // times the rest of the enclosing block into `stat`
+ *   STRIDERA_PERF_MARK(period);   // records the interval since the previous mark
+ *
+ * With STRIDERA_PERF undefined or 0 both macros expand to nothing (their
+ * arguments are not even evaluated), so instrumented code costs nothing.
+ *
+ * Clock: Xtensa CCOUNT on ESP32 (one cycle resolution, per core: time
+ * stages in pinned tasks), esp_timer elsewhere on ESP-IDF, std::chrono on a
+ * host so benchmarks can reuse the same stats. CCOUNT follows the CPU clock,
+ * which the power policy changes per mode: each stat keeps the clock of its
+ * first sample and converts with that, and the firmware requests a reset on
+ * every change so no stat mixes clocks (DFS dips below the planned maximum
+ * are not tracked).
+ */
+
+#ifndef STRIDERA_PERF
+  #define STRIDERA_PERF 0
+#endif
+
+#if defined(ARDUINO) && defined(__XTENSA__)
+  #include <Arduino.h>
+  static inline uint32_t stridera_perf_now() {
+    uint32_t c;
+    __asm__ __volatile__("rsr %0, ccount" : "=r"(c));
+    return c;
+  }
+  static inline uint32_t stridera_perf_ticks_per_us() { return getCpuFrequencyMhz(); }
+#elif defined(ARDUINO)
+  #include <Arduino.h>
+  #include <esp_timer.h>
+  static inline uint32_t stridera_perf_now() { return (uint32_t)esp_timer_get_time(); }
+  static inline uint32_t stridera_perf_ticks_per_us() { return 1; }
+#else
+  #include <chrono>
+  static inline uint32_t stridera_perf_now() {
+    return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+  static inline uint32_t stridera_perf_ticks_per_us() { return 1000; }
+#endif
+
+/**
+ * PerfStat — min / max / mean / percentile of tick durations.
+ * Log-linear histogram: 8 buckets per octave (<= 12.5% error) over the full
+ * uint32 range in 240 uint16 counters; counters halve together before one
+ * would saturate, so percentiles stay valid on long runs. Single writer;
+ * readers may see a slightly torn snapshot, which is fine for diagnostics.
+ * Other tasks clear it with requestReset(): the writer does the clearing on
+ * its next record(), so the counters never see two writers.
+ */
+class PerfStat {
+public:
+  static constexpr size_t kBuckets = 240;
+
+  void record(uint32_t ticks) {
+    takeReset();
+    if (!count_) tpu_ = stridera_perf_ticks_per_us();
+    ++count_;
+    sum_ += ticks;
+    if (ticks < min_) min_ = ticks;
+    if (ticks > max_) max_ = ticks;
+    uint16_t& b = hist_[bucket(ticks)];
+    if (b == 0xFFFF) for (auto& h : hist_) h >>= 1;
+    ++b;
+  }
+
+  void reset() {
+    count_ = 0;
+    sum_   = 0;
+    min_   = UINT32_MAX;
+    max_   = 0;
+    memset(hist_, 0, sizeof(hist_));
+  }
+
+  void requestReset() { resetPending_.store(true); }            // any task
+
+  // Writer side of requestReset(): clears the stat if one is pending
+  bool takeReset() {
+    if (!resetPending_.load(std::memory_order_relaxed) || !resetPending_.exchange(false)) return false;
+    reset();
+    return true;
+  }
+
+  uint32_t count() const { return count_; }
+  uint32_t min()   const { return count_ ? min_ : 0; }
+  uint32_t max()   const { return max_; }
+  uint32_t avg()   const { return count_ ? (uint32_t)(sum_ / count_) : 0; }
+  uint32_t ticksPerUs() const { return tpu_; }                  // probe clock when recorded
+
+  // Upper edge of the bucket holding the pct-th percentile (pct in 1..100)
+  uint32_t percentile(uint8_t pct) const {
+    uint32_t total = 0;
+    for (auto h : hist_) total += h;
+    if (!total) return 0;
+    const uint32_t want = (uint32_t)(((uint64_t)total * pct + 99) / 100);
+    uint32_t seen = 0;
+    for (size_t i = 0; i < kBuckets; ++i) {
+      seen += hist_[i];
+      if (seen >= want) { const uint32_t hi = upper(i); return hi < max_ ? hi : max_; }
+    }
+    return max_;
+  }
+
+  static size_t bucket(uint32_t v) {
+    if (v < 8) return v;
+    const unsigned o = 31u - (unsigned)__builtin_clz(v);       // >= 3
+    return (size_t)(o - 2) * 8 + ((v >> (o - 3)) & 7);
+  }
+
+  static uint32_t upper(size_t b) {
+    if (b < 8) return (uint32_t)b;
+    const unsigned o = (unsigned)(b / 8) + 2;
+    const uint64_t lo = (uint64_t)(8 + b % 8) << (o - 3);
+    const uint64_t hi = lo + (1ULL << (o - 3)) - 1;
+    return hi > UINT32_MAX ? UINT32_MAX : (uint32_t)hi;
+  }
+
+private:
+  uint32_t count_ = 0;
+  uint64_t sum_   = 0;
+  uint32_t min_   = UINT32_MAX;
+  uint32_t max_   = 0;
+  uint32_t tpu_   = 0;
+  uint16_t hist_[kBuckets] = {0};
+  std::atomic<bool> resetPending_{false};
+};
+
+// Interval between successive marks (loop period, tick period) -> PerfStat
+class PerfPeriod {
+public:
+  void mark(uint32_t now) {
+    if (stat.takeReset()) have_ = false;           // the interval in flight spans the request
+    if (have_) stat.record(now - last_);
+    last_ = now;
+    have_ = true;
+  }
+  void reset() { stat.reset(); have_ = false; }
+  void requestReset() { stat.requestReset(); }    // any task; mark() drops the open interval
+
+  PerfStat stat;
+
+private:
+  uint32_t last_ = 0;
+  bool     have_ = false;
+};
+
+class PerfScope {
+public:
+  explicit PerfScope(PerfStat& s) : s_(s), t0_(stridera_perf_now()) {}
+  ~PerfScope() { s_.record(stridera_perf_now() - t0_); }
+  PerfScope(const PerfScope&) = delete;
+  PerfScope& operator=(const PerfScope&) = delete;
+
+private:
+  PerfStat& s_;
+  uint32_t  t0_;
+};
+
+static inline uint32_t stridera_perf_ticks_to_ns(uint32_t ticks, uint32_t ticks_per_us) {
+  return (uint32_t)((uint64_t)ticks * 1000 / (ticks_per_us ? ticks_per_us : 1));
+}
+
+static inline StrideraPerfEntry stridera_perf_entry(uint8_t stage, const PerfStat& s) {
+  StrideraPerfEntry e{};
+  e.stage  = stage;
+  e.count  = s.count();
+  e.min_ns = stridera_perf_ticks_to_ns(s.min(), s.ticksPerUs());
+  e.avg_ns = stridera_perf_ticks_to_ns(s.avg(), s.ticksPerUs());
+  e.max_ns = stridera_perf_ticks_to_ns(s.max(), s.ticksPerUs());
+  e.p99_ns = stridera_perf_ticks_to_ns(s.percentile(99), s.ticksPerUs());
+  return e;
+}
+
+#define STRIDERA_PERF_CAT2(a, b) a##b
+#define STRIDERA_PERF_CAT(a, b)  STRIDERA_PERF_CAT2(a, b)
+
+#if STRIDERA_PERF
+  #define STRIDERA_PERF_SCOPE(stat)   PerfScope STRIDERA_PERF_CAT(_perf_scope_, __LINE__)(stat)
+  #define STRIDERA_PERF_MARK(period)  (period).mark(stridera_perf_now())
+#else
+  #define STRIDERA_PERF_SCOPE(stat)   ((void)0)
+  #define STRIDERA_PERF_MARK(period)  ((void)0)
+#endif
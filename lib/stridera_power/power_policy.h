@@ -0,0 +1,131 @@
+#pragma once
+#include <stdint.h>
+
+/**
+ * Power policy — what the device should run at, decided from what it is doing.
+ *
+ * - PowerPolicy maps the activity (idle / capture / streaming / recording / bulk) to a
+ *   CPU clock and whether automatic light sleep may be used between IMU FIFO
+ *   batches and BLE connection events, and dims the backlight after a period
+ *   without user or central activity.
+ * - EnergyMeter integrates battery voltage x current over time and divides by
+ *   the samples streamed meanwhile (uJ per sample).
+ * Both are plain C++ on millisecond timestamps, so a host can replay a
+ * simulated timeline; PowerService applies the plan on the device.
+ */
+
+// Capture: idle, but the IMU task still feeds the event capture ring every tick
+enum class PowerMode : uint8_t { Idle, Capture, Streaming, Recording, Bulk };
+
+struct PowerConfig {
+  // CPU clock per mode (ESP32 with BLE: 80 / 160 / 240)
+  uint16_t idle_mhz      = 80;
+  uint16_t capture_mhz   = 80;     // one FIFO drain + a record store per sample
+  uint16_t streaming_mhz = 80;     // ~hundreds of ns per sample of work: plenty
+  uint16_t recording_mhz = 160;    // FAT + SD SPI
+  uint16_t bulk_mhz      = 240;    // file read + notify as fast as the link drains
+  // Light sleep between wakeups (timer ticks, connection events)
+  bool     sleep_idle      = true;
+  bool     sleep_capture   = true;    // the IMU timer wakes it every tick
+  bool     sleep_streaming = true;
+  bool     sleep_recording = false;   // SD card latency matters more here
+  bool     sleep_bulk      = false;
+  // Backlight
+  uint8_t  backlight_on         = 160;
+  uint8_t  backlight_off        = 0;
+  uint32_t backlight_timeout_ms = 30000;
+};
+
+struct PowerPlan {
+  uint16_t cpu_mhz;
+  bool     light_sleep;
+  uint8_t  backlight;
+  bool operator==(const PowerPlan& o) const {
+    return cpu_mhz == o.cpu_mhz && light_sleep == o.light_sleep && backlight == o.backlight;
+  }
+  bool operator!=(const PowerPlan& o) const { return !(*this == o); }
+};
+
+class PowerPolicy {
+public:
+  void begin(const PowerConfig& cfg, uint32_t now_ms) {
+    cfg_        = cfg;
+    activityMs_ = now_ms;
+  }
+
+  // Button press, state transition, central (dis)connecting: screen back on
+  void activity(uint32_t now_ms) { activityMs_ = now_ms; }
+
+  PowerPlan plan(PowerMode mode, uint32_t now_ms) const {
+    PowerPlan p{};
+    switch (mode) {
+      case PowerMode::Idle:      p.cpu_mhz = cfg_.idle_mhz;      p.light_sleep = cfg_.sleep_idle;      break;
+      case PowerMode::Capture:   p.cpu_mhz = cfg_.capture_mhz;   p.light_sleep = cfg_.sleep_capture;   break;
+      case PowerMode::Streaming: p.cpu_mhz = cfg_.streaming_mhz; p.light_sleep = cfg_.sleep_streaming; break;
+      case PowerMode::Recording: p.cpu_mhz = cfg_.recording_mhz; p.light_sleep = cfg_.sleep_recording; break;
+      case PowerMode::Bulk:      p.cpu_mhz = cfg_.bulk_mhz;      p.light_sleep = cfg_.sleep_bulk;      break;
+    }
+    p.backlight = now_ms - activityMs_ >= cfg_.backlight_timeout_ms ? cfg_.backlight_off : cfg_.backlight_on;
+    return p;
+  }
+
+  // ms until plan() changes on its own (backlight timeout), UINT32_MAX if it will not
+  uint32_t dueMs(uint32_t now_ms) const {
+    const uint32_t idle = now_ms - activityMs_;
+    return idle >= cfg_.backlight_timeout_ms ? UINT32_MAX : cfg_.backlight_timeout_ms - idle;
+  }
+
+  const PowerConfig& config() const { return cfg_; }
+
+private:
+  PowerConfig cfg_{};
+  uint32_t    activityMs_ = 0;
+};
+
+/**
+ * EnergyMeter — trapezoidal V x I integration. Readings only count while the
+ * battery discharges (current < 0 on the AXP192 convention): on USB the PMIC
+ * reports charge current, not what the system draws.
+ */
+class EnergyMeter {
+public:
+  void reset() {
+    nj_ = 0; ms_ = 0; samples_ = 0;
+    have_ = false; invalid_ = 0;
+  }
+
+  // `samples` = samples streamed since the previous reading; they only count
+  // for intervals whose energy was measured
+  void addReading(uint32_t now_ms, int32_t battery_mv, int32_t battery_ma, uint32_t samples = 0) {
+    const bool valid = battery_ma < 0 && battery_mv > 0;
+    const uint32_t uw = valid ? (uint32_t)battery_mv * (uint32_t)(-battery_ma) : 0;   // mV * mA = uW
+    if (!valid) ++invalid_;
+    if (have_ && valid && lastValid_) {
+      const uint32_t dt = now_ms - lastMs_;
+      nj_ += (uint64_t)(uw + lastUw_) / 2 * dt;                                       // uW * ms = nJ
+      ms_ += dt;
+      samples_ += samples;
+    }
+    have_      = true;
+    lastValid_ = valid;
+    lastMs_    = now_ms;
+    lastUw_    = uw;
+  }
+
+  bool     valid()      const { return ms_ > 0; }
+  uint32_t invalidReadings() const { return invalid_; }   // e.g. running on USB
+  uint32_t avgMilliwatts()   const { return ms_ ? (uint32_t)(nj_ / ms_ / 1000) : 0; }
+  uint32_t microjoulesPerSample() const { return samples_ ? (uint32_t)(nj_ / 1000 / samples_) : 0; }
+  uint64_t samples()    const { return samples_; }
+  uint32_t elapsedMs()  const { return ms_; }
+
+private:
+  uint64_t nj_      = 0;
+  uint32_t ms_      = 0;
+  uint64_t samples_ = 0;
+  bool     have_      = false;
+  bool     lastValid_ = false;
+  uint32_t lastMs_    = 0;
+  uint32_t lastUw_    = 0;
+  uint32_t invalid_   = 0;
+};
@@ -0,0 +1,134 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "stridera_packet.h"
+
+/**
+ * Batched accel frame — one notification carrying N samples.
+ *
+ *   [StrideraBatchHeader][StrideraBatchSample x count]
+ *
+ * - base_ts_ms is the timestamp of the first sample; every sample stores its
+ *   offset from it, so a frame can span up to ~65 s. Offsets are taken modulo
+ *   2^32, so a frame may cross the 49-day millis() wrap.
+ * - The frame is sized to the negotiated ATT payload (MTU - 3). At MTU 247
+ *   that is 29 samples per notification instead of one.
+ * - Little-endian, packed (same convention as StrideraAccelPacket).
+ */
+
+#define STRIDERA_FRAME_BATCH 0xB1   // first byte of a batched frame
+
+#pragma pack(push, 1)
+struct StrideraBatchHeader {
+  uint8_t  kind;        // STRIDERA_FRAME_BATCH
+  uint8_t  count;       // number of samples that follow
+  uint16_t rate_hz;     // nominal sample rate
+  uint32_t base_ts_ms;  // ts of sample 0 (ms since boot)
+};
+
+struct StrideraBatchSample {
+  uint16_t dt_ms;       // offset from base_ts_ms
+  int16_t  ax_mg;
+  int16_t  ay_mg;
+  int16_t  az_mg;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(StrideraBatchHeader) == 8, "Unexpected batch header size");
+static_assert(sizeof(StrideraBatchSample) == 8, "Unexpected batch sample size");
+
+// ATT notification payload for a given MTU (3 bytes of ATT overhead)
+static constexpr size_t stridera_att_payload(uint16_t mtu) {
+  return mtu > 3 ? (size_t)mtu - 3 : 0;
+}
+
+// How many samples fit into a payload of `bytes`
+static constexpr size_t stridera_batch_capacity(size_t bytes) {
+  return bytes < sizeof(StrideraBatchHeader)
+           ? 0
+           : (bytes - sizeof(StrideraBatchHeader)) / sizeof(StrideraBatchSample);
+}
+
+/**
+ * StrideraBatchEncoder — coalesces packets into a caller-owned frame buffer.
+ * push() returns false when the sample does not fit (frame full, or its ts
+ * cannot be expressed as a 16-bit offset); the caller sends the frame,
+ * calls reset() and pushes again.
+ */
+class StrideraBatchEncoder {
+public:
+  void begin(uint8_t* buf, size_t cap) {
+    buf_ = buf;
+    cap_ = stridera_batch_capacity(cap);
+    if (cap_ > 255) cap_ = 255;
+    reset();
+  }
+
+  void reset() { count_ = 0; }
+
+  bool push(const StrideraAccelPacket& p) {
+    if (!buf_ || count_ >= cap_) return false;
+
+    StrideraBatchHeader hdr;
+    if (count_ == 0) {
+      hdr.kind       = STRIDERA_FRAME_BATCH;
+      hdr.count      = 0;
+      hdr.rate_hz    = p.rate_hz;
+      hdr.base_ts_ms = p.ts_ms;
+    } else {
+      memcpy(&hdr, buf_, sizeof(hdr));
+      const uint32_t dt = p.ts_ms - hdr.base_ts_ms;
+      if (dt > 0xFFFF) return false;            // also catches ts before the base (wraps huge)
+    }
+
+    StrideraBatchSample s;
+    s.dt_ms = (uint16_t)(p.ts_ms - hdr.base_ts_ms);
+    s.ax_mg = p.ax_mg;
+    s.ay_mg = p.ay_mg;
+    s.az_mg = p.az_mg;
+    memcpy(buf_ + sizeof(hdr) + count_ * sizeof(s), &s, sizeof(s));
+
+    hdr.count = (uint8_t)++count_;
+    memcpy(buf_, &hdr, sizeof(hdr));
+    return true;
+  }
+
+  bool   empty()    const { return count_ == 0; }
+  bool   full()     const { return count_ >= cap_; }
+  size_t count()    const { return count_; }
+  size_t capacity() const { return cap_; }
+  size_t size()     const { return count_ ? sizeof(StrideraBatchHeader) + count_ * sizeof(StrideraBatchSample) : 0; }
+  const uint8_t* data() const { return buf_; }
+
+private:
+  uint8_t* buf_   = nullptr;
+  size_t   cap_   = 0;   // samples
+  size_t   count_ = 0;
+};
+
+/**
+ * Decode a batched frame back into packets. Returns the number of packets
+ * written to `out`, or 0 if the frame is malformed or truncated.
+ */
+static inline size_t stridera_batch_decode(const uint8_t* buf, size_t len,
+                                           StrideraAccelPacket* out, size_t max) {
+  StrideraBatchHeader hdr;
+  if (!buf || len < sizeof(hdr)) return 0;
+  memcpy(&hdr, buf, sizeof(hdr));
+  if (hdr.kind != STRIDERA_FRAME_BATCH) return 0;
+  if (len < sizeof(hdr) + (size_t)hdr.count * sizeof(StrideraBatchSample)) return 0;
+
+  const size_t n = hdr.count < max ? hdr.count : max;
+  for (size_t i = 0; i < n; ++i) {
+    StrideraBatchSample s;
+    memcpy(&s, buf + sizeof(hdr) + i * sizeof(s), sizeof(s));
+    out[i].ts_ms    = hdr.base_ts_ms + s.dt_ms;
+    out[i].ax_mg    = s.ax_mg;
+    out[i].ay_mg    = s.ay_mg;
+    out[i].az_mg    = s.az_mg;
+    out[i].rate_hz  = (uint8_t)(hdr.rate_hz > 255 ? 255 : hdr.rate_hz);
+    out[i].reserved = 0;
+  }
+  return n;
+}
@@ -0,0 +1,113 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+#include "stridera_capture.h"
+
+/**
+ * Bulk session download — wire format of STRIDERA_BULK_SERVICE_UUID.
+ *
+ * Central -> device, written to the control characteristic:
+ *   LIST                              list stored sessions
+ *   GET   u32 offset, u16 credits, name   stream `name` from `offset` (resume = last contiguous byte);
+ *                                     a session name or STRIDERA_CAPTURE_NAME, else ERR_NAME
+ *   CREDIT u16 credits                grant more chunks (window flow control)
+ *   ABORT                             stop the current transfer
+ *   CAPTURE u8 action[, StrideraCaptureConfig]   event capture: fire, re-arm, configure
+ *
+ * Device -> central, notified on the data characteristic (first byte = kind):
+ *   LIST   u8 count, StrideraBulkListEntry x count
+ *   CHUNK  u32 offset, payload (MTU - 3 - 5 bytes); one chunk consumes one credit
+ *   STATUS StrideraBulkStatus (end of list, end of file, errors, achieved bytes/s;
+ *          CAPTURE_READY unsolicited when a capture froze, size = its bytes)
+ *
+ * A frozen capture is listed and fetched as STRIDERA_CAPTURE_NAME (format in
+ * stridera_capture.h); delivering it to the end re-arms the ring.
+ *
+ * One transfer at a time: while it runs, commands from any other central get
+ * ERR_BUSY; its central disconnecting ends it (resume with GET <offset>).
+ *
+ * Little-endian, packed.
+ */
+
+// Control opcodes
+#define STRIDERA_BULK_OP_LIST    0x01
+#define STRIDERA_BULK_OP_GET     0x02
+#define STRIDERA_BULK_OP_CREDIT  0x03
+#define STRIDERA_BULK_OP_ABORT   0x04
+#define STRIDERA_BULK_OP_CAPTURE 0x05
+
+// STRIDERA_BULK_OP_CAPTURE actions
+#define STRIDERA_CAPTURE_FIRE   0x01   // trigger now (while armed)
+#define STRIDERA_CAPTURE_ARM    0x02   // drop a frozen capture, record again
+#define STRIDERA_CAPTURE_CONFIG 0x03   // new thresholds / window (StrideraCaptureConfig follows)
+
+// Data frame kinds
+#define STRIDERA_BULK_FRAME_LIST   0xE1
+#define STRIDERA_BULK_FRAME_CHUNK  0xE2
+#define STRIDERA_BULK_FRAME_STATUS 0xE3
+
+// Status codes
+#define STRIDERA_BULK_OK_LIST_END   0x00
+#define STRIDERA_BULK_OK_EOF        0x01
+#define STRIDERA_BULK_CAPTURE_READY 0x02
+#define STRIDERA_BULK_ERR_NOTFOUND  0x10
+#define STRIDERA_BULK_ERR_IO        0x11
+#define STRIDERA_BULK_ABORTED       0x12
+#define STRIDERA_BULK_ERR_BUSY      0x13   // another central's transfer is running; only to the sender
+#define STRIDERA_BULK_ERR_NAME      0x14   // GET of a name that is neither a session nor the capture
+
+#define STRIDERA_BULK_NAME_LEN 16
+
+// Sessions LIST reports and GET serves: the recorder's "rec_NNNN.ssn", a bare
+// name in the storage root (no path, nothing else on the card)
+static inline bool stridera_bulk_session_name(const char* name) {
+  if (strlen(name) != 12 || memcmp(name, "rec_", 4) != 0 || strcmp(name + 8, ".ssn") != 0) return false;
+  for (int i = 4; i < 8; ++i) {
+    if (name[i] < '0' || name[i] > '9') return false;
+  }
+  return true;
+}
+
+#pragma pack(push, 1)
+struct StrideraBulkGet {
+  uint8_t  op;            // STRIDERA_BULK_OP_GET
+  uint32_t offset;
+  uint16_t credits;
+  char     name[STRIDERA_BULK_NAME_LEN];  // not necessarily 0-terminated
+};
+
+struct StrideraBulkCredit {
+  uint8_t  op;            // STRIDERA_BULK_OP_CREDIT
+  uint16_t credits;
+};
+
+struct StrideraBulkCapture {
+  uint8_t  op;            // STRIDERA_BULK_OP_CAPTURE
+  uint8_t  action;        // STRIDERA_CAPTURE_*
+  StrideraCaptureConfig config;   // CONFIG only
+};
+
+struct StrideraBulkListEntry {
+  uint32_t size;
+  char     name[STRIDERA_BULK_NAME_LEN];  // 0-padded
+};
+
+struct StrideraBulkChunkHeader {
+  uint8_t  kind;          // STRIDERA_BULK_FRAME_CHUNK
+  uint32_t offset;
+};
+
+struct StrideraBulkStatus {
+  uint8_t  kind;          // STRIDERA_BULK_FRAME_STATUS
+  uint8_t  code;          // STRIDERA_BULK_OK_* / ERR_*
+  uint32_t size;          // file size (0 for lists)
+  uint32_t offset;        // bytes delivered up to here
+  uint32_t bytes_per_s;   // achieved during this transfer
+};
+#pragma pack(pop)
+
+static_assert(sizeof(StrideraBulkGet) == 23, "Unexpected bulk GET size");
+static_assert(sizeof(StrideraBulkCapture) == 12, "Unexpected bulk capture size");
+static_assert(sizeof(StrideraBulkListEntry) == 20, "Unexpected bulk list entry size");
+static_assert(sizeof(StrideraBulkChunkHeader) == 5, "Unexpected bulk chunk header size");
+static_assert(sizeof(StrideraBulkStatus) == 14, "Unexpected bulk status size");
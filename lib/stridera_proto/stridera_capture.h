@@ -0,0 +1,69 @@
+#pragma once
+#include <stdint.h>
+
+/**
+ * Event capture dump — what GET STRIDERA_CAPTURE_NAME streams over the bulk
+ * service (stridera_bulk.h) once a trigger has frozen the pre-trigger ring.
+ *
+ *   [StrideraCaptureHeader]
+ *   [StrideraCaptureRecord x record_count]   oldest first
+ *
+ * - trigger_record records come before the one that fired, the rest after it;
+ *   the pre-trigger part is shorter when the ring was re-armed less than
+ *   pre_ms before the trigger.
+ * - Records carry their own ts_us (v2 sample time), so a rate change inside
+ *   the window is visible; rate_hz is the rate at the trigger.
+ * - Gyro values are 0 in records whose sample carried no gyro.
+ * - Little-endian, packed.
+ *
+ * StrideraCaptureConfig is the CONFIG payload of STRIDERA_BULK_OP_CAPTURE.
+ */
+
+#define STRIDERA_CAPTURE_MAGIC   "CAP1"
+#define STRIDERA_CAPTURE_VERSION 1
+#define STRIDERA_CAPTURE_NAME    "capture.cap"   // bulk LIST / GET name while a capture is frozen
+
+// What fired (StrideraCaptureHeader::cause)
+#define STRIDERA_CAPTURE_CAUSE_ACCEL_HIGH 1      // |a| >= accel_high_mg (impact)
+#define STRIDERA_CAPTURE_CAUSE_ACCEL_LOW  2      // |a| <= accel_low_mg (free fall)
+#define STRIDERA_CAPTURE_CAUSE_GYRO       3      // |w| >= gyro_dps
+#define STRIDERA_CAPTURE_CAUSE_MANUAL     4      // STRIDERA_CAPTURE_FIRE from a central
+
+#pragma pack(push, 1)
+struct StrideraCaptureConfig {
+  uint16_t accel_high_mg;  // 0 = off
+  uint16_t accel_low_mg;   // 0 = off
+  uint16_t gyro_dps;       // 0 = off (samples without gyro never fire it)
+  uint16_t pre_ms;         // kept before the trigger (clamped to the ring)
+  uint16_t post_ms;        // recorded after it, then the window freezes
+};
+
+struct StrideraCaptureHeader {
+  char     magic[4];       // STRIDERA_CAPTURE_MAGIC
+  uint16_t version;        // STRIDERA_CAPTURE_VERSION
+  uint16_t header_size;    // bytes before the first record
+  uint16_t record_size;    // sizeof(StrideraCaptureRecord)
+  uint16_t rate_hz;        // sample rate at the trigger
+  uint32_t record_count;
+  uint32_t trigger_record; // index of the record that fired
+  uint32_t trigger_ts_us;
+  uint8_t  cause;          // STRIDERA_CAPTURE_CAUSE_*
+  uint8_t  chan_mask;      // STRIDERA_CH_* of the sample that fired
+  uint16_t trigger_value;  // |a| in mg or |w| in dps that fired (0 = manual)
+  uint32_t capture;        // number of this capture since boot, from 1
+};
+
+struct StrideraCaptureRecord {
+  uint32_t ts_us;
+  int16_t  ax_mg;
+  int16_t  ay_mg;
+  int16_t  az_mg;
+  int16_t  gx;             // 0.1 dps
+  int16_t  gy;
+  int16_t  gz;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(StrideraCaptureConfig) == 10, "Unexpected capture config size");
+static_assert(sizeof(StrideraCaptureHeader) == 32, "Unexpected capture header size");
+static_assert(sizeof(StrideraCaptureRecord) == 16, "Unexpected capture record size");
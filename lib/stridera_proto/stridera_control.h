@@ -0,0 +1,113 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "stridera_packet.h"
+#include "stridera_delta.h"
+
+/**
+ * Stream control — one write reconfigures the writer's stream at runtime.
+ *
+ *   [StrideraControl] (12 bytes, little-endian; 10-byte writes without
+ *   quat_hz are still accepted)
+ *
+ * - `fields` says which values the write sets; the others keep their
+ *   current setting, so a central can change only the rate.
+ * - The sample rate is device-wide (there is one sensor); everything else is
+ *   per connection, the same settings the format characteristic carries.
+ *   The orientation rate is device-wide too (one filter, stridera_quat.h).
+ * - The reply (read back, and a notify to the writer) holds every value as
+ *   applied, with `status` telling whether something was adjusted: rates
+ *   snap to what the sensor can run, unknown formats and unsampled channels
+ *   are dropped.
+ * - Changes land between frames: the IMU task switches rate between ticks,
+ *   the fan-out closes the open frame before the first sample with new
+ *   settings. The stream is never restarted and seq keeps counting.
+ */
+
+#define STRIDERA_CONTROL_VERSION 1
+
+// StrideraControl::fields
+#define STRIDERA_CTL_RATE     0x01
+#define STRIDERA_CTL_BATCH    0x02
+#define STRIDERA_CTL_FORMAT   0x04
+#define STRIDERA_CTL_VERSION  0x08
+#define STRIDERA_CTL_FLAGS    0x10
+#define STRIDERA_CTL_CHANNELS 0x20
+#define STRIDERA_CTL_QUAT     0x40
+
+// StrideraControl::status (reply)
+#define STRIDERA_CTL_OK       0   // applied as asked
+#define STRIDERA_CTL_ADJUSTED 1   // applied, some value differs from the request
+#define STRIDERA_CTL_REJECTED 2   // malformed or unknown version: nothing changed
+
+#pragma pack(push, 1)
+struct StrideraControl {
+  uint8_t  version;         // STRIDERA_CONTROL_VERSION
+  uint8_t  fields;          // STRIDERA_CTL_*: what this write sets (reply: echoed)
+  uint16_t rate_hz;         // output sample rate, device-wide
+  uint8_t  batch_samples;   // per batch frame, 0 = as many as the MTU allows
+  uint8_t  format;          // STRIDERA_FORMAT_*
+  uint8_t  packet_version;  // single-sample characteristic: STRIDERA_PACKET_V1 / V2
+  uint8_t  flags;           // STRIDERA_V2_F_*
+  uint8_t  channels;        // STRIDERA_CH_* in v2 packets
+  uint8_t  status;          // reply: STRIDERA_CTL_OK / ADJUSTED / REJECTED
+  uint16_t quat_hz;         // orientation packets per second, device-wide, 0 = off
+};
+#pragma pack(pop)
+
+#define STRIDERA_CONTROL_MIN_SIZE 10   // up to status: writes from before quat_hz
+
+static_assert(sizeof(StrideraControl) == 12, "Unexpected control size");
+
+/**
+ * Merge a write into the current settings. `cur` holds what the stream uses
+ * now (rates included), `channels_available` what the device samples. The
+ * rates are only copied; the caller snaps them to what runs. Returns the
+ * settings to apply with status OK or ADJUSTED, or `cur` with REJECTED.
+ */
+static inline StrideraControl stridera_control_resolve(const uint8_t* data, size_t len, const StrideraControl& cur,
+                                                       uint8_t channels_available) {
+  StrideraControl out = cur;
+  out.version = STRIDERA_CONTROL_VERSION;
+  out.fields  = 0;
+  out.status  = STRIDERA_CTL_OK;
+
+  StrideraControl req;
+  if (len < STRIDERA_CONTROL_MIN_SIZE) { out.status = STRIDERA_CTL_REJECTED; return out; }
+  memset(&req, 0, sizeof(req));
+  memcpy(&req, data, len < sizeof(req) ? len : sizeof(req));
+  if (len < sizeof(req)) req.fields &= ~STRIDERA_CTL_QUAT;
+  if (req.version != STRIDERA_CONTROL_VERSION) { out.status = STRIDERA_CTL_REJECTED; return out; }
+
+  bool adjusted = false;
+  out.fields = req.fields & 0x7F;
+  if (req.fields & STRIDERA_CTL_RATE)  out.rate_hz = req.rate_hz;
+  if (req.fields & STRIDERA_CTL_BATCH) out.batch_samples = req.batch_samples;
+  if (req.fields & STRIDERA_CTL_QUAT)  out.quat_hz = req.quat_hz;
+  if (req.fields & STRIDERA_CTL_FORMAT) {
+    if (req.format == STRIDERA_FORMAT_BATCH || req.format == STRIDERA_FORMAT_DELTA || req.format == STRIDERA_FORMAT_V2) {
+      out.format = req.format;
+    } else {
+      adjusted = true;
+    }
+  }
+  if (req.fields & STRIDERA_CTL_VERSION) {
+    if (req.packet_version == STRIDERA_PACKET_V1 || req.packet_version == STRIDERA_PACKET_V2) {
+      out.packet_version = req.packet_version;
+    } else {
+      adjusted = true;
+    }
+  }
+  if (req.fields & STRIDERA_CTL_FLAGS) {
+    out.flags = req.flags & STRIDERA_V2_F_CRC;
+    adjusted |= out.flags != req.flags;
+  }
+  if (req.fields & STRIDERA_CTL_CHANNELS) {
+    out.channels = req.channels & channels_available;
+    if (!out.channels) out.channels = STRIDERA_CH_ACCEL;
+    adjusted |= out.channels != req.channels;
+  }
+  if (adjusted) out.status = STRIDERA_CTL_ADJUSTED;
+  return out;
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <stdint.h>
+
+/**
+ * Gait feature packet — notified on STRIDERA_GAIT_CHAR_UUID once per detected
+ * step (<= ~4 Hz) and once when walking stops. Replaces streaming raw mg when
+ * the central only needs steps, cadence and stride timing.
+ * Little-endian, packed.
+ */
+
+#define STRIDERA_FRAME_GAIT 0xA1
+
+#define STRIDERA_GAIT_F_STEP    0x01   // this packet reports a new step at ts_ms
+#define STRIDERA_GAIT_F_WALKING 0x02   // steps are arriving at a plausible cadence
+
+#pragma pack(push, 1)
+struct StrideraGaitPacket {
+  uint8_t  kind;             // STRIDERA_FRAME_GAIT
+  uint8_t  flags;            // STRIDERA_GAIT_F_*
+  uint16_t step_count;       // since sampling started (wraps)
+  uint32_t ts_ms;            // time of the step peak (same clock as StrideraAccelPacket)
+  uint16_t step_ms;          // interval to the previous step (0 = first step)
+  uint16_t stride_ms;        // last two step intervals = one gait cycle (0 = unknown)
+  uint16_t cadence_spm_x10;  // steps/min x10, mean of the last 4 intervals
+  uint16_t peak_mg;          // band-passed |a| peak-to-valley of this step
+};
+#pragma pack(pop)
+
+static_assert(sizeof(StrideraGaitPacket) == 16, "Unexpected gait packet size");
@@ -0,0 +1,52 @@
+#pragma once
+#include <stdint.h>
+
+/**
+ * Link diagnostics — value of STRIDERA_LINK_DIAG_CHAR_UUID (read / notify 1 Hz).
+ * Reports what was actually negotiated for the current connection plus the
+ * measured notification rate, so a central can see why throughput is what it is.
+ * Per connection: a read returns the reader's own link, a notification goes to
+ * each subscribed central with its own values.
+ * Version 2 adds the stream's congestion level and what it cost: samples
+ * dropped from a full queue and samples left out by decimation.
+ * Little-endian, packed.
+ */
+
+#define STRIDERA_LINK_DIAG_VERSION 2
+
+// Link profiles (what the device is doing, drives the requested parameters)
+#define STRIDERA_LINK_PROFILE_IDLE      0
+#define STRIDERA_LINK_PROFILE_STREAMING 1
+#define STRIDERA_LINK_PROFILE_BULK      2
+
+// flags
+#define STRIDERA_LINK_F_PHY_PENDING     0x01   // PHY update requested, not confirmed yet
+#define STRIDERA_LINK_F_PARAMS_PENDING  0x02   // connection parameter update in flight
+#define STRIDERA_LINK_F_PARAMS_REJECTED 0x04   // central kept refusing; gave up for this profile
+#define STRIDERA_LINK_F_NO_2M           0x08   // controller has no LE 2M PHY (ESP32 classic)
+#define STRIDERA_LINK_F_DLE             0x10   // data length extension requested
+#define STRIDERA_LINK_F_CONGESTED       0x20   // congestion control is above level 0 (STRIDERA_CONG_*)
+
+#pragma pack(push, 1)
+struct StrideraLinkDiag {
+  uint8_t  version;        // STRIDERA_LINK_DIAG_VERSION
+  uint8_t  profile;        // STRIDERA_LINK_PROFILE_*
+  uint16_t mtu;            // ATT MTU
+  uint8_t  phy_tx;         // 1 = 1M, 2 = 2M, 3 = coded
+  uint8_t  phy_rx;
+  uint16_t data_len;       // LL TX octets (27 = no DLE)
+  uint16_t interval;       // 1.25 ms units
+  uint16_t latency;        // connection events
+  uint16_t timeout;        // 10 ms units
+  uint8_t  flags;          // STRIDERA_LINK_F_*
+  uint8_t  congestion;     // STRIDERA_CONG_* level of this central's stream (v1: reserved, 0)
+  uint16_t notify_per_s;   // over the last second
+  uint32_t notify_ok;      // since connect
+  uint32_t notify_failed;  // notify() refused (controller out of buffers)
+  // v2
+  uint32_t dropped_samples;    // since connect: lost when the send queue overflowed
+  uint32_t decimated_samples;  // since connect: left out by congestion control
+};
+#pragma pack(pop)
+
+static_assert(sizeof(StrideraLinkDiag) == 34, "Unexpected link diag size");
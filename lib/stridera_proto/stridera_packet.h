@@ -1,5 +1,7 @@
 #pragma once
 #include <stdint.h>
+#include <stddef.h>
+#include <string.h>
 
 #pragma pack(push, 1)
 struct StrideraAccelPacket {
@@ -13,3 +15,286 @@ struct StrideraAccelPacket {
 #pragma pack(pop)
 
 static_assert(sizeof(StrideraAccelPacket) == 12, "Unexpected packet size");
+
+/**
+ * Packet v2 — one self-describing sample, negotiated per connection (v1 stays the default).
+ *
+ * - seq counts samples produced since streaming started (wraps at 65536), so a
+ *   receiver tells lost samples (seq gap) from timing gaps (ts gap, no seq gap).
+ *   Samples lost on the device (ring overrun, a slow central's queue) show up
+ *   as gaps too.
+ * - ts_us is the sample time in µs since boot, low 32 bits (wraps every ~71 min).
+ * - chan_mask says which channels the sample carries (STRIDERA_CH_*).
+ * - With STRIDERA_V2_F_CRC, crc is CRC-16/CCITT-FALSE over every byte before
+ *   it; without it crc is 0 and not checked.
+ * - On the single-sample characteristic one packet per notification; with
+ *   STRIDERA_FORMAT_V2 the batch characteristic carries back-to-back packets.
+ *
+ * Two layouts, told apart by the first byte:
+ * - 0xA2 (StrideraAccelPacketV2): accel only, fixed 20 bytes.
+ * - 0xA3 (StrideraImuHeaderV2): any channel set — 12-byte header, one int16
+ *   per value in STRIDERA_CH_* bit order (ax ay az gx gy gz mx my mz temp,
+ *   only those in chan_mask), then crc. A central that asks for gyro only
+ *   pays 20 bytes per sample, all nine axes 32.
+ */
+
+#define STRIDERA_PACKET_V1 1
+#define STRIDERA_PACKET_V2 2
+
+#define STRIDERA_FRAME_ACCEL_V2 0xA2   // first byte of an accel-only v2 packet
+#define STRIDERA_FRAME_IMU_V2   0xA3   // first byte of a v2 packet with any channel set
+
+#define STRIDERA_V2_F_CRC 0x01         // crc field is valid
+
+#define STRIDERA_CH_AX    0x01
+#define STRIDERA_CH_AY    0x02
+#define STRIDERA_CH_AZ    0x04
+#define STRIDERA_CH_ACCEL (STRIDERA_CH_AX | STRIDERA_CH_AY | STRIDERA_CH_AZ)
+#define STRIDERA_CH_GX    0x08         // 0.1 dps
+#define STRIDERA_CH_GY    0x10
+#define STRIDERA_CH_GZ    0x20
+#define STRIDERA_CH_GYRO  (STRIDERA_CH_GX | STRIDERA_CH_GY | STRIDERA_CH_GZ)
+#define STRIDERA_CH_MAG   0x40         // mx, my, mz in 0.1 uT (one bit, three values)
+#define STRIDERA_CH_TEMP  0x80         // sensor die, 0.01 degC
+
+#define STRIDERA_CH_MAX_VALUES 10
+
+#pragma pack(push, 1)
+struct StrideraAccelPacketV2 {
+  uint8_t  kind;       // STRIDERA_FRAME_ACCEL_V2
+  uint8_t  flags;      // STRIDERA_V2_F_*
+  uint16_t seq;        // sample sequence number
+  uint32_t ts_us;      // µs since boot (low 32 bits)
+  int16_t  ax_mg;
+  int16_t  ay_mg;
+  int16_t  az_mg;
+  uint8_t  chan_mask;  // STRIDERA_CH_*
+  uint8_t  reserved;
+  uint16_t rate_hz;    // nominal sample rate (no 255 Hz cap)
+  uint16_t crc;        // see STRIDERA_V2_F_CRC
+};
+#pragma pack(pop)
+
+static_assert(sizeof(StrideraAccelPacketV2) == 20, "Unexpected v2 packet size");
+
+#pragma pack(push, 1)
+struct StrideraImuHeaderV2 {
+  uint8_t  kind;       // STRIDERA_FRAME_IMU_V2
+  uint8_t  flags;      // STRIDERA_V2_F_*
+  uint16_t seq;
+  uint32_t ts_us;
+  uint8_t  chan_mask;  // which values follow
+  uint8_t  reserved;
+  uint16_t rate_hz;
+  // int16_t values[stridera_channel_values(chan_mask)]; uint16_t crc;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(StrideraImuHeaderV2) == 12, "Unexpected v2 header size");
+
+/**
+ * StrideraSample — what the device pipeline carries (IMU ring -> BLE / SD).
+ * Not a wire format: v1 consumers (encoders, recorder, gait) use .v1, v2
+ * packets are built from it per connection. Accel is always present; the
+ * other fields are valid only if their bit is in chan_mask.
+ */
+struct StrideraSample {
+  StrideraAccelPacket v1;
+  uint32_t ts_us;
+  uint16_t seq;
+  uint16_t rate_hz;
+  uint8_t  chan_mask;
+  int16_t  gyro[3];    // 0.1 dps
+  int16_t  mag[3];     // 0.1 uT
+  int16_t  temp;       // 0.01 degC
+};
+
+// int16 values a channel mask stands for (STRIDERA_CH_MAG is three)
+static inline size_t stridera_channel_values(uint8_t mask) {
+  size_t n = 0;
+  for (uint8_t b = 0; b < 6; ++b) n += (mask >> b) & 1;
+  return n + ((mask & STRIDERA_CH_MAG) ? 3 : 0) + ((mask & STRIDERA_CH_TEMP) ? 1 : 0);
+}
+
+// Bytes of one v2 packet carrying `mask` (the accel-only layout for STRIDERA_CH_ACCEL)
+static inline size_t stridera_packet_v2_size(uint8_t mask) {
+  return mask == STRIDERA_CH_ACCEL ? sizeof(StrideraAccelPacketV2)
+                                   : sizeof(StrideraImuHeaderV2) + 2 * stridera_channel_values(mask) + 2;
+}
+
+// Bytes stridera_packet_v2_encode() may write for `mask`: a sample carrying none of
+// the mask's channels falls back to the accel layout, which can be the longer one
+static inline size_t stridera_packet_v2_max_size(uint8_t mask) {
+  const size_t n = stridera_packet_v2_size(mask);
+  return n > sizeof(StrideraAccelPacketV2) ? n : sizeof(StrideraAccelPacketV2);
+}
+
+// CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF), nibble table
+static inline uint16_t stridera_crc16(const uint8_t* p, size_t n, uint16_t crc = 0xFFFF) {
+  static const uint16_t t[16] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF };
+  while (n--) {
+    crc = (uint16_t)((crc << 4) ^ t[(crc >> 12) ^ (*p >> 4)]);
+    crc = (uint16_t)((crc << 4) ^ t[(crc >> 12) ^ (*p++ & 0x0F)]);
+  }
+  return crc;
+}
+
+static inline StrideraAccelPacketV2 stridera_packet_v2(const StrideraSample& s, bool with_crc) {
+  StrideraAccelPacketV2 p;
+  p.kind      = STRIDERA_FRAME_ACCEL_V2;
+  p.flags     = with_crc ? STRIDERA_V2_F_CRC : 0;
+  p.seq       = s.seq;
+  p.ts_us     = s.ts_us;
+  p.ax_mg     = s.v1.ax_mg;
+  p.ay_mg     = s.v1.ay_mg;
+  p.az_mg     = s.v1.az_mg;
+  p.chan_mask = s.chan_mask & STRIDERA_CH_ACCEL;   // what this layout carries
+  p.reserved  = 0;
+  p.rate_hz   = s.rate_hz;
+  p.crc       = with_crc ? stridera_crc16(reinterpret_cast<const uint8_t*>(&p), offsetof(StrideraAccelPacketV2, crc)) : 0;
+  return p;
+}
+
+// The selected values of a sample in wire order; returns how many
+static inline size_t stridera_channel_pack(const StrideraSample& s, uint8_t mask, int16_t* out) {
+  const int16_t six[6] = { s.v1.ax_mg, s.v1.ay_mg, s.v1.az_mg, s.gyro[0], s.gyro[1], s.gyro[2] };
+  size_t n = 0;
+  for (uint8_t b = 0; b < 6; ++b) if (mask & (1u << b)) out[n++] = six[b];
+  if (mask & STRIDERA_CH_MAG)  { out[n++] = s.mag[0]; out[n++] = s.mag[1]; out[n++] = s.mag[2]; }
+  if (mask & STRIDERA_CH_TEMP) out[n++] = s.temp;
+  return n;
+}
+
+/**
+ * One v2 packet with the channels in `mask` the sample actually has; accel
+ * only (or nothing else left) gives the fixed 0xA2 layout. `out` needs
+ * stridera_packet_v2_max_size(mask) bytes. Returns the bytes written.
+ */
+static inline size_t stridera_packet_v2_encode(const StrideraSample& s, uint8_t mask, bool with_crc, uint8_t* out) {
+  mask &= s.chan_mask | STRIDERA_CH_ACCEL;
+  if (mask == 0 || mask == STRIDERA_CH_ACCEL) {
+    const StrideraAccelPacketV2 p = stridera_packet_v2(s, with_crc);
+    memcpy(out, &p, sizeof(p));
+    return sizeof(p);
+  }
+  StrideraImuHeaderV2 h;
+  h.kind      = STRIDERA_FRAME_IMU_V2;
+  h.flags     = with_crc ? STRIDERA_V2_F_CRC : 0;
+  h.seq       = s.seq;
+  h.ts_us     = s.ts_us;
+  h.chan_mask = mask;
+  h.reserved  = 0;
+  h.rate_hz   = s.rate_hz;
+  memcpy(out, &h, sizeof(h));
+  int16_t v[STRIDERA_CH_MAX_VALUES];
+  const size_t n   = stridera_channel_pack(s, mask, v);
+  memcpy(out + sizeof(h), v, 2 * n);
+  const size_t len = sizeof(h) + 2 * n;
+  const uint16_t crc = with_crc ? stridera_crc16(out, len) : 0;
+  memcpy(out + len, &crc, 2);
+  return len + 2;
+}
+
+// Kind ok and, if flagged, CRC matches
+static inline bool stridera_packet_v2_valid(const StrideraAccelPacketV2& p) {
+  if (p.kind != STRIDERA_FRAME_ACCEL_V2) return false;
+  if (!(p.flags & STRIDERA_V2_F_CRC)) return true;
+  return p.crc == stridera_crc16(reinterpret_cast<const uint8_t*>(&p), offsetof(StrideraAccelPacketV2, crc));
+}
+
+// Back-to-back v2 packets (one notification) -> out[]; invalid packets are skipped and counted
+static inline size_t stridera_v2_decode(const uint8_t* buf, size_t len, StrideraAccelPacketV2* out, size_t max,
+                                        uint32_t* invalid = nullptr) {
+  size_t n = 0;
+  for (size_t off = 0; off + sizeof(StrideraAccelPacketV2) <= len && n < max; off += sizeof(StrideraAccelPacketV2)) {
+    memcpy(&out[n], buf + off, sizeof(StrideraAccelPacketV2));
+    if (stridera_packet_v2_valid(out[n])) ++n;
+    else if (invalid) ++*invalid;
+  }
+  return n;
+}
+
+/**
+ * One stream's 32-bit µs timestamps extended to 64 bits across the ~71.6 min
+ * wrap. Each step is taken the shorter way round, so a late packet from just
+ * before a wrap lands before it. Counts from the first timestamp seen.
+ */
+class StrideraUsClock {
+public:
+  uint64_t extend(uint32_t ts_us) {
+    if (!seen_) { seen_ = true; ext_ = ts_us; return ext_; }
+    const int32_t  step = (int32_t)(ts_us - (uint32_t)ext_);
+    const uint64_t v    = step < 0 && (uint64_t)-(int64_t)step > ext_ ? 0 : ext_ + (int64_t)step;
+    if (step > 0) ext_ = v;
+    return v;
+  }
+  void reset() { seen_ = false; ext_ = 0; }
+
+private:
+  bool     seen_ = false;
+  uint64_t ext_  = 0;       // newest timestamp, extended
+};
+
+/**
+ * Back-to-back v2 packets of either layout -> samples (v1 gets accel, ms time
+ * and the capped rate; channels not carried are zero). A packet with a bad
+ * CRC is skipped and counted; an unknown kind byte or a truncated packet ends
+ * the walk and counts once, since nothing after it can be framed.
+ * v1.ts_ms comes from ts_us, which wraps every ~71.6 min; pass the stream's
+ * `clock` to keep it counting across the wrap.
+ */
+static inline size_t stridera_v2_decode_samples(const uint8_t* buf, size_t len, StrideraSample* out, size_t max,
+                                                uint32_t* invalid = nullptr, StrideraUsClock* clock = nullptr) {
+  size_t n = 0, off = 0;
+  while (off < len && n < max) {
+    const uint8_t kind = buf[off];
+    StrideraSample& s  = out[n];
+    memset(&s, 0, sizeof(s));
+    size_t size;
+    bool ok;
+    if (kind == STRIDERA_FRAME_ACCEL_V2 && off + sizeof(StrideraAccelPacketV2) <= len) {
+      StrideraAccelPacketV2 p;
+      memcpy(&p, buf + off, sizeof(p));
+      size        = sizeof(p);
+      ok          = stridera_packet_v2_valid(p);
+      s.seq       = p.seq;
+      s.ts_us     = p.ts_us;
+      s.rate_hz   = p.rate_hz;
+      s.chan_mask = p.chan_mask;
+      s.v1.ax_mg  = p.ax_mg;
+      s.v1.ay_mg  = p.ay_mg;
+      s.v1.az_mg  = p.az_mg;
+    } else if (kind == STRIDERA_FRAME_IMU_V2 && off + sizeof(StrideraImuHeaderV2) <= len) {
+      StrideraImuHeaderV2 h;
+      memcpy(&h, buf + off, sizeof(h));
+      const size_t nv = stridera_channel_values(h.chan_mask);
+      size = sizeof(h) + 2 * nv + 2;
+      if (off + size > len) { if (invalid) ++*invalid; break; }
+      uint16_t crc;
+      memcpy(&crc, buf + off + size - 2, 2);
+      ok = !(h.flags & STRIDERA_V2_F_CRC) || crc == stridera_crc16(buf + off, size - 2);
+      int16_t v[STRIDERA_CH_MAX_VALUES];
+      memcpy(v, buf + off + sizeof(h), 2 * nv);
+      size_t k = 0;
+      int16_t* six[6] = { &s.v1.ax_mg, &s.v1.ay_mg, &s.v1.az_mg, &s.gyro[0], &s.gyro[1], &s.gyro[2] };
+      for (uint8_t b = 0; b < 6; ++b) if (h.chan_mask & (1u << b)) *six[b] = v[k++];
+      if (h.chan_mask & STRIDERA_CH_MAG)  { s.mag[0] = v[k++]; s.mag[1] = v[k++]; s.mag[2] = v[k++]; }
+      if (h.chan_mask & STRIDERA_CH_TEMP) s.temp = v[k++];
+      s.seq       = h.seq;
+      s.ts_us     = h.ts_us;
+      s.rate_hz   = h.rate_hz;
+      s.chan_mask = h.chan_mask;
+    } else {
+      if (invalid) ++*invalid;
+      break;
+    }
+    off += size;
+    if (!ok) { if (invalid) ++*invalid; continue; }
+    s.v1.ts_ms   = (uint32_t)((clock ? clock->extend(s.ts_us) : s.ts_us) / 1000);
+    s.v1.rate_hz = (uint8_t)(s.rate_hz > 255 ? 255 : s.rate_hz);
+    ++n;
+  }
+  return n;
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <stdint.h>
+
+/**
+ * Hot-path timing snapshot — value of STRIDERA_PERF_CHAR_UUID (read / notify).
+ * One entry per instrumented stage; times in ns, converted from CPU cycles
+ * on the device. p99 is the upper edge of its histogram bucket (<= 12.5% high).
+ * Little-endian, packed.
+ */
+
+#define STRIDERA_FRAME_PERF 0xC1
+
+// Stage ids (StrideraPerfEntry::stage)
+#define STRIDERA_PERF_STAGE_IMU_READ   0   // accelerometer read_batch (I2C / FIFO burst)
+#define STRIDERA_PERF_STAGE_IMU_DSP    1   // decimation, gait detector, ring push
+#define STRIDERA_PERF_STAGE_IMU_TICK   2   // IMU task wake-to-wake period
+#define STRIDERA_PERF_STAGE_BLE_NOTIFY 3   // one stream notify() call
+#define STRIDERA_PERF_STAGE_UI_DRAW    4   // HUD / state banner redraw
+#define STRIDERA_PERF_STAGE_LOOP       5   // System::loop() period
+#define STRIDERA_PERF_STAGE_AHRS       6   // one orientation filter update (part of IMU_DSP)
+
+#pragma pack(push, 1)
+struct StrideraPerfHeader {
+  uint8_t  kind;          // STRIDERA_FRAME_PERF
+  uint8_t  count;         // entries that follow
+  uint16_t tick_mhz;      // probe clock now (CPU MHz for cycle counts); entries use their own
+};
+
+struct StrideraPerfEntry {
+  uint8_t  stage;         // STRIDERA_PERF_STAGE_*
+  uint8_t  reserved[3];
+  uint32_t count;         // samples since the last reset
+  uint32_t min_ns;
+  uint32_t avg_ns;
+  uint32_t max_ns;
+  uint32_t p99_ns;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(StrideraPerfHeader) == 4, "Unexpected perf header size");
+static_assert(sizeof(StrideraPerfEntry) == 24, "Unexpected perf entry size");
@@ -0,0 +1,32 @@
+#pragma once
+#include <stdint.h>
+
+/**
+ * Orientation packet — notified on STRIDERA_QUAT_CHAR_UUID at the
+ * configured quaternion rate (StrideraControl::quat_hz). Replaces streaming
+ * raw accel + gyro when the central only needs orientation.
+ *
+ * - w, x, y, z: unit quaternion (sensor frame -> earth frame, z up) in Q14,
+ *   w >= 0. Yaw is relative to the start: there is no magnetometer term.
+ * - seq / ts_us: the sample it was computed at (same clock as packet v2).
+ * Little-endian, packed.
+ */
+
+#define STRIDERA_FRAME_QUAT 0xA4
+
+#define STRIDERA_QUAT_F_SETTLED 0x01   // past the start-up convergence window
+
+#pragma pack(push, 1)
+struct StrideraQuatPacket {
+  uint8_t  kind;    // STRIDERA_FRAME_QUAT
+  uint8_t  flags;   // STRIDERA_QUAT_F_*
+  uint16_t seq;
+  uint32_t ts_us;
+  int16_t  w;       // Q14
+  int16_t  x;
+  int16_t  y;
+  int16_t  z;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(StrideraQuatPacket) == 16, "Unexpected quaternion packet size");
@@ -0,0 +1,67 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+/**
+ * IBlockFile — the few file operations the session recorder needs.
+ * PosixBlockFile implements them with plain POSIX calls, which work both on
+ * the ESP32 VFS (SD mounted at "/sd" by SD.begin) and on Linux, where a temp
+ * directory stands in for the card.
+ */
+class IBlockFile {
+public:
+  virtual ~IBlockFile() = default;
+  virtual bool create(const char* path) = 0;
+  // Reserve `bytes` so the FAT cluster chain is allocated before recording starts
+  virtual bool preallocate(uint32_t bytes) = 0;
+  virtual bool writeAt(uint32_t offset, const uint8_t* buf, size_t len) = 0;
+  virtual bool truncate(uint32_t bytes) = 0;
+  virtual void close() = 0;
+};
+
+class PosixBlockFile : public IBlockFile {
+public:
+  ~PosixBlockFile() override { close(); }
+
+  bool create(const char* path) override {
+    close();
+    fd_ = ::open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    return fd_ >= 0;
+  }
+
+  bool preallocate(uint32_t bytes) override {
+    // Seeking past EOF and writing one byte makes FatFs link the whole chain
+    // up front; no data is written for the gap.
+    if (fd_ < 0 || bytes == 0) return fd_ >= 0;
+    const uint8_t zero = 0;
+    return ::lseek(fd_, (off_t)bytes - 1, SEEK_SET) >= 0 && ::write(fd_, &zero, 1) == 1;
+  }
+
+  bool writeAt(uint32_t offset, const uint8_t* buf, size_t len) override {
+    if (fd_ < 0 || ::lseek(fd_, (off_t)offset, SEEK_SET) < 0) return false;
+    while (len) {
+      const ssize_t n = ::write(fd_, buf, len);
+      if (n <= 0) return false;
+      buf += n;
+      len -= (size_t)n;
+    }
+    return true;
+  }
+
+  bool truncate(uint32_t bytes) override {
+    return fd_ >= 0 && ::ftruncate(fd_, (off_t)bytes) == 0;
+  }
+
+  void close() override {
+    if (fd_ >= 0) {
+      ::fsync(fd_);
+      ::close(fd_);
+      fd_ = -1;
+    }
+  }
+
+private:
+  int fd_ = -1;
+};
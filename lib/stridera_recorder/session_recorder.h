@@ -0,0 +1,249 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <atomic>
+#include "stridera_packet.h"
+#include "stridera_session.h"
+#include "block_file.h"
+
+struct RecorderStats {
+  uint32_t records;         // records accepted into the file
+  uint32_t dropped;         // records lost because both buffers were still being written
+  uint32_t bytes_written;   // data bytes handed to the file (excluding header/index)
+  uint32_t write_us_total;  // time spent inside writeAt()
+  uint32_t write_us_max;    // worst single buffer write (FAT latency spike)
+  uint32_t kbps() const {
+    return write_us_total ? (uint32_t)((uint64_t)bytes_written * 1000000ULL / write_us_total / 1024) : 0;
+  }
+};
+
+/**
+ * SessionRecorder — double-buffered .ssn writer (see stridera_session.h).
+ *
+ * Producer side (loop task): begin(), append(), requestStop().
+ * Writer side (background task): service(), called whenever woken.
+ *
+ * - Two BufBytes buffers: the producer fills one while the writer flushes the
+ *   other, so a slow FAT write only costs buffer headroom, never a stall.
+ *   If both are busy the record is dropped and counted.
+ * - Buffers land at 512 + k * BufBytes: every write is sector-aligned and a
+ *   whole number of sectors (the header block is 512 bytes).
+ * - The writer creates + preallocates the file on its first service() and
+ *   writes index + final header when a stop was requested.
+ */
+template <size_t BufBytes = 4096, size_t IndexCap = 2048>
+class SessionRecorder {
+  static_assert(BufBytes % 512 == 0, "Recorder buffers must be whole sectors");
+
+public:
+  using ClockFn = uint32_t (*)();             // microseconds, wraps
+  using WakeFn  = void (*)(void*);
+
+  void setClock(ClockFn fn)           { clock_ = fn; }
+  void setWake(WakeFn fn, void* arg)  { wake_ = fn; wakeArg_ = arg; }
+
+  // ---- producer side ----
+  bool begin(IBlockFile* file, const char* path, uint16_t rate_hz,
+             uint32_t prealloc_bytes, uint32_t index_stride = 512) {
+    if (phase_.load() == kOpening || phase_.load() == kOpen || phase_.load() == kStopping) return false;
+    file_     = file;
+    prealloc_ = prealloc_bytes;
+    strncpy(path_, path, sizeof(path_) - 1);
+    path_[sizeof(path_) - 1] = 0;
+
+    stridera_session_header_init(hdr_, rate_hz, kHeaderBlock, index_stride);
+    idxCount_ = 0;
+    memset(&stats_, 0, sizeof(stats_));
+    for (auto& b : bufs_) { b.len = 0; b.offset = 0; b.state.store(kFree); }
+    nextOffset_ = kHeaderBlock;
+    active_     = 0;
+    opened_     = false;
+    claim(0);
+
+    phase_.store(kOpening, std::memory_order_release);
+    kick();
+    return true;
+  }
+
+  bool append(const StrideraAccelPacket& p) {
+    const uint8_t ph = phase_.load(std::memory_order_acquire);
+    if (ph != kOpening && ph != kOpen) return false;
+
+    Buf* b = &bufs_[active_];
+    if (b->state.load(std::memory_order_acquire) != kFilling) {
+      if (!claim(active_ ^ 1)) { ++stats_.dropped; return false; }
+      b = &bufs_[active_];
+    }
+    // A record that straddles buffers needs the other one to be free now
+    const size_t room = BufBytes - b->len;
+    if (room < sizeof(StrideraSessionRecord) && bufs_[active_ ^ 1].state.load(std::memory_order_acquire) != kFree) {
+      ++stats_.dropped;
+      return false;
+    }
+
+    const uint32_t n = hdr_.record_count;
+    if (n % hdr_.index_stride == 0 && idxCount_ < IndexCap) {
+      idx_[idxCount_++] = StrideraSessionIndexEntry{p.ts_ms, n};
+    }
+    if (n == 0) hdr_.first_ts_ms = p.ts_ms;
+    hdr_.last_ts_ms = p.ts_ms;
+    ++hdr_.record_count;
+    ++stats_.records;
+
+    const StrideraSessionRecord r = stridera_session_record(p);
+    const uint8_t* src = reinterpret_cast<const uint8_t*>(&r);
+    size_t left = sizeof(r);
+    while (left) {
+      const size_t take = (BufBytes - b->len) < left ? (BufBytes - b->len) : left;
+      memcpy(b->data + b->len, src, take);
+      b->len += take;
+      src    += take;
+      left   -= take;
+      if (b->len == BufBytes) {
+        submit(*b);
+        // Succeeds whenever `left` > 0 (checked above); otherwise the next append retries
+        claim(active_ ^ 1);
+        b = &bufs_[active_];
+      }
+    }
+    return true;
+  }
+
+  // No more append() after this; the writer flushes the tail and closes the file.
+  void requestStop() {
+    uint8_t expect = kOpen;
+    if (!phase_.compare_exchange_strong(expect, kStopping)) {
+      expect = kOpening;
+      phase_.compare_exchange_strong(expect, kStopping);
+    }
+    kick();
+  }
+
+  // ---- writer side ----
+  // Returns true if anything was written.
+  bool service() {
+    uint8_t ph = phase_.load(std::memory_order_acquire);
+    if (ph == kOpening || (ph == kStopping && !opened_)) {   // a stop may beat the first wakeup
+      if (!file_ || !file_->create(path_) || !file_->preallocate(prealloc_)) {
+        phase_.store(kFailed);
+        return false;
+      }
+      opened_ = true;
+      uint8_t expect = kOpening;
+      phase_.compare_exchange_strong(expect, kOpen);
+      ph = phase_.load(std::memory_order_acquire);
+    }
+    if (ph != kOpen && ph != kStopping) return false;
+
+    bool did = false;
+    for (;;) {                                   // oldest READY buffer first
+      Buf* next = nullptr;
+      for (auto& b : bufs_) {
+        if (b.state.load(std::memory_order_acquire) == kReady && (!next || b.offset < next->offset)) next = &b;
+      }
+      if (!next) break;
+      if (!timedWrite(next->offset, next->data, BufBytes)) { phase_.store(kFailed); return did; }
+      next->state.store(kFree, std::memory_order_release);
+      did = true;
+    }
+
+    if (ph == kStopping) {
+      finalize();
+      did = true;
+    }
+    return did;
+  }
+
+  // ---- status (any side) ----
+  bool active()  const { const uint8_t p = phase_.load(); return p == kOpening || p == kOpen || p == kStopping; }
+  bool closed()  const { return phase_.load() == kClosed; }
+  bool failed()  const { return phase_.load() == kFailed; }
+  const char* path() const { return path_; }
+  const RecorderStats& stats() const { return stats_; }
+
+private:
+  enum : uint8_t { kFree, kFilling, kReady };
+  enum : uint8_t { kIdle, kOpening, kOpen, kStopping, kClosed, kFailed };
+  static constexpr uint16_t kHeaderBlock = 512;
+
+  struct Buf {
+    alignas(4) uint8_t data[BufBytes];
+    uint32_t offset = 0;
+    size_t   len    = 0;
+    std::atomic<uint8_t> state{kFree};
+  };
+
+  bool claim(uint8_t i) {
+    Buf& b = bufs_[i];
+    if (b.state.load(std::memory_order_acquire) != kFree) return false;
+    b.len    = 0;
+    b.offset = nextOffset_;
+    nextOffset_ += BufBytes;
+    b.state.store(kFilling, std::memory_order_relaxed);
+    active_ = i;
+    return true;
+  }
+
+  void submit(Buf& b) {
+    b.state.store(kReady, std::memory_order_release);
+    kick();
+  }
+
+  void kick() { if (wake_) wake_(wakeArg_); }
+
+  bool timedWrite(uint32_t offset, const uint8_t* data, size_t len) {
+    const uint32_t t0 = clock_ ? clock_() : 0;
+    const bool ok = file_->writeAt(offset, data, len);
+    if (clock_) {
+      const uint32_t dt = clock_() - t0;
+      stats_.write_us_total += dt;
+      if (dt > stats_.write_us_max) stats_.write_us_max = dt;
+    }
+    stats_.bytes_written += (uint32_t)len;
+    return ok;
+  }
+
+  void finalize() {
+    // Producer is done: the partially filled buffer is ours now
+    for (auto& b : bufs_) {
+      if (b.state.load(std::memory_order_acquire) == kFilling && b.len) {
+        timedWrite(b.offset, b.data, b.len);
+      }
+      b.state.store(kFree);
+    }
+
+    const uint32_t dataEnd = kHeaderBlock + hdr_.record_count * (uint32_t)sizeof(StrideraSessionRecord);
+    hdr_.index_offset = idxCount_ ? dataEnd : 0;
+    hdr_.index_count  = (uint32_t)idxCount_;
+    bool ok = !idxCount_ || file_->writeAt(dataEnd, reinterpret_cast<const uint8_t*>(idx_),
+                                           idxCount_ * sizeof(StrideraSessionIndexEntry));
+
+    uint8_t* block = bufs_[0].data;              // reuse a buffer for the 512-byte header block
+    memset(block, 0, kHeaderBlock);
+    memcpy(block, &hdr_, sizeof(hdr_));
+    ok = file_->writeAt(0, block, kHeaderBlock) && ok;
+    ok = file_->truncate(hdr_.index_offset ? dataEnd + hdr_.index_count * (uint32_t)sizeof(StrideraSessionIndexEntry)
+                                           : dataEnd) && ok;
+    file_->close();
+    phase_.store(ok ? kClosed : kFailed, std::memory_order_release);
+  }
+
+  IBlockFile* file_     = nullptr;
+  uint32_t    prealloc_ = 0;
+  char        path_[48] = {0};
+  ClockFn     clock_    = nullptr;
+  WakeFn      wake_     = nullptr;
+  void*       wakeArg_  = nullptr;
+
+  std::atomic<uint8_t> phase_{kIdle};
+  bool     opened_     = false;        // writer created the file for this session
+  Buf      bufs_[2];
+  uint8_t  active_     = 0;            // producer's buffer
+  uint32_t nextOffset_ = kHeaderBlock; // file offset for the next claimed buffer
+
+  StrideraSessionHeader     hdr_{};
+  StrideraSessionIndexEntry idx_[IndexCap];
+  size_t                    idxCount_ = 0;
+  RecorderStats             stats_{};
+};
@@ -0,0 +1,298 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <atomic>
+
+struct ReadAheadStats {
+  uint32_t depth;           // blocks buffered ahead of the parser right now
+  uint32_t depth_min;       // lowest depth the parser saw when taking a block (after the first fill)
+  uint32_t stalls;          // reads that found the ring empty and had to wait for storage
+  uint32_t stall_us_total;
+  uint32_t stall_us_max;
+  uint32_t seeks;           // seeks that missed the resident head and restarted the fill
+  uint32_t bytes_read;      // bytes the fill side read from the file
+  uint32_t read_us_total;   // time spent inside File::read()
+  uint32_t read_us_max;     // worst single block read (SD / flash latency spike)
+  uint32_t kbps() const {
+    return read_us_total ? (uint32_t)((uint64_t)bytes_read * 1000000ULL / read_us_total / 1024) : 0;
+  }
+};
+
+/**
+ * ReadAhead — block prefetcher between a File and the replay readers.
+ *
+ * Parser side (IMU task): begin(), then read() / seek() — the cursor API of
+ * StrideraCsvLineReader and StrideraSessionReader, so it drops in for the File.
+ * Fill side (background task): service(), called whenever woken.
+ *
+ * - A ring of Blocks x BlockBytes is kept full ahead of the parser; a slow
+ *   read only costs ring depth, so parsing never waits on storage as long as
+ *   the average read rate keeps up with the replay.
+ * - The first block of the file stays resident: seek() into it (rewind, the
+ *   CSV header, the session header + first records) is served at once while
+ *   the fill side restarts behind it, so looping does not stall either.
+ * - Any other seek restarts the fill there (a new generation; blocks of the
+ *   old one are skipped) and the next read waits for it.
+ * - An empty ring makes read() wait (WaitFn, e.g. a 1-tick delay) until the
+ *   block or end of file arrives; every such wait is counted as a stall.
+ *
+ * File: `size_t read(uint8_t*, size_t)`, `bool seek(uint32_t)`.
+ */
+template <typename File, size_t BlockBytes = 4096, size_t Blocks = 8>
+class ReadAhead {
+  static_assert(Blocks >= 2 && (Blocks & (Blocks - 1)) == 0, "Blocks must be a power of two");
+  static_assert(BlockBytes <= 0xFFFF, "Block length is stored in 16 bits");
+
+public:
+  using ClockFn = uint32_t (*)();             // microseconds, wraps
+  using WakeFn  = void (*)(void* arg);        // kick the fill task
+  using WaitFn  = void (*)(void* arg);        // parser side: yield while the ring is empty
+
+  void setClock(ClockFn fn)           { clock_ = fn; }
+  void setWake(WakeFn fn, void* arg)  { wake_ = fn; wakeArg_ = arg; }
+  void setWait(WaitFn fn, void* arg)  { wait_ = fn; waitArg_ = arg; }
+
+  // ---- parser side ----
+
+  // Reads the resident head block synchronously and queues the fill behind it.
+  // The fill side must not be inside service() for this file.
+  bool begin(File* f) {
+    file_ = f;
+    head_.store(0, std::memory_order_relaxed);
+    tail_.store(0, std::memory_order_relaxed);
+    fillGen_ = 0;
+    rd_      = ReaderCounters{};
+    fill_    = FillCounters{};
+    genStart_ = kNoPos;
+    if (!file_ || !file_->seek(0)) return false;
+    headLen_ = readBlock(headBuf_);
+    return seek(0);
+  }
+
+  size_t read(uint8_t* buf, size_t len) {
+    size_t done = 0;
+    while (done < len) {
+      if (inHead_) {
+        if (pos_ < headLen_) {
+          size_t n = headLen_ - pos_;
+          if (n > len - done) n = len - done;
+          memcpy(buf + done, headBuf_ + pos_, n);
+          pos_ += (uint32_t)n;
+          done += n;
+          continue;
+        }
+        inHead_ = false;
+      }
+      if (eof_) break;
+      const Slot* s = front();
+      if (!s) { waitForFill(); continue; }
+      if (!s->len) { eof_ = true; break; }           // end of file for this generation
+      size_t n = s->len - off_;
+      if (n > len - done) n = len - done;
+      memcpy(buf + done, s->data + off_, n);
+      taken_ = true;
+      off_ += (uint32_t)n;
+      pos_ += (uint32_t)n;
+      done += n;
+      if (off_ == s->len) popFront();
+    }
+    return done;
+  }
+
+  bool seek(uint32_t pos) {
+    eof_ = false;
+    if (pos <= headLen_) {                          // resident: refill from the end of the head
+      inHead_ = true;
+      pos_    = pos;
+      restartFill(headLen_);
+      return true;
+    }
+    if (!inHead_) {                                 // forward inside the block being parsed
+      const Slot* s = front();
+      if (s && s->len && pos >= s->pos + off_ && pos < s->pos + s->len) {
+        off_ = pos - s->pos;
+        pos_ = pos;
+        return true;
+      }
+    }
+    ++rd_.seeks;
+    inHead_ = false;
+    pos_    = pos;
+    restartFill(pos);
+    return true;
+  }
+
+  uint32_t position() const { return pos_; }
+
+  ReadAheadStats stats() const {
+    ReadAheadStats st{};
+    st.depth          = head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_relaxed);
+    st.depth_min      = rd_.depthMin == kNoDepth ? st.depth : rd_.depthMin;
+    st.stalls         = rd_.stalls;
+    st.stall_us_total = rd_.stallUsTotal;
+    st.stall_us_max   = rd_.stallUsMax;
+    st.seeks          = rd_.seeks;
+    st.bytes_read     = fill_.bytes;
+    st.read_us_total  = fill_.readUsTotal;
+    st.read_us_max    = fill_.readUsMax;
+    return st;
+  }
+  static constexpr size_t capacity() { return Blocks; }
+
+  // ---- fill side ----
+
+  // Reads one block into a free slot; true while more work is pending.
+  bool service() {
+    if (!file_) return false;
+    const uint32_t gen = reqGen_.load(std::memory_order_acquire);
+    if (gen != fillGen_) {                          // restart: new generation from reqPos_
+      fillGen_ = gen;
+      fillPos_ = reqPos_.load(std::memory_order_relaxed);
+      fillEof_ = false;
+      seekOk_  = file_->seek(fillPos_);             // failed: publish EOF for this generation
+    }
+    if (fillEof_) return false;
+    if (!publish(seekOk_)) return false;            // ring full
+    return !fillEof_;
+  }
+
+  // Fill side: the next block would be read at this file position (host tests
+  // use it to model per-block latency before the read happens)
+  uint32_t fillPosition() const {
+    return reqGen_.load(std::memory_order_acquire) != fillGen_ ? reqPos_.load(std::memory_order_relaxed) : fillPos_;
+  }
+  bool fillPending() const {
+    return reqGen_.load(std::memory_order_acquire) != fillGen_ ||
+           (!fillEof_ && head_.load(std::memory_order_relaxed) - tail_.load(std::memory_order_acquire) < Blocks);
+  }
+
+private:
+  struct Slot {
+    uint32_t gen;
+    uint32_t pos;                                   // file offset of data[0]
+    uint16_t len;                                   // 0 = end of file
+    uint8_t  data[BlockBytes];
+  };
+  struct ReaderCounters {
+    uint32_t stalls = 0, stallUsTotal = 0, stallUsMax = 0, seeks = 0, depthMin = kNoDepth;
+  };
+  struct FillCounters {
+    uint32_t bytes = 0, readUsTotal = 0, readUsMax = 0;
+  };
+  static constexpr uint32_t kNoDepth = 0xFFFFFFFFu;
+  static constexpr uint32_t kNoPos   = 0xFFFFFFFFu;
+
+  uint32_t now() const { return clock_ ? clock_() : 0; }
+  void kick() { if (wake_) wake_(wakeArg_); }
+
+  size_t readBlock(uint8_t* dst) {
+    size_t got = 0;
+    while (got < BlockBytes) {
+      const size_t n = file_->read(dst + got, BlockBytes - got);
+      if (!n) break;
+      got += n;
+    }
+    return got;
+  }
+
+  // Fill side: read a block (or only mark EOF) into the next free slot
+  bool publish(bool data) {
+    const uint32_t h = head_.load(std::memory_order_relaxed);
+    if (h - tail_.load(std::memory_order_acquire) >= Blocks) return false;
+    Slot& s = slots_[h & (Blocks - 1)];
+    size_t n = 0;
+    if (data) {
+      const uint32_t t0 = now();
+      n = readBlock(s.data);
+      const uint32_t dt = now() - t0;
+      fill_.readUsTotal += dt;
+      if (dt > fill_.readUsMax) fill_.readUsMax = dt;
+      fill_.bytes += (uint32_t)n;
+    }
+    s.gen = fillGen_;
+    s.pos = fillPos_;
+    s.len = (uint16_t)n;
+    fillPos_ += (uint32_t)n;
+    if (!n) fillEof_ = true;
+    head_.store(h + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Parser side: oldest block of the current generation (stale ones are dropped)
+  const Slot* front() {
+    for (;;) {
+      const uint32_t t = tail_.load(std::memory_order_relaxed);
+      if (t == head_.load(std::memory_order_acquire)) return nullptr;
+      const Slot& s = slots_[t & (Blocks - 1)];
+      if (s.gen == gen_) return &s;
+      tail_.store(t + 1, std::memory_order_release);
+      kick();
+    }
+  }
+
+  void popFront() {
+    const uint32_t t = tail_.load(std::memory_order_relaxed) + 1;
+    tail_.store(t, std::memory_order_release);
+    off_ = 0;
+    const uint32_t depth = head_.load(std::memory_order_acquire) - t;
+    if (depth < rd_.depthMin) rd_.depthMin = depth;
+    kick();
+  }
+
+  void restartFill(uint32_t pos) {
+    // Already filling from there (e.g. repeated rewinds) and nothing taken yet: keep it
+    if (pos == genStart_ && !taken_) return;
+    ++gen_;
+    genStart_ = pos;
+    taken_    = false;
+    off_      = 0;
+    reqPos_.store(pos, std::memory_order_relaxed);
+    reqGen_.store(gen_, std::memory_order_release);
+    kick();
+  }
+
+  void waitForFill() {
+    ++rd_.stalls;
+    const uint32_t t0 = now();
+    while (!front()) {
+      kick();
+      if (wait_) wait_(waitArg_);
+    }
+    const uint32_t dt = now() - t0;
+    rd_.stallUsTotal += dt;
+    if (dt > rd_.stallUsMax) rd_.stallUsMax = dt;
+  }
+
+  File*    file_    = nullptr;
+  ClockFn  clock_   = nullptr;
+  WakeFn   wake_    = nullptr;
+  void*    wakeArg_ = nullptr;
+  WaitFn   wait_    = nullptr;
+  void*    waitArg_ = nullptr;
+
+  Slot                  slots_[Blocks];
+  std::atomic<uint32_t> head_{0};                   // fill side publishes
+  std::atomic<uint32_t> tail_{0};                   // parser side frees
+  std::atomic<uint32_t> reqGen_{0};                 // parser -> fill: restart request
+  std::atomic<uint32_t> reqPos_{0};
+
+  // Parser side
+  uint8_t  headBuf_[BlockBytes];
+  uint32_t headLen_  = 0;
+  bool     inHead_   = false;
+  uint32_t pos_      = 0;                           // file offset of the next byte read() returns
+  uint32_t off_      = 0;                           // into the front slot
+  uint32_t gen_      = 0;
+  uint32_t genStart_ = kNoPos;                      // where this generation's fill began
+  bool     taken_    = false;                       // a block of this generation was consumed
+  bool     eof_      = false;
+  ReaderCounters rd_;
+
+  // Fill side
+  uint32_t fillGen_ = 0;
+  uint32_t fillPos_ = 0;
+  bool     fillEof_ = true;
+  bool     seekOk_  = false;
+  FillCounters fill_;
+};
@@ -0,0 +1,209 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include "stridera_packet.h"
+
+/**
+ * ReplayScheduler — releases recorded rows on their own timestamps against a
+ * monotonic clock the caller passes in (esp_timer on the device, a virtual
+ * clock on the host, so a replay load test is reproducible bit for bit).
+ *
+ *   due(row) = anchor_wall + (rec_us(row) - anchor_rec) * 100 / speed_x100
+ *
+ * - rec_us is the row's ts_ms relative to the first row, unwrapped across
+ *   loops: a loop restarts one recorded period after the last row.
+ * - Released rows are stamped with their due time (ts_us, v1.ts_ms) and the
+ *   output rate (recorded rate x speed), so looping and speed-up still give a
+ *   monotonic stream with a matching nominal period.
+ * - Behind by more than max_lag_us the policy decides: CATCH_UP releases the
+ *   backlog (max_burst rows per poll), DROP discards overdue rows, SLIP moves
+ *   the schedule forward and keeps every row.
+ * - poll() does at most max_burst rows of work, whatever the lag.
+ *
+ * Source: `bool readNext(StrideraSample&, uint16_t nominal_rate_hz)` and
+ * `bool rewind()` (CsvReplay, or an in-memory trace on the host).
+ */
+
+#define STRIDERA_REPLAY_CATCH_UP 0
+#define STRIDERA_REPLAY_DROP     1
+#define STRIDERA_REPLAY_SLIP     2
+
+#define STRIDERA_REPLAY_SPEED_MIN 25     // x100
+#define STRIDERA_REPLAY_SPEED_MAX 2000
+
+struct ReplayConfig {
+  uint16_t speed_x100 = 100;                       // 25..2000 (0.25x..20x)
+  bool     loop       = true;                      // rewind at the end instead of stopping
+  uint8_t  policy     = STRIDERA_REPLAY_CATCH_UP;
+  uint32_t max_lag_us = 100000;                    // DROP / SLIP beyond this
+  uint16_t max_burst  = 64;                        // rows handled per poll()
+};
+
+struct ReplayStats {
+  uint32_t released     = 0;
+  uint32_t dropped      = 0;   // DROP: overdue rows discarded
+  uint32_t slips        = 0;   // SLIP: schedule moved forward
+  uint32_t loops        = 0;
+  uint32_t late_max_us  = 0;   // worst release time behind schedule
+  uint32_t target_mhz   = 0;   // rows/s the schedule asks for (recorded rate x speed), milli-Hz
+  uint32_t achieved_mhz = 0;   // rows released / wall time since start(), milli-Hz
+};
+
+template <typename Source>
+class ReplayScheduler {
+public:
+  // Measures the recorded rate over the first rows, then rewinds. false = no rows.
+  bool begin(Source* src, const ReplayConfig& cfg) {
+    src_ = src;
+    cfg_ = cfg;
+    cfg_.speed_x100 = clampSpeed(cfg.speed_x100);
+    if (!cfg_.max_burst) cfg_.max_burst = 1;
+
+    StrideraSample s;
+    uint32_t first = 0, last = 0, n = 0;
+    while (n < kRateRows && src_->readNext(s, 0)) {
+      if (!n) first = s.v1.ts_ms;
+      last = s.v1.ts_ms;
+      ++n;
+    }
+    if (!n || !src_->rewind()) return false;
+    periodUs_ = n > 1 && last > first ? (uint32_t)((uint64_t)(last - first) * 1000u / (n - 1)) : 10000u;
+    if (!periodUs_) periodUs_ = 1;
+    recHz_ = (uint16_t)((1000000u + periodUs_ / 2) / periodUs_);
+    restart();
+    return true;
+  }
+
+  // First row due now; a finished, non-looping replay starts over
+  void start(uint64_t now_us) {
+    if (done_) { src_->rewind(); restart(); }
+    anchorWall_ = now_us;
+    anchorRec_  = have_ ? nextRec_ : 0;
+    startWall_  = now_us;
+    lastPoll_   = now_us;
+    stats_      = ReplayStats{};
+  }
+
+  // From the next row on; rows already due keep their place
+  void setSpeed(uint16_t speed_x100, uint64_t now_us) {
+    speed_x100 = clampSpeed(speed_x100);
+    if (speed_x100 == cfg_.speed_x100) return;
+    const uint64_t due = have_ ? dueUs(nextRec_) : now_us;
+    anchorWall_ = due > now_us ? due : now_us;
+    anchorRec_  = have_ ? nextRec_ : 0;
+    cfg_.speed_x100 = speed_x100;
+  }
+
+  // emit(StrideraSample&) for every row due at now_us; returns rows released
+  template <typename Fn>
+  size_t poll(uint64_t now_us, Fn&& emit) {
+    lastPoll_ = now_us;
+    size_t released = 0;
+    for (uint16_t work = 0; have_ && work < cfg_.max_burst; ++work) {
+      uint64_t due = dueUs(nextRec_);
+      if (due > now_us) break;
+      uint64_t late = now_us - due;
+      if (late > cfg_.max_lag_us && cfg_.policy == STRIDERA_REPLAY_DROP) {
+        ++stats_.dropped;
+        advance();
+        continue;
+      }
+      if (late > cfg_.max_lag_us && cfg_.policy == STRIDERA_REPLAY_SLIP) {
+        anchorWall_ += late;                       // this row is due now, the rest follow it
+        due  = now_us;
+        late = 0;
+        ++stats_.slips;
+      }
+      if (late > stats_.late_max_us) stats_.late_max_us = (uint32_t)(late > 0xFFFFFFFFu ? 0xFFFFFFFFu : late);
+
+      StrideraSample s = next_;
+      s.ts_us      = (uint32_t)due;
+      s.v1.ts_ms   = (uint32_t)(due / 1000u);
+      s.rate_hz    = outputHz();
+      s.v1.rate_hz = (uint8_t)(s.rate_hz > 255 ? 255 : s.rate_hz);
+      ++stats_.released;
+      ++released;
+      advance();
+      emit(s);
+    }
+    return released;
+  }
+
+  bool     done()        const { return done_; }
+  uint16_t speedX100()   const { return cfg_.speed_x100; }
+  uint16_t recordedHz()  const { return recHz_; }
+  uint16_t outputHz()    const { return (uint16_t)(((uint32_t)recHz_ * cfg_.speed_x100 + 50) / 100); }
+  const ReplayConfig& config() const { return cfg_; }
+
+  ReplayStats stats() const {
+    ReplayStats r = stats_;
+    const uint64_t wall = lastPoll_ - startWall_;
+    r.target_mhz   = (uint32_t)(1000000000ull * cfg_.speed_x100 / 100 / periodUs_);
+    r.achieved_mhz = wall ? (uint32_t)((uint64_t)stats_.released * 1000000000ull / wall) : 0;
+    return r;
+  }
+
+private:
+  static constexpr uint32_t kRateRows = 32;        // rows averaged for the recorded period (ms timestamps)
+
+  static uint16_t clampSpeed(uint16_t s) {
+    return s < STRIDERA_REPLAY_SPEED_MIN ? STRIDERA_REPLAY_SPEED_MIN
+         : s > STRIDERA_REPLAY_SPEED_MAX ? STRIDERA_REPLAY_SPEED_MAX : s;
+  }
+
+  uint64_t dueUs(uint64_t rec) const {
+    if (rec <= anchorRec_) return anchorWall_;     // out-of-order row: due with the anchor
+    return anchorWall_ + (rec - anchorRec_) * 100u / cfg_.speed_x100;
+  }
+
+  void restart() {
+    done_     = false;
+    loopBase_ = 0;
+    have_     = false;
+    if (src_->readNext(next_, recHz_)) {
+      have_     = true;
+      firstMs_  = next_.v1.ts_ms;
+      nextRec_  = 0;
+    } else {
+      done_ = true;
+    }
+  }
+
+  // Read the row after next_, rewinding at the end when looping
+  void advance() {
+    const uint64_t prev = nextRec_;
+    if (src_->readNext(next_, recHz_)) {
+      // A row stamped before its predecessor (or before the loop's first row)
+      // is due with the previous one instead of ~49 days of unsigned wrap later
+      const int32_t  ms  = (int32_t)(next_.v1.ts_ms - firstMs_);
+      const uint64_t rec = ms > 0 ? loopBase_ + (uint64_t)ms * 1000u : loopBase_;
+      nextRec_ = rec > prev ? rec : prev;
+      return;
+    }
+    if (cfg_.loop && src_->rewind() && src_->readNext(next_, recHz_)) {
+      loopBase_ = prev + periodUs_;
+      firstMs_  = next_.v1.ts_ms;
+      nextRec_  = loopBase_;
+      ++stats_.loops;
+      return;
+    }
+    have_ = false;
+    done_ = true;
+  }
+
+  Source*        src_ = nullptr;
+  ReplayConfig   cfg_;
+  ReplayStats    stats_;
+  StrideraSample next_{};                          // read ahead: the row poll() waits for
+  bool     have_       = false;
+  bool     done_       = false;
+  uint32_t firstMs_    = 0;                        // ts_ms of the first row of this loop
+  uint32_t periodUs_   = 10000;
+  uint16_t recHz_      = 100;
+  uint64_t loopBase_   = 0;                        // rec_us of the first row of this loop
+  uint64_t nextRec_    = 0;
+  uint64_t anchorRec_  = 0;
+  uint64_t anchorWall_ = 0;
+  uint64_t startWall_  = 0;
+  uint64_t lastPoll_   = 0;
+};
@@ -0,0 +1,256 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "stridera_packet.h"
+
+/**
+ * Allocation-free CSV replay parsing (no float math, no heap).
+ *
+ * - stridera_parse_milli():  "-0.9815", "1.2e-3", "+2" -> value * 1000, rounded
+ *                            half away from zero, using integer math only.
+ * - stridera_parse_csv_row(): "ts_ms, ax_g, ay_g, az_g[, ...]" -> packet; the
+ *                            packet is only written when the whole row parses.
+ * - stridera_csv_columns() + stridera_parse_csv_sample(): multi-channel
+ *                            recordings, "ts_ms, ax_g, ay_g, az_g[, gx_dps,
+ *                            gy_dps, gz_dps][, mx_ut, my_ut, mz_ut][, temp_c]";
+ *                            the header names which optional groups follow.
+ * - StrideraCsvLineReader<Source>: pulls fixed-size blocks from any source with
+ *                            `size_t read(uint8_t*, size_t)` (fs::File, host
+ *                            FILE adapter) into an in-object buffer and yields
+ *                            lines in place. Over-long lines are skipped.
+ */
+
+namespace stridera_csv {
+  static inline bool is_digit(char c) { return c >= '0' && c <= '9'; }
+  static inline void skip_ws(const char*& p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) ++p;
+  }
+  static constexpr uint64_t kPow10[] = {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL,
+    100000000ULL, 1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL,
+    10000000000000ULL, 100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+    100000000000000000ULL, 1000000000000000000ULL,
+  };
+  static constexpr int kMaxDigits = 18;   // significant digits kept in the mantissa
+}
+
+// Parse a decimal (optional sign, fraction, exponent) as value * 1000.
+// Saturates to +-2^31. Advances p past the number and trailing blanks.
+static inline bool stridera_parse_milli(const char*& p, const char* end, int32_t& out) {
+  using namespace stridera_csv;
+  skip_ws(p, end);
+
+  bool neg = false;
+  if (p < end && (*p == '-' || *p == '+')) { neg = (*p == '-'); ++p; }
+
+  uint64_t mant   = 0;
+  int      digits = 0;     // significant digits in mant
+  int      scale  = 0;     // value = mant * 10^scale
+  bool     any    = false;
+
+  for (; p < end && is_digit(*p); ++p) {
+    any = true;
+    if (digits < kMaxDigits) { mant = mant * 10 + (uint64_t)(*p - '0'); if (mant) ++digits; }
+    else                     { ++scale; }                     // drop excess integer digits
+  }
+  if (p < end && *p == '.') {
+    ++p;
+    for (; p < end && is_digit(*p); ++p) {
+      any = true;
+      if (digits < kMaxDigits) { mant = mant * 10 + (uint64_t)(*p - '0'); if (mant) ++digits; --scale; }
+    }
+  }
+  if (!any) return false;
+
+  if (p < end && (*p == 'e' || *p == 'E')) {
+    const char* q = p + 1;
+    bool eneg = false;
+    if (q < end && (*q == '-' || *q == '+')) { eneg = (*q == '-'); ++q; }
+    if (q >= end || !is_digit(*q)) return false;
+    int e = 0;
+    for (; q < end && is_digit(*q); ++q) if (e < 1000) e = e * 10 + (*q - '0');
+    scale += eneg ? -e : e;
+    p = q;
+  }
+
+  // milli = mant * 10^(scale + 3)
+  const int s = scale + 3;
+  uint64_t v;
+  if (mant == 0) {
+    v = 0;
+  } else if (s >= 0) {
+    v = (s > 10 || mant > (uint64_t)INT32_MAX / kPow10[s]) ? (uint64_t)INT32_MAX + 1 : mant * kPow10[s];
+  } else if (-s > kMaxDigits) {
+    v = 0;
+  } else {
+    const uint64_t d = kPow10[-s];
+    v = (mant + d / 2) / d;                                   // round half away from zero
+  }
+  if (v > (uint64_t)INT32_MAX) v = neg ? (uint64_t)INT32_MAX + 1 : (uint64_t)INT32_MAX;
+
+  out = neg ? (int32_t)(0 - v) : (int32_t)v;
+  skip_ws(p, end);
+  return true;
+}
+
+// Parse an unsigned integer (an optional ".xxx" fraction is accepted and truncated).
+static inline bool stridera_parse_u32(const char*& p, const char* end, uint32_t& out) {
+  using namespace stridera_csv;
+  skip_ws(p, end);
+  if (p >= end || !is_digit(*p)) return false;
+  uint64_t v = 0;
+  for (; p < end && is_digit(*p); ++p) {
+    v = v * 10 + (uint64_t)(*p - '0');
+    if (v > UINT32_MAX) return false;
+  }
+  if (p < end && *p == '.') { ++p; while (p < end && is_digit(*p)) ++p; }
+  out = (uint32_t)v;
+  skip_ws(p, end);
+  return true;
+}
+
+static inline int16_t stridera_clamp_mg(int32_t v) {
+  if (v >  32767) return  32767;
+  if (v < -32768) return -32768;
+  return (int16_t)v;
+}
+
+// "ts_ms, ax_g, ay_g, az_g" -> packet. `out` is untouched unless the row is valid.
+static inline bool stridera_parse_csv_row(const char* s, const char* end,
+                                          StrideraAccelPacket& out, uint8_t nominal_rate_hz) {
+  uint32_t ts;
+  int32_t  mg[3];
+  const char* p = s;
+
+  if (!stridera_parse_u32(p, end, ts)) return false;
+  for (int i = 0; i < 3; ++i) {
+    if (p >= end || *p != ',') return false;
+    ++p;
+    if (!stridera_parse_milli(p, end, mg[i])) return false;
+  }
+  if (p < end && *p != ',') return false;                       // junk after az (extra columns are fine)
+
+  out.ts_ms    = ts;
+  out.ax_mg    = stridera_clamp_mg(mg[0]);
+  out.ay_mg    = stridera_clamp_mg(mg[1]);
+  out.az_mg    = stridera_clamp_mg(mg[2]);
+  out.rate_hz  = nominal_rate_hz;
+  out.reserved = 0;
+  return true;
+}
+
+// Header line -> STRIDERA_CH_* groups the rows carry (accel always): a column
+// starting with "gx", "mx" or "temp" (any case) turns on gyro, mag, temperature
+static inline uint8_t stridera_csv_columns(const char* s, const char* end) {
+  uint8_t mask = STRIDERA_CH_ACCEL;
+  const char* p = s;
+  while (p < end) {
+    stridera_csv::skip_ws(p, end);
+    char c[4] = {0};
+    for (size_t i = 0; i < 4 && p + i < end && p[i] != ','; ++i) c[i] = (char)(p[i] | 0x20);
+    if (c[0] == 'g' && c[1] == 'x') mask |= STRIDERA_CH_GYRO;
+    if (c[0] == 'm' && c[1] == 'x') mask |= STRIDERA_CH_MAG;
+    if (!memcmp(c, "temp", 4))      mask |= STRIDERA_CH_TEMP;
+    while (p < end && *p != ',') ++p;
+    if (p < end) ++p;
+  }
+  return mask;
+}
+
+// One row of a multi-channel recording -> sample (ts_us = ts_ms * 1000, seq 0).
+// `columns` from stridera_csv_columns(); the row must have every column it names.
+// `out` is untouched unless the row is valid.
+static inline bool stridera_parse_csv_sample(const char* s, const char* end, StrideraSample& out,
+                                             uint16_t nominal_rate_hz, uint8_t columns) {
+  const size_t n = stridera_channel_values(columns | STRIDERA_CH_ACCEL);
+  uint32_t ts;
+  int32_t  milli[STRIDERA_CH_MAX_VALUES];
+  const char* p = s;
+
+  if (!stridera_parse_u32(p, end, ts)) return false;
+  for (size_t i = 0; i < n; ++i) {
+    if (p >= end || *p != ',') return false;
+    ++p;
+    if (!stridera_parse_milli(p, end, milli[i])) return false;
+  }
+  if (p < end && *p != ',') return false;
+
+  // milli-units -> wire units: mg, 0.1 dps, 0.1 uT, 0.01 degC
+  auto scaled = [](int32_t v, int32_t div) {
+    return stridera_clamp_mg((v >= 0 ? v + div / 2 : v - div / 2) / div);
+  };
+  memset(&out, 0, sizeof(out));
+  out.v1.ts_ms   = ts;
+  out.v1.ax_mg   = stridera_clamp_mg(milli[0]);
+  out.v1.ay_mg   = stridera_clamp_mg(milli[1]);
+  out.v1.az_mg   = stridera_clamp_mg(milli[2]);
+  out.v1.rate_hz = (uint8_t)(nominal_rate_hz > 255 ? 255 : nominal_rate_hz);
+  out.ts_us      = ts * 1000u;
+  out.rate_hz    = nominal_rate_hz;
+  out.chan_mask  = columns | STRIDERA_CH_ACCEL;
+  size_t k = 3;
+  if (columns & STRIDERA_CH_GYRO) for (int i = 0; i < 3; ++i) out.gyro[i] = scaled(milli[k++], 100);
+  if (columns & STRIDERA_CH_MAG)  for (int i = 0; i < 3; ++i) out.mag[i]  = scaled(milli[k++], 100);
+  if (columns & STRIDERA_CH_TEMP) out.temp = scaled(milli[k++], 10);
+  return true;
+}
+
+template <typename Source, size_t BlockSize = 512>
+class StrideraCsvLineReader {
+public:
+  void begin(Source* src) { src_ = src; pos_ = len_ = 0; eof_ = false; longLines_ = 0; }
+
+  // Next line without its '\n' (may be empty). The range stays valid until the next call.
+  bool next(const char*& line, const char*& lineEnd) {
+    for (;;) {
+      const char* nl = static_cast<const char*>(memchr(buf_ + pos_, '\n', len_ - pos_));
+      if (nl) {
+        line    = buf_ + pos_;
+        lineEnd = nl;
+        pos_    = (size_t)(nl - buf_) + 1;
+        return true;
+      }
+      if (eof_) {
+        if (pos_ == len_) return false;
+        line    = buf_ + pos_;                                  // last line without '\n'
+        lineEnd = buf_ + len_;
+        pos_    = len_;
+        return true;
+      }
+      if (pos_ == 0 && len_ == BlockSize) {                     // no '\n' in a whole block
+        ++longLines_;
+        skipping_ = true;
+        len_ = 0;
+      }
+      refill();
+      if (skipping_) {
+        const char* end = static_cast<const char*>(memchr(buf_, '\n', len_));
+        if (end) { pos_ = (size_t)(end - buf_) + 1; skipping_ = false; }
+        else     { pos_ = len_; }
+      }
+    }
+  }
+
+  uint32_t longLines() const { return longLines_; }
+
+private:
+  void refill() {
+    if (pos_ > 0) {                                             // keep the partial line
+      memmove(buf_, buf_ + pos_, len_ - pos_);
+      len_ -= pos_;
+      pos_  = 0;
+    }
+    const size_t got = src_ ? src_->read(reinterpret_cast<uint8_t*>(buf_) + len_, BlockSize - len_) : 0;
+    if (got == 0) eof_ = true;
+    len_ += got;
+  }
+
+  Source*  src_       = nullptr;
+  char     buf_[BlockSize];
+  size_t   pos_       = 0;
+  size_t   len_       = 0;
+  bool     eof_       = false;
+  bool     skipping_  = false;
+  uint32_t longLines_ = 0;
+};
@@ -0,0 +1,175 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "stridera_packet.h"
+
+/**
+ * Stridera session file (.ssn) — fixed-width binary recording with a sparse time index.
+ *
+ *   [StrideraSessionHeader, padded to header_size]
+ *   [StrideraSessionRecord x record_count]
+ *   [StrideraSessionIndexEntry x index_count]   (at index_offset)
+ *
+ * - Records are 10 bytes: no text parsing on-device, fixed stride = O(1) addressing.
+ * - Every index_stride-th record has an index entry, so seeking to a timestamp
+ *   is a binary search over the index plus a scan of at most one stride.
+ * - header_size lets writers pad the header (e.g. to 512 so records start
+ *   sector-aligned on SD).
+ * - Little-endian, packed.
+ */
+
+#define STRIDERA_SESSION_MAGIC   "SSN1"
+#define STRIDERA_SESSION_VERSION 1
+
+#pragma pack(push, 1)
+struct StrideraSessionHeader {
+  char     magic[4];       // STRIDERA_SESSION_MAGIC
+  uint16_t version;        // STRIDERA_SESSION_VERSION
+  uint16_t header_size;    // bytes before the first record (>= sizeof(header))
+  uint16_t record_size;    // sizeof(StrideraSessionRecord)
+  uint16_t rate_hz;        // nominal sample rate
+  uint32_t record_count;
+  uint32_t first_ts_ms;
+  uint32_t last_ts_ms;
+  uint32_t index_offset;   // byte offset of the index (0 = no index)
+  uint32_t index_count;
+  uint32_t index_stride;   // records per index entry
+  uint8_t  reserved[28];
+};
+
+struct StrideraSessionRecord {
+  uint32_t ts_ms;
+  int16_t  ax_mg;
+  int16_t  ay_mg;
+  int16_t  az_mg;
+};
+
+struct StrideraSessionIndexEntry {
+  uint32_t ts_ms;          // timestamp of `record`
+  uint32_t record;         // record number (multiple of index_stride)
+};
+#pragma pack(pop)
+
+static_assert(sizeof(StrideraSessionHeader) == 64, "Unexpected session header size");
+static_assert(sizeof(StrideraSessionRecord) == 10, "Unexpected session record size");
+static_assert(sizeof(StrideraSessionIndexEntry) == 8, "Unexpected session index size");
+
+static inline void stridera_session_header_init(StrideraSessionHeader& h, uint16_t rate_hz,
+                                                uint16_t header_size = sizeof(StrideraSessionHeader),
+                                                uint32_t index_stride = 256) {
+  memset(&h, 0, sizeof(h));
+  memcpy(h.magic, STRIDERA_SESSION_MAGIC, 4);
+  h.version      = STRIDERA_SESSION_VERSION;
+  h.header_size  = header_size < sizeof(h) ? (uint16_t)sizeof(h) : header_size;
+  h.record_size  = sizeof(StrideraSessionRecord);
+  h.rate_hz      = rate_hz;
+  h.index_stride = index_stride ? index_stride : 256;
+}
+
+static inline bool stridera_session_header_valid(const StrideraSessionHeader& h) {
+  return memcmp(h.magic, STRIDERA_SESSION_MAGIC, 4) == 0 &&
+         h.version == STRIDERA_SESSION_VERSION &&
+         h.record_size == sizeof(StrideraSessionRecord) &&
+         h.header_size >= sizeof(StrideraSessionHeader);
+}
+
+static inline StrideraSessionRecord stridera_session_record(const StrideraAccelPacket& p) {
+  return StrideraSessionRecord{p.ts_ms, p.ax_mg, p.ay_mg, p.az_mg};
+}
+
+/**
+ * StrideraSessionReader<Source> — block-reading cursor over a session file.
+ * Source needs `size_t read(uint8_t*, size_t)` and `bool seek(uint32_t)`
+ * (fs::File on device, a FILE adapter on the host).
+ */
+template <typename Source, size_t BlockRecords = 51>
+class StrideraSessionReader {
+public:
+  bool begin(Source* src) {
+    src_ = src;
+    if (!src_ || !src_->seek(0)) return false;
+    if (src_->read(reinterpret_cast<uint8_t*>(&hdr_), sizeof(hdr_)) != sizeof(hdr_)) return false;
+    if (!stridera_session_header_valid(hdr_)) return false;
+    return seekRecord(0);
+  }
+
+  bool next(StrideraAccelPacket& out, uint8_t nominal_rate_hz) {
+    if (cur_ >= hdr_.record_count) return false;
+    if (bufPos_ == bufLen_ && !fill()) return false;
+
+    StrideraSessionRecord r;
+    memcpy(&r, buf_ + bufPos_ * sizeof(r), sizeof(r));
+    ++bufPos_;
+    ++cur_;
+    out.ts_ms    = r.ts_ms;
+    out.ax_mg    = r.ax_mg;
+    out.ay_mg    = r.ay_mg;
+    out.az_mg    = r.az_mg;
+    out.rate_hz  = nominal_rate_hz;
+    out.reserved = 0;
+    return true;
+  }
+
+  bool seekRecord(uint32_t i) {
+    if (i > hdr_.record_count) i = hdr_.record_count;
+    cur_ = i;
+    bufPos_ = bufLen_ = 0;
+    return src_->seek(hdr_.header_size + i * (uint32_t)sizeof(StrideraSessionRecord));
+  }
+
+  // Position on the first record with ts >= ts_ms: O(log n) index probes + <= one stride.
+  bool seekMs(uint32_t ts_ms) {
+    uint32_t start = 0;
+    if (hdr_.index_offset && hdr_.index_count) {
+      uint32_t lo = 0, hi = hdr_.index_count;       // last entry with ts <= ts_ms
+      while (hi - lo > 1) {
+        const uint32_t mid = lo + (hi - lo) / 2;
+        StrideraSessionIndexEntry e;
+        if (!readIndex(mid, e)) return false;
+        if (e.ts_ms <= ts_ms) lo = mid; else hi = mid;
+      }
+      StrideraSessionIndexEntry e;
+      if (!readIndex(lo, e)) return false;
+      if (e.ts_ms <= ts_ms) start = e.record;
+    }
+    if (!seekRecord(start)) return false;
+
+    StrideraAccelPacket p;
+    while (next(p, 0)) {
+      if (p.ts_ms >= ts_ms) {                        // step back onto it (still buffered)
+        --bufPos_;
+        --cur_;
+        return true;
+      }
+    }
+    return true;                                      // past the end: next() returns false
+  }
+
+  const StrideraSessionHeader& header() const { return hdr_; }
+  uint32_t position() const { return cur_; }
+
+private:
+  bool fill() {
+    uint32_t n = hdr_.record_count - cur_;
+    if (n > BlockRecords) n = BlockRecords;
+    const size_t want = n * sizeof(StrideraSessionRecord);
+    const size_t got  = src_->read(buf_, want);
+    bufLen_ = got / sizeof(StrideraSessionRecord);
+    bufPos_ = 0;
+    return bufLen_ > 0;
+  }
+
+  bool readIndex(uint32_t i, StrideraSessionIndexEntry& e) {
+    bufPos_ = bufLen_ = 0;                            // the file cursor moves
+    return src_->seek(hdr_.index_offset + i * (uint32_t)sizeof(e)) &&
+           src_->read(reinterpret_cast<uint8_t*>(&e), sizeof(e)) == sizeof(e);
+  }
+
+  Source*               src_ = nullptr;
+  StrideraSessionHeader hdr_{};
+  uint32_t              cur_    = 0;                  // next record number
+  uint8_t               buf_[BlockRecords * sizeof(StrideraSessionRecord)];
+  size_t                bufPos_ = 0;                  // in records
+  size_t                bufLen_ = 0;
+};
@@ -0,0 +1,49 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include <type_traits>
+
+/**
+ * Seqlock — latest-value snapshot from one writer to any number of readers.
+ * - write() never waits: bump the sequence to odd, copy, bump to even.
+ * - read() copies and retries if a write overlapped (odd or changed sequence);
+ *   returns false after `tries` collisions so a reader never spins forever.
+ * - Readers see whole values only, never a torn mix of two writes.
+ * - T must be trivially copyable (plain structs with fixed arrays).
+ * - No heap, no locks: the writer (IMU task, loop) cannot be held up by a
+ *   slow reader (UI task).
+ */
+template <typename T>
+class Seqlock {
+  static_assert(std::is_trivially_copyable<T>::value, "Seqlock needs a trivially copyable type");
+
+public:
+  // Writer side (one task only)
+  void write(const T& v) {
+    const uint32_t s = seq_.load(std::memory_order_relaxed);
+    seq_.store(s + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(&val_, &v, sizeof(T));
+    seq_.store(s + 2, std::memory_order_release);
+  }
+
+  // Reader side (any task)
+  bool read(T& out, int tries = 8) const {
+    while (tries-- > 0) {
+      const uint32_t s0 = seq_.load(std::memory_order_acquire);
+      if (s0 & 1) continue;                      // write in progress
+      memcpy(&out, &val_, sizeof(T));
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (seq_.load(std::memory_order_relaxed) == s0) return true;
+    }
+    return false;
+  }
+
+  // Bumps on every write: compare against a previous value to detect changes
+  uint32_t version() const { return seq_.load(std::memory_order_acquire) >> 1; }
+
+private:
+  std::atomic<uint32_t> seq_{0};
+  T val_{};
+};
@@ -0,0 +1,73 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+/**
+ * SpscRing — wait-free single-producer / single-consumer ring.
+ * - N must be a power of two; all N slots are usable.
+ * - push() is called only from the producer, pop()/discard() only from the consumer.
+ * - A full ring rejects the new element (the oldest samples are kept) and
+ *   counts an overrun; high-water is the deepest fill the producer has seen.
+ * - No heap, no locks: safe between a pinned FreeRTOS task and loop().
+ */
+template <typename T, size_t N>
+class SpscRing {
+  static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscRing size must be a power of two");
+
+public:
+  // Producer side
+  bool push(const T& v) {
+    const uint32_t head = head_.load(std::memory_order_relaxed);
+    const uint32_t tail = tail_.load(std::memory_order_acquire);
+    if (head - tail >= N) {
+      overruns_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    buf_[head & (N - 1)] = v;
+    head_.store(head + 1, std::memory_order_release);
+
+    const uint32_t depth = head + 1 - tail;
+    if (depth > highWater_.load(std::memory_order_relaxed)) {
+      highWater_.store(depth, std::memory_order_relaxed);
+    }
+    return true;
+  }
+
+  // Consumer side
+  bool pop(T& out) {
+    const uint32_t tail = tail_.load(std::memory_order_relaxed);
+    const uint32_t head = head_.load(std::memory_order_acquire);
+    if (tail == head) return false;
+    out = buf_[tail & (N - 1)];
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side: drop everything currently queued
+  void discard() {
+    tail_.store(head_.load(std::memory_order_acquire), std::memory_order_release);
+  }
+
+  size_t size() const {
+    return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+  }
+  bool   empty() const { return size() == 0; }
+  static constexpr size_t capacity() { return N; }
+
+  // Stats (readable from either side)
+  uint32_t overruns()  const { return overruns_.load(std::memory_order_relaxed); }
+  uint32_t highWater() const { return highWater_.load(std::memory_order_relaxed); }
+  void resetStats() {
+    overruns_.store(0, std::memory_order_relaxed);
+    highWater_.store(0, std::memory_order_relaxed);
+  }
+
+private:
+  // Producer and consumer indices on separate cache lines
+  alignas(32) std::atomic<uint32_t> head_{0};
+  alignas(32) std::atomic<uint32_t> tail_{0};
+  std::atomic<uint32_t> overruns_{0};
+  std::atomic<uint32_t> highWater_{0};
+  T buf_[N];
+};
@@ -1,70 +1,61 @@
 #include "System.h"
 #include <M5Unified.h>
+#include "services/Perf.h"
 
-// ---------- UI helpers ----------
-void System::drawHeader() {
-  // Small header at top-center
-  M5.Display.setTextDatum(textdatum_t::top_center);
-  M5.Display.setFont(&fonts::Font2);          // small bitmap font
-  M5.Display.setTextSize(1);
-  M5.Display.setTextColor(TFT_BLACK, TFT_WHITE);
-  M5.Display.drawString("Stridera IMU BLE Streamer",
-                        M5.Display.width() / 2, 4);
-}
-
-// Draw one or two centered lines (small font so everything fits)
-void System::drawCenteredLines(const char* line1, const char* line2) {
-  const int cx = M5.Display.width()  / 2;
-  const int cy = M5.Display.height() / 2;
-
-  M5.Display.setTextDatum(textdatum_t::middle_center);
-  M5.Display.setFont(&fonts::Font2);          // smaller than Font4
-  M5.Display.setTextSize(1);
-  M5.Display.setTextColor(TFT_BLACK, TFT_WHITE);
-
-  if (line2 && *line2) {
-    const int gap = 6;                         // small gap between lines
-    int fh = M5.Display.fontHeight();
-    M5.Display.drawString(line1, cx, cy - (fh/2 + gap/2));
-    M5.Display.drawString(line2, cx, cy + (fh/2 + gap/2));
-  } else {
-    M5.Display.drawString(line1, cx, cy);
-  }
-}
-
+// ---------- UI ----------
+// Publish what the banner should say; the UI task draws it (never blocks here)
 void System::refreshStateBanner() {
   const bool conn = ble_.connected();
   const bool sub  = ble_.subscribed();
+  const size_t subs = ble_.subscribers();
 
-  if (state_ == lastDrawnState_ && conn == lastDrawnConn_ && sub == lastDrawnSub_) return;
-
-  M5.Display.fillScreen(TFT_WHITE);
-  drawHeader();
+  if (fsm_.state() == lastDrawnState_ && conn == lastDrawnConn_ && sub == lastDrawnSub_ &&
+      subs == lastDrawnSubs_) return;
 
-  switch (state_) {
+  const char* line1 = "";
+  const char* line2 = "";
+  switch (fsm_.state()) {
     case SystemState::BOOTING:
-      drawCenteredLines("BOOTING", "");
+      line1 = "BOOTING";
       break;
 
     case SystemState::IDLE:
-      if (!conn)           drawCenteredLines("IDLE:", "not connected / not subscribed");
-      else if (!sub)       drawCenteredLines("IDLE:", "connected / not subscribed");
-      else                 drawCenteredLines("IDLE:", "connected / (unexpected)");
+      line1 = "IDLE:";
+      if (!conn)           line2 = "not connected / not subscribed";
+      else if (!sub)       line2 = "connected / not subscribed";
+      else                 line2 = "connected / (unexpected)";
+      break;
+
+    case SystemState::RECORDING:
+      line1 = "RECORDING:";
+      line2 = rec_.currentName();
       break;
 
     case SystemState::STREAMING:
       // two-line banner so 'STREAMING' is always visible
-      drawCenteredLines("STREAMING:", "connected / subscribed");
+      line1 = "STREAMING:";
+      line2 = "connected / subscribed";
       break;
 
     case SystemState::SHUTTING_DOWN:
-      drawCenteredLines("SHUTTING DOWN", "");
+      line1 = "SHUTTING DOWN";
       break;
   }
 
-  lastDrawnState_ = state_;
+  UiStatus st{};
+  strncpy(st.line1, line1, sizeof(st.line1) - 1);
+  strncpy(st.line2, line2, sizeof(st.line2) - 1);
+  if (fsm_.state() == SystemState::STREAMING && subs > 1) {
+    snprintf(st.line2, sizeof(st.line2), "%u centrals subscribed", (unsigned)subs);
+  }
+  st.hud    = fsm_.state() == SystemState::STREAMING;   // no HUD while recording: SD shares the SPI bus on Core2
+  st.replay = imu_.replaying();
+  ui_.setStatus(st);
+
+  lastDrawnState_ = fsm_.state();
   lastDrawnConn_  = conn;
   lastDrawnSub_   = sub;
+  lastDrawnSubs_  = subs;
 }
 
 // ---------- lifecycle ----------
@@ -77,7 +68,7 @@ void System::begin() {
 
   // Make sure panel is visible
   M5.Display.wakeup();
-  M5.Display.setBrightness(160);
+  M5.Display.setBrightness(UI_BACKLIGHT_ON);
 
   // Optional: silence speaker "peep" on some Core2 batches
   M5.Speaker.setVolume(0);
@@ -87,113 +78,240 @@ void System::begin() {
   M5.BtnPWR.setDebounceThresh(50);                         // ms
   M5.BtnPWR.setHoldThresh(1500);                           // <- 1.5 s shutdown hold
 
+  loopTask_ = xTaskGetCurrentTaskHandle();                 // setup() and loop() share the task
+
   // Services
+  power_.begin();                                          // clock / light-sleep policy
   ble_.begin();
   imu_.begin();
+  ble_.setChannels(imu_.channels());                       // what a central may ask for in v2 packets
+  ble_.setRateControl(&System::requestRate, this, imu_.sampleRateHz());
+  ble_.setQuatControl(&System::requestQuat, this, requestQuat(this, AHRS_QUAT_HZ));
+  rec_.begin();
+  bulk_.begin(ble_.server());
+  bulk_.setCapture(&imu_.capture());                       // capture.cap, fire / re-arm from a central
+  ble_.setWake(&System::wakeBle, this);
+  imu_.setWake(&System::wakeImu, this);
+  bulk_.setWake(&System::wakeBulk, this);
+  ble_.setDisconnectHook(&System::centralGone, this);     // a bulk transfer ends with its central
+  ble_.startAdvertising();                                 // after every GATT service is registered
+  ui_.setInputPoll(&System::pollInput, this);
+  switch (M5.getBoard()) {                                 // lines that wake the dark UI task
+    case m5::board_t::board_M5StickCPlus2:
+      ui_.wakeOnPin(GPIO_NUM_37);                          // BtnA
+      ui_.wakeOnPin(GPIO_NUM_35);                          // BtnPWR
+      break;
+    case m5::board_t::board_M5StackCore2:
+      ui_.wakeOnPin(GPIO_NUM_39);                          // touch panel INT (BtnA); the AXP's key has no line
+      break;
+    default:                                               // unknown wiring: the UI task keeps polling
+      break;
+  }
+  ui_.begin(&imu_.latest());                               // from here on only the UI task draws
 
   resetAllRuntimeState();
-  boot_ms_ = millis();
-  state_   = SystemState::BOOTING;                         // show BOOTING first
-  refreshStateBanner();                                    // draw initial banner
+  fsm_.begin(this, [] { return (uint32_t)micros(); });     // BOOTING banner for the grace period
+  refreshStateBanner();                                    // publish initial banner
   Serial.println("[FSM] -> BOOTING");
 }
 
 void System::resetAllRuntimeState() {
   ble_.reset();
   imu_.reset();
-  reqStart_ = reqStop_ = reqShutdown_ = false;
+  uint32_t since;
+  events_.take(since);
 
   // force next UI draw
   lastDrawnState_ = (SystemState)255;
 }
 
-// ---------- main loop ----------
-void System::loop() {
-  // ---- 1) Poll inputs / intents ----
-  const uint32_t now = millis();
-  const bool past_boot_grace = (now - boot_ms_) > 2000;    // 2 s grace after boot
+// ---------- events ----------
+void System::raise(uint32_t ev) {
+  events_.raise(ev, micros());
+  if (loopTask_) xTaskNotifyGive(loopTask_);
+}
 
-  if (past_boot_grace && power_.longPressToggled()) {      // release-after-hold edge
-    reqShutdown_ = true;
-  }
+void System::wakeBle(void* arg)  {                                                    // NimBLE host task
+  auto* self = static_cast<System*>(arg);
+  self->power_.activity();                                 // a central came or went: screen on
+  self->raise(kWakeBle);
+}
+void System::wakeImu(void* arg)  { static_cast<System*>(arg)->raise(kWakeSamples); }  // IMU task, per tick
+void System::wakeBulk(void* arg) { static_cast<System*>(arg)->raise(kWakeBulk); }     // bulk pump task
+void System::centralGone(void* arg, uint16_t conn) { static_cast<System*>(arg)->bulk_.onDisconnect(conn); }
+
+uint16_t System::requestRate(void* arg, uint16_t hz) {                                // NimBLE host task
+  auto* self = static_cast<System*>(arg);
+  // A session file has one rate in its header: keep it until the recording stops
+  if (self->fsm_.state() == SystemState::RECORDING) return self->imu_.sampleRateHz();
+  return self->imu_.requestRateHz(hz);
+}
+
+uint16_t System::requestQuat(void* arg, uint16_t hz) {                                // NimBLE host task
+  auto* self = static_cast<System*>(arg);
+  // Orientation needs the gyro: accel-only sensors and recordings report 0
+  return self->imu_.requestQuatHz(self->imu_.channels() & STRIDERA_CH_GYRO ? hz : 0);
+}
 
-  if (ble_.shouldStartStreaming()) reqStart_ = true;
-  if (ble_.shouldStopStreaming())  reqStop_  = true;
-
-  // ---- 2) State transitions & timed windows ----
-  if (state_ == SystemState::BOOTING) {
-    // After ~2s, move to IDLE banner automatically
-    if ((now - boot_ms_) > 2000) {
-      state_ = SystemState::IDLE;
-      Serial.println("[FSM] -> IDLE");
-    }
-    refreshStateBanner();
-    delay(10);
-    return;
+void System::pollInput(void* arg) {
+  // Buttons are polled devices here (PMIC / touch panel on Core2). The UI task
+  // polls them every UI_POLL_MS while the display is on and from a button line's
+  // interrupt while it is dark, so the loop task can block.
+  auto* self = static_cast<System*>(arg);
+  if (self->power_.longPressToggled()) self->raise(FSM_EV_BTN_POWER);   // release-after-hold edge
+  if (M5.BtnA.wasClicked())            self->raise(FSM_EV_BTN_RECORD);  // M5.update() ran above
+  if (M5.BtnA.wasPressed() || M5.BtnPWR.wasPressed()) {
+    self->power_.activity();
+    self->raise(kWakeUser);
   }
+}
+
+uint32_t System::nextWaitMs() const {
+  uint32_t ms = fsmWaitUs_ == SystemFsm::kNever ? UINT32_MAX : (fsmWaitUs_ + 999) / 1000;
+  const uint32_t ble = ble_.pollDueMs();                   // batch deadline, link retries, diagnostics
+  if (ble < ms) ms = ble;
+  if (rec_.busy() && SYSTEM_BUSY_POLL_MS < ms) ms = SYSTEM_BUSY_POLL_MS;  // report once the file is closed
+  const uint32_t pwr = power_.dueMs();                     // backlight timeout, energy readings
+  if (pwr < ms) ms = pwr;
+  return ms;
+}
 
-  if (reqShutdown_) {
-    reqShutdown_ = false;
-    state_ = SystemState::SHUTTING_DOWN;
-    shutdown_ms_ = now;                                     // mark start of 2 s window
-    refreshStateBanner();                                   // show "SHUTTING DOWN"
-    Serial.println("[FSM] -> SHUTTING_DOWN");
+// ---------- FSM actions (ISystemPort) ----------
+void System::startStreaming() {
+  imu_.reset();  // Do NOT clear all runtime state, since ble connection needs to stay active
+  imu_.startSampling();
+}
+
+void System::stopStreaming(bool unsubscribed) {
+  imu_.stopSampling();
+  if (unsubscribed) ble_.stopNotifications();
+}
+
+bool System::startRecording() {
+  imu_.reset();
+  if (!rec_.start(imu_.sampleRateHz())) return false;
+  imu_.startSampling();
+  return true;
+}
+
+void System::stopRecording() {
+  imu_.stopSampling();
+  drainImuToRecorder();
+  rec_.stop();                                  // index + header written by the writer task
+}
+
+void System::beginShutdown() {
+  imu_.stopSampling();                          // ring keeps what is queued for the final flush
+}
+
+void System::finishShutdown() {
+  // Orderly stop -> then power off
+  drainImuToBle();                              // send what is still queued in the ring
+  ble_.flush();
+  ble_.stopNotifications();
+  ble_.stopAdvertising();
+  imu_.end();
+  ui_.end();                                    // hand the display back before powerOff() blanks it
+  power_.powerOff();                            // usually never returns
+}
+
+void System::onTransition(SystemState from, SystemState to, uint32_t latency_us) {
+  power_.activity();
+  const PerfStat& l = fsm_.latency();
+  Serial.printf("[FSM] %s -> %s in %.2f ms (p99 %.2f ms over %lu)\n", system_state_name(from),
+                system_state_name(to), latency_us / 1000.0f, l.percentile(99) / 1000.0f,
+                (unsigned long)l.count());
+  // Idle keeps the sensor on for event capture; the STREAMING / RECORDING actions switched to full output
+  if (system_sensor_output(to) == SensorOutput::Capture) imu_.startSampling(SensorOutput::Capture);
+}
+
+// ---------- data path ----------
+void System::drainImuToBle() {
+  StrideraSample pkt;
+  while (imu_.pop(pkt)) {
+    ble_.sendImu(pkt);
+  }
+  StrideraGaitPacket ev;
+  while (imu_.popGait(ev)) {
+    ble_.sendGait(ev);
+  }
+  StrideraQuatPacket q;
+  while (imu_.popQuat(q)) {
+    ble_.sendQuat(q);
   }
+}
 
-  if (reqStart_) {
-    reqStart_ = false;
-    if (state_ == SystemState::IDLE && ble_.connected()) {
-      imu_.reset();  // Do NOT clear all runtime state, since ble connection needs to stay active
-      state_ = SystemState::STREAMING;
-      Serial.println("[FSM] -> STREAMING");
-    }
+void System::drainImuToRecorder() {
+  StrideraSample pkt;
+  while (imu_.pop(pkt)) {
+    rec_.append(pkt.v1);                        // sessions stay v1 records
   }
+}
+
+void System::reportPerf(uint32_t now) {
+#if STRIDERA_PERF
+  if (now - perf_ms_ < PERF_SERIAL_PERIOD_MS) return;
+  perf_ms_ = now;
+  g_perf.print(Serial);
+#else
+  (void)now;
+#endif
+}
 
-  if (reqStop_) {
-    reqStop_ = false;
-    if (state_ == SystemState::STREAMING) {
-      ble_.stopNotifications();
-      state_ = SystemState::IDLE;
-      Serial.println("[FSM] -> IDLE");
-    }
+// ---------- main loop ----------
+void System::loop() {
+  // ---- 1) Block until an event or the nearest deadline ----
+  if (!events_.pending()) {
+    const uint32_t ms = nextWaitMs();
+    ulTaskNotifyTake(pdTRUE, ms == UINT32_MAX ? portMAX_DELAY : pdMS_TO_TICKS(ms));
   }
+  STRIDERA_PERF_MARK(g_perf.loop);
+
+  uint32_t since = 0;
+  uint32_t ev = events_.take(since);
 
-  if (!ble_.connected() && state_ == SystemState::STREAMING) {
-    state_ = SystemState::IDLE;
-    Serial.println("[FSM] disconnected -> IDLE");
+  // ---- 2) Translate wake reasons into FSM inputs, step the FSM ----
+  if (ev & kWakeBle) {
+    if (ble_.shouldStartStreaming()) ev |= FSM_EV_SUBSCRIBE;
+    if (ble_.shouldStopStreaming())  ev |= FSM_EV_UNSUBSCRIBE;
+    ev |= FSM_EV_LINK;
   }
+  fsmWaitUs_ = fsm_.step(ev, since);
+  const SystemState state = fsm_.state();
+
+  // Link tuning and power follow what the device is doing (short interval / clock only while data flows)
+  ble_.setLinkProfile(bulk_.busy()                   ? STRIDERA_LINK_PROFILE_BULK
+                      : state == SystemState::STREAMING ? STRIDERA_LINK_PROFILE_STREAMING
+                                                        : STRIDERA_LINK_PROFILE_IDLE);
+  power_.update(bulk_.busy()                       ? PowerMode::Bulk
+                : state == SystemState::STREAMING ? PowerMode::Streaming
+                : state == SystemState::RECORDING ? PowerMode::Recording
+                : imu_.output() != SensorOutput::Off ? PowerMode::Capture
+                                                  : PowerMode::Idle,
+                imu_.timing().samples);
+  ui_.setBacklight(power_.backlight());
 
   // ---- 3) State actions & UI ----
-  switch (state_) {
+  const uint32_t now = millis();
+  refreshStateBanner();             // publishes only when state / connection changed
+  switch (state) {
     case SystemState::IDLE:
-      refreshStateBanner();         // will reflect connection/subscription changes
-      ble_.poll();
-      delay(20);
+      ble_.poll();                  // link negotiation / diagnostics for a connected central
+      rec_.poll();                  // reports a session once the writer has closed it
       break;
 
-    case SystemState::STREAMING:
-      Serial.print(reqStart_);
-      Serial.print(reqStop_);
-      refreshStateBanner();         // header + streaming banner stays visible
-      imu_.update();
-      ble_.sendImu(imu_.current());
-      delay(10);                    // ~100 Hz
+    case SystemState::RECORDING:
+      drainImuToRecorder();         // RAM copy only; the writer task does the FAT writes
+      ble_.poll();
+      reportPerf(now);
       break;
 
-    case SystemState::SHUTTING_DOWN:
-      refreshStateBanner();         // keep the "SHUTTING DOWN" text on screen
-      if ((now - shutdown_ms_) >= 2000) {
-        // Orderly stop -> then power off
-        ble_.flush();
-        ble_.stopNotifications();
-        ble_.stopAdvertising();
-        imu_.end();
-        power_.powerOff();          // usually never returns
-        state_ = SystemState::IDLE; // fallback if it ever returns
-      }
-      delay(10);
+    case SystemState::STREAMING:
+      drainImuToBle();              // everything the IMU task queued since the last tick
+      ble_.poll();                  // flush a partial batch past its deadline
+      reportPerf(now);
       break;
 
-    default: break;
+    default: break;                 // BOOTING / SHUTTING_DOWN: timed by the FSM
   }
 }
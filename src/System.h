@@ -4,41 +4,73 @@
 #include "services/BleService.h"
 #include "services/ImuService.h"
 #include "services/PowerService.h"
+#include "services/RecorderService.h"
+#include "services/BulkService.h"
+#include "services/UiService.h"
+#include "system_fsm.h"
+#include "fsm_events.h"
 
-enum class SystemState { BOOTING, IDLE, STREAMING, SHUTTING_DOWN };
-
-class System {
+// System — owns the services and runs SystemFsm (lib/stridera_fsm) on the loop
+// task. The loop blocks on a task notification: BLE callbacks, the IMU task,
+// the bulk pump and the button poll raise events, the FSM and the services
+// report their next deadline, and nothing runs in between.
+class System : private ISystemPort {
 public:
-  void begin();   // one-time bring-up (board + services) and land in IDLE
-  void loop();    // poll inputs, run FSM, and perform state actions
+  void begin();   // one-time bring-up (board + services) and land in BOOTING
+  void loop();    // wait for an event or deadline, step the FSM, run state actions
 
 private:
-  void setState(SystemState s) { state_ = s; }
+  // Wake reasons that are not FSM inputs themselves
+  static constexpr uint32_t kWakeBle     = 1u << 16;   // connect / disconnect / subscribe / MTU
+  static constexpr uint32_t kWakeSamples = 1u << 17;   // the IMU task queued samples
+  static constexpr uint32_t kWakeBulk    = 1u << 18;   // a bulk transfer started or finished
+  static constexpr uint32_t kWakeUser    = 1u << 19;   // a button was pressed (backlight back on)
+
+  void raise(uint32_t ev);                      // any task: latch + notify the loop task
+  static void wakeBle(void* arg);               // service hooks -> raise(kWake*)
+  static void wakeImu(void* arg);
+  static void wakeBulk(void* arg);
+  static void centralGone(void* arg, uint16_t conn);   // NimBLE host task -> services with per-link state
+  static uint16_t requestRate(void* arg, uint16_t hz);   // control characteristic -> IMU rate
+  static uint16_t requestQuat(void* arg, uint16_t hz);   // control characteristic -> orientation rate
+  static void pollInput(void* arg);             // UI task (UI_POLL_MS, or a button IRQ when dark): buttons -> events
+  uint32_t nextWaitMs() const;                  // min(FSM, BLE, recorder) deadline
+
   void resetAllRuntimeState();  // clears volatile runtime state across services
+  void drainImuToBle();         // pop all queued IMU samples and hand them to BLE
+  void drainImuToRecorder();    // same, into the SD session recorder
+  void reportPerf(uint32_t now);  // [PERF] table every PERF_SERIAL_PERIOD_MS (STRIDERA_PERF builds)
 
-  // --- UI helpers ---
-  // --- UI helpers (new) ---
-  void drawHeader();                                 // small title at top
-  void drawCenteredLines(const char* line1,
-                         const char* line2 = "");    // 1–2 centered lines
-  void refreshStateBanner();                         // redraw only when needed
+  // ISystemPort (called from SystemFsm::step on the loop task)
+  bool connected() const override { return ble_.connected(); }
+  bool recorderBusy() const override { return rec_.busy(); }
+  void startStreaming() override;
+  void stopStreaming(bool unsubscribed) override;
+  bool startRecording() override;
+  void stopRecording() override;               // stop sampling, hand the tail to the recorder, close in background
+  void beginShutdown() override;
+  void finishShutdown() override;
+  void onTransition(SystemState from, SystemState to, uint32_t latency_us) override;
 
-  // transition requests (latched; consumed in loop)
-  bool reqStart_    = false;
-  bool reqStop_     = false;
-  bool reqShutdown_ = false;
+  // --- UI ---
+  void refreshStateBanner();                         // publish to the UI task only when needed
 
-  // --- state bookkeeping
-  SystemState state_ = SystemState::BOOTING;
-  uint32_t boot_ms_ = 0;
-  uint32_t shutdown_ms_ = 0;
+  SystemFsm     fsm_;
+  FsmEventLatch events_;
+  TaskHandle_t  loopTask_ = nullptr;
+  uint32_t      fsmWaitUs_ = 0;                 // from the last step()
+  uint32_t      perf_ms_ = 0;
 
-  // last-rendered flags to avoid flicker
+  // last-published flags to avoid redundant redraws
   SystemState lastDrawnState_ = (SystemState)255;
   bool lastDrawnConn_ = false;
   bool lastDrawnSub_  = false;
+  size_t lastDrawnSubs_ = 0;
 
   BleService   ble_;
   ImuService   imu_;
   PowerService power_;
+  RecorderService rec_;
+  BulkService     bulk_;
+  UiService       ui_;
 };
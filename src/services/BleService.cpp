@@ -1,21 +1,111 @@
 #include "BleService.h"
+#include "Perf.h"
+#include <soc/soc_caps.h>
+
+// LinkPolicy's view of the NimBLE host (raw GAP calls: plain 0/error return codes)
+class _NimbleLinkControl : public ILinkControl {
+public:
+  bool supports2M() const override {
+  #if SOC_BLE_50_SUPPORTED
+    return true;
+  #else
+    return false;                                // ESP32 classic controller is BLE 4.2
+  #endif
+  }
+
+  bool requestPhy(uint16_t conn, bool phy_2m) override {
+  #if SOC_BLE_50_SUPPORTED
+    const uint8_t mask = phy_2m ? BLE_GAP_LE_PHY_2M_MASK : BLE_GAP_LE_PHY_1M_MASK;
+    return ble_gap_set_prefered_le_phy(conn, mask, mask, BLE_GAP_LE_PHY_CODED_ANY) == 0;
+  #else
+    (void)conn; (void)phy_2m;
+    return false;
+  #endif
+  }
+
+  bool requestDataLen(uint16_t conn, uint16_t octets) override {
+    return ble_gap_set_data_len(conn, octets, (octets + 14) * 8) == 0;   // tx time at 1M, µs
+  }
+
+  bool requestParams(uint16_t conn, const LinkParams& p) override {
+    ble_gap_upd_params up{};
+    up.itvl_min            = p.min_interval;
+    up.itvl_max            = p.max_interval;
+    up.latency             = p.latency;
+    up.supervision_timeout = p.timeout;
+    return ble_gap_update_params(conn, &up) == 0;
+  }
+};
+
+static _NimbleLinkControl s_linkCtl;
+
+#ifdef CONFIG_BT_NIMBLE_MAX_CONNECTIONS
+static_assert(BLE_MAX_CENTRALS <= CONFIG_BT_NIMBLE_MAX_CONNECTIONS, "NimBLE cannot hold BLE_MAX_CENTRALS links");
+#endif
 
 class _BleServerCallbacks : public NimBLEServerCallbacks {
 public:
   _BleServerCallbacks(BleService* p): owner(p) {}
   void onConnect(NimBLEServer* s, NimBLEConnInfo& c) override {
-    owner->connected_ = true;
-    Serial.printf("[BLE] onConnect: %s\n", c.getAddress().toString().c_str());
+    const uint16_t conn = c.getConnHandle();
+    if (!owner->fan_.open(conn, c.getMTU())) {
+      Serial.printf("[BLE] onConnect: %s refused, %u centrals already\n", c.getAddress().toString().c_str(),
+                    (unsigned)BLE_MAX_CENTRALS);
+      s->disconnect(conn);
+      return;
+    }
+    LinkPolicy& link = owner->link_[owner->fan_.indexOf(conn)];
+    link.onConnect(conn, c.getConnInterval(), c.getConnLatency(), c.getConnTimeout(), millis());
+    link.setProfile(owner->profile_, millis());
+    Serial.printf("[BLE] onConnect: %s conn=%u (%u/%u) interval=%u latency=%u\n", c.getAddress().toString().c_str(),
+                  conn, (unsigned)owner->fan_.connected(), (unsigned)BLE_MAX_CENTRALS,
+                  c.getConnInterval(), c.getConnLatency());
+    if (owner->fan_.connected() < BLE_MAX_CENTRALS) owner->startAdvertising();   // room for another central
+    owner->kick();
   }
 
   void onDisconnect(NimBLEServer* s, NimBLEConnInfo& c, int reason) override {
-    owner->connected_ = false;
-    owner->subscribed_ = false;
-    owner->ev_stop_ = true;                      // if streaming, System will transition to IDLE
-    Serial.printf("[BLE] onDisconnect: reason=0x%02X (%d) peer=%s\n",
-                  reason, reason, c.getAddress().toString().c_str());
+    const uint16_t conn = c.getConnHandle();
+    const bool was = owner->subscribed();
+    const int i = owner->fan_.indexOf(conn);
+    if (i >= 0) owner->link_[i].onDisconnect();
+    owner->fan_.close(conn);                     // the other centrals keep streaming
+    owner->subscriptionEdge(was);                // stop only when it was the last subscriber
+    if (owner->discFn_) owner->discFn_(owner->discArg_, conn);
+    Serial.printf("[BLE] onDisconnect: reason=0x%02X (%d) peer=%s conn=%u (%u left)\n",
+                  reason, reason, c.getAddress().toString().c_str(), conn, (unsigned)owner->fan_.connected());
     owner->startAdvertising();
+    owner->kick();
+  }
+
+  void onMTUChange(uint16_t MTU, NimBLEConnInfo& c) override {
+    const int i = owner->fan_.indexOf(c.getConnHandle());
+    if (i < 0) return;
+    owner->fan_.at(i).setMtu(MTU);
+    owner->link_[i].onMtu(MTU);
+    owner->kick();
+    Serial.printf("[BLE] MTU=%u conn=%u (batch capacity %u samples)\n", MTU, c.getConnHandle(),
+                  (unsigned)stridera_batch_capacity(stridera_att_payload(MTU)));
+  }
+
+  void onConnParamsUpdate(NimBLEConnInfo& c) override {
+    const int i = owner->fan_.indexOf(c.getConnHandle());
+    if (i < 0) return;
+    owner->link_[i].onParams(c.getConnInterval(), c.getConnLatency(), c.getConnTimeout());
+    owner->kick();
+    Serial.printf("[BLE] conn params: conn=%u interval=%u (x1.25 ms) latency=%u timeout=%u\n",
+                  c.getConnHandle(), c.getConnInterval(), c.getConnLatency(), c.getConnTimeout());
+  }
+
+#if SOC_BLE_50_SUPPORTED
+  void onPhyUpdate(NimBLEConnInfo& c, uint8_t txPhy, uint8_t rxPhy) override {
+    const int i = owner->fan_.indexOf(c.getConnHandle());
+    if (i < 0) return;
+    owner->link_[i].onPhy(txPhy, rxPhy);
+    owner->kick();
+    Serial.printf("[BLE] PHY conn=%u tx=%u rx=%u\n", c.getConnHandle(), txPhy, rxPhy);
   }
+#endif
 private:
   BleService* owner;
 };
@@ -23,16 +113,102 @@ private:
 class _BleCharCallbacks : public NimBLECharacteristicCallbacks {
 public:
   _BleCharCallbacks(BleService* p): owner(p) {}
-  void onSubscribe(NimBLECharacteristic*, NimBLEConnInfo& info, uint16_t subVal) override {
+  void onSubscribe(NimBLECharacteristic* chr, NimBLEConnInfo& info, uint16_t subVal) override {
     const bool notifyOn = (subVal & 0x0001);
-    if (notifyOn) {
-      owner->subscribed_ = true;
-      owner->ev_start_   = true;
-    } else {
-      owner->subscribed_ = false;
-      owner->ev_stop_    = true;
+    BleService::Fan::Stream* s = owner->fan_.find(info.getConnHandle());
+    if (!s) return;
+    const bool was = owner->subscribed();
+
+    if (chr == owner->chrBatch_)     s->setBatch(notifyOn);
+    else if (chr == owner->chrGait_) s->setGait(notifyOn);
+    else if (chr == owner->chrQuat_) s->setQuat(notifyOn);
+    else if (chr == owner->chr_)     s->setLegacy(notifyOn);
+    else return;                                 // diagnostics: does not drive streaming
+    s->setMtu(info.getMTU());
+
+    // Edges only on the first subscribe / last unsubscribe across all centrals
+    owner->subscriptionEdge(was);
+
+    Serial.printf("[BLE] notify=%s %s (conn=%u, %u subscribed)\n", notifyOn ? "on" : "off",
+                  chr == owner->chrBatch_ ? "batch" : chr == owner->chrGait_ ? "gait" :
+                  chr == owner->chrQuat_ ? "quat" : "single",
+                  info.getConnHandle(), (unsigned)owner->fan_.subscribed());
+    owner->kick();
+  }
+
+  // Format characteristic: [batch format, single-sample packet version, v2 flags,
+  // v2 channel mask]; a 1-byte write (older centrals) only picks the batch format
+  // and keeps v1. The mask is cut to what the device samples (0 = accel).
+  void onRead(NimBLECharacteristic* chr, NimBLEConnInfo& info) override {
+    if (chr == owner->chrDiag_) {
+      const int i = owner->fan_.indexOf(info.getConnHandle());
+      if (i < 0) return;
+      const StrideraLinkDiag d = owner->diag((size_t)i);   // the reader's link, not the last one notified
+      chr->setValue(reinterpret_cast<const uint8_t*>(&d), sizeof(d));
+      return;
+    }
+    if (chr == owner->chrControl_) {
+      const StrideraControl c = owner->control(owner->fan_.find(info.getConnHandle()));
+      chr->setValue(reinterpret_cast<const uint8_t*>(&c), sizeof(c));
+      return;
+    }
+    if (chr != owner->chrFormat_) return;
+    const BleService::Fan::Stream* s = owner->fan_.find(info.getConnHandle());
+    const uint8_t v[4] = { s ? s->format() : (uint8_t)STRIDERA_FORMAT_BATCH,
+                           s ? s->version() : (uint8_t)STRIDERA_PACKET_V1,
+                           (uint8_t)(s && s->crc() ? STRIDERA_V2_F_CRC : 0),
+                           s ? s->channels() : (uint8_t)STRIDERA_CH_ACCEL };
+    chr->setValue(v, sizeof(v));                 // each central reads back its own settings
+  }
+
+  void onWrite(NimBLECharacteristic* chr, NimBLEConnInfo& info) override {
+    if (chr == owner->chrControl_) {
+      BleService::Fan::Stream* s = owner->fan_.find(info.getConnHandle());
+      if (!s) return;
+      const NimBLEAttValue v = chr->getValue();
+      const StrideraControl c = owner->applyControl(*s, v.data(), v.size());
+      chr->setValue(reinterpret_cast<const uint8_t*>(&c), sizeof(c));
+      chr->notify(reinterpret_cast<const uint8_t*>(&c), sizeof(c), info.getConnHandle());   // reply to the writer
+      Serial.printf("[BLE] control rate=%u batch=%u format=%u single=v%u flags=0x%02X channels=0x%02X quat=%u status=%u (conn=%u)\n",
+                    c.rate_hz, c.batch_samples, c.format, c.packet_version, c.flags, c.channels, c.quat_hz, c.status,
+                    info.getConnHandle());
+      return;
+    }
+    if (chr != owner->chrFormat_) return;
+    BleService::Fan::Stream* s = owner->fan_.find(info.getConnHandle());
+    if (!s) return;
+    const NimBLEAttValue v = chr->getValue();
+    const uint8_t fmt = v.size() ? v[0] : 0xFF;
+    if (fmt == STRIDERA_FORMAT_BATCH || fmt == STRIDERA_FORMAT_DELTA || fmt == STRIDERA_FORMAT_V2) {
+      s->setFormat(fmt);                         // applied at the next frame boundary
     }
-    Serial.printf("[BLE] notify=%s (conn=%u)\n", notifyOn ? "on" : "off", info.getConnHandle());
+    if (v.size() >= 2 && (v[1] == STRIDERA_PACKET_V1 || v[1] == STRIDERA_PACKET_V2)) s->setVersion(v[1]);
+    if (v.size() >= 3) s->setCrc(v[2] & STRIDERA_V2_F_CRC);
+    if (v.size() >= 4) s->setChannels(v[3] & owner->channels_);
+    const uint8_t applied[4] = { s->format(), s->version(), (uint8_t)(s->crc() ? STRIDERA_V2_F_CRC : 0), s->channels() };
+    chr->setValue(applied, sizeof(applied));     // read back = what is actually used
+    Serial.printf("[BLE] stream format=%s single=v%u%s channels=0x%02X (conn=%u)\n",
+                  applied[0] == STRIDERA_FORMAT_DELTA ? "delta" : applied[0] == STRIDERA_FORMAT_V2 ? "v2" : "batch",
+                  applied[1], applied[2] ? " crc" : "", applied[3], info.getConnHandle());
+  }
+private:
+  BleService* owner;
+};
+
+// Where FanOut hands finished frames: a notify to one connection handle
+class _BleFanOutSink : public IFanOutSink {
+public:
+  _BleFanOutSink(BleService* p): owner(p) {}
+  bool notify(uint16_t conn, FanOutChannel ch, const uint8_t* data, size_t len) override {
+    const int i = owner->fan_.indexOf(conn);
+    if (i < 0) return true;                      // gone; sync() drops its queue on the next pump
+    const BleService::Fan::Stream& s = owner->fan_.at(i);
+    NimBLECharacteristic* chr = ch == FanOutChannel::Legacy ? owner->chr_ : owner->chrBatch_;
+    if (!chr || !(ch == FanOutChannel::Legacy ? s.legacy() : s.batch())) return true;   // unsubscribed meanwhile
+    STRIDERA_PERF_SCOPE(g_perf.bleNotify);
+    const bool ok = chr->notify(data, len, conn);  // false = host out of buffers: stays queued
+    owner->link_[i].countNotify(ok);
+    return ok;
   }
 private:
   BleService* owner;
@@ -40,7 +216,7 @@ private:
 
 void BleService::begin() {
   NimBLEDevice::init(STRIDERA_DEVICE_NAME);
-  NimBLEDevice::setMTU(247);
+  NimBLEDevice::setMTU(BLE_PREFERRED_MTU);
   NimBLEDevice::setPower(ESP_PWR_LVL_P9);
   NimBLEDevice::setSecurityAuth(false, false, false);
   NimBLEDevice::setSecurityIOCap(BLE_HS_IO_NO_INPUT_OUTPUT);
@@ -53,10 +229,61 @@ void BleService::begin() {
       STRIDERA_CHAR_UUID,
       NIMBLE_PROPERTY::NOTIFY | NIMBLE_PROPERTY::READ
   );
-  chr_->setCallbacks(new _BleCharCallbacks(this));
+  chrBatch_ = service_->createCharacteristic(
+      STRIDERA_BATCH_CHAR_UUID,
+      NIMBLE_PROPERTY::NOTIFY
+  );
+  chrFormat_ = service_->createCharacteristic(
+      STRIDERA_FORMAT_CHAR_UUID,
+      NIMBLE_PROPERTY::READ | NIMBLE_PROPERTY::WRITE
+  );
+  const uint8_t fmt[4] = { STRIDERA_FORMAT_BATCH, STRIDERA_PACKET_V1, 0, STRIDERA_CH_ACCEL };
+  chrFormat_->setValue(fmt, sizeof(fmt));
+  chrDiag_ = service_->createCharacteristic(
+      STRIDERA_LINK_DIAG_CHAR_UUID,
+      NIMBLE_PROPERTY::READ | NIMBLE_PROPERTY::NOTIFY
+  );
+  const StrideraLinkDiag diag = link_[0].diag();          // placeholder until a central connects
+  chrDiag_->setValue(reinterpret_cast<const uint8_t*>(&diag), sizeof(diag));
+  chrGait_ = service_->createCharacteristic(
+      STRIDERA_GAIT_CHAR_UUID,
+      NIMBLE_PROPERTY::READ | NIMBLE_PROPERTY::NOTIFY
+  );
+  chrControl_ = service_->createCharacteristic(
+      STRIDERA_CONTROL_CHAR_UUID,
+      NIMBLE_PROPERTY::READ | NIMBLE_PROPERTY::WRITE | NIMBLE_PROPERTY::NOTIFY
+  );
+  const StrideraControl ctl = control(nullptr);
+  chrControl_->setValue(reinterpret_cast<const uint8_t*>(&ctl), sizeof(ctl));
+  chrQuat_ = service_->createCharacteristic(
+      STRIDERA_QUAT_CHAR_UUID,
+      NIMBLE_PROPERTY::READ | NIMBLE_PROPERTY::NOTIFY
+  );
+#if STRIDERA_PERF
+  chrPerf_ = service_->createCharacteristic(
+      STRIDERA_PERF_CHAR_UUID,
+      NIMBLE_PROPERTY::READ | NIMBLE_PROPERTY::NOTIFY
+  );
+#endif
+
+  auto charCallbacks = new _BleCharCallbacks(this);
+  chr_->setCallbacks(charCallbacks);
+  chrBatch_->setCallbacks(charCallbacks);
+  chrFormat_->setCallbacks(charCallbacks);
+  chrDiag_->setCallbacks(charCallbacks);
+  chrGait_->setCallbacks(charCallbacks);
+  chrControl_->setCallbacks(charCallbacks);
+  chrQuat_->setCallbacks(charCallbacks);
+  if (chrPerf_) chrPerf_->setCallbacks(charCallbacks);
+  if (!sink_) sink_ = new _BleFanOutSink(this);
+
+  CongestionConfig cong;
+  cong.window_ms    = BLE_CONG_WINDOW_MS;
+  cong.calm_windows = BLE_CONG_CALM_WINDOWS;
+  cong.max_level    = BLE_CONG_MAX_LEVEL;
+  fan_.setCongestion(cong);
 
   service_->start();
-  startAdvertising();
 }
 
 void BleService::end() {
@@ -65,11 +292,59 @@ void BleService::end() {
   server_ = nullptr;
   service_ = nullptr;
   chr_ = nullptr;
+  chrBatch_ = nullptr;
+  chrFormat_ = nullptr;
+  chrDiag_ = nullptr;
+  chrGait_ = nullptr;
+  chrPerf_ = nullptr;
+  chrControl_ = nullptr;
+  chrQuat_ = nullptr;
+}
+
+StrideraControl BleService::control(const Fan::Stream* s) const {
+  StrideraControl c;
+  c.version        = STRIDERA_CONTROL_VERSION;
+  c.fields         = 0;
+  c.rate_hz        = rateHz_;
+  c.batch_samples  = s ? s->batchLimit() : 0;
+  c.format         = s ? s->format() : (uint8_t)STRIDERA_FORMAT_BATCH;
+  c.packet_version = s ? s->version() : (uint8_t)STRIDERA_PACKET_V1;
+  c.flags          = s && s->crc() ? STRIDERA_V2_F_CRC : 0;
+  c.channels       = s ? s->channels() : (uint8_t)STRIDERA_CH_ACCEL;
+  c.status         = STRIDERA_CTL_OK;
+  c.quat_hz        = quatHz_;
+  return c;
+}
+
+StrideraControl BleService::applyControl(Fan::Stream& s, const uint8_t* data, size_t len) {
+  StrideraControl c = stridera_control_resolve(data, len, control(&s), channels_);
+  if (c.status == STRIDERA_CTL_REJECTED) return c;
+  if (c.fields & STRIDERA_CTL_RATE) {
+    const uint16_t want = c.rate_hz;
+    c.rate_hz = rateFn_ ? rateFn_(rateArg_, want) : rateHz_;
+    rateHz_   = c.rate_hz;
+    if (c.rate_hz != want) c.status = STRIDERA_CTL_ADJUSTED;
+  }
+  // After the rate: the orientation rate is capped by it
+  if (c.fields & STRIDERA_CTL_QUAT) {
+    const uint16_t want = c.quat_hz;
+    c.quat_hz = quatFn_ ? quatFn_(quatArg_, want) : 0;
+    quatHz_   = c.quat_hz;
+    if (c.quat_hz != want) c.status = STRIDERA_CTL_ADJUSTED;
+  }
+  // Per-connection settings; the fan-out closes the open frame before using them
+  s.setBatchLimit(c.batch_samples);
+  s.setFormat(c.format);
+  s.setVersion(c.packet_version);
+  s.setCrc(c.flags & STRIDERA_V2_F_CRC);
+  s.setChannels(c.channels);
+  return c;
 }
 
 void BleService::reset() {
   // clear only volatile/runtime flags (not GATT)
-  subscribed_ = false;
+  for (size_t i = 0; i < Fan::capacity(); ++i) fan_.at(i).unsubscribeAll();
+  fan_.discard();
   ev_start_ = false;
   ev_stop_ = false;
 }
@@ -83,8 +358,86 @@ bool BleService::shouldStopStreaming() {
   return false;
 }
 
+void BleService::subscriptionEdge(bool was) {
+  const bool now = subscribed();
+  if (!was && now) ev_start_ = true;
+  if (was && !now) ev_stop_  = true;             // if streaming, System will transition to IDLE
+}
+
+void BleService::pump() {
+  fan_.sync([](uint16_t conn, const FanOutStats& st) {
+    const uint32_t total = st.samples + st.dropped_samples;
+    if (!total) return;
+    Serial.printf("[BLE] conn=%u: %lu samples in %lu notifies (%llu B), dropped %lu (%.1f%%), "
+                  "decimated %lu, busy %lu, queue high-water %u/%u\n", conn, (unsigned long)st.samples,
+                  (unsigned long)st.frames, (unsigned long long)st.bytes, (unsigned long)st.dropped_samples,
+                  100.0f * st.dropped_samples / total, (unsigned long)st.decimated_samples,
+                  (unsigned long)st.busy, st.queue_high_water, (unsigned)BLE_FANOUT_QUEUE);
+  });
+  if (sink_) fan_.pump(*sink_, BLE_FANOUT_BURST);
+
+  for (size_t i = 0; i < Fan::capacity(); ++i) {
+    const Fan::Stream& s = fan_.at(i);
+    const uint8_t level = s.streamConn() != STRIDERA_CONN_NONE ? s.congestion().level : 0;
+    if (level == congLevel_[i]) continue;
+    if (s.streamConn() != STRIDERA_CONN_NONE) {
+      Serial.printf("[BLE] conn=%u congestion level %u -> %u (queue %u/%u)\n", s.streamConn(), congLevel_[i], level,
+                    (unsigned)s.queued(), (unsigned)BLE_FANOUT_QUEUE);
+    }
+    congLevel_[i] = level;
+  }
+}
+
 void BleService::poll() {
-  // nothing needed currently
+  // Latency deadline for partially filled frames when no new sample arrives, then retry what is queued
+  const uint32_t now = millis();
+  fan_.flushDue(now, BLE_BATCH_MAX_LATENCY_MS);
+  pump();
+
+  for (size_t i = 0; i < Fan::capacity(); ++i) link_[i].tick(s_linkCtl, now);
+  if (connected() && chrDiag_ && now - diagMs_ >= BLE_LINK_DIAG_PERIOD_MS) {
+    diagMs_ = now;
+    for (size_t i = 0; i < Fan::capacity(); ++i) {
+      const Fan::Stream& s = fan_.at(i);
+      if (!s.used()) continue;
+      const StrideraLinkDiag d = diag(i);          // to its own central only; reads are answered per connection
+      chrDiag_->notify(reinterpret_cast<const uint8_t*>(&d), sizeof(d), s.conn());   // no-op unless subscribed
+    }
+  #if STRIDERA_PERF
+    uint8_t snap[sizeof(StrideraPerfHeader) + 8 * sizeof(StrideraPerfEntry)];
+    chrPerf_->setValue(snap, g_perf.snapshot(snap, sizeof(snap)));
+    chrPerf_->notify();
+  #endif
+  }
+}
+
+StrideraLinkDiag BleService::diag(size_t i) const {
+  const Fan::Stream& s = fan_.at(i);
+  StrideraLinkDiag d = link_[i].diag();            // each central sees its own link
+  d.congestion        = s.congestion().level;      // ... and what backpressure cost its stream
+  d.dropped_samples   = s.stats().dropped_samples;
+  d.decimated_samples = s.stats().decimated_samples;
+  if (d.congestion) d.flags |= STRIDERA_LINK_F_CONGESTED;
+  return d;
+}
+
+uint32_t BleService::pollDueMs() const {
+  const uint32_t now = millis();
+  uint32_t due = fan_.dueMs(now, BLE_BATCH_MAX_LATENCY_MS, BLE_FANOUT_RETRY_MS);
+  if (connected()) {
+    const uint32_t age  = now - diagMs_;
+    uint32_t next = age >= BLE_LINK_DIAG_PERIOD_MS ? 0 : BLE_LINK_DIAG_PERIOD_MS - age;
+    for (size_t i = 0; i < Fan::capacity(); ++i) {
+      if (fan_.at(i).used() && !link_[i].settled() && BLE_LINK_POLL_MS < next) next = BLE_LINK_POLL_MS;
+    }
+    if (next < due) due = next;
+  }
+  return due;
+}
+
+void BleService::setLinkProfile(uint8_t profile) {
+  profile_ = profile;
+  for (auto& l : link_) l.setProfile(profile, millis());
 }
 
 void BleService::startAdvertising() {
@@ -121,15 +474,46 @@ void BleService::stopAdvertising() {
 }
 
 void BleService::stopNotifications() {
-  subscribed_ = false;
+  for (size_t i = 0; i < Fan::capacity(); ++i) fan_.at(i).unsubscribeAll();
+  fan_.discard();
 }
 
 void BleService::flush() {
-  // add ring buffer flush later if you buffer packets
+  fan_.flushDue(millis(), 0);                    // close every partial frame
+  pump();
+}
+
+void BleService::sendImu(const StrideraSample& pkt) {
+  if (!subscribed()) return;
+
+  bool legacy = false;
+  for (size_t i = 0; i < Fan::capacity(); ++i) legacy |= fan_.at(i).used() && fan_.at(i).legacy();
+  if (legacy && chr_) chr_->setValue((uint8_t*)&pkt.v1, sizeof(pkt.v1));   // read = latest sample (v1)
+
+  // Single: one v1 or v2 packet per notification; batched: coalesced per central until
+  // its frame is full or the latency deadline expires. Each central has its own queue.
+  fan_.push(pkt, millis());
+  pump();
 }
 
-void BleService::sendImu(const StrideraAccelPacket& pkt) {
-  if (!connected_ || !subscribed_ || !chr_) return;
-  chr_->setValue((uint8_t*)&pkt, sizeof(pkt));
-  chr_->notify((uint8_t*)&pkt, sizeof(pkt));
+void BleService::sendGait(const StrideraGaitPacket& ev) {
+  if (!connected() || !chrGait_) return;
+  chrGait_->setValue(reinterpret_cast<const uint8_t*>(&ev), sizeof(ev));   // read = latest step
+  for (size_t i = 0; i < Fan::capacity(); ++i) {
+    const Fan::Stream& s = fan_.at(i);
+    if (!s.used() || !s.gait()) continue;
+    STRIDERA_PERF_SCOPE(g_perf.bleNotify);
+    link_[i].countNotify(chrGait_->notify(reinterpret_cast<const uint8_t*>(&ev), sizeof(ev), s.conn()));
+  }
+}
+
+void BleService::sendQuat(const StrideraQuatPacket& q) {
+  if (!connected() || !chrQuat_) return;
+  chrQuat_->setValue(reinterpret_cast<const uint8_t*>(&q), sizeof(q));     // read = latest orientation
+  for (size_t i = 0; i < Fan::capacity(); ++i) {
+    const Fan::Stream& s = fan_.at(i);
+    if (!s.used() || !s.quat()) continue;
+    STRIDERA_PERF_SCOPE(g_perf.bleNotify);
+    link_[i].countNotify(chrQuat_->notify(reinterpret_cast<const uint8_t*>(&q), sizeof(q), s.conn()));
+  }
 }
@@ -2,44 +2,110 @@
 #include <Arduino.h>
 #include <NimBLEDevice.h>
 #include "stridera_packet.h"
+#include "stridera_batch.h"
+#include "stridera_delta.h"
+#include "stridera_control.h"
+#include "fanout.h"
+#include "stridera_link_diag.h"
+#include "stridera_gait.h"
+#include "stridera_quat.h"
+#include "link_policy.h"
 #include "config.h"
 
 class BleService {
 public:
-  void begin();
+  void begin();                                  // GATT only; call startAdvertising() once all services exist
   void end();
   void reset();                                  // clear runtime flags/queues
 
   // Event edges (latched until read; System should poll and clear them)
-  bool shouldStartStreaming();                   // true once when client subscribes
-  bool shouldStopStreaming();                    // true once when client unsubscribes or disconnects
+  bool shouldStartStreaming();                   // true once when the first central subscribes
+  bool shouldStopStreaming();                    // true once when the last one unsubscribes or disconnects
 
-  // Runtime status
-  bool connected() const { return connected_; }
-  bool subscribed() const { return subscribed_; }
+  // Runtime status (any of up to BLE_MAX_CENTRALS centrals)
+  bool connected() const { return fan_.connected() > 0; }
+  bool subscribed() const { return fan_.subscribed() > 0; }
+  size_t centrals() const { return fan_.connected(); }
+  size_t subscribers() const { return fan_.subscribed(); }
+  NimBLEServer* server() const { return server_; }   // for additional services (bulk download)
+
+  // Loop wake-up: called from NimBLE callbacks on connect/disconnect/subscribe/link changes
+  using WakeFn = void (*)(void*);
+  void setWake(WakeFn fn, void* arg) { wake_ = fn; wakeArg_ = arg; }
+  uint32_t pollDueMs() const;                    // ms until poll() has work (UINT32_MAX = none)
+  // Also from NimBLE: a central disconnected (per-link state in other services, e.g. bulk)
+  using ConnFn = void (*)(void* arg, uint16_t conn);
+  void setDisconnectHook(ConnFn fn, void* arg) { discFn_ = fn; discArg_ = arg; }
 
   // Operations
-  void poll();                                   // keep alive if needed
+  void poll();                                   // batch deadlines, queued frames, link negotiation, diagnostics
+  void setLinkProfile(uint8_t profile);          // STRIDERA_LINK_PROFILE_*: what the link should be tuned for
   void startAdvertising();
   void stopAdvertising();
   void stopNotifications();
-  void flush();
-  void sendImu(const StrideraAccelPacket& pkt);  // notify if subscribed
+  void flush();                                  // send partially filled frames and whatever is queued
+  void sendImu(const StrideraSample& pkt);       // fan out to every subscribed central (single and/or batched)
+  void sendGait(const StrideraGaitPacket& ev);   // low-rate step/cadence events
+  void sendQuat(const StrideraQuatPacket& q);    // orientation at the control's quat_hz
+  void setChannels(uint8_t mask) { channels_ = mask; }   // STRIDERA_CH_* the samples carry (v2 masks are cut to it)
+
+  // Control characteristic: the sample rate is device-wide and owned by the sampler.
+  // `fn` runs on the NimBLE host task and returns the rate that will actually run.
+  using RateFn = uint16_t (*)(void* arg, uint16_t hz);
+  void setRateControl(RateFn fn, void* arg, uint16_t current_hz) { rateFn_ = fn; rateArg_ = arg; rateHz_ = current_hz; }
+  // Same for the orientation rate (owned by the sampler's filter); 0 = off
+  void setQuatControl(RateFn fn, void* arg, uint16_t current_hz) { quatFn_ = fn; quatArg_ = arg; quatHz_ = current_hz; }
+
+  using Fan = FanOut<BLE_MAX_CENTRALS, BLE_FANOUT_QUEUE, stridera_att_payload(BLE_PREFERRED_MTU)>;
 
 private:
+  void kick() { if (wake_) wake_(wakeArg_); }
+  void pump();                                   // sync connects/disconnects, hand queued frames to NimBLE
+  void subscriptionEdge(bool was);               // latch start/stop on the first / last subscriber
+  StrideraControl control(const Fan::Stream* s) const;          // a central's current settings
+  StrideraLinkDiag diag(size_t i) const;                       // fan_ slot i's link + stream costs
+  StrideraControl applyControl(Fan::Stream& s, const uint8_t* data, size_t len);  // write -> applied
+
   NimBLEServer*        server_ = nullptr;
   NimBLEService*       service_ = nullptr;
-  NimBLECharacteristic* chr_   = nullptr;
+  NimBLECharacteristic* chr_   = nullptr;        // legacy: one 12-byte packet per notify
+  NimBLECharacteristic* chrBatch_ = nullptr;     // batched frames sized to the MTU
+  NimBLECharacteristic* chrFormat_ = nullptr;    // per-connection encoding of chrBatch_
+  NimBLECharacteristic* chrDiag_ = nullptr;      // negotiated link values + notify rate
+  NimBLECharacteristic* chrGait_ = nullptr;      // step events instead of raw samples
+  NimBLECharacteristic* chrPerf_ = nullptr;      // hot-path timing snapshot (STRIDERA_PERF builds)
+  NimBLECharacteristic* chrControl_ = nullptr;   // runtime rate / batch / format / channels
+  NimBLECharacteristic* chrQuat_ = nullptr;      // orientation instead of raw accel + gyro
 
-  volatile bool connected_  = false;
-  volatile bool subscribed_ = false;
+  // Per-central subscriptions, MTU, format, open frame and send queue
+  Fan           fan_;
+  IFanOutSink*  sink_ = nullptr;                 // notify() per connection handle
 
   // Latched edge flags
   volatile bool ev_start_ = false;
   volatile bool ev_stop_  = false;
 
+  // PHY / DLE / connection interval negotiation, one per fan_ slot
+  LinkPolicy link_[BLE_MAX_CENTRALS];
+  uint8_t    congLevel_[BLE_MAX_CENTRALS] = {};  // last congestion level logged per fan_ slot
+  uint8_t    profile_ = STRIDERA_LINK_PROFILE_IDLE;
+  uint8_t    channels_ = STRIDERA_CH_ACCEL;
+  RateFn            rateFn_  = nullptr;
+  void*             rateArg_ = nullptr;
+  volatile uint16_t rateHz_  = IMU_SAMPLE_RATE_HZ;   // as last applied
+  RateFn            quatFn_  = nullptr;
+  void*             quatArg_ = nullptr;
+  volatile uint16_t quatHz_  = 0;
+  uint32_t   diagMs_ = 0;
+
+  WakeFn wake_    = nullptr;
+  void*  wakeArg_ = nullptr;
+  ConnFn discFn_  = nullptr;
+  void*  discArg_ = nullptr;
+
   bool advConfigured_ = false; 
 
   friend class _BleServerCallbacks;
   friend class _BleCharCallbacks;
+  friend class _BleFanOutSink;
 };
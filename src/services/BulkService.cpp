@@ -0,0 +1,334 @@
+#include "BulkService.h"
+
+#if STRIDERA_HAS_SD
+  #include <SD.h>
+#else
+  #include <SPIFFS.h>
+#endif
+
+class _BulkCtrlCallbacks : public NimBLECharacteristicCallbacks {
+public:
+  _BulkCtrlCallbacks(BulkService* p): owner(p) {}
+  void onWrite(NimBLECharacteristic* chr, NimBLEConnInfo& info) override {
+    const NimBLEAttValue v = chr->getValue();
+    if (v.size() == 0) return;
+
+    BulkService::Cmd c{};
+    c.op   = v[0];
+    if (c.op & BulkService::kOpInternal) return;
+    c.conn = info.getConnHandle();
+    c.mtu  = info.getMTU();
+    if (c.op == STRIDERA_BULK_OP_GET && v.size() > offsetof(StrideraBulkGet, name)) {
+      StrideraBulkGet g{};
+      memcpy(&g, v.data(), v.size() < sizeof(g) ? v.size() : sizeof(g));
+      c.offset  = g.offset;
+      c.credits = g.credits;
+      memcpy(c.name, g.name, STRIDERA_BULK_NAME_LEN);
+    } else if (c.op == STRIDERA_BULK_OP_CREDIT && v.size() >= sizeof(StrideraBulkCredit)) {
+      StrideraBulkCredit cr;
+      memcpy(&cr, v.data(), sizeof(cr));
+      c.credits = cr.credits;
+    } else if (c.op == STRIDERA_BULK_OP_CAPTURE && v.size() >= 2) {
+      StrideraBulkCapture cap{};
+      memcpy(&cap, v.data(), v.size() < sizeof(cap) ? v.size() : sizeof(cap));
+      if (cap.action == STRIDERA_CAPTURE_CONFIG && v.size() < sizeof(cap)) return;   // truncated config
+      c.action  = cap.action;
+      c.capture = cap.config;
+    }
+    xQueueSend(owner->queue_, &c, 0);             // never block the NimBLE host task
+  }
+private:
+  BulkService* owner;
+};
+
+void BulkService::begin(NimBLEServer* server) {
+  server_ = server;
+  if (!server_) return;
+
+  NimBLEService* svc = server_->createService(STRIDERA_BULK_SERVICE_UUID);
+  ctrl_ = svc->createCharacteristic(STRIDERA_BULK_CTRL_UUID,
+                                    NIMBLE_PROPERTY::WRITE | NIMBLE_PROPERTY::WRITE_NR);
+  data_ = svc->createCharacteristic(STRIDERA_BULK_DATA_UUID, NIMBLE_PROPERTY::NOTIFY);
+  ctrl_->setCallbacks(new _BulkCtrlCallbacks(this));
+  svc->start();
+  link_.chr = data_;
+
+#if !STRIDERA_HAS_SD
+  SPIFFS.begin(true);                              // no-op if replay already mounted it
+#endif
+
+  queue_ = xQueueCreate(8, sizeof(Cmd));
+  xTaskCreatePinnedToCore(&BulkService::taskEntry, "bulk", BULK_TASK_STACK, this,
+                          BULK_TASK_PRIO, &task_, BULK_TASK_CORE);
+}
+
+void BulkService::setCapture(CaptureBuffer* cap) {
+  capture_ = cap;
+  captureSrc_.attach(cap);
+  if (cap) cap->setWake(&BulkService::captureFrozen, this);
+}
+
+void BulkService::captureFrozen(void* arg) {
+  auto* self = static_cast<BulkService*>(arg);
+  Cmd c{};
+  c.op = kOpCaptureFrozen;
+  if (self->queue_) xQueueSend(self->queue_, &c, 0);   // never block the IMU task
+}
+
+void BulkService::onDisconnect(uint16_t conn) {
+  Cmd c{};
+  c.op   = kOpDisconnect;
+  c.conn = conn;
+  if (queue_) xQueueSendToFront(queue_, &c, 0);    // ahead of credits the central can no longer use
+}
+
+fs::FS& BulkService::storage() {
+#if STRIDERA_HAS_SD
+  return SD;
+#else
+  return SPIFFS;
+#endif
+}
+
+// ---------- pump task ----------
+void BulkService::taskEntry(void* arg) {
+  static_cast<BulkService*>(arg)->taskLoop();
+}
+
+void BulkService::taskLoop() {
+  TickType_t wait = portMAX_DELAY;
+  for (;;) {
+    Cmd c;
+    if (xQueueReceive(queue_, &c, wait) == pdTRUE) {
+      handle(c);
+      while (xQueueReceive(queue_, &c, 0) == pdTRUE) handle(c);
+    }
+
+    if (!tx_.active()) { wait = portMAX_DELAY; continue; }
+
+    const uint32_t stallsBefore = tx_.stalls();
+    tx_.pump(link_, micros(), BULK_CHUNKS_PER_PUMP);
+
+    if (!tx_.active()) {                           // EOF / error / abort status went out
+      Serial.printf("[BULK] %s: %u/%u bytes, %u B/s, %u link stalls\n",
+                    current_, tx_.offset(), tx_.size(), tx_.bytesPerSec(), tx_.stalls());
+      finished();
+      wait = portMAX_DELAY;
+    } else if (tx_.stalls() != stallsBefore) {     // controller out of buffers (a lost link arrives as kOpDisconnect)
+      wait = pdMS_TO_TICKS(BULK_RETRY_MS);
+    } else {
+      wait = tx_.waitingForCredits() ? portMAX_DELAY : 0;   // credits arrive as CREDIT commands
+    }
+  }
+}
+
+void BulkService::finished() {
+  if (sendingCapture_) {
+    sendingCapture_ = false;
+    if (tx_.size() && tx_.offset() == tx_.size() && capture_) {   // all of it arrived: record again
+      capture_->rearm();
+      Serial.println("[BULK] capture delivered, re-armed");
+    }
+  } else {
+    src_.close();
+  }
+  kick();
+  if (captureReady_ && capture_ && capture_->frozen()) sendStatus(STRIDERA_BULK_CAPTURE_READY, capture_->size());
+  captureReady_ = false;
+}
+
+void BulkService::handle(const Cmd& c) {
+  if (c.op == kOpDisconnect) { linkLost(c.conn); return; }
+  if (!(c.op & kOpInternal)) {
+    if (tx_.active() && c.conn != link_.conn) {    // the running transfer's central owns the service
+      sendStatusTo(c.conn, STRIDERA_BULK_ERR_BUSY);
+      return;
+    }
+    link_.conn = c.conn;
+    link_.mtu  = c.mtu;
+  }
+
+  switch (c.op) {
+    case STRIDERA_BULK_OP_LIST:
+      if (!tx_.active()) sendList();
+      break;
+
+    case STRIDERA_BULK_OP_GET: {
+      const bool capture = strcmp(c.name, STRIDERA_CAPTURE_NAME) == 0;
+      if (!capture && !stridera_bulk_session_name(c.name)) {   // no paths, nothing LIST would not show
+        Serial.printf("[BULK] GET \"%s\" refused\n", c.name);
+        sendStatus(STRIDERA_BULK_ERR_NAME);
+        break;
+      }
+      if (tx_.active()) { tx_.reset(); sendingCapture_ = false; src_.close(); }
+      snprintf(current_, sizeof(current_), "/%s", c.name);
+      IBulkSource* src = &src_;
+      if (capture) {                                   // from memory while frozen
+        if (!capture_ || !capture_->frozen()) {
+          sendStatus(STRIDERA_BULK_ERR_NOTFOUND);
+          break;
+        }
+        src = &captureSrc_;
+        sendingCapture_ = true;
+      } else if (!src_.open(storage(), current_)) {
+        sendStatus(STRIDERA_BULK_ERR_NOTFOUND);
+        break;
+      }
+      tx_.start(src, c.offset, c.credits, micros());
+      kick();
+      Serial.printf("[BULK] GET %s from %u (%u bytes, %u credits)\n",
+                    current_, c.offset, src->size(), c.credits);
+      break;
+    }
+
+    case STRIDERA_BULK_OP_CREDIT:
+      tx_.addCredits(c.credits);
+      break;
+
+    case STRIDERA_BULK_OP_ABORT:
+      tx_.abort();
+      break;
+
+    case STRIDERA_BULK_OP_CAPTURE:
+      handleCapture(c);
+      break;
+
+    case kOpCaptureFrozen: {
+      if (!capture_ || !capture_->frozen()) break;
+      const StrideraCaptureHeader& h = capture_->header();
+      Serial.printf("[BULK] capture #%u frozen: cause %u (%u), %u records, %u before the trigger, %u bytes\n",
+                    h.capture, h.cause, h.trigger_value, h.record_count, h.trigger_record, capture_->size());
+      if (tx_.active()) captureReady_ = true;      // announced when the current transfer ends
+      else sendStatus(STRIDERA_BULK_CAPTURE_READY, capture_->size());
+      break;
+    }
+
+    default: break;
+  }
+}
+
+void BulkService::linkLost(uint16_t conn) {
+  if (conn != link_.conn) return;
+  link_.conn = BLE_HS_CONN_HANDLE_NONE;            // announcements go to whoever subscribes next
+  if (!tx_.active()) return;
+  Serial.printf("[BULK] %s: link lost at %u/%u\n", current_, tx_.offset(), tx_.size());
+  tx_.reset();                                     // it resumes with GET <offset>
+  finished();
+}
+
+void BulkService::handleCapture(const Cmd& c) {
+  if (!capture_) return;
+  switch (c.action) {
+    case STRIDERA_CAPTURE_FIRE:
+      capture_->trigger();                         // the IMU task fires on its next sample
+      Serial.println("[BULK] capture: fire");
+      break;
+
+    case STRIDERA_CAPTURE_ARM:
+      if (sendingCapture_ && tx_.active()) tx_.abort();   // no more reads: only the ABORTED status goes out
+      capture_->rearm();
+      captureReady_ = false;
+      Serial.println("[BULK] capture: re-armed");
+      break;
+
+    case STRIDERA_CAPTURE_CONFIG:
+      capture_->configure(c.capture);
+      Serial.printf("[BULK] capture: high %u mg, low %u mg, gyro %u dps, window -%u/+%u ms\n",
+                    c.capture.accel_high_mg, c.capture.accel_low_mg, c.capture.gyro_dps,
+                    c.capture.pre_ms, c.capture.post_ms);
+      break;
+
+    default: break;
+  }
+}
+
+void BulkService::sendList() {
+  uint8_t frame[244];
+  const size_t payload = link_.maxPayload() < sizeof(frame) ? link_.maxPayload() : sizeof(frame);
+  const size_t perFrame = payload > 2 ? (payload - 2) / sizeof(StrideraBulkListEntry) : 0;
+  if (perFrame == 0) return;
+
+  uint8_t count = 0;
+  bool ok = true;
+  if (capture_ && capture_->frozen()) {            // listed first: the reason a central is asking
+    StrideraBulkListEntry e{};
+    e.size = capture_->size();
+    memcpy(e.name, STRIDERA_CAPTURE_NAME, sizeof(STRIDERA_CAPTURE_NAME) - 1);
+    ok = listEntry(frame, count, perFrame, e);
+  }
+
+  fs::File dir = storage().open("/");
+  for (fs::File f = dir.openNextFile(); ok && f; f = dir.openNextFile()) {
+    const char* name = f.name();
+    if (*name == '/') ++name;
+    if (f.isDirectory() || !stridera_bulk_session_name(name)) continue;
+
+    StrideraBulkListEntry e{};
+    e.size = (uint32_t)f.size();
+    memcpy(e.name, name, strlen(name));
+    ok = listEntry(frame, count, perFrame, e);
+  }
+  if (ok && count) {
+    frame[0] = STRIDERA_BULK_FRAME_LIST;
+    frame[1] = count;
+    ok = sendFrame(frame, 2 + count * sizeof(StrideraBulkListEntry));
+  }
+  if (!ok) {                                       // like a stalled transfer: give up, say so
+    Serial.println("[BULK] LIST: link stalled, aborted");
+    sendStatus(STRIDERA_BULK_ABORTED);
+    return;
+  }
+  sendStatus(STRIDERA_BULK_OK_LIST_END);
+}
+
+// Appends to a LIST frame, sends it once full; false if the link would not take it
+bool BulkService::listEntry(uint8_t* frame, uint8_t& count, size_t perFrame, const StrideraBulkListEntry& e) {
+  memcpy(frame + 2 + count * sizeof(e), &e, sizeof(e));
+  if (++count < perFrame) return true;
+  frame[0] = STRIDERA_BULK_FRAME_LIST;
+  frame[1] = count;
+  count = 0;
+  return sendFrame(frame, 2 + perFrame * sizeof(e));
+}
+
+// Retries while the controller is out of buffers, up to BULK_SEND_TIMEOUT_MS (central gone or stuck)
+bool BulkService::sendFrame(const uint8_t* frame, size_t len) {
+  const uint32_t start = millis();
+  while (!link_.send(frame, len)) {
+    if (millis() - start >= BULK_SEND_TIMEOUT_MS) return false;
+    vTaskDelay(pdMS_TO_TICKS(BULK_RETRY_MS));
+  }
+  return true;
+}
+
+void BulkService::sendStatus(uint8_t code, uint32_t size) {
+  sendStatusTo(link_.conn, code, size);
+}
+
+void BulkService::sendStatusTo(uint16_t conn, uint8_t code, uint32_t size) {
+  const StrideraBulkStatus st{STRIDERA_BULK_FRAME_STATUS, code, size, 0, 0};
+  if (data_) data_->notify(reinterpret_cast<const uint8_t*>(&st), sizeof(st), conn);
+}
+
+// ---------- file source ----------
+bool BulkService::FileSource::open(fs::FS& fs, const char* path) {
+  close();
+  if (!fs.exists(path)) return false;
+  file_ = fs.open(path, "r");
+  if (!file_) return false;
+  size_ = (uint32_t)file_.size();
+  pos_  = 0;
+  return true;
+}
+
+void BulkService::FileSource::close() {
+  if (file_) file_.close();
+  size_ = pos_ = 0;
+}
+
+size_t BulkService::FileSource::readAt(uint32_t offset, uint8_t* buf, size_t len) {
+  if (offset != pos_ && !file_.seek(offset)) return 0;
+  const size_t got = file_.read(buf, len);
+  pos_ = offset + (uint32_t)got;
+  return got;
+}
@@ -0,0 +1,100 @@
+#pragma once
+#include <Arduino.h>
+#include <NimBLEDevice.h>
+#include <FS.h>
+#include "stridera_bulk.h"
+#include "bulk_transfer.h"
+#include "capture_buffer.h"
+#include "config.h"
+
+// BulkService — second GATT service for pulling recorded sessions (*.ssn) off
+// the device at link speed: list, then stream a file as MTU-sized chunks under
+// credit flow control, resumable from any offset. All file I/O and notifies
+// run on a low-priority pump task; control writes only enqueue commands.
+// A frozen event capture is served the same way from memory (capture.cap).
+class BulkService {
+public:
+  void begin(NimBLEServer* server);              // call before advertising starts
+  bool busy() const { return tx_.active(); }
+
+  // Called from the pump task when a transfer starts or ends (link profile switch)
+  using WakeFn = void (*)(void*);
+  void setWake(WakeFn fn, void* arg) { wake_ = fn; wakeArg_ = arg; }
+
+  // Event capture to trigger, serve and re-arm (after begin()); its freeze wakes the pump task
+  void setCapture(CaptureBuffer* cap);
+
+  // NimBLE host task: a central disconnected; the transfer it owned stops
+  void onDisconnect(uint16_t conn);
+
+private:
+  struct Cmd {
+    uint8_t  op;
+    uint32_t offset;
+    uint16_t credits;
+    uint16_t conn;
+    uint16_t mtu;
+    char     name[STRIDERA_BULK_NAME_LEN + 1];
+    uint8_t  action;                               // STRIDERA_BULK_OP_CAPTURE
+    StrideraCaptureConfig capture;
+  };
+  // Internal ops (never accepted from the control characteristic)
+  static constexpr uint8_t kOpInternal      = 0x80;
+  static constexpr uint8_t kOpCaptureFrozen = 0x80;  // the IMU task froze a capture
+  static constexpr uint8_t kOpDisconnect    = 0x81;  // a central left (conn)
+
+  class FileSource : public IBulkSource {
+  public:
+    bool open(fs::FS& fs, const char* path);
+    void close();
+    uint32_t size() const override { return size_; }
+    size_t readAt(uint32_t offset, uint8_t* buf, size_t len) override;
+  private:
+    fs::File file_;
+    uint32_t size_ = 0;
+    uint32_t pos_  = 0;
+  };
+
+  class NotifyLink : public IBulkLink {
+  public:
+    NimBLECharacteristic* chr = nullptr;
+    uint16_t conn = BLE_HS_CONN_HANDLE_NONE;       // central of the last command; NONE = every subscriber
+    uint16_t mtu  = 23;
+    size_t maxPayload() const override { return mtu > 3 ? mtu - 3 : 0; }
+    bool send(const uint8_t* buf, size_t len) override { return chr && chr->notify(buf, len, conn); }
+  };
+
+  static void taskEntry(void* arg);
+  static void captureFrozen(void* arg);            // IMU task
+  void taskLoop();
+  void kick() { if (wake_) wake_(wakeArg_); }
+  void handle(const Cmd& c);
+  void handleCapture(const Cmd& c);
+  void linkLost(uint16_t conn);
+  void finished();                                 // transfer over: close the source, re-arm a delivered capture
+  void sendList();
+  bool listEntry(uint8_t* frame, uint8_t& count, size_t perFrame, const StrideraBulkListEntry& e);
+  bool sendFrame(const uint8_t* frame, size_t len);   // bounded retry, false = gave up
+  void sendStatus(uint8_t code, uint32_t size = 0);
+  void sendStatusTo(uint16_t conn, uint8_t code, uint32_t size = 0);
+  fs::FS& storage();
+
+  NimBLEServer*         server_ = nullptr;
+  NimBLECharacteristic* ctrl_   = nullptr;
+  NimBLECharacteristic* data_   = nullptr;
+  QueueHandle_t         queue_  = nullptr;
+  TaskHandle_t          task_   = nullptr;
+
+  BulkSender<>  tx_;
+  FileSource    src_;
+  CaptureBuffer* capture_ = nullptr;
+  CaptureSource captureSrc_;
+  bool          sendingCapture_ = false;
+  bool          captureReady_   = false;           // announce once the current transfer is over
+  NotifyLink    link_;
+  char          current_[STRIDERA_BULK_NAME_LEN + 2] = {0};
+  WakeFn        wake_    = nullptr;
+  void*         wakeArg_ = nullptr;
+
+  friend class _BulkCtrlCallbacks;
+};
@@ -2,6 +2,10 @@
 #pragma once
 #include <Arduino.h>
 #include "stridera_packet.h"
+#include "stridera_csv.h"
+#include "stridera_session.h"
+#include "read_ahead.h"
+#include "config.h"
 
 #if STRIDERA_HAS_SD
   #include <SD.h>
@@ -9,56 +13,134 @@
   #include <SPIFFS.h>
 #endif
 
+// Replays either a CSV (ts_ms, ax_g, ay_g, az_g[, gx_dps, gy_dps, gz_dps][, mx_ut,
+// my_ut, mz_ut][, temp_c], groups named by the header) or a binary session file
+// (.ssn, accel only, see stridera_session.h). The format is detected from the
+// file's first bytes. Reads go through a ReadAhead ring; its fill side runs
+// on the prefetch task (service()), so parsing does not wait on storage.
 class CsvReplay {
 public:
+  using Prefetch = ReadAhead<fs::File, REPLAY_PREFETCH_BLOCK_BYTES, REPLAY_PREFETCH_BLOCKS>;
+
   bool begin(const char* path) {
+    if (!mounted_) {
+    #if STRIDERA_HAS_SD
+      // Core2: built-in SD (CS is typically GPIO 4)
+      if (!SD.begin(4)) return false;  // Core2 default CS = 4
+    #else
+      // StickC Plus 2: no SD — use SPIFFS
+      if (!SPIFFS.begin(true)) return false;
+    #endif
+      mounted_ = true;
+    }
   #if STRIDERA_HAS_SD
-    // Core2: built-in SD (CS is typically GPIO 4)
-    if (!SD.begin(4)) return false;  // Core2 default CS = 4
+    if (!SD.exists(path)) return false;
     file_ = SD.open(path, FILE_READ);
   #else
-    // StickC Plus 2: no SD — use SPIFFS
-    if (!SPIFFS.begin(true)) return false;
     if (!SPIFFS.exists(path)) return false;         // quick existence check
     file_ = SPIFFS.open(path, "r");
   #endif
-    if (!file_) return false;
+    if (!file_ || !ahead_.begin(&file_)) return false;
 
-    // Skip header
-    (void)file_.readStringUntil('\n');
-    return true;
-  }
+    // Sniff the magic (resident head block), then hand the file to the matching reader
+    char magic[4] = {0};
+    const bool binary = ahead_.read((uint8_t*)magic, sizeof(magic)) == sizeof(magic) &&
+                        memcmp(magic, STRIDERA_SESSION_MAGIC, sizeof(magic)) == 0;
+    format_    = binary ? Format::Session : Format::Csv;
+    malformed_ = 0;
+    pending_   = false;
+    path_      = path;
 
-  bool readNext(StrideraAccelPacket& out, uint8_t nominal_rate_hz = 100) {
-    String line = file_.readStringUntil('\n');
-    if (line.length() == 0) return false;
+    if (format_ == Format::Session) return session_.begin(&ahead_);
+    return rewindCsv();
+  }
 
-    // CSV: ts_ms, ax_g, ay_g, az_g
-    char* endp = nullptr;
-    const char* s = line.c_str();
-    uint32_t ts = strtoul(s, &endp, 10);
-    if (!endp) return false;
+  // Next valid row; malformed rows are skipped and counted, `out` is only
+  // written for a row that parsed completely. No heap, no float math.
+  bool readNext(StrideraSample& out, uint16_t nominal_rate_hz = 100) {
+    if (format_ == Format::Session) {
+      StrideraAccelPacket pkt;
+      if (!session_.next(pkt, (uint8_t)(nominal_rate_hz > 255 ? 255 : nominal_rate_hz))) return false;
+      memset(&out, 0, sizeof(out));
+      out.v1        = pkt;
+      out.ts_us     = pkt.ts_ms * 1000u;
+      out.rate_hz   = nominal_rate_hz;
+      out.chan_mask = STRIDERA_CH_ACCEL;
+      return true;
+    }
 
-    float ax = strtof(endp+1, &endp);
-    float ay = strtof(endp+1, &endp);
-    float az = strtof(endp+1, &endp);
+    if (pending_) {                                  // row held back by seekMs()
+      pending_ = false;
+      out = pendingPkt_;
+      out.rate_hz    = nominal_rate_hz;
+      out.v1.rate_hz = (uint8_t)(nominal_rate_hz > 255 ? 255 : nominal_rate_hz);
+      return true;
+    }
+    const char *s, *e;
+    while (lines_.next(s, e)) {
+      if (s == e || (e - s == 1 && *s == '\r')) continue;  // blank line
+      if (stridera_parse_csv_sample(s, e, out, nominal_rate_hz, columns_)) return true;
+      ++malformed_;
+    }
+    return false;
+  }
 
-    out.ts_ms   = ts;
-    out.ax_mg   = (int16_t)lrintf(ax * 1000.0f);
-    out.ay_mg   = (int16_t)lrintf(ay * 1000.0f);
-    out.az_mg   = (int16_t)lrintf(az * 1000.0f);
-    out.rate_hz = nominal_rate_hz;
-    out.reserved= 0;
+  // Position on the first sample with ts >= ts_ms.
+  // Session files: index binary search (O(log n)). CSV: rescan from the top (O(n)).
+  bool seekMs(uint32_t ts_ms) {
+    if (format_ == Format::Session) return session_.seekMs(ts_ms);
+    if (!rewindCsv()) return false;
+    while (readNext(pendingPkt_, 0)) {
+      if (pendingPkt_.v1.ts_ms >= ts_ms) { pending_ = true; break; }
+    }
     return true;
   }
 
+  // Back to the first row; both formats land in the resident head block (no storage wait)
+  bool rewind() {
+    if (format_ == Format::Session) return session_.seekRecord(0);
+    return rewindCsv();
+  }
+
+  // Prefetch task: read ahead while there is room; true while more work is pending
+  bool service() { return ahead_.service(); }
+  ReadAheadStats prefetchStats() const { return ahead_.stats(); }
+  static constexpr size_t prefetchBlocks() { return Prefetch::capacity(); }
+  void setPrefetchHooks(Prefetch::ClockFn clock, Prefetch::WakeFn wake, Prefetch::WaitFn wait, void* arg) {
+    ahead_.setClock(clock);
+    ahead_.setWake(wake, arg);
+    ahead_.setWait(wait, arg);
+  }
+
   void setPath(const char* p) { path_ = p; }
+  bool isSession() const { return format_ == Format::Session; }
+  uint8_t channels() const { return format_ == Format::Session ? STRIDERA_CH_ACCEL : columns_; }
+
+  uint32_t malformedRows() const { return malformed_ + lines_.longLines(); }
 
 private:
-#if STRIDERA_HAS_SD
-  File file_;
-#else
+  bool rewindCsv() {
+    pending_ = false;
+    if (!ahead_.seek(0)) return false;
+    // Block reads into the in-object buffer; rows are parsed in place
+    lines_.begin(&ahead_);
+    // Header: which channel groups the rows carry
+    const char *s, *e;
+    columns_ = lines_.next(s, e) ? stridera_csv_columns(s, e) : STRIDERA_CH_ACCEL;
+    return true;
+  }
+
+  enum class Format { Csv, Session };
+  Format format_  = Format::Csv;
+  bool   mounted_ = false;
+
   fs::File file_;
-#endif
+  Prefetch ahead_;                                 // file_ -> parser, filled by the prefetch task
+  StrideraCsvLineReader<Prefetch> lines_;
+  StrideraSessionReader<Prefetch> session_;
+  uint32_t       malformed_ = 0;
+  uint8_t        columns_   = STRIDERA_CH_ACCEL;
+  bool           pending_   = false;
+  StrideraSample pendingPkt_{};
   String path_ = "/snapchat.csv";
 };
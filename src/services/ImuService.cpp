@@ -1,74 +1,472 @@
 #include "ImuService.h"
+#include "Perf.h"
 #include "config.h"
 
+static_assert(IMU_CH_ACCEL == STRIDERA_CH_ACCEL && IMU_CH_GYRO == STRIDERA_CH_GYRO &&
+              IMU_CH_MAG == STRIDERA_CH_MAG && IMU_CH_TEMP == STRIDERA_CH_TEMP, "HAL and wire channel bits differ");
+
 void ImuService::begin() {
-  // Try to detect a CSV file; if found -> Replay; else -> Live
+  // Try to detect a replay file; if found -> Replay; else -> Live
   // We optimistically try to start replay here; if it fails we fall back to live.
+  // A binary session (csv2ssn output) wins over the CSV it was made from.
   if (!replayReady_) {
-    // Lazy init: try the default path
-    player_.setPath("/snapchat.csv");
-    replayReady_ = player_.begin("/snapchat.csv");
-    if (replayReady_) {
-      mode_ = Mode::Replay;
+    static const char* const kReplayPaths[] = { "/snapchat.ssn", "/snapchat.csv" };
+    player_.setPrefetchHooks(&ImuService::clockUs, &ImuService::prefetchWake, &ImuService::prefetchWait, this);
+    for (const char* path : kReplayPaths) {
+      ReplayConfig rc;
+      rc.speed_x100 = REPLAY_SPEED_X100;
+      rc.loop       = REPLAY_LOOP;
+      rc.policy     = REPLAY_POLICY;
+      rc.max_lag_us = REPLAY_MAX_LAG_MS * 1000UL;
+      rc.max_burst  = REPLAY_MAX_BURST;
+      replayReady_ = player_.begin(path) && replay_.begin(&player_, rc);
+      if (replayReady_) {
+        mode_ = Mode::Replay;
+        Serial.printf("[IMU] replay %s (%s), recorded %u Hz x%.2f%s\n", path, player_.isSession() ? "session" : "csv",
+                      replay_.recordedHz(), replay_.speedX100() / 100.0f, rc.loop ? ", looping" : "");
+        break;
+      }
+    }
+    // Storage reads move off the IMU task: the prefetch task keeps the ring full
+    if (replayReady_ && !prefetchTask_) {
+      xTaskCreatePinnedToCore(&ImuService::prefetchEntry, "prefetch", REPLAY_PREFETCH_TASK_STACK, this,
+                              REPLAY_PREFETCH_TASK_PRIO, &prefetchTask_, REPLAY_PREFETCH_TASK_CORE);
     }
   }
 
   if (mode_ == Mode::Live) {
-    accel_.begin();    
+    accel_.set_odr_hz(IMU_SAMPLE_RATE_HZ);
+    accel_.begin();
+    configureLive(IMU_SAMPLE_RATE_HZ);
   }
+  beginCapture();
   reset();
+
+  // Producer task + its tick source; both idle until startSampling()
+  if (!task_) {
+    xTaskCreatePinnedToCore(&ImuService::taskEntry, "imu", IMU_TASK_STACK, this,
+                            IMU_TASK_PRIO, &task_, IMU_TASK_CORE);
+  }
+  if (!timer_) {
+    esp_timer_create_args_t args = {};
+    args.callback        = &ImuService::onTimer;
+    args.arg             = this;
+    args.dispatch_method = ESP_TIMER_TASK;
+    args.name            = "imu_tick";
+    esp_timer_create(&args, &timer_);
+  }
+}
+
+void ImuService::beginCapture() {
+  if (captureMem_) return;                         // kept across begin(): a frozen capture stays fetchable
+  uint32_t n = CAPTURE_RECORDS;
+  if (psramFound()) captureMem_ = static_cast<StrideraCaptureRecord*>(ps_malloc(n * sizeof(StrideraCaptureRecord)));
+  const bool psram = captureMem_ != nullptr;
+  if (!psram && CAPTURE_RECORDS_NO_PSRAM) {
+    n = CAPTURE_RECORDS_NO_PSRAM;
+    captureMem_ = static_cast<StrideraCaptureRecord*>(malloc(n * sizeof(StrideraCaptureRecord)));
+  }
+  if (!captureMem_) {
+    Serial.println("[IMU] capture: no memory, disabled");
+    return;
+  }
+  StrideraCaptureConfig cc;
+  cc.accel_high_mg = CAPTURE_ACCEL_HIGH_MG;
+  cc.accel_low_mg  = CAPTURE_ACCEL_LOW_MG;
+  cc.gyro_dps      = CAPTURE_GYRO_DPS;
+  cc.pre_ms        = CAPTURE_PRE_MS;
+  cc.post_ms       = CAPTURE_POST_MS;
+  capture_.begin(captureMem_, n, cc);
+  const uint16_t hz = sampleRateHz() ? sampleRateHz() : 100;   // replay header without a rate
+  Serial.printf("[IMU] capture: %u records in %s (%u s at %u Hz), armed\n", n, psram ? "PSRAM" : "RAM",
+                n / hz, hz);
 }
 
 void ImuService::end() {
+  stopSampling();
   // If you later add explicit power-down for IMU/I2C, put it here.
 }
 
 void ImuService::reset() {
+  ring_.discard();
+  gaitRing_.discard();
+  quatRing_.discard();
+  ring_.resetStats();
   memset(&current_, 0, sizeof(current_));
-  lastUi_ = 0;
 }
 
-void ImuService::update() {
-  if (mode_ == Mode::Replay && replayReady_) {
-    // Advance one CSV row per call; stream at firmware loop's pace
-    StrideraAccelPacket pkt;
-    if (player_.readNext(pkt, replayRateHz_)) {
-      current_ = pkt;
-    }
+void ImuService::startSampling(SensorOutput out) {
+  if (out == SensorOutput::Off) { stopSampling(); return; }
+  if (sampling_) {
+    if (out == output_) return;
+    stopSampling();                                // switch output from a parked task
+  }
+  if (!timer_) return;
+  // Capture-only needs a ring, and replay rows only run while something consumes them
+  if (out == SensorOutput::Capture && (mode_ == Mode::Replay || !capture_.stats().capacity)) return;
+
+  // Task is parked (no ticks), so touching the sensor from here is safe:
+  // take a rate asked for while idle, drop whatever piled up in the FIFO.
+  const uint16_t want = pendingRateHz_.exchange(0);
+  if (want) applyRate(want);
+  if (mode_ == Mode::Live && accel_.has_fifo()) {
+    AccelSample scratch[8];
+    while (accel_.read_batch(scratch, 8) == 8) {}
+    decim_.reset();                                // re-primed from the first fresh frame
+  }
+
+  startUs_ = lastTickUs_ = esp_timer_get_time();
+  ticks_ = samples_ = jitterMaxUs_ = 0;
+  if (mode_ == Mode::Replay) replay_.start(startUs_);    // first row due now
+  seq_ = 0;                                        // v2 receivers count loss from here
+  jitterSumUs_ = 0;
+#if STRIDERA_PERF
+  g_perf.requestReset();                           // per-session stats
+#endif
+
+  GaitConfig gc;
+  gc.rate_hz = sampleRateHz();
+  gait_.begin(gc);                                 // float coefficients here, integer-only per sample
+  beginAhrs();
+
+  output_   = out;
+  sampling_ = true;
+  esp_timer_start_periodic(timer_, tickPeriodUs());
+}
+
+void ImuService::stopSampling() {
+  if (!sampling_) return;
+  if (timer_) esp_timer_stop(timer_);
+  sampling_ = false;
+  while (inTick_) vTaskDelay(1);                   // the sensor and rings are ours once the tick is done
+  if (output_ == SensorOutput::Capture) return;    // idle capture: nothing to report per session
+
+  const ImuTiming t = timing();
+  Serial.printf("[IMU] %u samples @%u Hz (target %u), tick jitter avg=%uus max=%uus, "
+                "fifo overflows=%u, ring overruns=%u high-water=%u/%u\n",
+                t.samples, t.measured_hz, sampleRateHz(), t.jitter_avg_us, t.jitter_max_us,
+                t.fifo_overflows, ringOverruns(), ringHighWater(), (unsigned)ring_.capacity());
+  Serial.printf("[IMU] gait: %u steps\n", gait_.steps());
+  const CaptureStats c = capture_.stats();
+  if (c.capacity) {
+    static const char* const kCaptureState[] = { "armed", "recording post-trigger", "frozen" };
+    Serial.printf("[IMU] capture: %s, %u captures, %u triggers ignored, %u samples skipped while frozen\n",
+                  kCaptureState[c.state], c.captures, c.ignored, c.skipped);
+  }
+  if (mode_ == Mode::Replay) {
+    const ReplayStats r = replay_.stats();
+    Serial.printf("[IMU] replay x%.2f: %u rows, %.1f Hz of %.1f target, late max %ums, "
+                  "%u dropped, %u slips, %u loops, %u malformed rows skipped\n",
+                  replay_.speedX100() / 100.0f, r.released, r.achieved_mhz / 1000.0f, r.target_mhz / 1000.0f,
+                  r.late_max_us / 1000, r.dropped, r.slips, r.loops, player_.malformedRows());
+    const ReadAheadStats p = player_.prefetchStats();
+    Serial.printf("[IMU] prefetch: depth %u/%u (min %u), %u stalls (%u ms total, worst %u ms), %u seeks, "
+                  "read %u KB/s, worst read %u ms\n",
+                  p.depth, (unsigned)CsvReplay::prefetchBlocks(), p.depth_min, p.stalls, p.stall_us_total / 1000,
+                  p.stall_us_max / 1000, p.seeks, p.kbps(), p.read_us_max / 1000);
+  }
+}
+
+bool ImuService::pop(StrideraSample& out) {
+  if (!ring_.pop(out)) return false;
+  current_ = out;
+  return true;
+}
+
+bool ImuService::popGait(StrideraGaitPacket& out) {
+  return gaitRing_.pop(out);
+}
+
+bool ImuService::popQuat(StrideraQuatPacket& out) {
+  return quatRing_.pop(out);
+}
+
+uint16_t ImuService::requestQuatHz(uint16_t hz) {
+  const uint16_t rate = sampleRateHz();
+  if (hz > rate) hz = rate;
+  quatHz_.store(hz, std::memory_order_relaxed);    // the IMU task reads it per sample
+  return hz;
+}
+
+void ImuService::beginAhrs() {
+  AhrsConfig ac;
+  ac.rate_hz       = sampleRateHz();
+  ac.kp_milli      = AHRS_KP_MILLI;
+  ac.ki_milli      = AHRS_KI_MILLI;
+  ac.accel_gate_mg = AHRS_ACCEL_GATE_MG;
+  ahrs_.begin(ac);                                 // dt and gains depend on the rate; re-aligns on gravity
+  quatAcc_ = 0;
+}
+
+uint16_t ImuService::replaySpeedFor(uint16_t hz) const {
+  const uint32_t rec = replay_.recordedHz() ? replay_.recordedHz() : 1;
+  const uint32_t x100 = ((uint32_t)hz * 100 + rec / 2) / rec;
+  return (uint16_t)(x100 > STRIDERA_REPLAY_SPEED_MAX ? STRIDERA_REPLAY_SPEED_MAX : x100);
+}
+
+ImuService::RatePlan ImuService::planRate(uint16_t hz) const {
+  RatePlan p;
+  if (mode_ == Mode::Replay) {
+    // Rows keep their recorded spacing; the rate only scales it (clamped to the speed range)
+    uint16_t speed = replaySpeedFor(hz);
+    if (speed < STRIDERA_REPLAY_SPEED_MIN) speed = STRIDERA_REPLAY_SPEED_MIN;
+    p.odr_hz = replay_.recordedHz();
+    p.out_hz = (uint16_t)(((uint32_t)p.odr_hz * speed + 50) / 100);
+    p.factor = 1;
+    return p;
+  }
+  if (hz < IMU_RATE_MIN_HZ) hz = IMU_RATE_MIN_HZ;
+  if (hz > IMU_RATE_MAX_HZ) hz = IMU_RATE_MAX_HZ;
+  if (accel_.has_fifo()) {
+    // FIFO sensors oversample and we decimate; others are read once per tick at the output rate
+    p.odr_hz = accel_.odr_for(hz * IMU_OVERSAMPLE);
+    p.factor = (uint16_t)((p.odr_hz + hz / 2) / hz);
+    if (p.factor == 0) p.factor = 1;
+    p.out_hz = p.odr_hz / p.factor;
   } else {
-    int16_t ax, ay, az;
-    accel_.read_mg(ax, ay, az);
-    current_.ts_ms   = millis();
-    current_.ax_mg   = ax;
-    current_.ay_mg   = ay;
-    current_.az_mg   = az;
-    current_.rate_hz = accel_.sample_rate_hz();
-  }
-
-  // --- Bottom-of-screen HUD once per second (small, unobtrusive) ---
-  if (millis() - lastUi_ > UI_REFRESH_MS) {
-    lastUi_ = millis();
-
-    // Use small font and bottom-center datum
-    M5.Display.setFont(&fonts::Font2);
-    M5.Display.setTextSize(1);
-    M5.Display.setTextColor(TFT_BLACK, TFT_WHITE);
-    M5.Display.setTextDatum(textdatum_t::bottom_center);
-
-    // Compute a slim bar area at the bottom and clear it
-    int fh = M5.Display.fontHeight();
-    int y  = M5.Display.height() - 2;          // a couple pixels above the edge
-    M5.Display.fillRect(0, M5.Display.height() - (fh + 6),
-                        M5.Display.width(), fh + 6, TFT_WHITE);
-
-    // Centered one-line IMU HUD
-    char buf[64];
-    if (mode_ == Mode::Replay) {
-      snprintf(buf, sizeof(buf), "REPLAY mg: %d %d %d @%uHz",
-               current_.ax_mg, current_.ay_mg, current_.az_mg, sampleRateHz());
-    } else {
-      snprintf(buf, sizeof(buf), "IMU mg: %d %d %d", current_.ax_mg, current_.ay_mg, current_.az_mg);
+    p.odr_hz = p.out_hz = accel_.odr_for(hz);
+    p.factor = 1;
+  }
+  return p;
+}
+
+void ImuService::configureLive(uint16_t hz) {
+  const RatePlan p = planRate(hz);
+  accel_.set_odr_hz(p.odr_hz);                     // FIFO restarts empty
+  decimFactor_ = p.factor;
+  outRateHz_   = p.out_hz;
+  if (decimFactor_ > 1) {
+    // Cutoff follows the output rate down (<= output/4), never above the configured one
+    float cutoff = IMU_DECIM_CUTOFF_HZ;
+    if (cutoff > outRateHz_ / 4.0f) cutoff = outRateHz_ / 4.0f;
+    decim_.begin(decimFactor_, cutoff, p.odr_hz);
+  }
+  Serial.printf("[IMU] sensor %u Hz -> output %u Hz (decimate x%u, %u taps), channels 0x%02X\n",
+                accel_.sample_rate_hz(), outRateHz_, decimFactor_, (unsigned)decim_.taps(), accel_.channels());
+}
+
+uint16_t ImuService::requestRateHz(uint16_t hz) {
+  const RatePlan p = planRate(hz);
+  pendingRateHz_.store(p.out_hz);
+  return p.out_hz;
+}
+
+void ImuService::applyRate(uint16_t hz) {
+  if (hz == sampleRateHz()) return;
+  const uint32_t oldTickUs = tickPeriodUs();
+  if (mode_ == Mode::Replay) replay_.setSpeed(replaySpeedFor(hz), esp_timer_get_time());
+  else                       configureLive(hz);
+
+  GaitConfig gc;
+  gc.rate_hz = sampleRateHz();
+  gait_.begin(gc);                                 // coefficients depend on the rate
+  beginAhrs();
+  if (sampling_ && tickPeriodUs() != oldTickUs) {  // timer-paced sources: new period from the next tick
+    esp_timer_stop(timer_);
+    esp_timer_start_periodic(timer_, tickPeriodUs());
+  }
+  Serial.printf("[IMU] rate -> %u Hz\n", sampleRateHz());
+}
+
+uint8_t ImuService::channels() const {
+  return mode_ == Mode::Replay ? player_.channels() : accel_.channels();
+}
+
+ImuTiming ImuService::timing() const {
+  ImuTiming t{};
+  t.ticks          = ticks_;
+  t.samples        = samples_;
+  t.jitter_avg_us  = ticks_ > 1 ? (uint32_t)(jitterSumUs_ / (ticks_ - 1)) : 0;
+  t.jitter_max_us  = jitterMaxUs_;
+  const int64_t elapsed = lastTickUs_ - startUs_;
+  t.measured_hz    = elapsed > 0 ? (uint32_t)((uint64_t)samples_ * 1000000ULL / elapsed) : 0;
+  t.fifo_overflows = accel_.fifo_overflows();
+  return t;
+}
+
+// ---------- producer task ----------
+uint32_t ImuService::tickPeriodUs() const {
+  // FIFO: the chip paces samples, replay: the row timestamps; the tick only batches them.
+  // Otherwise one reading per tick.
+  if (mode_ == Mode::Replay || accel_.has_fifo()) return IMU_TICK_MS * 1000UL;
+  const uint16_t hz = sampleRateHz() ? sampleRateHz() : 100;
+  return 1000000UL / hz;
+}
+
+void ImuService::onTimer(void* arg) {
+  // esp_timer task context: record the tick time and hand off to the IMU task
+  auto* self = static_cast<ImuService*>(arg);
+  self->tickUs_ = esp_timer_get_time();
+  xTaskNotifyGive(self->task_);
+}
+
+void ImuService::prefetchEntry(void* arg) {
+  auto* self = static_cast<ImuService*>(arg);
+  for (;;) {
+    while (self->player_.service()) {}
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);       // woken when the parser frees a block or seeks
+  }
+}
+
+void ImuService::prefetchWake(void* arg) {
+  auto* self = static_cast<ImuService*>(arg);
+  if (self->prefetchTask_) xTaskNotifyGive(self->prefetchTask_);
+}
+
+void ImuService::prefetchWait(void* arg) {
+  auto* self = static_cast<ImuService*>(arg);
+  if (self->prefetchTask_) vTaskDelay(1);          // the fill task runs meanwhile
+  else self->player_.service();                    // begin(): no task yet, read inline
+}
+
+uint32_t ImuService::clockUs() {
+  return (uint32_t)esp_timer_get_time();
+}
+
+void ImuService::taskEntry(void* arg) {
+  static_cast<ImuService*>(arg)->taskLoop();
+}
+
+void ImuService::taskLoop() {
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);       // one wakeup per tick (missed ticks coalesce)
+    inTick_ = true;                                // before the check: stopSampling() sees one or the other
+    if (sampling_) handleTick();
+    inTick_ = false;
+  }
+}
+
+void ImuService::handleTick() {
+  STRIDERA_PERF_MARK(g_perf.imuTick);
+
+  const int64_t tick = tickUs_;
+  noteTick(tick);
+  const uint32_t before = samples_;
+  if (mode_ == Mode::Replay && replayReady_) sampleReplay(tick);
+  else                                        sampleLive(tick);
+  const uint16_t want = pendingRateHz_.exchange(0);
+  if (want) applyRate(want);                       // between ticks: this tick's samples kept the old rate
+  if (samples_ != before) {
+    latest_.write(last_);                          // UI snapshot: never waits on the reader
+    if (wake_ && output_ == SensorOutput::Full) wake_(wakeArg_);   // consumer drains as soon as data exists
+  }
+}
+
+void ImuService::noteTick(int64_t tick_us) {
+  if (ticks_ > 0) {
+    const int64_t interval = tick_us - lastTickUs_;
+    const int64_t nominal  = (int64_t)tickPeriodUs();
+    const uint32_t jitter  = (uint32_t)(interval > nominal ? interval - nominal : nominal - interval);
+    jitterSumUs_ += jitter;
+    if (jitter > jitterMaxUs_) jitterMaxUs_ = jitter;
+  }
+  lastTickUs_ = tick_us;
+  ++ticks_;
+}
+
+void ImuService::sampleLive(int64_t tick_us) {
+  ImuSample batch[kMaxBatch];
+  size_t n;
+  {
+    STRIDERA_PERF_SCOPE(g_perf.imuRead);
+    n = accel_.read_imu(batch, kMaxBatch);         // every channel from the same burst
+  }
+  if (n == 0) return;
+  STRIDERA_PERF_SCOPE(g_perf.imuDsp);             // rest of the tick: decimate, gait, ring
+
+  // Newest FIFO frame ~ at the tick; older ones are one ODR period apart.
+  // Timestamps come from the timer clock, never from when the task got to run.
+  const uint16_t hz        = accel_.sample_rate_hz();
+  const int64_t  period_us = 1000000 / (hz ? hz : 1);
+
+  if (decimFactor_ <= 1) {
+    for (size_t i = 0; i < n; ++i) {
+      emitLive(tick_us - (int64_t)(n - 1 - i) * period_us, batch[i]);
     }
-    M5.Display.drawString(buf, M5.Display.width()/2, y);
+    return;
+  }
+
+  // AoS -> SoA for the block kernel: accel and gyro are filtered, temperature
+  // is slow enough to take from the frame each output lines up with
+  int16_t in_[kFiltered][kMaxBatch], out_[kFiltered][kMaxBatch];
+  for (size_t i = 0; i < n; ++i) {
+    in_[0][i] = batch[i].ax_mg;    in_[1][i] = batch[i].ay_mg;    in_[2][i] = batch[i].az_mg;
+    in_[3][i] = batch[i].gx_dps10; in_[4][i] = batch[i].gy_dps10; in_[5][i] = batch[i].gz_dps10;
+  }
+  uint16_t at[kMaxBatch];
+  const int16_t* in[kFiltered];
+  int16_t*       out[kFiltered];
+  for (size_t c = 0; c < kFiltered; ++c) { in[c] = in_[c]; out[c] = out_[c]; }
+  const size_t m = decim_.process(in, n, out, at);
+
+  // Each output is centred groupDelay() input periods before the frame it lines up with
+  const int64_t delay_us = (int64_t)(decim_.groupDelay() * (float)period_us);
+  for (size_t k = 0; k < m; ++k) {
+    ImuSample v = batch[at[k]];
+    v.ax_mg    = out_[0][k]; v.ay_mg    = out_[1][k]; v.az_mg    = out_[2][k];
+    v.gx_dps10 = out_[3][k]; v.gy_dps10 = out_[4][k]; v.gz_dps10 = out_[5][k];
+    emitLive(tick_us - (int64_t)(n - 1 - at[k]) * period_us - delay_us, v);
   }
 }
+
+void ImuService::emitLive(int64_t ts_us, const ImuSample& v) {
+  StrideraSample s;
+  s.v1.ts_ms    = (uint32_t)(ts_us / 1000);
+  s.v1.ax_mg    = v.ax_mg;
+  s.v1.ay_mg    = v.ay_mg;
+  s.v1.az_mg    = v.az_mg;
+  s.v1.rate_hz  = (uint8_t)(outRateHz_ > 255 ? 255 : outRateHz_);
+  s.v1.reserved = 0;
+  s.ts_us       = (uint32_t)ts_us;
+  s.rate_hz     = outRateHz_;
+  s.chan_mask   = accel_.channels();
+  s.gyro[0] = v.gx_dps10; s.gyro[1] = v.gy_dps10; s.gyro[2] = v.gz_dps10;
+  s.mag[0]  = v.mx_ut10;  s.mag[1]  = v.my_ut10;  s.mag[2]  = v.mz_ut10;
+  s.temp    = v.temp_c100;
+  push(s);
+}
+
+void ImuService::sampleReplay(int64_t tick_us) {
+  // Rows due by this tick, stamped with their scheduled time; replay rows only have ms
+  replay_.poll((uint64_t)tick_us, [this](StrideraSample& s) { push(s); });
+}
+
+void ImuService::push(StrideraSample& s) {
+  if (output_ == SensorOutput::Capture) {          // idle: nobody drains the rings, gait / AHRS wait for a session
+    capture_.push(s);
+    last_ = s.v1;
+    ++samples_;
+    return;
+  }
+  s.seq = seq_++;                                  // before the ring: overruns show up as seq gaps
+  ring_.push(s);                                   // overrun counted inside the ring
+  last_ = s.v1;
+  ++samples_;
+  capture_.push(s);                                // pre-trigger ring: one record store + trigger test
+  if (gait_.push(s.v1)) gaitRing_.push(gait_.event());
+  if (s.chan_mask & STRIDERA_CH_GYRO) pushAhrs(s);
+}
+
+void ImuService::pushAhrs(const StrideraSample& s) {
+  {
+    STRIDERA_PERF_SCOPE(g_perf.ahrs);
+    ahrs_.update(s.v1.ax_mg, s.v1.ay_mg, s.v1.az_mg, s.gyro[0], s.gyro[1], s.gyro[2]);
+  }
+  const uint16_t hz = quatHz_.load(std::memory_order_relaxed);
+  if (!hz) return;
+  quatAcc_ += hz;                                  // phase accumulator: any quat_hz <= rate, no division
+  const uint16_t rate = ahrs_.config().rate_hz;
+  if (quatAcc_ < rate) return;
+  quatAcc_ -= rate;
+  if (quatAcc_ >= rate) quatAcc_ = 0;              // quat_hz above a lowered sample rate: every sample
+
+  int16_t q[4];
+  ahrs_.quatQ14(q);
+  StrideraQuatPacket p;
+  p.kind  = STRIDERA_FRAME_QUAT;
+  p.flags = ahrs_.settled() ? STRIDERA_QUAT_F_SETTLED : 0;
+  p.seq   = s.seq;
+  p.ts_us = s.ts_us;
+  p.w = q[0]; p.x = q[1]; p.y = q[2]; p.z = q[3];
+  quatRing_.push(p);                               // full: dropped, the next one supersedes it
+}
@@ -1,29 +1,146 @@
 #pragma once
 #include <Arduino.h>
 #include <M5Unified.h>
+#include <esp_timer.h>
+#include <atomic>
 #include "accel_m5unified.h"
 #include "stridera_packet.h"
+#include "spsc_ring.h"
+#include "seqlock.h"
+#include "gait_detector.h"
+#include "mahony_ahrs.h"
+#include "stridera_quat.h"
+#include "fir_decimator.h"
 #include "CsvReplay.h"
+#include "replay_scheduler.h"
+#include "capture_buffer.h"
+#include "system_fsm.h"
+#include "config.h"
+
+// Sampling timing, measured by the IMU task (read from any task)
+struct ImuTiming {
+  uint32_t ticks;           // timer ticks handled
+  uint32_t samples;         // samples pushed into the ring
+  uint32_t jitter_avg_us;   // mean |tick interval - nominal|
+  uint32_t jitter_max_us;   // worst |tick interval - nominal|
+  uint32_t measured_hz;     // samples / elapsed since startSampling()
+  uint32_t fifo_overflows;  // sensor FIFO overruns (samples lost in the chip)
+};
 
 class ImuService {
 public:
-  void begin();
+  void begin();                                    // init source + start the (parked) sampling task
   void end();
-  void reset();
-  void update();                                   // refresh current_ packet (live imu or csv replay mode) (only used in STREAMING)
-  const StrideraAccelPacket& current() const { return current_; }
-  uint8_t sampleRateHz() const { return mode_ == Mode::Replay ? replayRateHz_ : accel_.sample_rate_hz(); }
+  void reset();                                    // drop queued samples, clear last packet
+
+  // Producer task control (task pinned to IMU_TASK_CORE, woken by an esp_timer every IMU_TICK_MS)
+  // Full: samples flow into the ring (BLE / SD), gait and AHRS. Capture: only the
+  // event capture ring is fed (idle; live sensor only). Switching output restarts sampling.
+  void startSampling(SensorOutput out = SensorOutput::Full);
+  void stopSampling();                             // stop the timer (waits out a running tick); ring keeps what was queued
+  SensorOutput output() const { return sampling_ ? output_ : SensorOutput::Off; }
+
+  // Consumer side (loop task)
+  bool pop(StrideraSample& out);                   // next queued sample (v1 packet + seq / us), false if empty
+  bool popGait(StrideraGaitPacket& out);           // next step/stop event from the gait detector
+  bool popQuat(StrideraQuatPacket& out);           // next orientation packet (gyro sensors / recordings)
+  const StrideraSample& current() const { return current_; }  // last popped sample
+
+  // Called from the IMU task after every tick that queued samples (wakes the consumer)
+  using WakeFn = void (*)(void*);
+  void setWake(WakeFn fn, void* arg) { wake_ = fn; wakeArg_ = arg; }
+
+  // Any task: newest sample the IMU task produced, once per tick (for the UI task)
+  const Seqlock<StrideraAccelPacket>& latest() const { return latest_; }
+  bool replaying() const { return mode_ == Mode::Replay; }
+  uint16_t sampleRateHz() const { return mode_ == Mode::Replay ? replay_.outputHz() : outRateHz_; }
+  uint8_t channels() const;                        // STRIDERA_CH_* the samples carry (sensor or recording)
+  // Any task: switch the output rate; returns the rate that will actually run.
+  // The IMU task applies it after the current tick, or startSampling() if idle.
+  // Replay: the rate picks the speed (recorded rate x 0.25..20).
+  uint16_t requestRateHz(uint16_t hz);
+  // Any task: orientation packets per second (0 = off, at most the sample rate); returns the rate kept
+  uint16_t requestQuatHz(uint16_t hz);
+  uint16_t quatHz() const { return quatHz_.load(std::memory_order_relaxed); }
+
+  // Event capture fed by the IMU task; the bulk service triggers, reads and re-arms it
+  CaptureBuffer& capture() { return capture_; }
+
+  // Ring / timing stats
+  uint32_t ringOverruns()  const { return ring_.overruns(); }
+  uint32_t ringHighWater() const { return ring_.highWater(); }
+  ImuTiming timing() const;
 
 private:
+  static void taskEntry(void* arg);
+  static void onTimer(void* arg);
+  static void prefetchEntry(void* arg);            // replay read-ahead: fills player_'s block ring
+  static void prefetchWake(void* arg);
+  static void prefetchWait(void* arg);             // IMU task: ring empty, let the fill catch up
+  static uint32_t clockUs();
+  void taskLoop();
+  void handleTick();                               // one timer tick of work while sampling
+  void noteTick(int64_t tick_us);
+  void sampleLive(int64_t tick_us);                // drain the sensor FIFO, decimate, timestamp from the tick
+  void emitLive(int64_t ts_us, const ImuSample& v);
+  void sampleReplay(int64_t tick_us);              // release the rows due by this tick
+  uint16_t replaySpeedFor(uint16_t hz) const;      // output rate -> speed x100
+  uint32_t tickPeriodUs() const;
+  struct RatePlan { uint16_t odr_hz, factor, out_hz; };
+  RatePlan planRate(uint16_t hz) const;            // sensor ODR + decimation for an output rate
+  void configureLive(uint16_t hz);                 // program the sensor and the decimator
+  void applyRate(uint16_t hz);                     // IMU task (or parked): new rate between ticks
+  void push(StrideraSample& s);                    // assigns seq, queues, feeds capture + gait + AHRS (Capture: capture only)
+  void beginCapture();                             // ring in PSRAM (internal RAM fallback), once
+  void beginAhrs();                                // (re)start the filter at the current rate
+  void pushAhrs(const StrideraSample& s);
+
+  static constexpr size_t kMaxBatch = 36;          // FIFO frames drained per tick
+  static constexpr size_t kFiltered = 6;           // accel + gyro through the decimator; temp is picked
+
   enum class Mode { Live, Replay };
   Mode mode_ = Mode::Live;
 
   AccelM5Unified accel_;
-  StrideraAccelPacket current_{};
-  uint32_t lastUi_ = 0;
+  FirDecimator<kFiltered, IMU_DECIM_TAPS, kMaxBatch> decim_;  // sensor ODR -> outRateHz_ (FIFO sensors only)
+  uint16_t decimFactor_ = 1;
+  uint16_t outRateHz_   = IMU_SAMPLE_RATE_HZ;
+  std::atomic<uint16_t> pendingRateHz_{0};         // requestRateHz() -> IMU task, 0 = none
+  StrideraSample current_{};
+  StrideraAccelPacket last_{};                     // IMU task: last pushed, published per tick
+  Seqlock<StrideraAccelPacket> latest_;
+  WakeFn wake_    = nullptr;
+  void*  wakeArg_ = nullptr;
+
+  // Producer task -> loop
+  SpscRing<StrideraSample, IMU_RING_CAPACITY> ring_;
+  SpscRing<StrideraGaitPacket, GAIT_RING_CAPACITY> gaitRing_;
+  GaitDetector       gait_;                        // runs in the IMU task on every pushed sample
+  SpscRing<StrideraQuatPacket, QUAT_RING_CAPACITY> quatRing_;
+  MahonyAhrs         ahrs_;                        // IMU task, samples that carry gyro
+  std::atomic<uint16_t> quatHz_{AHRS_QUAT_HZ};
+  uint32_t           quatAcc_  = 0;                // IMU task: += quat_hz per sample, publish at >= rate
+  CaptureBuffer      capture_;                     // IMU task writes every sample, in both outputs
+  StrideraCaptureRecord* captureMem_ = nullptr;
+  TaskHandle_t       task_     = nullptr;
+  esp_timer_handle_t timer_    = nullptr;
+  std::atomic<bool>  sampling_{false};
+  std::atomic<bool>  inTick_{false};               // IMU task is inside handleTick(): stopSampling() waits it out
+  SensorOutput       output_   = SensorOutput::Full;   // set while the task is parked
+  volatile int64_t   tickUs_   = 0;               // esp_timer time of the latest tick
+
+  // Timing (written by the IMU task only)
+  int64_t  startUs_      = 0;
+  int64_t  lastTickUs_   = 0;
+  uint32_t ticks_        = 0;
+  uint32_t samples_      = 0;
+  uint16_t seq_          = 0;                      // v2 sequence number of the next sample
+  uint64_t jitterSumUs_  = 0;
+  uint32_t jitterMaxUs_  = 0;
 
   // Replay
   CsvReplay player_;
-  uint8_t   replayRateHz_ = 100;
+  ReplayScheduler<CsvReplay> replay_;              // paces player_ on the recorded timestamps
   bool      replayReady_ = false;
+  TaskHandle_t prefetchTask_ = nullptr;
 };
@@ -0,0 +1,61 @@
+#include "Perf.h"
+
+#if STRIDERA_PERF
+PerfProbes g_perf;
+
+namespace {
+constexpr size_t kStages = 7;
+
+struct StageRef { uint8_t id; const char* name; const PerfStat* stat; };
+
+size_t stages(const PerfProbes& p, StageRef* out) {
+  size_t n = 0;
+  out[n++] = { STRIDERA_PERF_STAGE_IMU_READ,   "imu_read",   &p.imuRead };
+  out[n++] = { STRIDERA_PERF_STAGE_IMU_DSP,    "imu_dsp",    &p.imuDsp };
+  out[n++] = { STRIDERA_PERF_STAGE_AHRS,       "ahrs",       &p.ahrs };
+  out[n++] = { STRIDERA_PERF_STAGE_IMU_TICK,   "imu_tick",   &p.imuTick.stat };
+  out[n++] = { STRIDERA_PERF_STAGE_BLE_NOTIFY, "ble_notify", &p.bleNotify };
+  out[n++] = { STRIDERA_PERF_STAGE_UI_DRAW,    "ui_draw",    &p.uiDraw };
+  out[n++] = { STRIDERA_PERF_STAGE_LOOP,       "loop",       &p.loop.stat };
+  return n;
+}
+}
+
+void PerfProbes::requestReset() {
+  imuRead.requestReset();
+  imuDsp.requestReset();
+  ahrs.requestReset();
+  imuTick.requestReset();
+  bleNotify.requestReset();
+  uiDraw.requestReset();
+  loop.requestReset();
+}
+
+size_t PerfProbes::snapshot(uint8_t* buf, size_t cap) const {
+  StageRef st[kStages];
+  const size_t n = stages(*this, st);
+  if (cap < sizeof(StrideraPerfHeader)) return 0;
+
+  StrideraPerfHeader h{STRIDERA_FRAME_PERF, 0, (uint16_t)stridera_perf_ticks_per_us()};
+  size_t len = sizeof(h);
+  for (size_t i = 0; i < n && len + sizeof(StrideraPerfEntry) <= cap; ++i) {
+    const StrideraPerfEntry e = stridera_perf_entry(st[i].id, *st[i].stat);
+    memcpy(buf + len, &e, sizeof(e));
+    len += sizeof(e);
+    ++h.count;
+  }
+  memcpy(buf, &h, sizeof(h));
+  return len;
+}
+
+void PerfProbes::print(Print& out) const {
+  StageRef st[kStages];
+  const size_t n = stages(*this, st);
+  for (size_t i = 0; i < n; ++i) {
+    const StrideraPerfEntry e = stridera_perf_entry(st[i].id, *st[i].stat);
+    out.printf("[PERF] %-10s n=%-7lu min=%7.1f avg=%7.1f p99=%7.1f max=%7.1f us\n", st[i].name,
+               (unsigned long)e.count, e.min_ns / 1000.0f, e.avg_ns / 1000.0f,
+               e.p99_ns / 1000.0f, e.max_ns / 1000.0f);
+  }
+}
+#endif
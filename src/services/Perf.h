@@ -0,0 +1,25 @@
+// Perf.h
+#pragma once
+#include <Arduino.h>
+#include "perf_probe.h"
+
+// Hot-path probes shared by the services. Everything here (and every
+// STRIDERA_PERF_SCOPE / STRIDERA_PERF_MARK that names g_perf) disappears
+// unless the build sets -D STRIDERA_PERF=1.
+#if STRIDERA_PERF
+struct PerfProbes {
+  PerfStat   imuRead;      // IMU task
+  PerfStat   imuDsp;       // IMU task
+  PerfStat   ahrs;         // IMU task, inside imuDsp
+  PerfPeriod imuTick;      // IMU task
+  PerfStat   bleNotify;    // loop task
+  PerfStat   uiDraw;       // UI task
+  PerfPeriod loop;         // loop task
+
+  void   requestReset();                           // any task; each probe clears on its writer's next sample
+  size_t snapshot(uint8_t* buf, size_t cap) const; // StrideraPerfHeader + entries, bytes written
+  void   print(Print& out) const;                  // one [PERF] line per stage, in us
+};
+
+extern PerfProbes g_perf;
+#endif
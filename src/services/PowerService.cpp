@@ -1,9 +1,25 @@
 #include "PowerService.h"
+#include <esp_pm.h>
+#include "m5_bus_lock.h"
+#include "Perf.h"
+
+void PowerService::begin() {
+  PowerConfig cfg;
+  cfg.backlight_on         = UI_BACKLIGHT_ON;
+  cfg.backlight_timeout_ms = UI_BACKLIGHT_TIMEOUT_MS;
+  policy_.begin(cfg, millis());
+  update(PowerMode::Idle, 0);
+  Serial.printf("[PWR] DFS %s, light sleep %s\n", pmOk_ ? "on" : "unavailable (setCpuFrequencyMhz only)",
+                sleepOk_ ? "on" : "unavailable (needs CONFIG_PM_ENABLE + tickless idle)");
+}
 
 // Detect a *release after hold* to avoid "instant reboot" when PMU sees key still down.
 // See M5Unified Button_Class: pressedFor / wasReleased require M5.update() every loop.
 bool PowerService::longPressToggled() {
-  M5.update();  // refresh BtnPWR state (required by M5Unified Button API)
+  {
+    M5BusLock bus;  // buttons, touch and the PMIC key sit on the IMU's bus
+    M5.update();    // refresh BtnPWR state (required by M5Unified Button API)
+  }
 
   // 1) Latch when the button has been held long enough
   if (!holdSeen_ && M5.BtnPWR.pressedFor(kLongPressMs)) {
@@ -19,10 +35,94 @@ bool PowerService::longPressToggled() {
   return false;
 }
 
+void PowerService::activity() {
+  activity_.store(true, std::memory_order_release);
+}
+
+void PowerService::update(PowerMode mode, uint32_t samples) {
+  const uint32_t now = millis();
+  if (activity_.exchange(false, std::memory_order_acq_rel)) policy_.activity(now);
+
+  // Energy per sample: streaming only, one PMIC reading per POWER_METER_MS
+  if (mode != mode_) {
+    if (mode_ == PowerMode::Streaming) report("stream end");
+    meter_.reset();
+    meterMs_ = reportMs_ = now;
+    lastSamples_ = samples;
+    mode_ = mode;
+  }
+  if (mode_ == PowerMode::Streaming && now - meterMs_ >= POWER_METER_MS) {
+    meterMs_ = now;
+    int32_t mv, ma;
+    {
+      M5BusLock bus;
+      mv = M5.Power.getBatteryVoltage();
+      ma = M5.Power.getBatteryCurrent();
+    }
+    meter_.addReading(now, mv, ma, samples - lastSamples_);
+    lastSamples_ = samples;
+    if (now - reportMs_ >= POWER_REPORT_MS) { reportMs_ = now; report("streaming"); }
+  }
+
+  const PowerPlan p = policy_.plan(mode, now);
+  if (p != plan_) apply(p);
+}
+
+uint32_t PowerService::dueMs() const {
+  const uint32_t now = millis();
+  uint32_t due = policy_.dueMs(now);
+  if (mode_ == PowerMode::Streaming) {
+    const uint32_t age = now - meterMs_;
+    const uint32_t m = age >= POWER_METER_MS ? 0 : POWER_METER_MS - age;
+    if (m < due) due = m;
+  }
+  return due;
+}
+
+void PowerService::apply(const PowerPlan& p) {
+  if (p.cpu_mhz != plan_.cpu_mhz || p.light_sleep != plan_.light_sleep) {
+    pmOk_ = sleepOk_ = false;
+  #if CONFIG_PM_ENABLE && CONFIG_IDF_TARGET_ESP32
+    // DFS between XTAL-derived min and the planned max; light sleep whenever
+    // every task is blocked (IMU timer ticks and BLE events wake it).
+    esp_pm_config_esp32_t pm{};
+    pm.max_freq_mhz       = p.cpu_mhz;
+    pm.min_freq_mhz       = POWER_MIN_MHZ;
+    pm.light_sleep_enable = p.light_sleep;
+    if (esp_pm_configure(&pm) == ESP_OK) {
+      pmOk_ = true;
+      sleepOk_ = p.light_sleep;
+    } else if (p.light_sleep) {                  // tickless idle not in this build: DFS only
+      pm.light_sleep_enable = false;
+      pmOk_ = esp_pm_configure(&pm) == ESP_OK;
+    }
+  #endif
+    if (!pmOk_) setCpuFrequencyMhz(p.cpu_mhz);
+  #if STRIDERA_PERF
+    if (p.cpu_mhz != plan_.cpu_mhz) g_perf.requestReset();   // cycle counts change meaning
+  #endif
+  }
+  plan_ = p;
+}
+
+void PowerService::report(const char* why) {
+  if (!meter_.valid()) {
+    if (meter_.invalidReadings()) Serial.printf("[PWR] %s: no energy figure (battery not discharging, on USB?)\n", why);
+    return;
+  }
+  Serial.printf("[PWR] %s: %u mW avg, %u uJ/sample over %llu samples (%u s) @%u MHz%s\n", why,
+                meter_.avgMilliwatts(), meter_.microjoulesPerSample(),
+                (unsigned long long)meter_.samples(), meter_.elapsedMs() / 1000, plan_.cpu_mhz,
+                sleepOk_ ? " + light sleep" : "");
+}
+
 void PowerService::powerOff() {
   // UX: blank and sleep the panel so the user sees a proper shutdown
   M5.Display.fillScreen(TFT_BLACK);
-  M5.Display.sleep();
+  {
+    M5BusLock bus;  // Core2: panel sleep also switches the AXP192 backlight rail
+    M5.Display.sleep();
+  }
 
   // Small guard so the PMU definitely sees the key released
   // and to let USB CDC flush if connected to a host.
@@ -31,7 +131,10 @@ void PowerService::powerOff() {
 
   // Official power cut for PMIC-equipped devices (Core2). 
   // Per M5 docs, true power-off requires running on battery.
-  M5.Power.powerOff();
+  {
+    M5BusLock bus;
+    M5.Power.powerOff();
+  }
 
   // If powerOff() returns (edge cases), park the CPU.
   while (true) { delay(1000); }
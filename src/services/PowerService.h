@@ -1,14 +1,43 @@
 #pragma once
 #include <Arduino.h>
 #include <M5Unified.h>
+#include <atomic>
+#include "power_policy.h"
+#include "config.h"
 
 // PowerService.h
+// Long-press power-off, plus the power policy (power_policy.h): CPU clock and
+// automatic light sleep per activity, backlight timeout, energy per streamed
+// sample from the PMIC's battery voltage/current.
 class PowerService {
 public:
+  void begin();                                  // policy + PM capabilities (after M5.begin)
   bool longPressToggled();   // now: returns true once on RELEASE after a long press
   void powerOff();
+
+  void activity();                               // any task: user / central activity (backlight on)
+  // Loop task, after every FSM step. `samples` = IMU samples produced so far this session.
+  void update(PowerMode mode, uint32_t samples);
+  uint8_t  backlight() const { return plan_.backlight; }
+  uint32_t dueMs() const;                        // next time update() has work on its own
+
 private:
+  void apply(const PowerPlan& p);
+  void report(const char* why);
+
   static constexpr uint32_t kLongPressMs = 2000;
   bool holdSeen_ = false;    // internal latch: we saw a long press, waiting for release
-};
 
+  PowerPolicy policy_;
+  PowerPlan   plan_{0, false, 0};
+  PowerMode   mode_ = PowerMode::Idle;
+  bool        pmOk_ = false;                     // esp_pm accepted a config (DFS available)
+  bool        sleepOk_ = false;                  // ... with automatic light sleep
+  std::atomic<bool> activity_{false};
+
+  // Energy while streaming
+  EnergyMeter meter_;
+  uint32_t    meterMs_   = 0;
+  uint32_t    reportMs_  = 0;
+  uint32_t    lastSamples_ = 0;
+};
@@ -0,0 +1,88 @@
+#include "RecorderService.h"
+#include <esp_timer.h>
+
+#if STRIDERA_HAS_SD
+#include <SD.h>
+
+void RecorderService::begin() {
+  sdReady_ = SD.begin(4);                        // no-op if replay already mounted it (Core2 CS = 4)
+  if (!sdReady_) {
+    Serial.println("[REC] no SD card, recording disabled");
+    return;
+  }
+  rec_.setClock(&RecorderService::clockUs);
+  rec_.setWake(&RecorderService::wake, this);
+  if (!task_) {
+    xTaskCreatePinnedToCore(&RecorderService::taskEntry, "rec", REC_TASK_STACK, this,
+                            REC_TASK_PRIO, &task_, REC_TASK_CORE);
+  }
+}
+
+bool RecorderService::start(uint16_t rate_hz) {
+  if (!sdReady_ || rec_.active()) return false;
+
+  // Next free session number
+  for (uint16_t i = 1; i < 10000; ++i) {
+    snprintf(name_, sizeof(name_), "/rec_%04u.ssn", i);
+    if (!SD.exists(name_)) break;
+  }
+  char path[32];
+  snprintf(path, sizeof(path), "/sd%s", name_);  // POSIX path through the SD VFS mount
+
+  if (!rec_.begin(&file_, path, rate_hz, REC_PREALLOC_BYTES)) return false;
+  report_ = true;
+  Serial.printf("[REC] recording %s @%u Hz\n", name_, rate_hz);
+  return true;
+}
+
+void RecorderService::stop() {
+  rec_.requestStop();
+}
+
+void RecorderService::append(const StrideraAccelPacket& pkt) {
+  rec_.append(pkt);
+}
+
+bool RecorderService::busy() const {
+  return rec_.active();
+}
+
+void RecorderService::poll() {
+  if (!report_ || rec_.active()) return;
+  report_ = false;
+  const RecorderStats& st = rec_.stats();
+  Serial.printf("[REC] %s %s: %u records, %u dropped, %u KB, write %u KB/s, worst write %u ms\n",
+                name_, rec_.closed() ? "closed" : "FAILED", st.records, st.dropped,
+                st.bytes_written / 1024, st.kbps(), st.write_us_max / 1000);
+}
+
+void RecorderService::taskEntry(void* arg) {
+  auto* self = static_cast<RecorderService*>(arg);
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);     // woken on begin / full buffer / stop
+    while (self->rec_.service()) {}
+  }
+}
+
+void RecorderService::wake(void* arg) {
+  auto* self = static_cast<RecorderService*>(arg);
+  if (self->task_) xTaskNotifyGive(self->task_);
+}
+
+uint32_t RecorderService::clockUs() {
+  return (uint32_t)esp_timer_get_time();
+}
+
+#else  // no SD slot: recording is unavailable
+
+void RecorderService::begin() {}
+bool RecorderService::start(uint16_t) { return false; }
+void RecorderService::stop() {}
+void RecorderService::append(const StrideraAccelPacket&) {}
+bool RecorderService::busy() const { return false; }
+void RecorderService::poll() {}
+void RecorderService::taskEntry(void*) {}
+void RecorderService::wake(void*) {}
+uint32_t RecorderService::clockUs() { return (uint32_t)esp_timer_get_time(); }
+
+#endif
@@ -0,0 +1,35 @@
+#pragma once
+#include <Arduino.h>
+#include "stridera_packet.h"
+#include "session_recorder.h"
+#include "config.h"
+
+// RecorderService — offline sessions to SD as .ssn files (Core2, STRIDERA_HAS_SD=1).
+// The loop task appends samples into RAM buffers; a low-priority writer task
+// does all FAT I/O, so card latency spikes never reach the sampling path.
+class RecorderService {
+public:
+  void begin();                                  // mount SD, create the (parked) writer task
+  bool available() const { return sdReady_; }    // SD present and mounted
+  bool start(uint16_t rate_hz);                  // open the next /rec_NNNN.ssn
+  void stop();                                   // writer flushes, writes index + header, closes
+  void append(const StrideraAccelPacket& pkt);
+  bool busy() const;                             // recording or still closing
+  void poll();                                   // report stats once a session is closed
+  const char* currentName() const { return name_; }
+
+private:
+  static void taskEntry(void* arg);
+  static void wake(void* arg);
+  static uint32_t clockUs();
+
+  bool sdReady_ = false;
+  bool report_  = false;
+  char name_[24] = {0};                          // e.g. "/rec_0003.ssn"
+
+#if STRIDERA_HAS_SD
+  PosixBlockFile file_;
+  SessionRecorder<REC_BUFFER_BYTES> rec_;
+  TaskHandle_t task_ = nullptr;
+#endif
+};
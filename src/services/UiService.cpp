@@ -0,0 +1,156 @@
+#include "UiService.h"
+#include <driver/gpio.h>
+#include <esp_sleep.h>
+#include "Perf.h"
+#include "m5_bus_lock.h"
+
+namespace {
+constexpr int kBannerH = 48;                     // two Font2 lines + gap
+constexpr int kLineGap = 6;                      // between banner lines
+}
+
+void UiService::begin(const Seqlock<StrideraAccelPacket>* latest) {
+  latest_ = latest;
+
+  M5.Display.setFont(&fonts::Font2);
+  M5.Display.setTextSize(1);
+  const int w      = M5.Display.width();
+  const int stripH = M5.Display.fontHeight() + 6;
+  bannerY_ = M5.Display.height() / 2 - kBannerH / 2;
+  stripY_  = M5.Display.height() - stripH;
+
+  for (M5Canvas* c : {&banner_, &strip_}) {
+    c->setColorDepth(8);                         // black on white: RGB332 is plenty
+    c->setFont(&fonts::Font2);
+    c->setTextSize(1);
+    c->setTextColor(TFT_BLACK, TFT_WHITE);
+  }
+  banner_.createSprite(w, kBannerH);
+  banner_.setTextDatum(textdatum_t::middle_center);
+  strip_.createSprite(w, stripH);
+  strip_.setTextDatum(textdatum_t::bottom_center);
+
+  M5.Display.fillScreen(TFT_WHITE);
+  drawHeader();
+
+  stop_ = false;
+  parked_ = false;
+  if (!task_) {
+    xTaskCreatePinnedToCore(&UiService::taskEntry, "ui", UI_TASK_STACK, this,
+                            UI_TASK_PRIO, &task_, UI_TASK_CORE);
+  } else {
+    vTaskResume(task_);
+  }
+}
+
+void UiService::end() {
+  if (!task_ || parked_) return;
+  stop_ = true;
+  wake();                                        // may be blocked with the backlight off
+  while (!parked_) delay(1);                     // at most one render in flight
+}
+
+void UiService::wakeOnPin(int pin) {
+  attachInterruptArg(pin, &UiService::pinIsr, this, FALLING);
+  // Automatic light sleep only ends on enabled wake sources
+  gpio_wakeup_enable((gpio_num_t)pin, GPIO_INTR_LOW_LEVEL);
+  esp_sleep_enable_gpio_wakeup();
+  ++wakePins_;
+}
+
+void IRAM_ATTR UiService::pinIsr(void* arg) {
+  auto* self = static_cast<UiService*>(arg);
+  if (!self->task_) return;
+  BaseType_t woken = pdFALSE;
+  vTaskNotifyGiveFromISR(self->task_, &woken);
+  if (woken) portYIELD_FROM_ISR();
+}
+
+void UiService::taskEntry(void* arg) {
+  static_cast<UiService*>(arg)->taskLoop();
+}
+
+void UiService::taskLoop() {
+  UiStatus st{};
+  uint32_t shownVersion = UINT32_MAX;
+  uint32_t hudMs = 0;
+  uint8_t  brightness = UI_BACKLIGHT_ON;
+
+  for (;;) {
+    if (stop_) {
+      parked_ = true;
+      vTaskSuspend(nullptr);
+      continue;
+    }
+
+    if (poll_) poll_(pollArg_);
+
+    const uint8_t bl = backlight_.load(std::memory_order_relaxed);
+    if (bl != brightness) {                      // power policy: backlight timeout
+      brightness = bl;
+      M5BusLock bus;                             // Core2: backlight is an AXP192 register
+      M5.Display.setBrightness(bl);
+    }
+
+    // Banner: only when System published something new
+    const uint32_t v = status_.version();
+    if (v != shownVersion && status_.read(st)) {
+      shownVersion = v;
+      renderBanner(st);
+      if (!st.hud) renderHud("");                // leaving STREAMING: clear the strip
+    }
+
+    // HUD strip: latest sample at UI_REFRESH_MS, pushed only if the text changed
+    StrideraAccelPacket p;
+    if (st.hud && millis() - hudMs >= UI_REFRESH_MS && latest_ && latest_->read(p)) {
+      hudMs = millis();
+      char buf[sizeof(hudShown_)];
+      if (st.replay) {
+        snprintf(buf, sizeof(buf), "REPLAY mg: %d %d %d @%uHz", p.ax_mg, p.ay_mg, p.az_mg, p.rate_hz);
+      } else {
+        snprintf(buf, sizeof(buf), "IMU mg: %d %d %d", p.ax_mg, p.ay_mg, p.az_mg);
+      }
+      renderHud(buf);
+    }
+
+    // Backlight off and nothing new to draw: block until a button line, a status
+    // or the backlight changes, so IDLE does not wake the CPU every UI_POLL_MS
+    const bool dark = brightness == 0 && wakePins_ && status_.version() == shownVersion;
+    ulTaskNotifyTake(pdTRUE, dark ? portMAX_DELAY : pdMS_TO_TICKS(UI_POLL_MS));
+  }
+}
+
+void UiService::drawHeader() {
+  // Small header at top-center
+  M5.Display.setTextDatum(textdatum_t::top_center);
+  M5.Display.setFont(&fonts::Font2);
+  M5.Display.setTextSize(1);
+  M5.Display.setTextColor(TFT_BLACK, TFT_WHITE);
+  M5.Display.drawString("Stridera IMU BLE Streamer", M5.Display.width() / 2, 4);
+}
+
+void UiService::renderBanner(const UiStatus& st) {
+  STRIDERA_PERF_SCOPE(g_perf.uiDraw);
+  const int cx = banner_.width() / 2;
+  const int cy = banner_.height() / 2;
+
+  banner_.fillSprite(TFT_WHITE);
+  if (st.line2[0]) {
+    const int fh = banner_.fontHeight();
+    banner_.drawString(st.line1, cx, cy - (fh / 2 + kLineGap / 2));
+    banner_.drawString(st.line2, cx, cy + (fh / 2 + kLineGap / 2));
+  } else {
+    banner_.drawString(st.line1, cx, cy);
+  }
+  banner_.pushSprite(0, bannerY_);
+}
+
+void UiService::renderHud(const char* text) {
+  if (strcmp(text, hudShown_) == 0) return;      // unchanged: no SPI traffic at all
+  STRIDERA_PERF_SCOPE(g_perf.uiDraw);
+  strncpy(hudShown_, text, sizeof(hudShown_) - 1);
+
+  strip_.fillSprite(TFT_WHITE);
+  if (*text) strip_.drawString(text, strip_.width() / 2, strip_.height() - 2);
+  strip_.pushSprite(0, stripY_);
+}
@@ -0,0 +1,67 @@
+// UiService.h
+#pragma once
+#include <Arduino.h>
+#include <M5Unified.h>
+#include <atomic>
+#include "stridera_packet.h"
+#include "seqlock.h"
+#include "config.h"
+
+// What the screen should show; composed by System (loop task) on state changes
+struct UiStatus {
+  char line1[24];
+  char line2[40];
+  bool hud;                 // bottom IMU strip (STREAMING only: SD shares the SPI bus on Core2)
+  bool replay;              // HUD label: replayed file instead of the live sensor
+};
+
+// UiService — all display I/O, in a low-priority task on UI_TASK_CORE.
+// The loop and IMU tasks only publish snapshots (Seqlock writes never wait);
+// the task renders changed regions into small off-screen sprites and pushes
+// just those rectangles, so a slow SPI transfer never delays sampling or BLE.
+class UiService {
+public:
+  void begin(const Seqlock<StrideraAccelPacket>* latest);  // sprites, static header, task
+  void end();                                    // park the task (before anyone else draws)
+  void setStatus(const UiStatus& st) { status_.write(st); wake(); }
+  void setBacklight(uint8_t level) {                                   // applied by the task
+    if (backlight_.exchange(level, std::memory_order_relaxed) != level) wake();
+  }
+
+  // Runs on the UI task every UI_POLL_MS while the backlight is on (button
+  // polling lives here so loop() can block)
+  using PollFn = void (*)(void*);
+  void setInputPoll(PollFn fn, void* arg) { poll_ = fn; pollArg_ = arg; }
+
+  // Button / touch interrupt line (active low). Once one is registered, the
+  // task blocks with the backlight off until a line fires or System publishes
+  // something; without one it keeps polling.
+  void wakeOnPin(int pin);
+
+private:
+  static void taskEntry(void* arg);
+  static void IRAM_ATTR pinIsr(void* arg);
+  void wake() { if (task_) xTaskNotifyGive(task_); }
+  void taskLoop();
+  void drawHeader();                             // static title, drawn once
+  void renderBanner(const UiStatus& st);         // 1–2 centered lines
+  void renderHud(const char* text);              // bottom strip ("" = blank)
+
+  const Seqlock<StrideraAccelPacket>* latest_ = nullptr;
+  Seqlock<UiStatus> status_;
+
+  M5Canvas banner_{&M5.Display};                 // 8-bit sprites: ~15 KB + ~7 KB on Core2
+  M5Canvas strip_{&M5.Display};
+  int bannerY_ = 0;
+  int stripY_  = 0;
+  char hudShown_[64] = {0};                      // last pushed HUD text (dirty check)
+
+  PollFn poll_    = nullptr;
+  void*  pollArg_ = nullptr;
+  uint8_t wakePins_ = 0;
+
+  TaskHandle_t task_ = nullptr;
+  std::atomic<uint8_t> backlight_{UI_BACKLIGHT_ON};
+  std::atomic<bool> stop_{false};
+  std::atomic<bool> parked_{false};
+};
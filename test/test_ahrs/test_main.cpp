@@ -0,0 +1,94 @@
+// MahonyAhrs (mahony_ahrs.h) against the double-precision reference and the
+// true orientation of a synthetic 200 Hz trace (bench/ahrs_ref.h): sway and
+// turning with stride bumps, accel noise and a constant gyro bias.
+//   pio test -e native -f test_ahrs
+#include <unity.h>
+#include "ahrs_ref.h"
+
+void setUp() {}
+void tearDown() {}
+
+// Worst errors over a 120 s replay, after twice the start-up window
+struct AhrsErrors {
+  double ref  = 0;                                // fixed point vs double, degrees
+  double q14  = 0;                                // Q14 packing vs Q30
+  double tilt = 0;                                // roll/pitch vs truth
+  bool   settled = false;
+};
+
+static const AhrsErrors& replay() {
+  static AhrsErrors e;
+  static bool done = false;
+  if (done) return e;
+  done = true;
+  std::vector<StrideraSample> sm;
+  std::vector<std::array<double, 4>> truth;
+  synth_imu(120 * 200, 200, sm, truth);
+  AhrsConfig c;
+  MahonyAhrs f;
+  MahonyRef ref;
+  f.begin(c);
+  ref.begin(c);
+  const size_t skip = (size_t)c.settle_ms * c.rate_hz / 1000 * 2;
+  for (size_t i = 0; i < sm.size(); ++i) {
+    const StrideraSample& s = sm[i];
+    f.update(s.v1.ax_mg, s.v1.ay_mg, s.v1.az_mg, s.gyro[0], s.gyro[1], s.gyro[2]);
+    const double k = M_PI / 1800.0;
+    ref.update(s.v1.ax_mg, s.v1.ay_mg, s.v1.az_mg, s.gyro[0] * k, s.gyro[1] * k, s.gyro[2] * k);
+    if (i < skip) continue;
+    double q[4], q14[4];
+    int16_t p[4];
+    f.quatQ14(p);
+    for (int j = 0; j < 4; ++j) { q[j] = f.q()[j] / 1073741824.0; q14[j] = p[j] / 16384.0; }
+    e.ref  = std::max(e.ref, quat_angle_deg(q, ref.q));
+    e.q14  = std::max(e.q14, quat_angle_deg(q, q14));
+    e.tilt = std::max(e.tilt, tilt_err_deg(q, truth[i].data()));
+  }
+  e.settled = f.settled();
+  return e;
+}
+
+static void test_tracks_double_reference() {
+  TEST_ASSERT_TRUE(replay().ref < 0.5);
+}
+
+static void test_q14_packing_loses_under_a_twentieth_degree() {
+  TEST_ASSERT_TRUE(replay().q14 < 0.05);
+}
+
+static void test_tilt_follows_true_orientation() {
+  TEST_ASSERT_TRUE(replay().tilt < 3.0);
+}
+
+static void test_settles_after_start_up_window() {
+  TEST_ASSERT_TRUE(replay().settled);
+  AhrsConfig c;
+  MahonyAhrs f;
+  f.begin(c);
+  f.update(0, 0, 1000, 0, 0, 0);
+  TEST_ASSERT_FALSE(f.settled());
+}
+
+// First sample aligns with gravity: flat, yaw 0
+static void test_first_sample_aligns_with_gravity() {
+  AhrsConfig c;
+  MahonyAhrs f;
+  f.begin(c);
+  f.update(0, 0, 1000, 0, 0, 0);
+  int16_t p[4];
+  f.quatQ14(p);
+  TEST_ASSERT_INT_WITHIN(2, 16384, p[0]);
+  TEST_ASSERT_INT_WITHIN(2, 0, p[1]);
+  TEST_ASSERT_INT_WITHIN(2, 0, p[2]);
+  TEST_ASSERT_INT_WITHIN(2, 0, p[3]);
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_tracks_double_reference);
+  RUN_TEST(test_q14_packing_loses_under_a_twentieth_degree);
+  RUN_TEST(test_tilt_follows_true_orientation);
+  RUN_TEST(test_settles_after_start_up_window);
+  RUN_TEST(test_first_sample_aligns_with_gravity);
+  return UNITY_END();
+}
@@ -0,0 +1,117 @@
+// Batched accel frames (stridera_batch.h): encoder -> decoder round trip.
+//   pio test -e native -f test_batch
+#include <unity.h>
+#include "stridera_batch.h"
+
+void setUp() {}
+void tearDown() {}
+
+static StrideraAccelPacket packet(uint32_t ts_ms, int i) {
+  StrideraAccelPacket p{};
+  p.ts_ms   = ts_ms;
+  p.ax_mg   = (int16_t)(i * 7 - 1000);
+  p.ay_mg   = (int16_t)(-i * 13);
+  p.az_mg   = (int16_t)(1000 + i);
+  p.rate_hz = 200;
+  return p;
+}
+
+static void assert_same(const StrideraAccelPacket& a, const StrideraAccelPacket& b) {
+  TEST_ASSERT_EQUAL_UINT32(a.ts_ms, b.ts_ms);
+  TEST_ASSERT_EQUAL_INT16(a.ax_mg, b.ax_mg);
+  TEST_ASSERT_EQUAL_INT16(a.ay_mg, b.ay_mg);
+  TEST_ASSERT_EQUAL_INT16(a.az_mg, b.az_mg);
+  TEST_ASSERT_EQUAL_UINT8(a.rate_hz, b.rate_hz);
+}
+
+static void test_capacity_follows_mtu() {
+  TEST_ASSERT_EQUAL_size_t(244, stridera_att_payload(247));
+  TEST_ASSERT_EQUAL_size_t(29, stridera_batch_capacity(stridera_att_payload(247)));
+  TEST_ASSERT_EQUAL_size_t(1, stridera_batch_capacity(stridera_att_payload(23)));
+  TEST_ASSERT_EQUAL_size_t(0, stridera_batch_capacity(7));
+}
+
+static void test_full_frame_round_trip() {
+  uint8_t frame[244];
+  StrideraBatchEncoder enc;
+  enc.begin(frame, sizeof(frame));
+
+  StrideraAccelPacket in[29];
+  for (int i = 0; i < 29; ++i) {
+    in[i] = packet(123456 + i * 5, i);
+    TEST_ASSERT_TRUE(enc.push(in[i]));
+  }
+  TEST_ASSERT_TRUE(enc.full());
+  TEST_ASSERT_FALSE(enc.push(packet(123456 + 29 * 5, 29)));
+  TEST_ASSERT_EQUAL_size_t(sizeof(StrideraBatchHeader) + 29 * sizeof(StrideraBatchSample), enc.size());
+
+  StrideraAccelPacket out[32];
+  TEST_ASSERT_EQUAL_size_t(29, stridera_batch_decode(enc.data(), enc.size(), out, 32));
+  for (int i = 0; i < 29; ++i) assert_same(in[i], out[i]);
+}
+
+static void test_offset_limit_starts_new_frame() {
+  uint8_t frame[64];
+  StrideraBatchEncoder enc;
+  enc.begin(frame, sizeof(frame));
+
+  TEST_ASSERT_TRUE(enc.push(packet(1000, 0)));
+  TEST_ASSERT_TRUE(enc.push(packet(1000 + 0xFFFF, 1)));      // largest 16-bit offset
+  TEST_ASSERT_FALSE(enc.push(packet(1000 + 0x10000, 2)));    // one past it
+  TEST_ASSERT_FALSE(enc.push(packet(999, 3)));               // before the base
+  TEST_ASSERT_EQUAL_size_t(2, enc.count());
+
+  StrideraAccelPacket out[4];
+  TEST_ASSERT_EQUAL_size_t(2, stridera_batch_decode(enc.data(), enc.size(), out, 4));
+  TEST_ASSERT_EQUAL_UINT32(1000 + 0xFFFF, out[1].ts_ms);
+
+  enc.reset();
+  const StrideraAccelPacket late = packet(1000 + 0x10000, 2);
+  TEST_ASSERT_TRUE(enc.push(late));
+  TEST_ASSERT_EQUAL_size_t(1, stridera_batch_decode(enc.data(), enc.size(), out, 4));
+  assert_same(late, out[0]);
+}
+
+static void test_base_near_ms_wrap() {
+  uint8_t frame[64];
+  StrideraBatchEncoder enc;
+  enc.begin(frame, sizeof(frame));
+  const StrideraAccelPacket a = packet(0xFFFFFF00u, 0);
+  const StrideraAccelPacket b = packet(0xFFFFFFFFu, 1);
+  const StrideraAccelPacket c = packet(0x00000010u, 2);      // past the wrap: offset 0x110
+  TEST_ASSERT_TRUE(enc.push(a));
+  TEST_ASSERT_TRUE(enc.push(b));
+  TEST_ASSERT_TRUE(enc.push(c));
+
+  StrideraAccelPacket out[3];
+  TEST_ASSERT_EQUAL_size_t(3, stridera_batch_decode(enc.data(), enc.size(), out, 3));
+  assert_same(a, out[0]);
+  assert_same(b, out[1]);
+  assert_same(c, out[2]);
+}
+
+static void test_decode_rejects_bad_frames() {
+  uint8_t frame[64];
+  StrideraBatchEncoder enc;
+  enc.begin(frame, sizeof(frame));
+  for (int i = 0; i < 3; ++i) TEST_ASSERT_TRUE(enc.push(packet(10 + i, i)));
+
+  StrideraAccelPacket out[4];
+  TEST_ASSERT_EQUAL_size_t(0, stridera_batch_decode(enc.data(), enc.size() - 1, out, 4));   // truncated
+  TEST_ASSERT_EQUAL_size_t(0, stridera_batch_decode(enc.data(), 4, out, 4));                // short header
+  TEST_ASSERT_EQUAL_size_t(0, stridera_batch_decode(nullptr, 0, out, 4));
+  TEST_ASSERT_EQUAL_size_t(2, stridera_batch_decode(enc.data(), enc.size(), out, 2));       // caller's max wins
+
+  frame[0] ^= 0xFF;
+  TEST_ASSERT_EQUAL_size_t(0, stridera_batch_decode(frame, enc.size(), out, 4));            // wrong kind
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_capacity_follows_mtu);
+  RUN_TEST(test_full_frame_round_trip);
+  RUN_TEST(test_offset_limit_starts_new_frame);
+  RUN_TEST(test_base_near_ms_wrap);
+  RUN_TEST(test_decode_rejects_bad_frames);
+  return UNITY_END();
+}
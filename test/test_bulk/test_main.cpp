@@ -0,0 +1,192 @@
+// Bulk download engines (bulk_transfer.h) over the in-memory loopback link:
+// credit window, resume after a disconnect, abort / errors, and the names
+// LIST and GET accept (stridera_bulk.h).
+//   pio test -e native -f test_bulk
+#include <unity.h>
+#include <vector>
+#include "bulk_loopback.h"
+
+void setUp() {}
+void tearDown() {}
+
+class VecSource : public IBulkSource {
+public:
+  explicit VecSource(size_t n) : data(n) {
+    uint32_t x = 0x12345678;
+    for (auto& b : data) { x = x * 1103515245u + 12345u; b = (uint8_t)(x >> 16); }
+  }
+  uint32_t size() const override { return (uint32_t)data.size(); }
+  size_t readAt(uint32_t offset, uint8_t* buf, size_t len) override {
+    if (failAt && offset >= failAt) return 0;
+    if (offset >= data.size()) return 0;
+    if (len > data.size() - offset) len = data.size() - offset;
+    memcpy(buf, data.data() + offset, len);
+    return len;
+  }
+  std::vector<uint8_t> data;
+  uint32_t failAt = 0;          // readAt() from here on fails (0 = never)
+};
+
+static constexpr uint16_t kWindow = 16;
+
+// One connection event per round: pump, then hand the granted credits back
+static size_t drive(BulkSender<>& tx, BulkLoopbackLink& link, uint32_t& now, size_t maxRounds = 100000) {
+  size_t rounds = 0;
+  while (tx.active() && link.connected() && rounds++ < maxRounds) {
+    const uint32_t before = tx.credits();
+    const size_t sent = tx.pump(link, now += 7500, 8);
+    TEST_ASSERT_LESS_OR_EQUAL(before + 1, sent);                 // chunks never exceed credits (+1 status)
+    tx.addCredits(link.takeCredits());
+    link.connectionEvent();
+  }
+  return rounds;
+}
+
+static void test_full_transfer_within_credit_window() {
+  VecSource src(100003);
+  std::vector<uint8_t> dst(src.data.size());
+  BulkReceiver rx;
+  rx.begin(dst.data(), (uint32_t)dst.size(), kWindow);
+  BulkLoopbackLink link(rx, 244, 6);
+  BulkSender<> tx;
+  uint32_t now = 0;
+  tx.start(&src, 0, kWindow, now);
+  drive(tx, link, now);
+
+  TEST_ASSERT_FALSE(tx.active());
+  TEST_ASSERT_TRUE(rx.complete());
+  TEST_ASSERT_EQUAL_UINT32(src.size(), rx.size());
+  TEST_ASSERT_EQUAL_MEMORY(src.data.data(), dst.data(), dst.size());
+  TEST_ASSERT_EQUAL_UINT32(0, rx.duplicates());
+  TEST_ASSERT_EQUAL_UINT32(0, rx.outOfOrder());
+  TEST_ASSERT_EQUAL_size_t((src.size() + 238) / 239 + 1, link.frames());   // 239-byte chunks + status
+  TEST_ASSERT_GREATER_THAN(0, rx.reportedBytesPerSec());
+}
+
+static void test_no_credits_no_chunks() {
+  VecSource src(1000);
+  std::vector<uint8_t> dst(src.data.size());
+  BulkReceiver rx;
+  rx.begin(dst.data(), (uint32_t)dst.size(), kWindow);
+  BulkLoopbackLink link(rx, 244, 6);
+  BulkSender<> tx;
+  tx.start(&src, 0, 0, 0);
+  TEST_ASSERT_EQUAL_size_t(0, tx.pump(link, 100));
+  TEST_ASSERT_TRUE(tx.waitingForCredits());
+  TEST_ASSERT_EQUAL_size_t(0, link.frames());
+
+  tx.addCredits(2);
+  TEST_ASSERT_EQUAL_size_t(2, tx.pump(link, 200));
+  TEST_ASSERT_TRUE(tx.waitingForCredits());
+  TEST_ASSERT_EQUAL_UINT32(2 * 239, tx.offset());
+}
+
+// Drop the link at several points; every resume continues from the receiver's
+// contiguous offset and the file arrives intact with nothing sent twice
+static void test_resume_after_disconnects() {
+  VecSource src(50000);
+  std::vector<uint8_t> dst(src.data.size());
+  BulkReceiver rx;
+  rx.begin(dst.data(), (uint32_t)dst.size(), kWindow);
+  BulkLoopbackLink link(rx, 185 - 3, 4);
+  BulkSender<> tx;
+  uint32_t now = 0;
+
+  const size_t drops[] = {1, 17, 40, 3};
+  tx.start(&src, 0, kWindow, now);
+  for (size_t d : drops) {
+    link.disconnectAfter(d);
+    drive(tx, link, now);
+    TEST_ASSERT_FALSE(link.connected());
+    TEST_ASSERT_FALSE(rx.done());
+    tx.reset();                                   // the service drops the transfer with the link
+    rx.resume();
+    link.reconnect();
+    tx.start(&src, rx.contiguous(), kWindow, now);
+    TEST_ASSERT_EQUAL_UINT32(rx.contiguous(), tx.offset());
+  }
+  drive(tx, link, now);
+
+  TEST_ASSERT_TRUE(rx.complete());
+  TEST_ASSERT_EQUAL_MEMORY(src.data.data(), dst.data(), dst.size());
+  TEST_ASSERT_EQUAL_UINT32(0, rx.duplicates());
+  TEST_ASSERT_EQUAL_UINT32(0, rx.outOfOrder());
+}
+
+static void test_resume_past_end_sends_eof_only() {
+  VecSource src(4000);
+  std::vector<uint8_t> dst(src.data.size());
+  BulkReceiver rx;
+  rx.begin(dst.data(), (uint32_t)dst.size(), kWindow);
+  BulkLoopbackLink link(rx, 244, 6);
+  BulkSender<> tx;
+  tx.start(&src, 999999, kWindow, 0);
+  TEST_ASSERT_EQUAL_UINT32(src.size(), tx.offset());
+  TEST_ASSERT_EQUAL_size_t(1, tx.pump(link, 10));
+  TEST_ASSERT_TRUE(rx.done());
+  TEST_ASSERT_EQUAL_UINT8(STRIDERA_BULK_OK_EOF, rx.code());
+}
+
+static void test_abort_and_read_error_report_status() {
+  VecSource src(20000);
+  std::vector<uint8_t> dst(src.data.size());
+  BulkReceiver rx;
+  rx.begin(dst.data(), (uint32_t)dst.size(), kWindow);
+  BulkLoopbackLink link(rx, 244, 100);
+  BulkSender<> tx;
+  tx.start(&src, 0, 4, 0);
+  tx.pump(link, 10);
+  tx.abort();
+  tx.pump(link, 20);
+  TEST_ASSERT_FALSE(tx.active());
+  TEST_ASSERT_TRUE(rx.done());
+  TEST_ASSERT_EQUAL_UINT8(STRIDERA_BULK_ABORTED, rx.code());
+  TEST_ASSERT_FALSE(rx.complete());
+  TEST_ASSERT_EQUAL_UINT32(4 * 239, rx.contiguous());
+
+  src.failAt = 1000;
+  rx.begin(dst.data(), (uint32_t)dst.size(), kWindow);
+  tx.start(&src, 0, 100, 0);
+  tx.pump(link, 10, 100);
+  TEST_ASSERT_FALSE(tx.active());
+  TEST_ASSERT_EQUAL_UINT8(STRIDERA_BULK_ERR_IO, rx.code());
+  TEST_ASSERT_LESS_OR_EQUAL(1000 + 239, rx.contiguous());
+}
+
+// The controller refusing notifications is a stall, not a lost chunk
+static void test_link_stall_keeps_offset() {
+  VecSource src(3000);
+  std::vector<uint8_t> dst(src.data.size());
+  BulkReceiver rx;
+  rx.begin(dst.data(), (uint32_t)dst.size(), kWindow);
+  BulkLoopbackLink link(rx, 244, 2);
+  BulkSender<> tx;
+  tx.start(&src, 0, kWindow, 0);
+  TEST_ASSERT_EQUAL_size_t(2, tx.pump(link, 10));
+  TEST_ASSERT_EQUAL_UINT32(1, tx.stalls());
+  TEST_ASSERT_EQUAL_UINT32(2 * 239, tx.offset());
+  TEST_ASSERT_EQUAL_UINT32(kWindow - 2, tx.credits());
+}
+
+static void test_session_names() {
+  TEST_ASSERT_TRUE(stridera_bulk_session_name("rec_0000.ssn"));
+  TEST_ASSERT_TRUE(stridera_bulk_session_name("rec_9999.ssn"));
+  const char* bad[] = {
+    "", "rec_.ssn", "rec_123.ssn", "rec_12345.ssn", "rec_12a4.ssn", "REC_0001.ssn",
+    "rec_0001.SSN", "rec_0001.csv", "/rec_0001.ssn", "../rec_001.ssn", "snapchat.ssn",
+    STRIDERA_CAPTURE_NAME,
+  };
+  for (const char* n : bad) TEST_ASSERT_FALSE_MESSAGE(stridera_bulk_session_name(n), n);
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_full_transfer_within_credit_window);
+  RUN_TEST(test_no_credits_no_chunks);
+  RUN_TEST(test_resume_after_disconnects);
+  RUN_TEST(test_resume_past_end_sends_eof_only);
+  RUN_TEST(test_abort_and_read_error_report_status);
+  RUN_TEST(test_link_stall_keeps_offset);
+  RUN_TEST(test_session_names);
+  return UNITY_END();
+}
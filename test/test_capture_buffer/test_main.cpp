@@ -0,0 +1,235 @@
+// CaptureBuffer (capture_buffer.h): a 200 Hz 6-axis walk (|a| 0.5..1.3 g)
+// with a 7 g impact at sample 5000 into a 4096-record ring (20 s), 3 s before
+// and 1 s after each trigger. Windows are checked against the samples they
+// were cut from, and dumped through the bulk loopback.
+//   pio test -e native -f test_capture_buffer
+#include <unity.h>
+#include <string>
+#include <vector>
+#include "bench_data.h"
+#include "bulk_loopback.h"
+#include "capture_buffer.h"
+#include "system_fsm.h"
+
+static std::vector<StrideraSample>        smp;
+static std::vector<StrideraCaptureRecord> mem(4096);
+static StrideraCaptureConfig              cc;
+static CaptureBuffer                      cap;
+
+static void impact(size_t i, int16_t az) { smp[i].v1.ax_mg = 1200; smp[i].v1.ay_mg = -900; smp[i].v1.az_mg = az; }
+
+void setUp() {
+  smp = bench_walk_imu_samples(40000);
+  impact(5000, 6900);
+  cc = StrideraCaptureConfig{};
+  cc.accel_high_mg = 6000;
+  cc.pre_ms        = 3000;
+  cc.post_ms       = 1000;
+  cap.begin(mem.data(), (uint32_t)mem.size(), cc);
+}
+void tearDown() {}
+
+static void feed(size_t from, size_t to) { for (size_t i = from; i < to; ++i) cap.push(smp[i]); }
+
+// The frozen window against the samples it was cut from (sample `first` = record 0)
+static void assert_window(size_t first) {
+  TEST_ASSERT_TRUE(cap.frozen());
+  const StrideraCaptureHeader h = cap.header();
+  std::vector<uint8_t> dump(cap.size());
+  TEST_ASSERT_EQUAL_size_t(sizeof(h) + h.record_count * sizeof(StrideraCaptureRecord), dump.size());
+  TEST_ASSERT_EQUAL_size_t(dump.size(), cap.readAt(0, dump.data(), dump.size()));
+  TEST_ASSERT_EQUAL_MEMORY(&h, dump.data(), sizeof(h));
+  TEST_ASSERT_EQUAL_MEMORY(STRIDERA_CAPTURE_MAGIC, h.magic, 4);
+  for (uint32_t k = 0; k < h.record_count; ++k) {
+    StrideraCaptureRecord r;
+    memcpy(&r, dump.data() + sizeof(h) + k * sizeof(r), sizeof(r));
+    const StrideraSample& s = smp[first + k];
+    TEST_ASSERT_EQUAL_UINT32(s.ts_us, r.ts_us);
+    TEST_ASSERT_EQUAL_INT16(s.v1.ax_mg, r.ax_mg);
+    TEST_ASSERT_EQUAL_INT16(s.v1.ay_mg, r.ay_mg);
+    TEST_ASSERT_EQUAL_INT16(s.v1.az_mg, r.az_mg);
+    TEST_ASSERT_EQUAL_INT16(s.gyro[0], r.gx);
+    TEST_ASSERT_EQUAL_INT16(s.gyro[1], r.gy);
+    TEST_ASSERT_EQUAL_INT16(s.gyro[2], r.gz);
+  }
+}
+
+// 600 records before, the one that fired, 200 after
+static void test_impact_freezes_the_window_around_it() {
+  feed(0, 5001);
+  TEST_ASSERT_EQUAL(CaptureBuffer::Post, cap.state());
+  feed(5001, 5201);
+  const StrideraCaptureHeader h = cap.header();
+  TEST_ASSERT_EQUAL_UINT8(STRIDERA_CAPTURE_CAUSE_ACCEL_HIGH, h.cause);
+  TEST_ASSERT_EQUAL_UINT32(801, h.record_count);
+  TEST_ASSERT_EQUAL_UINT32(600, h.trigger_record);
+  TEST_ASSERT_EQUAL_UINT32(smp[5000].ts_us, h.trigger_ts_us);
+  TEST_ASSERT_EQUAL_UINT16(200, h.rate_hz);
+  TEST_ASSERT_EQUAL_UINT32(7061, h.trigger_value);        // |(1200, -900, 6900)| mg
+  assert_window(4400);
+}
+
+// Frozen: a manual fire is ignored and samples are skipped until the reader re-arms
+static void test_frozen_window_ignores_triggers() {
+  feed(0, 5201);
+  cap.trigger();
+  feed(5201, 5301);
+  TEST_ASSERT_EQUAL_UINT32(1, cap.stats().ignored);
+  TEST_ASSERT_EQUAL_UINT32(100, cap.stats().skipped);
+  assert_window(4400);
+}
+
+// MTU 247, one disconnect and a resume from the receiver's contiguous offset
+static void test_dump_survives_disconnect_and_resume() {
+  feed(0, 5201);
+  std::vector<uint8_t> dump(cap.size()), got(cap.size());
+  cap.readAt(0, dump.data(), dump.size());
+  CaptureSource src(&cap);
+  BulkReceiver rx;
+  rx.begin(got.data(), (uint32_t)got.size(), 16);
+  BulkLoopbackLink link(rx, 244, 6);
+  BulkSender<> tx;
+  uint32_t t = 0;
+  tx.start(&src, 0, 16, t);
+  link.disconnectAfter(20);
+  bool resumed = false;
+  while (!rx.complete() && t < 100000000) {
+    t += 7500;
+    link.connectionEvent();
+    tx.pump(link, t, 16);
+    tx.addCredits(link.takeCredits());
+    if (!link.connected()) {
+      link.reconnect();
+      rx.resume();
+      tx.start(&src, rx.contiguous(), 16, t);
+      resumed = true;
+    }
+  }
+  TEST_ASSERT_TRUE(resumed);
+  TEST_ASSERT_TRUE(rx.complete());
+  TEST_ASSERT_TRUE(got == dump);
+}
+
+// Re-armed 1 s before the next trigger: only what was recorded since then comes before it
+static void test_rearm_shortens_the_next_pre_trigger_part() {
+  feed(0, 5301);
+  cap.rearm();
+  TEST_ASSERT_FALSE(cap.frozen());
+  TEST_ASSERT_EQUAL_UINT32(0, cap.size());
+  feed(5301, 6000);
+  cap.trigger();
+  feed(6000, 6300);                                         // fires on 6000, freezes after 6200
+  TEST_ASSERT_EQUAL_UINT8(STRIDERA_CAPTURE_CAUSE_MANUAL, cap.header().cause);
+  TEST_ASSERT_EQUAL_UINT32(600, cap.header().trigger_record);
+  assert_window(5400);
+  cap.rearm();
+  feed(6300, 6500);
+  cap.trigger();
+  feed(6500, 6800);
+  TEST_ASSERT_EQUAL_UINT32(200, cap.header().trigger_record);
+  assert_window(6300);
+}
+
+// Reconfigured at runtime: gyro above 150 dps, then free fall below 600 mg; 0.5 s before, none after
+static void test_gyro_and_free_fall_triggers() {
+  StrideraCaptureConfig c2{};
+  c2.pre_ms = 500;
+  cap.configure(c2);                                        // all off while the pre-trigger part fills
+  feed(0, 200);
+  c2.gyro_dps = 150;
+  cap.configure(c2);
+  size_t i = 200;
+  while (i < 20000 && !cap.frozen()) cap.push(smp[i++]);
+  TEST_ASSERT_EQUAL_UINT8(STRIDERA_CAPTURE_CAUSE_GYRO, cap.header().cause);
+  TEST_ASSERT_EQUAL_UINT32(101, cap.header().record_count);
+  TEST_ASSERT_TRUE(cap.header().trigger_value >= 150);
+  assert_window(i - 101);
+
+  c2.gyro_dps = 0;
+  cap.configure(c2);
+  cap.rearm();
+  feed(i, i + 200);
+  i += 200;
+  c2.accel_low_mg = 600;
+  cap.configure(c2);
+  while (i < 40000 && !cap.frozen()) cap.push(smp[i++]);
+  TEST_ASSERT_EQUAL_UINT8(STRIDERA_CAPTURE_CAUSE_ACCEL_LOW, cap.header().cause);
+  TEST_ASSERT_TRUE(cap.header().trigger_value <= 600);
+  assert_window(i - 101);
+}
+
+// Window across the end of the ring (slots 3400..4095, then 0..104): still in order
+static void test_window_across_the_ring_end() {
+  impact(24000, 6900);
+  feed(20000, 24300);
+  assert_window(23400);
+}
+
+// Impacts every 10000 samples, the reader re-arming at once: every one is kept
+static void test_every_impact_is_captured() {
+  for (size_t i = 15000; i < smp.size(); i += 10000) impact(i, 6900);
+  uint32_t windows = 0;
+  for (size_t i = 0; i < smp.size(); ++i) {
+    cap.push(smp[i]);
+    if (cap.frozen()) { windows += cap.header().record_count == 801; cap.rearm(); }
+  }
+  TEST_ASSERT_EQUAL_UINT32(4, windows);
+  TEST_ASSERT_EQUAL_UINT32(4, cap.stats().captures);
+  TEST_ASSERT_EQUAL_UINT32(0, cap.stats().skipped);
+}
+
+// No central ever connects: the FSM goes BOOTING -> IDLE and the sensor feeds
+// the ring per system_sensor_output() (nothing while booting)
+static uint32_t s_clock_us = 0;
+static uint32_t vclock() { return s_clock_us; }
+
+class NoCentralPort : public ISystemPort {
+public:
+  std::string trail;
+  bool connected() const override { return false; }
+  bool recorderBusy() const override { return false; }
+  void startStreaming() override {}
+  void stopStreaming(bool) override {}
+  bool startRecording() override { return false; }
+  void stopRecording() override {}
+  void beginShutdown() override {}
+  void finishShutdown() override {}
+  void onTransition(SystemState f, SystemState t, uint32_t) override {
+    trail += system_state_name(f)[0];
+    trail += '>';
+    trail += system_state_name(t)[0];
+  }
+};
+
+static void test_idle_without_central_still_captures() {
+  NoCentralPort port;
+  SystemFsm fsm;
+  s_clock_us = 0;
+  fsm.begin(&port, &vclock);
+  uint32_t fed = 0;
+  for (size_t k = 0; k < 5201; ++k) {
+    s_clock_us = (uint32_t)k * 5000;                        // 200 Hz
+    fsm.step(FSM_EV_LINK, s_clock_us);
+    if (system_sensor_output(fsm.state()) == SensorOutput::Off) continue;
+    cap.push(smp[k]);
+    ++fed;
+  }
+  TEST_ASSERT_TRUE(fsm.state() == SystemState::IDLE);
+  TEST_ASSERT_EQUAL_STRING("B>I", port.trail.c_str());
+  TEST_ASSERT_EQUAL_UINT32(4801, fed);                      // 2 s boot grace
+  TEST_ASSERT_EQUAL_UINT32(smp[5000].ts_us, cap.header().trigger_ts_us);
+  assert_window(4400);
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_impact_freezes_the_window_around_it);
+  RUN_TEST(test_frozen_window_ignores_triggers);
+  RUN_TEST(test_dump_survives_disconnect_and_resume);
+  RUN_TEST(test_rearm_shortens_the_next_pre_trigger_part);
+  RUN_TEST(test_gyro_and_free_fall_triggers);
+  RUN_TEST(test_window_across_the_ring_end);
+  RUN_TEST(test_every_impact_is_captured);
+  RUN_TEST(test_idle_without_central_still_captures);
+  return UNITY_END();
+}
@@ -0,0 +1,161 @@
+// Fixed-point CSV parsing for replay (stridera_csv.h): numbers, rows, malformed
+// input and the block line reader.
+//   pio test -e native -f test_csv_parse
+#include <unity.h>
+#include <math.h>
+#include <stdlib.h>
+#include "stridera_csv.h"
+
+void setUp() {}
+void tearDown() {}
+
+static bool milli(const char* s, int32_t& out) {
+  const char* p = s;
+  return stridera_parse_milli(p, s + strlen(s), out);
+}
+
+static bool row(const char* s, StrideraAccelPacket& out) {
+  return stridera_parse_csv_row(s, s + strlen(s), out, 200);
+}
+
+static void test_milli_values() {
+  struct { const char* in; int32_t want; } cases[] = {
+    {"0", 0}, {"-0.0", 0}, {"1", 1000}, {"+2", 2000}, {"-0.9815", -982},
+    {"0.0005", 1}, {"-0.0005", -1}, {"0.00049", 0}, {"1.2e-3", 1}, {"1.5E-3", 2},
+    {"2.5e2", 250000}, {".5", 500}, {"5.", 5000}, {"  7.25  ", 7250},
+    {"000001.0000000000000000000001", 1000}, {"2147483.647", INT32_MAX},
+    {"9e99", INT32_MAX}, {"-9e99", INT32_MIN}, {"1e-99", 0},
+  };
+  for (const auto& c : cases) {
+    int32_t v = 12345;
+    TEST_ASSERT_TRUE_MESSAGE(milli(c.in, v), c.in);
+    TEST_ASSERT_EQUAL_INT_MESSAGE(c.want, v, c.in);
+  }
+}
+
+// Integer parse vs a double reference over the accel range
+static void test_milli_matches_reference() {
+  char s[32];
+  for (int32_t i = -160000; i <= 160000; i += 7) {
+    const double g = i / 10000.0;                        // 4 decimals, like the recorder writes
+    snprintf(s, sizeof(s), "%.4f", g);
+    int32_t v;
+    TEST_ASSERT_TRUE(milli(s, v));
+    const double ref = strtod(s, nullptr) * 1000.0;
+    const int32_t want = (int32_t)(ref < 0 ? ceil(ref - 0.5 - 1e-9) : floor(ref + 0.5 + 1e-9));
+    TEST_ASSERT_EQUAL_INT_MESSAGE(want, v, s);
+  }
+}
+
+static void test_milli_rejects_non_numbers() {
+  const char* bad[] = {"", " ", "-", "+", ".", "-.", "e3", "1e", "1e+", "abc", ",1"};
+  for (const char* s : bad) {
+    int32_t v = 42;
+    TEST_ASSERT_FALSE_MESSAGE(milli(s, v), s);
+    TEST_ASSERT_EQUAL_INT_MESSAGE(42, v, s);
+  }
+}
+
+static void test_row_parses_and_clamps() {
+  StrideraAccelPacket p{};
+  TEST_ASSERT_TRUE(row("1234, -0.9815, 0.02,1.0\r", p));
+  TEST_ASSERT_EQUAL_UINT32(1234, p.ts_ms);
+  TEST_ASSERT_EQUAL_INT16(-982, p.ax_mg);
+  TEST_ASSERT_EQUAL_INT16(20, p.ay_mg);
+  TEST_ASSERT_EQUAL_INT16(1000, p.az_mg);
+  TEST_ASSERT_EQUAL_UINT8(200, p.rate_hz);
+
+  TEST_ASSERT_TRUE(row("5.9,40,-40,0,1.0,2.0", p));    // fractional ts truncated, extra columns ignored
+  TEST_ASSERT_EQUAL_UINT32(5, p.ts_ms);
+  TEST_ASSERT_EQUAL_INT16(32767, p.ax_mg);
+  TEST_ASSERT_EQUAL_INT16(-32768, p.ay_mg);
+}
+
+// Malformed rows fail and leave the previous packet alone
+static void test_malformed_rows_leave_packet_untouched() {
+  const char* bad[] = {
+    "", "ts_ms,ax_g,ay_g,az_g", "100", "100,1,2", "100,1,2,", "100,,2,3",
+    "100;1;2;3", "100,1,2,3x", "100,1,2 3,4", "-5,1,2,3", "4294967296,1,2,3",
+    "100,1e,2,3", "100,0x10,2,3",
+  };
+  for (const char* s : bad) {
+    StrideraAccelPacket p{777, 1, 2, 3, 50, 0};
+    TEST_ASSERT_FALSE_MESSAGE(row(s, p), s);
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(777, p.ts_ms, s);
+    TEST_ASSERT_EQUAL_MESSAGE(1, p.ax_mg, s);
+    TEST_ASSERT_EQUAL_MESSAGE(50, p.rate_hz, s);
+  }
+}
+
+static void test_multi_channel_sample() {
+  const char* hdr = "ts_ms,ax_g,ay_g,az_g,gx_dps,gy_dps,gz_dps,temp_c";
+  const uint8_t cols = stridera_csv_columns(hdr, hdr + strlen(hdr));
+  TEST_ASSERT_EQUAL_UINT8(STRIDERA_CH_ACCEL | STRIDERA_CH_GYRO | STRIDERA_CH_TEMP, cols);
+
+  const char* s = "250,0.001,-0.002,1.0,12.34,-0.05,250,36.555";
+  StrideraSample out;
+  TEST_ASSERT_TRUE(stridera_parse_csv_sample(s, s + strlen(s), out, 200, cols));
+  TEST_ASSERT_EQUAL_UINT32(250000, out.ts_us);
+  TEST_ASSERT_EQUAL_INT16(1, out.v1.ax_mg);
+  TEST_ASSERT_EQUAL_INT16(-2, out.v1.ay_mg);
+  TEST_ASSERT_EQUAL_INT16(123, out.gyro[0]);          // 0.1 dps
+  TEST_ASSERT_EQUAL_INT16(-1, out.gyro[1]);           // -0.5 rounds away from zero
+  TEST_ASSERT_EQUAL_INT16(2500, out.gyro[2]);
+  TEST_ASSERT_EQUAL_INT16(3656, out.temp);            // 0.01 degC
+  TEST_ASSERT_EQUAL_UINT8(cols, out.chan_mask);
+
+  const char* shortRow = "250,0.001,-0.002,1.0,12.34,-0.05,250";   // temp missing
+  out.ts_us = 1;
+  TEST_ASSERT_FALSE(stridera_parse_csv_sample(shortRow, shortRow + strlen(shortRow), out, 200, cols));
+  TEST_ASSERT_EQUAL_UINT32(1, out.ts_us);
+}
+
+struct MemSource {
+  const char* data;
+  size_t len, pos = 0, chunk;
+  size_t read(uint8_t* buf, size_t n) {
+    if (n > chunk) n = chunk;
+    if (n > len - pos) n = len - pos;
+    memcpy(buf, data + pos, n);
+    pos += n;
+    return n;
+  }
+};
+
+// Lines split across blocks, an over-long line skipped, a last line without '\n'
+static void test_line_reader() {
+  char text[400];
+  char longLine[100];
+  memset(longLine, '9', sizeof(longLine) - 1);
+  longLine[sizeof(longLine) - 1] = 0;
+  snprintf(text, sizeof(text), "ts_ms,ax_g,ay_g,az_g\n1,0.1,0.2,0.3\r\n%s\n\n2,0.4,0.5,0.6\n3,0.7,0.8,0.9", longLine);
+
+  MemSource src{text, strlen(text), 0, 7};
+  StrideraCsvLineReader<MemSource, 32> reader;
+  reader.begin(&src);
+
+  const char* l;
+  const char* e;
+  uint32_t rows = 0, lines = 0, tsSum = 0;
+  while (reader.next(l, e)) {
+    ++lines;
+    StrideraAccelPacket p;
+    if (stridera_parse_csv_row(l, e, p, 100)) { ++rows; tsSum += p.ts_ms; }
+  }
+  TEST_ASSERT_EQUAL_UINT32(3, rows);
+  TEST_ASSERT_EQUAL_UINT32(6, tsSum);
+  TEST_ASSERT_EQUAL_UINT32(1, reader.longLines());
+  TEST_ASSERT_EQUAL_UINT32(5, lines);                 // header, 3 rows, the empty line
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_milli_values);
+  RUN_TEST(test_milli_matches_reference);
+  RUN_TEST(test_milli_rejects_non_numbers);
+  RUN_TEST(test_row_parses_and_clamps);
+  RUN_TEST(test_malformed_rows_leave_packet_untouched);
+  RUN_TEST(test_multi_channel_sample);
+  RUN_TEST(test_line_reader);
+  return UNITY_END();
+}
@@ -0,0 +1,176 @@
+// Delta-compressed frames (stridera_delta.h): round trip, and every frame
+// decodes on its own from its keyframe.
+//   pio test -e native -f test_delta
+#include <unity.h>
+#include <vector>
+#include "stridera_batch.h"
+#include "stridera_delta.h"
+
+void setUp() {}
+void tearDown() {}
+
+static uint32_t rng_state = 1;
+static int32_t rnd(int32_t lo, int32_t hi) {
+  rng_state = rng_state * 1664525u + 1013904223u;
+  return lo + (int32_t)((rng_state >> 8) % (uint32_t)(hi - lo + 1));
+}
+
+// 200 Hz walk-like signal with +-1 ms timestamp jitter
+static std::vector<StrideraAccelPacket> walk(size_t n, uint32_t t0) {
+  std::vector<StrideraAccelPacket> v(n);
+  int32_t a[3] = {0, 0, 1000};
+  uint32_t ts = t0;
+  for (size_t i = 0; i < n; ++i) {
+    for (int c = 0; c < 3; ++c) {
+      a[c] += rnd(-40, 40);
+      if (a[c] > 4000) a[c] = 4000;
+      if (a[c] < -4000) a[c] = -4000;
+    }
+    v[i] = StrideraAccelPacket{ts, (int16_t)a[0], (int16_t)a[1], (int16_t)a[2], 200, 0};
+    ts += 5 + rnd(-1, 1);
+  }
+  return v;
+}
+
+// Split `in` into frames of at most `cap` bytes / `max_samples` samples
+static std::vector<std::vector<uint8_t>> encode(const std::vector<StrideraAccelPacket>& in,
+                                                size_t cap, size_t max_samples = 255) {
+  std::vector<std::vector<uint8_t>> frames;
+  std::vector<uint8_t> buf(cap);
+  StrideraDeltaEncoder enc;
+  enc.begin(buf.data(), cap, max_samples);
+  for (const auto& p : in) {
+    if (!enc.push(p)) {
+      const size_t n = enc.finish();
+      TEST_ASSERT_LESS_OR_EQUAL(cap, n);
+      frames.emplace_back(buf.begin(), buf.begin() + n);
+      enc.reset();
+      TEST_ASSERT_TRUE(enc.push(p));
+    }
+  }
+  if (!enc.empty()) { const size_t n = enc.finish(); frames.emplace_back(buf.begin(), buf.begin() + n); }
+  return frames;
+}
+
+static void assert_same(const StrideraAccelPacket& a, const StrideraAccelPacket& b) {
+  TEST_ASSERT_EQUAL_UINT32(a.ts_ms, b.ts_ms);
+  TEST_ASSERT_EQUAL_INT16(a.ax_mg, b.ax_mg);
+  TEST_ASSERT_EQUAL_INT16(a.ay_mg, b.ay_mg);
+  TEST_ASSERT_EQUAL_INT16(a.az_mg, b.az_mg);
+  TEST_ASSERT_EQUAL_UINT8(a.rate_hz, b.rate_hz);
+}
+
+static void test_walk_round_trip() {
+  const auto in = walk(5000, 100000);
+  const auto frames = encode(in, stridera_att_payload(247));
+  TEST_ASSERT_GREATER_THAN(1, frames.size());
+
+  std::vector<StrideraAccelPacket> out(in.size());
+  size_t total = 0;
+  for (const auto& f : frames) total += stridera_delta_decode(f.data(), f.size(), &out[total], out.size() - total);
+  TEST_ASSERT_EQUAL_size_t(in.size(), total);
+  for (size_t i = 0; i < in.size(); ++i) assert_same(in[i], out[i]);
+
+  // Quiet motion packs well below the 8 bytes/sample of a batch frame
+  size_t bytes = 0;
+  for (const auto& f : frames) bytes += f.size();
+  TEST_ASSERT_LESS_THAN(in.size() * 5, bytes);
+}
+
+// Lose every other notification: the frames that arrive still decode exactly
+static void test_lost_frames_do_not_corrupt_the_next() {
+  const auto in = walk(3000, 7);
+  const auto frames = encode(in, stridera_att_payload(185));
+  TEST_ASSERT_GREATER_THAN(4, frames.size());
+
+  size_t first = 0;
+  for (size_t k = 0; k < frames.size(); ++k) {
+    StrideraAccelPacket out[255];
+    const size_t n = stridera_delta_decode(frames[k].data(), frames[k].size(), out, 255);
+    TEST_ASSERT_GREATER_THAN(0, n);
+    if (k % 2) {
+      for (size_t i = 0; i < n; ++i) assert_same(in[first + i], out[i]);
+    }
+    first += n;
+  }
+  TEST_ASSERT_EQUAL_size_t(in.size(), first);
+}
+
+static void test_max_samples_bounds_keyframe_interval() {
+  const auto in = walk(1000, 0);
+  const auto frames = encode(in, stridera_att_payload(247), 16);
+  TEST_ASSERT_EQUAL_size_t((in.size() + 15) / 16, frames.size());
+  for (const auto& f : frames) {
+    StrideraDeltaHeader hdr;
+    memcpy(&hdr, f.data(), sizeof(hdr));
+    TEST_ASSERT_LESS_OR_EQUAL(16, hdr.count);
+  }
+}
+
+// Full-scale swings, repeated timestamps and the largest step still round-trip
+static void test_extremes_round_trip() {
+  std::vector<StrideraAccelPacket> in;
+  uint32_t ts = 0xFFFF0000u;
+  for (int i = 0; i < 40; ++i) {
+    const int16_t hi = i % 2 ? INT16_MAX : INT16_MIN;
+    in.push_back(StrideraAccelPacket{ts, hi, (int16_t)(-hi - 1), (int16_t)(i * 800), 100, 0});
+    ts += (i % 3 == 0) ? 0 : (i % 7 == 0 ? 0xFFFF : 10);
+  }
+  const auto frames = encode(in, stridera_att_payload(247));
+
+  std::vector<StrideraAccelPacket> out(in.size());
+  size_t total = 0;
+  for (const auto& f : frames) total += stridera_delta_decode(f.data(), f.size(), &out[total], out.size() - total);
+  TEST_ASSERT_EQUAL_size_t(in.size(), total);
+  for (size_t i = 0; i < in.size(); ++i) assert_same(in[i], out[i]);
+}
+
+static void test_encoder_refuses_time_going_back() {
+  uint8_t buf[64];
+  StrideraDeltaEncoder enc;
+  enc.begin(buf, sizeof(buf));
+  TEST_ASSERT_TRUE(enc.push(StrideraAccelPacket{1000, 0, 0, 1000, 200, 0}));
+  TEST_ASSERT_FALSE(enc.push(StrideraAccelPacket{999, 0, 0, 1000, 200, 0}));
+  TEST_ASSERT_FALSE(enc.push(StrideraAccelPacket{1000 + 0x10000, 0, 0, 1000, 200, 0}));
+  TEST_ASSERT_EQUAL_size_t(1, enc.count());
+}
+
+// A frame crossing the millis() wrap stays one frame
+static void test_frame_spans_ms_wrap() {
+  uint8_t buf[64];
+  StrideraDeltaEncoder enc;
+  enc.begin(buf, sizeof(buf));
+  const StrideraAccelPacket in[3] = {{0xFFFFFFF6u, 10, 0, 1000, 200, 0},
+                                     {0xFFFFFFFBu, 11, 0, 1000, 200, 0},
+                                     {0x00000000u, 12, 0, 1000, 200, 0}};
+  for (const auto& p : in) TEST_ASSERT_TRUE(enc.push(p));
+  StrideraAccelPacket out[3];
+  TEST_ASSERT_EQUAL_size_t(3, stridera_delta_decode(enc.data(), enc.finish(), out, 3));
+  for (int i = 0; i < 3; ++i) assert_same(in[i], out[i]);
+}
+
+static void test_decode_rejects_truncated_frames() {
+  const auto in = walk(200, 0);
+  const auto frames = encode(in, stridera_att_payload(247));
+  const auto& f = frames[0];
+  StrideraAccelPacket out[255];
+  TEST_ASSERT_GREATER_THAN(0, stridera_delta_decode(f.data(), f.size(), out, 255));
+  TEST_ASSERT_EQUAL_size_t(0, stridera_delta_decode(f.data(), f.size() - 2, out, 255));
+  TEST_ASSERT_EQUAL_size_t(0, stridera_delta_decode(f.data(), sizeof(StrideraDeltaHeader) - 1, out, 255));
+
+  std::vector<uint8_t> bad = f;
+  bad[0] = STRIDERA_FRAME_BATCH;
+  TEST_ASSERT_EQUAL_size_t(0, stridera_delta_decode(bad.data(), bad.size(), out, 255));
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_walk_round_trip);
+  RUN_TEST(test_lost_frames_do_not_corrupt_the_next);
+  RUN_TEST(test_max_samples_bounds_keyframe_interval);
+  RUN_TEST(test_extremes_round_trip);
+  RUN_TEST(test_encoder_refuses_time_going_back);
+  RUN_TEST(test_frame_spans_ms_wrap);
+  RUN_TEST(test_decode_rejects_truncated_frames);
+  return UNITY_END();
+}
@@ -0,0 +1,137 @@
+// FanOut / CentralStream (fanout.h) against FakeCentrals (bench/fakes): 200 Hz
+// to four centrals at once, each on its own link, plus the TEMP-only v2 case.
+//   pio test -e native -f test_fanout
+#include <unity.h>
+#include <vector>
+#include "bench_data.h"
+#include "fakes/fake_nimble.h"
+#include "fanout.h"
+
+void setUp() {}
+void tearDown() {}
+
+static const size_t N = 20000;                     // 100 s at 200 Hz
+
+// Fast batch, delta on a 30 ms link, a legacy v2 client at MTU 23 that can take
+// ~1/10 of the rate, and one that reconnects halfway (back 1 s later as a new handle)
+struct FourCentrals {
+  using Fan = FanOut<4, 8, 244>;
+  Fan          fan;
+  FakeCentrals sink;
+  FanOutStats  ended{};                            // the reconnecting central's first session
+  uint64_t     missed = 0;                         // samples while it was away
+};
+
+static FourCentrals& four() {
+  static FourCentrals* run = nullptr;
+  if (run) return *run;
+  run = new FourCentrals;                          // ~8 KB of queues: once, off the stack
+  const auto smp = bench_walk_samples(N);
+  auto& fan  = run->fan;
+  auto& sink = run->sink;
+  sink.add(1, 247, 8, 6);
+  sink.add(2, 185, 30, 2);
+  sink.add(3, 23, 50, 1);
+  sink.add(4, 247, 15, 4);
+  fan.open(1, 247)->setBatch(true);
+  FourCentrals::Fan::Stream* d = fan.open(2, 185);
+  d->setFormat(STRIDERA_FORMAT_DELTA);
+  d->setBatch(true);
+  FourCentrals::Fan::Stream* v2 = fan.open(3, 23);
+  v2->setVersion(STRIDERA_PACKET_V2);
+  v2->setCrc(true);
+  v2->setLegacy(true);
+  fan.open(4, 247)->setBatch(true);
+  uint32_t now = 0;
+  for (size_t i = 0; i < N; ++i) {
+    now = (uint32_t)i * 5;
+    if (i == N / 2) fan.close(4);
+    if (i == N / 2 + 200) { sink.at(3).conn = 5; fan.open(5, 247)->setBatch(true); }
+    if (i >= N / 2 && i < N / 2 + 200) ++run->missed;
+    fan.sync([&](uint16_t, const FanOutStats& st) { run->ended = st; });
+    fan.push(smp[i], now);
+    if ((i & 3) == 3) {                            // loop wake every 20 ms
+      sink.advance(now);
+      fan.flushDue(now, 50);
+      fan.pump(sink, 8);
+    }
+  }
+  for (int k = 0; k < 200; ++k) {                  // drain what is still queued
+    now += 20;
+    sink.advance(now);
+    fan.flushDue(now, 0);
+    fan.pump(sink, 8);
+  }
+  return *run;
+}
+
+static void test_every_central_in_order_within_mtu() {
+  FourCentrals& r = four();
+  for (size_t i = 0; i < 4; ++i) {
+    TEST_ASSERT_TRUE(r.sink.at(i).ordered);
+    TEST_ASSERT_EQUAL_UINT64(0, r.sink.at(i).rejected);
+  }
+}
+
+static void test_fast_links_get_every_sample() {
+  FourCentrals& r = four();
+  TEST_ASSERT_EQUAL_UINT64(N, r.sink.at(0).samples);
+  TEST_ASSERT_EQUAL_UINT32(0, r.fan.at(0).stats().dropped_samples);
+  TEST_ASSERT_EQUAL_UINT64(N, r.sink.at(1).samples);                 // delta
+  TEST_ASSERT_EQUAL_UINT32(0, r.fan.at(1).stats().dropped_samples);
+}
+
+static void test_slow_central_drops_only_its_own_samples() {
+  FourCentrals& r = four();
+  const FanOutStats& slow = r.fan.at(2).stats();
+  TEST_ASSERT_TRUE(slow.dropped_samples > 0);
+  TEST_ASSERT_EQUAL_UINT64(N, r.sink.at(2).samples + slow.dropped_samples + slow.decimated_samples);
+}
+
+static void test_reconnect_loses_at_most_the_open_frame() {
+  FourCentrals& r = four();
+  const FanOutStats& back = r.fan.at(3).stats();
+  TEST_ASSERT_TRUE(r.ended.samples <= N / 2);
+  TEST_ASSERT_TRUE(N / 2 - r.ended.samples <= stridera_batch_capacity(244));
+  TEST_ASSERT_EQUAL_UINT64(N - N / 2, back.samples + r.missed);     // the new session gets everything
+  TEST_ASSERT_EQUAL_UINT32(0, back.dropped_samples);
+  TEST_ASSERT_EQUAL_UINT64(r.ended.samples + back.samples, r.sink.at(3).samples);
+}
+
+// v2 batches asking an accel-only sensor for temperature alone: every sample
+// falls back to the 20-byte 0xA2 packet, longer than the 16 bytes the mask
+// packs to, and frames must still fit a 97-byte payload
+static void test_temp_only_fallback_fits_small_mtu() {
+  static CentralStream<8, 244> t;
+  const auto smp = bench_walk_samples(4000);
+  FakeCentrals sink;
+  sink.add(1, 100, 8, 6);
+  t.open(1, 100);
+  t.setFormat(STRIDERA_FORMAT_V2);
+  t.setChannels(STRIDERA_CH_TEMP);
+  t.setBatch(true);
+  FanOutStats ended;
+  uint16_t endedConn;
+  t.sync(ended, endedConn);
+  uint32_t now = 0;
+  for (size_t i = 0; i < smp.size(); ++i) {
+    now = (uint32_t)i * 5;
+    t.push(smp[i], now);
+    if ((i & 3) == 3) { sink.advance(now); t.flushDue(now, 50); t.pump(sink, 8); }
+  }
+  for (int k = 0; k < 50; ++k) { now += 20; sink.advance(now); t.flushDue(now, 0); t.pump(sink, 8); }
+  TEST_ASSERT_EQUAL_UINT64(smp.size(), sink.at(0).samples);
+  TEST_ASSERT_EQUAL_UINT64(0, sink.at(0).rejected);
+  TEST_ASSERT_TRUE(sink.at(0).ordered);
+  TEST_ASSERT_EQUAL_UINT32(0, t.stats().dropped_samples);
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_every_central_in_order_within_mtu);
+  RUN_TEST(test_fast_links_get_every_sample);
+  RUN_TEST(test_slow_central_drops_only_its_own_samples);
+  RUN_TEST(test_reconnect_loses_at_most_the_open_frame);
+  RUN_TEST(test_temp_only_fallback_fits_small_mtu);
+  return UNITY_END();
+}
@@ -0,0 +1,131 @@
+// FirDecimator (fir_decimator.h): the block kernel against the scalar
+// reference bit for bit, output alignment, and the filter's response.
+//   pio test -e native -f test_fir_decimator
+#include <unity.h>
+#include <math.h>
+#include <vector>
+#include "fir_decimator.h"
+
+void setUp() {}
+void tearDown() {}
+
+static uint32_t rng_state = 99;
+static int16_t rnd16(int32_t amp) {
+  rng_state = rng_state * 1664525u + 1013904223u;
+  return (int16_t)((int32_t)((rng_state >> 8) % (uint32_t)(2 * amp + 1)) - amp);
+}
+
+// Feed `in` (3 channels, frame-interleaved) in blocks of the given sizes, cycling
+template <size_t Taps, size_t MaxBlock>
+static void check_against_ref(uint16_t factor, const std::vector<int16_t>& in, const std::vector<size_t>& blocks) {
+  int16_t h[Taps];
+  stridera_fir_lowpass_q15(h, Taps, 50.0f, 200.0f * factor);
+  static FirDecimator<3, Taps, MaxBlock> fir;
+  FirDecimatorRef<3, Taps> ref;
+  fir.beginWith(h, factor);
+  ref.beginWith(h, factor);
+
+  const size_t frames = in.size() / 3;
+  std::vector<int16_t> want;
+  std::vector<size_t> wantAt;
+  for (size_t i = 0; i < frames; ++i) {
+    int16_t o[3];
+    if (ref.push(&in[i * 3], o)) { want.insert(want.end(), o, o + 3); wantAt.push_back(i); }
+  }
+
+  int16_t x[3][MaxBlock], y[3][MaxBlock];
+  const int16_t* xp[3] = {x[0], x[1], x[2]};
+  int16_t* yp[3] = {y[0], y[1], y[2]};
+  uint16_t at[MaxBlock];
+  size_t pos = 0, got = 0, b = 0;
+  while (pos < frames) {
+    size_t n = blocks[b++ % blocks.size()];
+    if (n > MaxBlock) n = MaxBlock;
+    if (n > frames - pos) n = frames - pos;
+    for (size_t i = 0; i < n; ++i) for (size_t c = 0; c < 3; ++c) x[c][i] = in[(pos + i) * 3 + c];
+    const size_t k = fir.process(xp, n, yp, at);
+    for (size_t j = 0; j < k; ++j) {
+      TEST_ASSERT_LESS_THAN(wantAt.size(), got);
+      TEST_ASSERT_EQUAL_size_t(wantAt[got], pos + at[j]);
+      for (size_t c = 0; c < 3; ++c) TEST_ASSERT_EQUAL_INT16(want[got * 3 + c], y[c][j]);
+      ++got;
+    }
+    pos += n;
+  }
+  TEST_ASSERT_EQUAL_size_t(wantAt.size(), got);
+}
+
+static std::vector<int16_t> noise_input(size_t frames, int32_t amp) {
+  std::vector<int16_t> v(frames * 3);
+  for (auto& s : v) s = rnd16(amp);
+  return v;
+}
+
+static void test_bit_exact_vs_reference() {
+  const auto in = noise_input(20000, 8000);
+  for (uint16_t m = 1; m <= 5; ++m) {
+    check_against_ref<64, 64>(m, in, {64});
+    check_against_ref<64, 64>(m, in, {1, 7, 64, 13, 2, 50});
+    check_against_ref<12, 16>(m, in, {5, 16, 3});
+  }
+}
+
+// Full-scale square wave: the accumulator must not wrap, outputs saturate like the reference
+static void test_full_scale_saturates_like_reference() {
+  std::vector<int16_t> in(6000 * 3);
+  for (size_t i = 0; i < in.size() / 3; ++i)
+    for (size_t c = 0; c < 3; ++c) in[i * 3 + c] = ((i / (3 + c)) & 1) ? INT16_MAX : INT16_MIN;
+  check_against_ref<64, 64>(5, in, {64, 9});
+}
+
+static void test_dc_passes_exactly() {
+  FirDecimator<3, 64, 64> fir;
+  fir.begin(5, 50.0f, 1000.0f);
+  int16_t x[3][64], y[3][64];
+  for (size_t i = 0; i < 64; ++i) { x[0][i] = 1000; x[1][i] = -250; x[2][i] = 0; }
+  const int16_t* xp[3] = {x[0], x[1], x[2]};
+  int16_t* yp[3] = {y[0], y[1], y[2]};
+  for (int blk = 0; blk < 10; ++blk) {
+    const size_t k = fir.process(xp, 64, yp);
+    TEST_ASSERT_GREATER_THAN(11, k);
+    for (size_t j = 0; j < k; ++j) {
+      TEST_ASSERT_EQUAL_INT16(1000, y[0][j]);            // primed: no ring-up from zero
+      TEST_ASSERT_EQUAL_INT16(-250, y[1][j]);
+      TEST_ASSERT_EQUAL_INT16(0, y[2][j]);
+    }
+  }
+}
+
+// Amplitude of a sine at f_hz after 1000 Hz -> 200 Hz decimation (steady state)
+static double gain_at(float f_hz) {
+  FirDecimator<1, 64, 64> fir;
+  fir.begin(5, 50.0f, 1000.0f);
+  const double amp = 10000.0;
+  int16_t x[64], y[64];
+  const int16_t* xp[1] = {x};
+  int16_t* yp[1] = {y};
+  double peak = 0;
+  for (size_t blk = 0; blk < 200; ++blk) {
+    for (size_t i = 0; i < 64; ++i) x[i] = (int16_t)lrint(amp * sin(2.0 * M_PI * f_hz * (blk * 64 + i) / 1000.0));
+    const size_t k = fir.process(xp, 64, yp);
+    if (blk < 20) continue;
+    for (size_t j = 0; j < k; ++j) peak = fabs((double)y[j]) > peak ? fabs((double)y[j]) : peak;
+  }
+  return peak / amp;
+}
+
+static void test_passband_and_stopband() {
+  TEST_ASSERT_FLOAT_WITHIN(0.02, 1.0, gain_at(5.0f));       // stride content
+  TEST_ASSERT_FLOAT_WITHIN(0.02, 1.0, gain_at(15.0f));
+  TEST_ASSERT_TRUE(gain_at(150.0f) < 0.01);                 // would alias to 50 Hz: -40 dB
+  TEST_ASSERT_TRUE(gain_at(420.0f) < 0.01);                 // would alias to 20 Hz
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_bit_exact_vs_reference);
+  RUN_TEST(test_full_scale_saturates_like_reference);
+  RUN_TEST(test_dc_passes_exactly);
+  RUN_TEST(test_passband_and_stopband);
+  return UNITY_END();
+}
@@ -0,0 +1,139 @@
+// GaitDetector (gait_detector.h) on synthetic walks with a known step count:
+// count, cadence, step interval, stop events and no steps while standing.
+//   pio test -e native -f test_gait
+#include <unity.h>
+#include <math.h>
+#include <vector>
+#include "gait_detector.h"
+
+void setUp() {}
+void tearDown() {}
+
+struct Phase { float secs, step_hz, mg; };
+
+static uint32_t rng_state = 7;
+static int32_t noise(int32_t amp) {
+  rng_state = rng_state * 1664525u + 1013904223u;
+  return (int32_t)((rng_state >> 8) % (uint32_t)(2 * amp + 1)) - amp;
+}
+
+// Vertical bounce per step on top of 1 g, device tilted, plus sensor noise.
+// Returns the true step count (bounce peaks, at phase k + 1/4).
+static int synth(const std::vector<Phase>& phases, uint16_t rate_hz, std::vector<StrideraAccelPacket>& out) {
+  const float dt = 1.0f / rate_hz;
+  float phase = 0;
+  uint32_t ts = 1000;
+  int steps = 0;
+  for (const auto& ph : phases) {
+    const int n = (int)(ph.secs * rate_hz);
+    for (int i = 0; i < n; ++i) {
+      const float prev = phase;
+      phase += ph.step_hz * dt;
+      if (ph.step_hz > 0 && floorf(phase - 0.25f) > floorf(prev - 0.25f)) ++steps;
+      const float bounce = ph.step_hz > 0 ? ph.mg * sinf(2.0f * (float)M_PI * phase) : 0.0f;
+      const float v = 1000.0f + bounce;
+      out.push_back(StrideraAccelPacket{ts, (int16_t)(0.20f * v + noise(15)), (int16_t)(0.10f * v + noise(15)),
+                                        (int16_t)(0.97f * v + noise(15)), (uint8_t)rate_hz, 0});
+      ts += 1000 / rate_hz;
+    }
+    if (ph.step_hz == 0) phase = ceilf(phase);   // walking resumes on a fresh cycle
+  }
+  return steps;
+}
+
+static void assert_count(int truth, uint32_t got) {
+  const int tol = truth * 3 / 100 > 2 ? truth * 3 / 100 : 2;
+  TEST_ASSERT_INT_WITHIN(tol, truth, (int)got);
+}
+
+static void test_walk_steps_and_cadence() {
+  std::vector<StrideraAccelPacket> pk;
+  const int truth = synth({{3, 0, 0}, {60, 1.8f, 350}}, 200, pk);
+  GaitDetector g;
+  g.begin(GaitConfig{});
+
+  uint32_t lastCadence = 0, lastStep = 0, walkingEvents = 0;
+  for (const auto& p : pk) {
+    if (!g.push(p)) continue;
+    const StrideraGaitPacket& e = g.event();
+    TEST_ASSERT_EQUAL_UINT8(STRIDERA_FRAME_GAIT, e.kind);
+    if (e.flags & STRIDERA_GAIT_F_WALKING) {
+      ++walkingEvents;
+      lastCadence = e.cadence_spm_x10;
+      lastStep = e.step_ms;
+    }
+  }
+  assert_count(truth, g.steps());
+  TEST_ASSERT_TRUE(g.walking());
+  TEST_ASSERT_GREATER_THAN(100, walkingEvents);
+  TEST_ASSERT_INT_WITHIN(30, 1080, lastCadence);         // 1.8 steps/s = 108 spm
+  TEST_ASSERT_INT_WITHIN(15, 556, lastStep);
+}
+
+static void test_run_at_100hz() {
+  std::vector<StrideraAccelPacket> pk;
+  const int truth = synth({{2, 0, 0}, {40, 2.8f, 900}}, 100, pk);
+  GaitDetector g;
+  GaitConfig c;
+  c.rate_hz = 100;
+  g.begin(c);
+  uint32_t cadence = 0;
+  for (const auto& p : pk) if (g.push(p) && (g.event().flags & STRIDERA_GAIT_F_STEP)) cadence = g.event().cadence_spm_x10;
+  assert_count(truth, g.steps());
+  TEST_ASSERT_INT_WITHIN(50, 1680, cadence);
+}
+
+// Walk / stand / run / stand: one stop event per pause, nothing while standing
+static void test_stop_events_and_standing() {
+  std::vector<StrideraAccelPacket> pk;
+  const int truth = synth({{5, 0, 0}, {30, 1.8f, 350}, {6, 0, 0}, {20, 2.8f, 900}, {6, 0, 0}}, 200, pk);
+  GaitDetector g;
+  g.begin(GaitConfig{});
+  uint32_t stops = 0;
+  uint32_t stepsAtFirstStop = 0;
+  for (const auto& p : pk) {
+    if (!g.push(p)) continue;
+    const StrideraGaitPacket& e = g.event();
+    if (!(e.flags & STRIDERA_GAIT_F_STEP)) {
+      ++stops;
+      TEST_ASSERT_FALSE(e.flags & STRIDERA_GAIT_F_WALKING);
+      TEST_ASSERT_EQUAL_UINT16(0, e.cadence_spm_x10);
+      if (stops == 1) stepsAtFirstStop = g.steps();
+    }
+  }
+  assert_count(truth, g.steps());
+  TEST_ASSERT_EQUAL_UINT32(2, stops);
+  TEST_ASSERT_FALSE(g.walking());
+  assert_count(54, stepsAtFirstStop);                    // 30 s at 1.8 Hz
+}
+
+static void test_no_steps_while_standing() {
+  std::vector<StrideraAccelPacket> pk;
+  synth({{120, 0, 0}}, 200, pk);
+  GaitDetector g;
+  g.begin(GaitConfig{});
+  uint32_t events = 0;
+  for (const auto& p : pk) events += g.push(p);
+  TEST_ASSERT_EQUAL_UINT32(0, g.steps());
+  TEST_ASSERT_EQUAL_UINT32(0, events);
+}
+
+// Strong vibration well above step rate: the refractory window caps the count
+static void test_refractory_caps_rate() {
+  std::vector<StrideraAccelPacket> pk;
+  synth({{2, 0, 0}, {10, 8.0f, 600}}, 200, pk);
+  GaitDetector g;
+  g.begin(GaitConfig{});
+  for (const auto& p : pk) g.push(p);
+  TEST_ASSERT_LESS_OR_EQUAL(10 * 1000 / GaitConfig{}.min_step_ms + 1, g.steps());
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_walk_steps_and_cadence);
+  RUN_TEST(test_run_at_100hz);
+  RUN_TEST(test_stop_events_and_standing);
+  RUN_TEST(test_no_steps_while_standing);
+  RUN_TEST(test_refractory_caps_rate);
+  return UNITY_END();
+}
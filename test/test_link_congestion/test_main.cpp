@@ -0,0 +1,78 @@
+// Per-central congestion control (congestion_policy.h in CentralStream) on a
+// fake link (bench/congestion_sim.h): 10 s good, 20 s squeezed, 10 s good.
+// Full plain batches need ~7 notifies/s at MTU 247, delta ~5/s: "tight"
+// allows 6.7/s, "choked" 3.3/s.
+//   pio test -e native -f test_link_congestion
+#include <unity.h>
+#include "bench_data.h"
+#include "congestion_sim.h"
+
+void setUp() {}
+void tearDown() {}
+
+static const LinkPhase kTight[]  = {{30, 4}, {150, 1}, {150, 1}, {30, 4}};
+static const LinkPhase kChoked[] = {{30, 4}, {300, 1}, {300, 1}, {30, 4}};
+
+static const std::vector<StrideraSample>& walk() {
+  static const std::vector<StrideraSample> v = bench_walk_samples(8000);
+  return v;
+}
+
+// Every sample is delivered, dropped or decimated (and counted), in order
+static void assert_accounted(const CongestionRun& c) {
+  TEST_ASSERT_TRUE(c.ordered);
+  TEST_ASSERT_EQUAL_UINT64(0, c.rejected);
+  TEST_ASSERT_EQUAL_UINT64(walk().size(), c.delivered + c.st.dropped_samples + c.st.decimated_samples);
+}
+
+// Delta encoding is enough for "tight": nothing decimated, no drops once it reacted
+static void test_tight_link_needs_only_delta() {
+  const CongestionRun c = run_congestion(walk(), kTight, 4, STRIDERA_FORMAT_BATCH, STRIDERA_CONG_QUARTER);
+  assert_accounted(c);
+  TEST_ASSERT_EQUAL_UINT8(STRIDERA_CONG_COMPACT, c.cong.peak_level);
+  TEST_ASSERT_EQUAL_UINT32(0, c.st.decimated_samples);
+  TEST_ASSERT_EQUAL_UINT32(0, c.lateDropped);
+}
+
+static void test_backs_off_when_the_link_recovers() {
+  const CongestionRun tight  = run_congestion(walk(), kTight, 4, STRIDERA_FORMAT_BATCH, STRIDERA_CONG_QUARTER);
+  const CongestionRun choked = run_congestion(walk(), kChoked, 4, STRIDERA_FORMAT_BATCH, STRIDERA_CONG_QUARTER);
+  TEST_ASSERT_EQUAL_UINT8(STRIDERA_CONG_NONE, tight.cong.level);
+  TEST_ASSERT_EQUAL_UINT8(STRIDERA_CONG_NONE, choked.cong.level);
+}
+
+// "choked" needs decimation, and still drops nothing once the policy has reacted
+static void test_choked_link_decimates_instead_of_dropping() {
+  const CongestionRun c = run_congestion(walk(), kChoked, 4, STRIDERA_FORMAT_BATCH, STRIDERA_CONG_QUARTER);
+  assert_accounted(c);
+  TEST_ASSERT_TRUE(c.cong.peak_level >= STRIDERA_CONG_HALF);
+  TEST_ASSERT_EQUAL_UINT32(0, c.lateDropped);
+}
+
+static void test_v2_format_is_throttled_too() {
+  const CongestionRun c = run_congestion(walk(), kTight, 4, STRIDERA_FORMAT_V2, STRIDERA_CONG_QUARTER);
+  assert_accounted(c);
+  TEST_ASSERT_TRUE(c.cong.peak_level >= STRIDERA_CONG_HALF);
+  TEST_ASSERT_EQUAL_UINT32(0, c.lateDropped);
+}
+
+// Without the policy the bounded queue overflows for the whole squeeze
+static void test_without_policy_the_queue_overflows() {
+  const CongestionRun adaptive = run_congestion(walk(), kTight, 4, STRIDERA_FORMAT_BATCH, STRIDERA_CONG_QUARTER);
+  const CongestionRun tight    = run_congestion(walk(), kTight, 4, STRIDERA_FORMAT_BATCH, STRIDERA_CONG_NONE);
+  const CongestionRun choked   = run_congestion(walk(), kChoked, 4, STRIDERA_FORMAT_BATCH, STRIDERA_CONG_NONE);
+  assert_accounted(tight);
+  assert_accounted(choked);
+  TEST_ASSERT_TRUE(tight.st.dropped_samples > 10 * adaptive.st.dropped_samples);
+  TEST_ASSERT_TRUE(choked.st.dropped_samples > tight.st.dropped_samples);
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_tight_link_needs_only_delta);
+  RUN_TEST(test_backs_off_when_the_link_recovers);
+  RUN_TEST(test_choked_link_decimates_instead_of_dropping);
+  RUN_TEST(test_v2_format_is_throttled_too);
+  RUN_TEST(test_without_policy_the_queue_overflows);
+  return UNITY_END();
+}
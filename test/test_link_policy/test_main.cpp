@@ -0,0 +1,204 @@
+// LinkPolicy (link_policy.h) against FakeLinkControl (link_fake.h): what is
+// asked for per profile, and that refusals end in a flag instead of a loop.
+//   pio test -e native -f test_link_policy
+#include <unity.h>
+#include "link_fake.h"
+
+void setUp() {}
+void tearDown() {}
+
+// BLE_LINK_POLL_MS ticks; controller events arrive between ticks
+static uint32_t run(LinkPolicy& policy, FakeLinkControl& ctl, uint32_t from_ms, uint32_t to_ms) {
+  for (uint32_t t = from_ms; t < to_ms; t += 100) {
+    policy.tick(ctl, t);
+    ctl.deliver(policy);
+  }
+  return to_ms;
+}
+
+static void connect(LinkPolicy& policy) {
+  policy.onConnect(1, 36, 0, 400, 0);             // 45 ms, as many phones open
+  policy.onMtu(247);
+}
+
+static void test_waits_for_settle_time() {
+  LinkPolicy policy;
+  FakeLinkControl ctl;
+  connect(policy);
+  policy.setProfile(STRIDERA_LINK_PROFILE_STREAMING, 0);
+  run(policy, ctl, 0, 1000);
+  TEST_ASSERT_EQUAL_UINT32(0, ctl.dleRequests + ctl.phyRequests + ctl.paramRequests);
+  TEST_ASSERT_FALSE(policy.settled());
+}
+
+static void test_streaming_negotiates_everything_once() {
+  LinkPolicy policy;
+  FakeLinkControl ctl;
+  connect(policy);
+  policy.setProfile(STRIDERA_LINK_PROFILE_STREAMING, 0);
+  run(policy, ctl, 0, 5000);
+
+  TEST_ASSERT_TRUE(policy.settled());
+  TEST_ASSERT_EQUAL_UINT32(1, ctl.dleRequests);
+  TEST_ASSERT_EQUAL_UINT32(1, ctl.phyRequests);
+  TEST_ASSERT_EQUAL_UINT32(1, ctl.paramRequests);
+
+  const StrideraLinkDiag d = policy.diag();
+  TEST_ASSERT_EQUAL_UINT8(STRIDERA_LINK_PROFILE_STREAMING, d.profile);
+  TEST_ASSERT_EQUAL_UINT16(247, d.mtu);
+  TEST_ASSERT_EQUAL_UINT8(2, d.phy_tx);
+  TEST_ASSERT_EQUAL_UINT16(251, d.data_len);
+  TEST_ASSERT_EQUAL_UINT16(24, d.interval);
+  TEST_ASSERT_EQUAL_UINT16(0, d.latency);
+  TEST_ASSERT_TRUE(d.flags & STRIDERA_LINK_F_DLE);
+  TEST_ASSERT_FALSE(d.flags & (STRIDERA_LINK_F_PARAMS_REJECTED | STRIDERA_LINK_F_NO_2M |
+                               STRIDERA_LINK_F_PHY_PENDING | STRIDERA_LINK_F_PARAMS_PENDING));
+}
+
+static void test_no_2m_is_flagged_not_requested() {
+  LinkPolicy policy;
+  FakeLinkControl ctl;
+  ctl.has2M = false;
+  connect(policy);
+  run(policy, ctl, 0, 5000);
+  TEST_ASSERT_EQUAL_UINT32(0, ctl.phyRequests);
+  TEST_ASSERT_TRUE(policy.diag().flags & STRIDERA_LINK_F_NO_2M);
+  TEST_ASSERT_EQUAL_UINT8(1, policy.diag().phy_tx);
+  TEST_ASSERT_TRUE(policy.settled());
+}
+
+// A central that never answers: max_attempts requests spaced by retry_ms, then
+// the policy gives up on the profile for good
+static void test_ignored_params_are_bounded() {
+  LinkPolicy policy;
+  FakeLinkControl ctl;
+  ctl.ignoreParams = true;
+  connect(policy);
+  policy.setProfile(STRIDERA_LINK_PROFILE_STREAMING, 0);
+  policy.onParams(40, 0, 400);                    // central keeps 50 ms, outside 15..30
+  run(policy, ctl, 0, 60000);
+
+  const LinkTiming t;
+  TEST_ASSERT_EQUAL_UINT32(t.max_attempts, ctl.paramRequests);
+  TEST_ASSERT_TRUE(policy.diag().flags & STRIDERA_LINK_F_PARAMS_REJECTED);
+  TEST_ASSERT_FALSE(policy.diag().flags & STRIDERA_LINK_F_PARAMS_PENDING);
+  TEST_ASSERT_EQUAL_UINT16(40, policy.diag().interval);
+  TEST_ASSERT_TRUE(policy.settled());              // no more polling for this connection
+}
+
+// A phone whose floor is 25 ms answers every bulk request with it
+static void test_refused_bulk_interval_stops_retrying() {
+  LinkPolicy policy;
+  FakeLinkControl ctl;
+  ctl.centralMinItvl = 20;
+  connect(policy);
+  policy.setProfile(STRIDERA_LINK_PROFILE_BULK, 0);
+  run(policy, ctl, 0, 60000);
+
+  const LinkTiming t;
+  TEST_ASSERT_EQUAL_UINT32(t.max_attempts, ctl.paramRequests);
+  TEST_ASSERT_TRUE(policy.diag().flags & STRIDERA_LINK_F_PARAMS_REJECTED);
+  TEST_ASSERT_EQUAL_UINT16(20, policy.diag().interval);
+  TEST_ASSERT_EQUAL_UINT16(6, ctl.lastParams.min_interval);
+
+  // A new profile clears the flag; 25 ms already suits streaming, so nothing is asked
+  policy.setProfile(STRIDERA_LINK_PROFILE_STREAMING, 60000);
+  run(policy, ctl, 60000, 70000);
+  TEST_ASSERT_EQUAL_UINT32(t.max_attempts, ctl.paramRequests);
+  TEST_ASSERT_FALSE(policy.diag().flags & STRIDERA_LINK_F_PARAMS_REJECTED);
+  TEST_ASSERT_EQUAL_UINT16(20, policy.diag().interval);
+  TEST_ASSERT_TRUE(policy.settled());
+}
+
+static void test_host_stack_refusals_are_bounded() {
+  LinkPolicy policy;
+  FakeLinkControl ctl;
+  ctl.failCalls = true;
+  connect(policy);
+  policy.setProfile(STRIDERA_LINK_PROFILE_STREAMING, 0);
+  run(policy, ctl, 0, 120000);
+
+  const LinkTiming t;
+  TEST_ASSERT_EQUAL_UINT32(t.max_attempts, ctl.dleRequests);
+  TEST_ASSERT_EQUAL_UINT32(t.max_attempts, ctl.phyRequests);
+  TEST_ASSERT_EQUAL_UINT32(t.max_attempts, ctl.paramRequests);
+  TEST_ASSERT_TRUE(policy.diag().flags & STRIDERA_LINK_F_PARAMS_REJECTED);
+  TEST_ASSERT_EQUAL_UINT16(27, policy.diag().data_len);
+  TEST_ASSERT_EQUAL_UINT8(1, policy.diag().phy_tx);
+  TEST_ASSERT_TRUE(policy.settled());
+}
+
+// PHY request accepted by the stack but never answered by the central
+static void test_unanswered_phy_gives_up() {
+  struct SilentPhy : FakeLinkControl {
+    bool requestPhy(uint16_t, bool) override { ++phyRequests; return true; }
+  } ctl;
+  LinkPolicy policy;
+  connect(policy);
+  run(policy, ctl, 0, 60000);
+
+  const LinkTiming t;
+  TEST_ASSERT_EQUAL_UINT32(t.max_attempts, ctl.phyRequests);
+  TEST_ASSERT_FALSE(policy.diag().flags & STRIDERA_LINK_F_PHY_PENDING);
+  TEST_ASSERT_TRUE(policy.settled());
+}
+
+// Streaming -> idle only after idle_hold_ms; a quick restart never drops to idle
+static void test_idle_hold_prevents_flapping() {
+  LinkPolicy policy;
+  FakeLinkControl ctl;
+  connect(policy);
+  policy.setProfile(STRIDERA_LINK_PROFILE_STREAMING, 0);
+  uint32_t now = run(policy, ctl, 0, 5000);
+  const uint32_t asked = ctl.paramRequests;
+
+  policy.setProfile(STRIDERA_LINK_PROFILE_IDLE, now);
+  now = run(policy, ctl, now, now + 2000);
+  policy.setProfile(STRIDERA_LINK_PROFILE_STREAMING, now);
+  now = run(policy, ctl, now, now + 5000);
+  TEST_ASSERT_EQUAL_UINT8(STRIDERA_LINK_PROFILE_STREAMING, policy.profile());
+  TEST_ASSERT_EQUAL_UINT32(asked, ctl.paramRequests);
+
+  policy.setProfile(STRIDERA_LINK_PROFILE_IDLE, now);
+  run(policy, ctl, now, now + 2900);
+  TEST_ASSERT_EQUAL_UINT8(STRIDERA_LINK_PROFILE_STREAMING, policy.profile());
+  run(policy, ctl, now + 2900, now + 5000);
+  TEST_ASSERT_EQUAL_UINT8(STRIDERA_LINK_PROFILE_IDLE, policy.profile());
+  TEST_ASSERT_EQUAL_UINT32(asked + 1, ctl.paramRequests);
+  TEST_ASSERT_EQUAL_UINT16(4, policy.diag().latency);
+  TEST_ASSERT_EQUAL_UINT16(96, policy.diag().interval);
+}
+
+static void test_notify_rate_and_counters() {
+  LinkPolicy policy;
+  FakeLinkControl ctl;
+  connect(policy);
+  for (uint32_t t = 0; t < 3000; t += 5) {
+    policy.countNotify(t % 100 != 0);             // 1 in 20 refused
+    if (t % 100 == 0) policy.tick(ctl, t);
+  }
+  const StrideraLinkDiag d = policy.diag();
+  TEST_ASSERT_INT_WITHIN(10, 190, policy.notifyPerSec());
+  TEST_ASSERT_EQUAL_UINT32(570, d.notify_ok);
+  TEST_ASSERT_EQUAL_UINT32(30, d.notify_failed);
+
+  policy.onDisconnect();
+  TEST_ASSERT_FALSE(policy.connected());
+  const uint32_t before = ctl.dleRequests + ctl.phyRequests + ctl.paramRequests;
+  run(policy, ctl, 3000, 20000);
+  TEST_ASSERT_EQUAL_UINT32(before, ctl.dleRequests + ctl.phyRequests + ctl.paramRequests);
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_waits_for_settle_time);
+  RUN_TEST(test_streaming_negotiates_everything_once);
+  RUN_TEST(test_no_2m_is_flagged_not_requested);
+  RUN_TEST(test_ignored_params_are_bounded);
+  RUN_TEST(test_refused_bulk_interval_stops_retrying);
+  RUN_TEST(test_host_stack_refusals_are_bounded);
+  RUN_TEST(test_unanswered_phy_gives_up);
+  RUN_TEST(test_idle_hold_prevents_flapping);
+  RUN_TEST(test_notify_rate_and_counters);
+  return UNITY_END();
+}
@@ -0,0 +1,56 @@
+// PerfStat / PerfPeriod (perf_probe.h): resets requested from another task
+// are carried out by the writer, and ns conversion uses the stat's own clock.
+//   pio test -e native -f test_perf_probe
+#include <unity.h>
+#include "perf_probe.h"
+
+void setUp() {}
+void tearDown() {}
+
+// Nothing is cleared until the writer records again; then only the new sample counts
+static void test_requested_reset_runs_on_next_record() {
+  PerfStat s;
+  for (uint32_t t = 100; t < 110; ++t) s.record(t);
+  s.requestReset();
+  TEST_ASSERT_EQUAL_UINT32(10, s.count());
+  s.record(5000);
+  TEST_ASSERT_EQUAL_UINT32(1, s.count());
+  TEST_ASSERT_EQUAL_UINT32(5000, s.min());
+  TEST_ASSERT_EQUAL_UINT32(5000, s.max());
+  TEST_ASSERT_FALSE(s.takeReset());
+}
+
+// The interval open when the reset was requested is dropped, not recorded
+static void test_period_drops_the_interval_across_a_reset() {
+  PerfPeriod p;
+  p.mark(0);
+  p.mark(10);
+  p.mark(20);
+  p.requestReset();
+  p.mark(1000);
+  TEST_ASSERT_EQUAL_UINT32(0, p.stat.count());
+  p.mark(1010);
+  p.mark(1020);
+  TEST_ASSERT_EQUAL_UINT32(2, p.stat.count());
+  TEST_ASSERT_EQUAL_UINT32(10, p.stat.max());
+}
+
+// Entries convert with the clock captured at the first sample
+static void test_entry_converts_with_the_recorded_clock() {
+  PerfStat s;
+  TEST_ASSERT_EQUAL_UINT32(0, stridera_perf_entry(0, s).max_ns);
+  s.record(3 * stridera_perf_ticks_per_us());                  // 3 us
+  TEST_ASSERT_EQUAL_UINT32(stridera_perf_ticks_per_us(), s.ticksPerUs());
+  const StrideraPerfEntry e = stridera_perf_entry(STRIDERA_PERF_STAGE_LOOP, s);
+  TEST_ASSERT_EQUAL_UINT8(STRIDERA_PERF_STAGE_LOOP, e.stage);
+  TEST_ASSERT_EQUAL_UINT32(1, e.count);
+  TEST_ASSERT_EQUAL_UINT32(3000, e.max_ns);
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_requested_reset_runs_on_next_record);
+  RUN_TEST(test_period_drops_the_interval_across_a_reset);
+  RUN_TEST(test_entry_converts_with_the_recorded_clock);
+  return UNITY_END();
+}
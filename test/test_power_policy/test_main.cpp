@@ -0,0 +1,89 @@
+// PowerPolicy and EnergyMeter (power_policy.h) on a simulated timeline: idle
+// with a button press at 5 s, streaming 40..100 s at 200 Hz on battery
+// (4.0 V, 50 mA) with USB plugged in 70..80 s, then bulk.
+//   pio test -e native -f test_power_policy
+#include <unity.h>
+#include "power_policy.h"
+
+void setUp() {}
+void tearDown() {}
+
+static void test_backlight_times_out_after_last_activity() {
+  PowerConfig cfg;
+  PowerPolicy pol;
+  pol.begin(cfg, 0);
+  pol.activity(5000);
+  TEST_ASSERT_EQUAL_UINT8(cfg.backlight_on, pol.plan(PowerMode::Idle, 34999).backlight);
+  TEST_ASSERT_EQUAL_UINT8(cfg.backlight_off, pol.plan(PowerMode::Idle, 35000).backlight);
+  pol.activity(40000);                              // streaming starts: screen back on
+  TEST_ASSERT_EQUAL_UINT8(cfg.backlight_on, pol.plan(PowerMode::Streaming, 41000).backlight);
+}
+
+static void test_due_ms_is_the_backlight_deadline() {
+  PowerConfig cfg;
+  PowerPolicy pol;
+  pol.begin(cfg, 0);
+  pol.activity(5000);
+  TEST_ASSERT_EQUAL_UINT32(15000, pol.dueMs(20000));
+  TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, pol.dueMs(36000));    // already dark: nothing left to change
+}
+
+static void test_clock_and_sleep_per_mode() {
+  PowerConfig cfg;
+  PowerPolicy pol;
+  pol.begin(cfg, 0);
+  const PowerPlan st = pol.plan(PowerMode::Streaming, 1000);
+  TEST_ASSERT_EQUAL_UINT16(cfg.streaming_mhz, st.cpu_mhz);
+  TEST_ASSERT_TRUE(st.light_sleep);
+  const PowerPlan rc = pol.plan(PowerMode::Recording, 1000);
+  TEST_ASSERT_EQUAL_UINT16(cfg.recording_mhz, rc.cpu_mhz);
+  TEST_ASSERT_FALSE(rc.light_sleep);
+  const PowerPlan bk = pol.plan(PowerMode::Bulk, 1000);
+  TEST_ASSERT_EQUAL_UINT16(cfg.bulk_mhz, bk.cpu_mhz);
+  TEST_ASSERT_FALSE(bk.light_sleep);
+}
+
+static void test_capture_mode_sleeps_with_screen_off() {
+  PowerConfig cfg;
+  PowerPolicy pol;
+  pol.begin(cfg, 0);
+  pol.activity(40000);
+  const PowerPlan cp = pol.plan(PowerMode::Capture, 120000);  // idle again, sensor feeding the capture ring
+  TEST_ASSERT_EQUAL_UINT16(cfg.capture_mhz, cp.cpu_mhz);
+  TEST_ASSERT_EQUAL(cfg.sleep_capture, cp.light_sleep);
+  TEST_ASSERT_EQUAL_UINT8(cfg.backlight_off, cp.backlight);
+}
+
+static void test_meter_skips_usb_intervals() {
+  EnergyMeter meter;
+  for (uint32_t t = 40; t <= 100; ++t) {
+    const bool usb = t >= 70 && t <= 80;
+    meter.addReading(t * 1000, 4000, usb ? 300 : -50, t == 40 ? 0 : 200);
+  }
+  // 48 s measured (29 + 19: intervals touching a USB reading are skipped)
+  TEST_ASSERT_EQUAL_UINT32(48000, meter.elapsedMs());
+  TEST_ASSERT_EQUAL_UINT32(11, meter.invalidReadings());
+  TEST_ASSERT_EQUAL_UINT64(9600, meter.samples());
+  TEST_ASSERT_EQUAL_UINT32(200, meter.avgMilliwatts());
+  TEST_ASSERT_EQUAL_UINT32(1000, meter.microjoulesPerSample());
+}
+
+static void test_meter_without_discharge_is_invalid() {
+  EnergyMeter meter;
+  meter.addReading(0, 4000, 300, 0);
+  meter.addReading(1000, 4000, 300, 200);
+  TEST_ASSERT_FALSE(meter.valid());
+  TEST_ASSERT_EQUAL_UINT32(0, meter.avgMilliwatts());
+  TEST_ASSERT_EQUAL_UINT32(0, meter.microjoulesPerSample());
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_backlight_times_out_after_last_activity);
+  RUN_TEST(test_due_ms_is_the_backlight_deadline);
+  RUN_TEST(test_clock_and_sleep_per_mode);
+  RUN_TEST(test_capture_mode_sleeps_with_screen_off);
+  RUN_TEST(test_meter_skips_usb_intervals);
+  RUN_TEST(test_meter_without_discharge_is_invalid);
+  return UNITY_END();
+}
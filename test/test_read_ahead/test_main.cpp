@@ -0,0 +1,119 @@
+// ReadAhead (read_ahead.h) over a latency-injecting file (bench/replay_sim.h):
+// byte-exact reads and seeks, and a 4x replay loop on a virtual clock where
+// the prefetch has to hide storage spikes.
+//   pio test -e native -f test_read_ahead
+#include <unity.h>
+#include <vector>
+#include "replay_sim.h"
+
+void setUp() { g_nowUs = 0; }
+void tearDown() {}
+
+// 2000-row 6-axis clip (~110 KB)
+static const std::string& clip() {
+  static std::string csv;
+  if (!csv.empty()) return csv;
+  std::vector<StrideraSample> sm(2000);
+  for (size_t i = 0; i < sm.size(); ++i) {
+    sm[i] = {};
+    sm[i].v1 = StrideraAccelPacket{(uint32_t)i * 5, (int16_t)(i % 400), -250, (int16_t)(980 + i % 40), 200, 0};
+    sm[i].gyro[0] = (int16_t)(i % 900);
+    sm[i].gyro[1] = (int16_t)-(int)(i % 700);
+    sm[i].gyro[2] = 12;
+    sm[i].temp    = 2531;
+  }
+  csv = make_imu_csv(sm);
+  return csv;
+}
+
+// Parser waits: the fill side reads the next block there and then
+static void fill_now(void* arg) { static_cast<BenchAhead*>(arg)->service(); }
+
+static void test_reads_the_file_byte_for_byte() {
+  const std::string& csv = clip();
+  SlowFile file;
+  file.d = reinterpret_cast<const uint8_t*>(csv.data());
+  file.n = csv.size();
+  std::unique_ptr<BenchAhead> ra(new BenchAhead);
+  ra->setWait(&fill_now, ra.get());
+  TEST_ASSERT_TRUE(ra->begin(&file));
+  std::string got;
+  uint8_t buf[1000];                              // not a divisor of the block size
+  size_t n;
+  while ((n = ra->read(buf, sizeof(buf))) > 0) got.append(reinterpret_cast<char*>(buf), n);
+  TEST_ASSERT_TRUE(got == csv);
+  TEST_ASSERT_EQUAL_UINT32(0, ra->stats().seeks);
+}
+
+// Rewind is served from the resident head; any other seek restarts the fill
+static void test_seeks_outside_the_head_restart_the_fill() {
+  const std::string& csv = clip();
+  SlowFile file;
+  file.d = reinterpret_cast<const uint8_t*>(csv.data());
+  file.n = csv.size();
+  std::unique_ptr<BenchAhead> ra(new BenchAhead);
+  ra->setWait(&fill_now, ra.get());
+  TEST_ASSERT_TRUE(ra->begin(&file));
+  uint8_t buf[64];
+  TEST_ASSERT_TRUE(ra->seek(50000));
+  TEST_ASSERT_EQUAL_size_t(sizeof(buf), ra->read(buf, sizeof(buf)));
+  TEST_ASSERT_EQUAL_MEMORY(csv.data() + 50000, buf, sizeof(buf));
+  TEST_ASSERT_EQUAL_UINT32(1, ra->stats().seeks);
+  TEST_ASSERT_TRUE(ra->seek(0));
+  TEST_ASSERT_EQUAL_size_t(sizeof(buf), ra->read(buf, sizeof(buf)));
+  TEST_ASSERT_EQUAL_MEMORY(csv.data(), buf, sizeof(buf));
+  TEST_ASSERT_EQUAL_UINT32(1, ra->stats().seeks);
+}
+
+// 2 MB/s plus a 150 ms stall every 64 KB (~350 KB/s average, 8x what 4x needs)
+static SlowFile spiky() {
+  SlowFile f;
+  f.us_per_kb = 500;
+  f.spike_us  = 150000;
+  return f;
+}
+
+// Read-ahead hides every spike: the stream is the one free storage gives
+static void test_spikes_are_hidden_from_the_parser() {
+  SlowFile instant;
+  instant.us_per_kb = 0;
+  const PrefetchRun ideal = run_prefetch(clip(), instant, 400, 20, true);
+  const PrefetchRun ahead = run_prefetch(clip(), spiky(), 400, 20, true);
+  TEST_ASSERT_TRUE(ahead.ra.read_us_max >= 150000);   // the spikes did happen
+  TEST_ASSERT_EQUAL_UINT32(0, ahead.ra.stalls);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(10000, ahead.st.late_max_us);
+  TEST_ASSERT_TRUE(ahead.ts == ideal.ts);
+}
+
+// Each loop's rewind comes from the resident head
+static void test_loop_rewinds_do_not_seek() {
+  const PrefetchRun ahead = run_prefetch(clip(), spiky(), 400, 20, true);
+  TEST_ASSERT_EQUAL_UINT32(7, ahead.st.loops);
+  TEST_ASSERT_EQUAL_UINT32(0, ahead.ra.seeks);
+}
+
+// Reading inline puts each spike on the IMU task
+static void test_inline_reads_make_replay_late() {
+  const PrefetchRun direct = run_prefetch(clip(), spiky(), 400, 20, false);
+  TEST_ASSERT_TRUE(direct.st.late_max_us >= 150000);
+}
+
+// 100 KB/s is less than 20x needs (~230 KB/s): stalls are counted, rate falls short
+static void test_starved_storage_counts_stalls() {
+  SlowFile slow;
+  slow.us_per_kb = 10000;
+  const PrefetchRun starved = run_prefetch(clip(), slow, 2000, 5, true);
+  TEST_ASSERT_TRUE(starved.ra.stalls > 0);
+  TEST_ASSERT_TRUE(starved.st.achieved_mhz < starved.st.target_mhz);
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_reads_the_file_byte_for_byte);
+  RUN_TEST(test_seeks_outside_the_head_restart_the_fill);
+  RUN_TEST(test_spikes_are_hidden_from_the_parser);
+  RUN_TEST(test_loop_rewinds_do_not_seek);
+  RUN_TEST(test_inline_reads_make_replay_late);
+  RUN_TEST(test_starved_storage_counts_stalls);
+  return UNITY_END();
+}
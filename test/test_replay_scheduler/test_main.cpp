@@ -0,0 +1,167 @@
+// ReplayScheduler (replay_scheduler.h) on a virtual clock: pacing, lag
+// policies, speed range, and traces whose timestamps go backwards.
+//   pio test -e native -f test_replay_scheduler
+#include <unity.h>
+#include <vector>
+#include "replay_scheduler.h"
+
+void setUp() {}
+void tearDown() {}
+
+// In-memory trace with the scheduler's source interface
+struct TraceSource {
+  std::vector<StrideraSample> rows;
+  size_t pos = 0;
+  bool readNext(StrideraSample& s, uint16_t) {
+    if (pos >= rows.size()) return false;
+    s = rows[pos++];
+    return true;
+  }
+  bool rewind() { pos = 0; return true; }
+};
+
+static TraceSource trace_of(const std::vector<uint32_t>& ts_ms) {
+  TraceSource src;
+  for (size_t i = 0; i < ts_ms.size(); ++i) {
+    StrideraSample s{};
+    s.v1.ts_ms = ts_ms[i];
+    s.v1.az_mg = (int16_t)i;                      // row number, to check the order
+    src.rows.push_back(s);
+  }
+  return src;
+}
+
+// Released rows, polled every 10 ms for `secs` of virtual time
+static std::vector<StrideraSample> play(TraceSource& src, const ReplayConfig& cfg, uint32_t secs) {
+  ReplayScheduler<TraceSource> sched;
+  std::vector<StrideraSample> out;
+  TEST_ASSERT_TRUE(sched.begin(&src, cfg));
+  uint64_t now = 5000000;
+  sched.start(now);
+  for (uint32_t t = 0; t < secs * 100; ++t, now += 10000) {
+    sched.poll(now, [&](const StrideraSample& s) { out.push_back(s); });
+  }
+  return out;
+}
+
+// Rows stamped before the first row of the loop, or before their predecessor,
+// are released with the previous row instead of stalling the replay
+static void test_backwards_timestamps_do_not_stall() {
+  TraceSource src = trace_of({1000, 1010, 990, 1030, 1020, 1050});
+  ReplayConfig cfg;
+  cfg.loop = false;
+  const auto out = play(src, cfg, 10);
+
+  TEST_ASSERT_EQUAL_size_t(6, out.size());
+  for (size_t i = 0; i < out.size(); ++i) TEST_ASSERT_EQUAL_INT16((int16_t)i, out[i].v1.az_mg);
+  for (size_t i = 1; i < out.size(); ++i) TEST_ASSERT_TRUE(out[i].ts_us >= out[i - 1].ts_us);
+  TEST_ASSERT_EQUAL_UINT32(out[1].ts_us, out[2].ts_us);   // 990 goes out with 1010
+  TEST_ASSERT_EQUAL_UINT32(out[3].ts_us, out[4].ts_us);   // 1020 with 1030
+  TEST_ASSERT_EQUAL_UINT32(out[0].ts_us + 50000, out[5].ts_us);
+}
+
+// 10 s at 200 Hz, released on a virtual clock with 10 ms ticks (+-2 ms
+// jitter) and one 300 ms stall 5 s in
+struct Paced {
+  std::vector<uint32_t> ts;                       // released ts_us, in order
+  ReplayStats st;
+  uint64_t expected = 0;                          // rows due by the end at the configured speed
+  uint32_t stepUs   = 0;
+};
+
+static Paced pace(const ReplayConfig& cfg, uint32_t secs) {
+  std::vector<uint32_t> ts(2000);
+  for (size_t i = 0; i < ts.size(); ++i) ts[i] = (uint32_t)i * 5;
+  TraceSource src = trace_of(ts);
+  ReplayScheduler<TraceSource> sched;
+  Paced out;
+  TEST_ASSERT_TRUE(sched.begin(&src, cfg));
+  uint64_t now = 1000000, rng = 99;
+  const uint64_t start = now, end = start + secs * 1000000ull;
+  sched.start(now);
+  auto emit = [&](const StrideraSample& s) { out.ts.push_back(s.ts_us); };
+  bool stalled = false;
+  while (now < end) {
+    rng = rng * 6364136223846793005ull + 1442695040888963407ull;
+    now += 10000 + (int)((rng >> 33) % 4001) - 2000;
+    if (!stalled && now > start + 5000000) { now += 300000; stalled = true; }
+    if (now > end) now = end;
+    sched.poll(now, emit);
+  }
+  while (sched.poll(end, emit) == cfg.max_burst) {}
+  out.st       = sched.stats();
+  out.stepUs   = (uint32_t)(1000000ull * 100 / sched.recordedHz() / sched.speedX100());
+  out.expected = (end - start) / out.stepUs + 1;
+  return out;
+}
+
+// Achieved rate within 1% of the target
+static void assert_on_rate(const Paced& p) {
+  TEST_ASSERT_TRUE(p.st.target_mhz > 0);
+  TEST_ASSERT_UINT32_WITHIN(p.st.target_mhz / 100, p.st.target_mhz, p.st.achieved_mhz);
+}
+
+static ReplayConfig at_4x(uint8_t policy) {
+  ReplayConfig cfg;
+  cfg.speed_x100 = 400;
+  cfg.loop       = true;
+  cfg.policy     = policy;
+  return cfg;
+}
+
+// Catch-up: every row, evenly stamped across loop boundaries (4x: 10 loops in 25 s)
+static void test_catch_up_releases_every_row_evenly() {
+  const Paced p = pace(at_4x(STRIDERA_REPLAY_CATCH_UP), 25);
+  TEST_ASSERT_EQUAL_UINT64(p.expected, p.st.released);
+  TEST_ASSERT_EQUAL_UINT32(10, p.st.loops);
+  for (size_t i = 1; i < p.ts.size(); ++i) TEST_ASSERT_EQUAL_UINT32(p.stepUs, p.ts[i] - p.ts[i - 1]);
+  assert_on_rate(p);
+}
+
+static void test_rerun_is_identical() {
+  const Paced a = pace(at_4x(STRIDERA_REPLAY_CATCH_UP), 25);
+  const Paced b = pace(at_4x(STRIDERA_REPLAY_CATCH_UP), 25);
+  TEST_ASSERT_TRUE(a.ts == b.ts);
+}
+
+// DROP: the stall's overdue rows are discarded and counted, lag stays bounded
+static void test_drop_discards_overdue_rows() {
+  const ReplayConfig cfg = at_4x(STRIDERA_REPLAY_DROP);
+  const Paced p = pace(cfg, 25);
+  TEST_ASSERT_TRUE(p.st.dropped > 0);
+  TEST_ASSERT_EQUAL_UINT64(p.expected, (uint64_t)p.st.released + p.st.dropped);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(cfg.max_lag_us + 12000, p.st.late_max_us);
+}
+
+// SLIP: every row kept, the schedule moves forward once
+static void test_slip_moves_the_schedule_once() {
+  const Paced p = pace(at_4x(STRIDERA_REPLAY_SLIP), 25);
+  TEST_ASSERT_EQUAL_UINT32(0, p.st.dropped);
+  TEST_ASSERT_TRUE(p.st.slips >= 1);
+  size_t jumps = 0;
+  for (size_t i = 1; i < p.ts.size(); ++i) jumps += p.ts[i] - p.ts[i - 1] != p.stepUs;
+  TEST_ASSERT_EQUAL_size_t(1, jumps);
+}
+
+static void test_speed_range_ends() {
+  ReplayConfig cfg;
+  cfg.speed_x100 = STRIDERA_REPLAY_SPEED_MIN;
+  const Paced slow = pace(cfg, 20);
+  TEST_ASSERT_EQUAL_UINT64(slow.expected, slow.st.released);
+  assert_on_rate(slow);
+  cfg.speed_x100 = STRIDERA_REPLAY_SPEED_MAX;
+  const Paced fast = pace(cfg, 3);
+  TEST_ASSERT_EQUAL_UINT64(fast.expected, fast.st.released);
+  assert_on_rate(fast);
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_catch_up_releases_every_row_evenly);
+  RUN_TEST(test_rerun_is_identical);
+  RUN_TEST(test_drop_discards_overdue_rows);
+  RUN_TEST(test_slip_moves_the_schedule_once);
+  RUN_TEST(test_speed_range_ends);
+  RUN_TEST(test_backwards_timestamps_do_not_stall);
+  return UNITY_END();
+}
@@ -0,0 +1,150 @@
+// SessionRecorder (session_recorder.h) writing a real file through
+// PosixBlockFile in a temp directory, read back with StrideraSessionReader.
+//   pio test -e native -f test_session_recorder
+#include <unity.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <vector>
+#include "session_recorder.h"
+#include "stridera_session.h"
+
+static char dir[64];
+static char path[96];
+
+void setUp() {
+  snprintf(dir, sizeof(dir), "/tmp/stridera_recXXXXXX");
+  TEST_ASSERT_NOT_NULL(mkdtemp(dir));
+  snprintf(path, sizeof(path), "%s/rec_0001.ssn", dir);
+}
+
+void tearDown() {
+  unlink(path);
+  rmdir(dir);
+}
+
+// Host stand-in for fs::File on the read side
+struct StdioSource {
+  FILE* f = nullptr;
+  size_t read(uint8_t* buf, size_t n) { return fread(buf, 1, n, f); }
+  bool seek(uint32_t off) { return fseek(f, (long)off, SEEK_SET) == 0; }
+};
+
+static std::vector<StrideraAccelPacket> walk(size_t n) {
+  std::vector<StrideraAccelPacket> v(n);
+  for (size_t i = 0; i < n; ++i) {
+    v[i] = StrideraAccelPacket{(uint32_t)(5000 + i * 5), (int16_t)(i % 2000 - 1000),
+                               (int16_t)(-(int)(i % 700)), (int16_t)(1000 + i % 50), 200, 0};
+  }
+  return v;
+}
+
+static long file_size(const char* p) {
+  struct stat st;
+  return stat(p, &st) == 0 ? (long)st.st_size : -1;
+}
+
+static bool woken = false;
+
+// The writer task's job, run inline whenever the producer kicks it
+template <typename Rec>
+static void record(Rec& rec, PosixBlockFile& file, const std::vector<StrideraAccelPacket>& pk,
+                   uint32_t prealloc, uint32_t stride) {
+  rec.setWake([](void*) { woken = true; }, nullptr);
+  TEST_ASSERT_TRUE(rec.begin(&file, path, 200, prealloc, stride));
+  for (const auto& p : pk) {
+    TEST_ASSERT_TRUE(rec.append(p));
+    if (woken) { woken = false; rec.service(); }
+  }
+  rec.requestStop();
+  rec.service();
+}
+
+static void test_record_and_read_back() {
+  static SessionRecorder<4096, 2048> rec;
+  PosixBlockFile file;
+  const auto pk = walk(20011);                     // ends mid-buffer
+  record(rec, file, pk, 1024 * 1024, 512);
+
+  TEST_ASSERT_TRUE(rec.closed());
+  TEST_ASSERT_EQUAL_UINT32(pk.size(), rec.stats().records);
+  TEST_ASSERT_EQUAL_UINT32(0, rec.stats().dropped);
+
+  // Preallocation trimmed back: header block + records + index
+  const uint32_t idx = (uint32_t)(pk.size() + 511) / 512;
+  TEST_ASSERT_EQUAL(512 + pk.size() * sizeof(StrideraSessionRecord) + idx * sizeof(StrideraSessionIndexEntry),
+                    file_size(path));
+
+  StdioSource src;
+  src.f = fopen(path, "rb");
+  TEST_ASSERT_NOT_NULL(src.f);
+  static StrideraSessionReader<StdioSource> rd;
+  TEST_ASSERT_TRUE(rd.begin(&src));
+  const StrideraSessionHeader& h = rd.header();
+  TEST_ASSERT_EQUAL_UINT32(pk.size(), h.record_count);
+  TEST_ASSERT_EQUAL_UINT16(200, h.rate_hz);
+  TEST_ASSERT_EQUAL_UINT16(512, h.header_size);
+  TEST_ASSERT_EQUAL_UINT32(pk.front().ts_ms, h.first_ts_ms);
+  TEST_ASSERT_EQUAL_UINT32(pk.back().ts_ms, h.last_ts_ms);
+  TEST_ASSERT_EQUAL_UINT32(idx, h.index_count);
+
+  StrideraAccelPacket p;
+  size_t n = 0;
+  while (rd.next(p, 200)) {
+    TEST_ASSERT_EQUAL_UINT32(pk[n].ts_ms, p.ts_ms);
+    TEST_ASSERT_EQUAL_INT16(pk[n].ax_mg, p.ax_mg);
+    TEST_ASSERT_EQUAL_INT16(pk[n].ay_mg, p.ay_mg);
+    TEST_ASSERT_EQUAL_INT16(pk[n].az_mg, p.az_mg);
+    ++n;
+  }
+  TEST_ASSERT_EQUAL_size_t(pk.size(), n);
+
+  // The index on disk drives seekMs: land on the first record at or after ts
+  const uint32_t target = pk[12345].ts_ms - 2;
+  TEST_ASSERT_TRUE(rd.seekMs(target));
+  TEST_ASSERT_EQUAL_UINT32(12345, rd.position());
+  TEST_ASSERT_TRUE(rd.next(p, 200));
+  TEST_ASSERT_EQUAL_UINT32(pk[12345].ts_ms, p.ts_ms);
+  fclose(src.f);
+}
+
+static void test_empty_session_is_valid() {
+  static SessionRecorder<4096, 2048> rec;
+  PosixBlockFile file;
+  record(rec, file, {}, 64 * 1024, 512);
+
+  TEST_ASSERT_TRUE(rec.closed());
+  TEST_ASSERT_EQUAL(512, file_size(path));
+
+  StdioSource src;
+  src.f = fopen(path, "rb");
+  TEST_ASSERT_NOT_NULL(src.f);
+  StrideraSessionReader<StdioSource> rd;
+  TEST_ASSERT_TRUE(rd.begin(&src));
+  TEST_ASSERT_EQUAL_UINT32(0, rd.header().record_count);
+  TEST_ASSERT_EQUAL_UINT32(0, rd.header().index_offset);
+  StrideraAccelPacket p;
+  TEST_ASSERT_FALSE(rd.next(p, 200));
+  fclose(src.f);
+}
+
+// No card / no directory: the writer reports failure instead of recording
+static void test_create_failure_reports_failed() {
+  static SessionRecorder<4096, 2048> rec;
+  PosixBlockFile file;
+  char missing[128];
+  snprintf(missing, sizeof(missing), "%s/no_such_dir/rec_0002.ssn", dir);
+  TEST_ASSERT_TRUE(rec.begin(&file, missing, 200, 0));
+  rec.service();
+  TEST_ASSERT_TRUE(rec.failed());
+  TEST_ASSERT_FALSE(rec.active());
+  TEST_ASSERT_FALSE(rec.append(StrideraAccelPacket{1, 0, 0, 1000, 200, 0}));
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_record_and_read_back);
+  RUN_TEST(test_empty_session_is_valid);
+  RUN_TEST(test_create_failure_reports_failed);
+  return UNITY_END();
+}
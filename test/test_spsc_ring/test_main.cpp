@@ -0,0 +1,160 @@
+// SpscRing (spsc_ring.h) under a real producer thread and consumer thread.
+//   pio test -e native -f test_spsc_ring
+// Every element carries its sequence number plus two fields derived from it,
+// so a torn slot, a duplicate or a reorder shows up on the consumer side.
+#include <unity.h>
+#include <atomic>
+#include <thread>
+#include "spsc_ring.h"
+
+void setUp() {}
+void tearDown() {}
+
+struct Item {
+  uint32_t seq;
+  uint32_t inv;      // ~seq
+  uint64_t mix;      // seq * odd constant
+};
+
+static Item make_item(uint32_t seq) { return Item{seq, ~seq, seq * 0x9E3779B97F4A7C15ull}; }
+static bool intact(const Item& it) { return it.inv == ~it.seq && it.mix == it.seq * 0x9E3779B97F4A7C15ull; }
+
+static constexpr size_t   kRing  = 256;        // IMU_RING_CAPACITY
+static constexpr uint32_t kItems = 4000000;
+
+struct ConsumerResult {
+  uint32_t received = 0;
+  uint32_t torn     = 0;
+  uint32_t reorders = 0;     // seq not above the previous one (duplicate or out of order)
+  uint32_t gaps     = 0;     // seqs skipped (lossy run only)
+  uint32_t last     = 0;
+};
+
+// Pops until the producer is done and the ring is empty; `slow` stalls now and
+// then so the producer overruns
+template <typename Ring>
+static void consume(Ring& ring, const std::atomic<bool>& done, ConsumerResult& r, bool slow) {
+  Item it;
+  bool first = true;
+  uint32_t spins = 0;
+  for (;;) {
+    if (!ring.pop(it)) {
+      if (done.load(std::memory_order_acquire) && ring.empty()) break;
+      std::this_thread::yield();
+      continue;
+    }
+    if (!intact(it)) ++r.torn;
+    if (!first && it.seq <= r.last) ++r.reorders;
+    if (!first && it.seq > r.last + 1) r.gaps += it.seq - r.last - 1;
+    r.last = it.seq;
+    first = false;
+    ++r.received;
+    if (slow && (++spins & 0x3FF) == 0) std::this_thread::sleep_for(std::chrono::microseconds(50));
+  }
+}
+
+// Producer retries every rejected push: nothing may be lost, and every
+// rejection must show up as exactly one overrun
+static void test_lossless_stream_in_order() {
+  static SpscRing<Item, kRing> ring;
+  ring.resetStats();
+  std::atomic<bool> done{false};
+  ConsumerResult r;
+  uint32_t rejected = 0;
+
+  std::thread consumer([&] { consume(ring, done, r, false); });
+  std::thread producer([&] {
+    for (uint32_t seq = 0; seq < kItems; ++seq) {
+      const Item it = make_item(seq);
+      while (!ring.push(it)) { ++rejected; std::this_thread::yield(); }
+    }
+    done.store(true, std::memory_order_release);
+  });
+  producer.join();
+  consumer.join();
+
+  TEST_ASSERT_EQUAL_UINT32(kItems, r.received);
+  TEST_ASSERT_EQUAL_UINT32(0, r.torn);
+  TEST_ASSERT_EQUAL_UINT32(0, r.reorders);
+  TEST_ASSERT_EQUAL_UINT32(0, r.gaps);
+  TEST_ASSERT_EQUAL_UINT32(kItems - 1, r.last);
+  TEST_ASSERT_EQUAL_UINT32(rejected, ring.overruns());
+  TEST_ASSERT_GREATER_THAN_UINT32(0, ring.highWater());
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(kRing, ring.highWater());
+  TEST_ASSERT_TRUE(ring.empty());
+}
+
+// Producer pushes each sample once like the IMU task does and the consumer
+// stalls: dropped samples are exactly the overruns, the rest arrive in order
+static void test_overruns_match_dropped_samples() {
+  static SpscRing<Item, kRing> ring;
+  ring.resetStats();
+  std::atomic<bool> done{false};
+  ConsumerResult r;
+  uint32_t accepted = 0;
+
+  std::thread consumer([&] { consume(ring, done, r, true); });
+  std::thread producer([&] {
+    for (uint32_t seq = 0; seq < kItems; ++seq) {
+      if (ring.push(make_item(seq))) ++accepted;
+      if ((seq & 0xFF) == 0) std::this_thread::yield();
+    }
+    done.store(true, std::memory_order_release);
+  });
+  producer.join();
+  consumer.join();
+
+  TEST_ASSERT_EQUAL_UINT32(accepted, r.received);
+  TEST_ASSERT_EQUAL_UINT32(kItems - accepted, ring.overruns());
+  TEST_ASSERT_EQUAL_UINT32(ring.overruns(), r.gaps + (kItems - 1 - r.last));   // drops inside the stream + at its end
+  TEST_ASSERT_EQUAL_UINT32(0, r.torn);
+  TEST_ASSERT_EQUAL_UINT32(0, r.reorders);
+  TEST_ASSERT_GREATER_THAN_UINT32(0, ring.overruns());
+  TEST_ASSERT_EQUAL_UINT32(kRing, ring.highWater());   // a rejection means the ring was seen full
+}
+
+// discard() from the consumer while the producer keeps going: whatever is
+// popped afterwards is still intact and in order
+static void test_discard_keeps_order() {
+  static SpscRing<Item, kRing> ring;
+  ring.resetStats();
+  std::atomic<bool> done{false};
+  uint32_t received = 0, torn = 0, reorders = 0, last = 0;
+  bool first = true;
+
+  std::thread producer([&] {
+    for (uint32_t seq = 0; seq < kItems / 4; ++seq) {
+      while (!ring.push(make_item(seq))) std::this_thread::yield();
+    }
+    done.store(true, std::memory_order_release);
+  });
+  Item it;
+  uint32_t n = 0;
+  for (;;) {
+    if ((++n & 0xFFF) == 0) { ring.discard(); continue; }
+    if (!ring.pop(it)) {
+      if (done.load(std::memory_order_acquire) && ring.empty()) break;
+      std::this_thread::yield();
+      continue;
+    }
+    if (!intact(it)) ++torn;
+    if (!first && it.seq <= last) ++reorders;
+    last = it.seq;
+    first = false;
+    ++received;
+  }
+  producer.join();
+
+  TEST_ASSERT_GREATER_THAN_UINT32(0, received);
+  TEST_ASSERT_EQUAL_UINT32(0, torn);
+  TEST_ASSERT_EQUAL_UINT32(0, reorders);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(kRing, ring.highWater());
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_lossless_stream_in_order);
+  RUN_TEST(test_overruns_match_dropped_samples);
+  RUN_TEST(test_discard_keeps_order);
+  return UNITY_END();
+}
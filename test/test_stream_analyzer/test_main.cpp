@@ -0,0 +1,157 @@
+// Packet v2 (stridera_packet.h) and StreamAnalyzer (stream_analyzer.h):
+// round trip, CRC, the 32-bit us wrap, and what a capture with known
+// impairments is reported as. seq and the us clock both wrap in every capture.
+//   pio test -e native -f test_stream_analyzer
+#include <unity.h>
+#include <utility>
+#include <vector>
+#include "stridera_packet.h"
+#include "stream_analyzer.h"
+
+void setUp() {}
+void tearDown() {}
+
+static const uint32_t kTs0 = 0xFFFFFFFFu - 5000000u;    // the us clock wraps 5 s in
+
+struct Captured { StrideraAccelPacketV2 p; uint64_t arrival_us; };
+
+static StrideraSample sample(size_t i, uint32_t stall_us = 0) {
+  StrideraSample s{};
+  s.v1        = StrideraAccelPacket{(uint32_t)(i * 5), (int16_t)(i % 700), (int16_t)-300, (int16_t)(1000 + i % 50), 200, 0};
+  s.seq       = (uint16_t)(65000 + i);                   // wraps after 536 samples
+  s.rate_hz   = 200;
+  s.chan_mask = STRIDERA_CH_ACCEL;
+  s.ts_us     = kTs0 + (uint32_t)(i * 5000) + stall_us;
+  return s;
+}
+
+// 200 Hz, arrival 0..2 ms after the nominal time
+static std::vector<Captured> clean(size_t n) {
+  std::vector<Captured> cap;
+  uint32_t rng = 12345;
+  for (size_t i = 0; i < n; ++i) {
+    rng = rng * 1103515245u + 12345u;
+    cap.push_back({stridera_packet_v2(sample(i), true), 10000000ull + i * 5000ull + (rng >> 16) % 2000});
+  }
+  return cap;
+}
+
+static StreamReport analyze(const std::vector<Captured>& cap) {
+  StreamAnalyzer a;
+  for (const auto& c : cap) a.addPayload(reinterpret_cast<const uint8_t*>(&c.p), sizeof(c.p), c.arrival_us);
+  return a.report();
+}
+
+static void test_v2_round_trip() {
+  const StrideraSample s = sample(7);
+  const StrideraAccelPacketV2 p = stridera_packet_v2(s, true);
+  StrideraAccelPacketV2 back;
+  uint32_t invalid = 0;
+  TEST_ASSERT_EQUAL_size_t(1, stridera_v2_decode(reinterpret_cast<const uint8_t*>(&p), sizeof(p), &back, 1, &invalid));
+  TEST_ASSERT_EQUAL_UINT32(0, invalid);
+  TEST_ASSERT_EQUAL_UINT16(s.seq, back.seq);
+  TEST_ASSERT_EQUAL_UINT32(s.ts_us, back.ts_us);
+  TEST_ASSERT_EQUAL_INT16(s.v1.ax_mg, back.ax_mg);
+  TEST_ASSERT_EQUAL_INT16(s.v1.az_mg, back.az_mg);
+  TEST_ASSERT_EQUAL_UINT8(s.rate_hz, back.rate_hz);
+}
+
+static void test_flipped_bit_fails_crc() {
+  StrideraAccelPacketV2 p[2] = {stridera_packet_v2(sample(0), true), stridera_packet_v2(sample(1), true)};
+  reinterpret_cast<uint8_t*>(p)[9] ^= 0x10;
+  StrideraAccelPacketV2 back[2];
+  uint32_t invalid = 0;
+  TEST_ASSERT_EQUAL_size_t(1, stridera_v2_decode(reinterpret_cast<const uint8_t*>(p), sizeof(p), back, 2, &invalid));
+  TEST_ASSERT_EQUAL_UINT32(1, invalid);
+  TEST_ASSERT_EQUAL_UINT16(sample(1).seq, back[0].seq);
+}
+
+// ms across the 32-bit us wrap: counting on with the stream's clock, a late
+// packet from before the wrap stays before it, the stateless decode starts again at 0
+static void test_ms_keep_counting_across_us_wrap() {
+  const uint32_t ts[] = { 0xFFFFFFFFu - 12000u, 0xFFFFFFFFu - 7000u, 3000u, 0xFFFFFFFFu - 2000u, 8000u };
+  const uint32_t ms[] = { 4294955u, 4294960u, 4294970u, 4294965u, 4294975u };
+  StrideraUsClock clock;
+  for (size_t i = 0; i < 5; ++i) {
+    StrideraSample s = sample(i);
+    s.ts_us = ts[i];
+    const StrideraAccelPacketV2 p = stridera_packet_v2(s, true);
+    StrideraSample out;
+    TEST_ASSERT_EQUAL_size_t(1, stridera_v2_decode_samples(reinterpret_cast<const uint8_t*>(&p), sizeof(p), &out, 1, nullptr, &clock));
+    TEST_ASSERT_EQUAL_UINT32(ms[i], out.v1.ts_ms);
+    TEST_ASSERT_EQUAL_UINT32(ts[i], out.ts_us);
+    TEST_ASSERT_EQUAL_size_t(1, stridera_v2_decode_samples(reinterpret_cast<const uint8_t*>(&p), sizeof(p), &out, 1));
+    TEST_ASSERT_EQUAL_UINT32(ts[i] / 1000, out.v1.ts_ms);
+  }
+}
+
+static void test_clean_capture_across_both_wraps() {
+  const StreamReport rep = analyze(clean(2000));
+  TEST_ASSERT_EQUAL_UINT64(2000, rep.expected);
+  TEST_ASSERT_EQUAL_UINT64(2000, rep.received);
+  TEST_ASSERT_EQUAL_UINT64(0, rep.lost);
+  TEST_ASSERT_EQUAL_UINT64(0, rep.reordered);
+  TEST_ASSERT_EQUAL_UINT64(0, rep.timing_gaps);
+  TEST_ASSERT_EQUAL_UINT32(0, rep.ts_step_dev_max_us);
+  TEST_ASSERT_EQUAL_UINT32(5000, rep.nominal_period_us);
+  TEST_ASSERT_TRUE(rep.jitter_us > 100);
+  TEST_ASSERT_TRUE(rep.jitter_max_us < 2000);
+}
+
+static void test_lost_and_corrupted_count_as_loss() {
+  auto cap = clean(2000);
+  cap.erase(cap.begin() + 1100);
+  cap.erase(cap.begin() + 100);
+  reinterpret_cast<uint8_t*>(&cap[300].p)[9] ^= 0x10;  // still arrives, fails the CRC
+  const StreamReport rep = analyze(cap);
+  TEST_ASSERT_EQUAL_UINT64(2000, rep.expected);
+  TEST_ASSERT_EQUAL_UINT64(3, rep.lost);
+  TEST_ASSERT_EQUAL_UINT64(1997, rep.received);
+  TEST_ASSERT_EQUAL_UINT32(1, rep.invalid);
+}
+
+static void test_duplicates_are_counted_once() {
+  auto cap = clean(2000);
+  cap.insert(cap.begin() + 500, cap[500]);
+  cap.insert(cap.begin() + 1500, cap[1500]);
+  const StreamReport rep = analyze(cap);
+  TEST_ASSERT_EQUAL_UINT64(2, rep.duplicates);
+  TEST_ASSERT_EQUAL_UINT64(2000, rep.received);
+  TEST_ASSERT_EQUAL_UINT64(0, rep.lost);
+}
+
+static void test_swapped_notifications_are_reordered_not_lost() {
+  auto cap = clean(2000);
+  std::swap(cap[700], cap[701]);                         // 536 is where seq wraps
+  std::swap(cap[535], cap[536]);
+  const StreamReport rep = analyze(cap);
+  TEST_ASSERT_EQUAL_UINT64(2, rep.reordered);
+  TEST_ASSERT_EQUAL_UINT64(0, rep.lost);
+  TEST_ASSERT_EQUAL_UINT64(2000, rep.received);
+}
+
+static void test_clock_stall_is_a_timing_gap_not_loss() {
+  std::vector<Captured> cap;
+  uint32_t stall_us = 0;
+  for (size_t i = 0; i < 2000; ++i) {
+    if (i == 900) stall_us += 100000;
+    cap.push_back({stridera_packet_v2(sample(i, stall_us), true), 10000000ull + i * 5000ull + stall_us});
+  }
+  const StreamReport rep = analyze(cap);
+  TEST_ASSERT_EQUAL_UINT64(1, rep.timing_gaps);
+  TEST_ASSERT_EQUAL_UINT64(0, rep.lost);
+  TEST_ASSERT_EQUAL_UINT32(0, rep.jitter_max_us);        // arrivals stalled with the clock
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_v2_round_trip);
+  RUN_TEST(test_flipped_bit_fails_crc);
+  RUN_TEST(test_ms_keep_counting_across_us_wrap);
+  RUN_TEST(test_clean_capture_across_both_wraps);
+  RUN_TEST(test_lost_and_corrupted_count_as_loss);
+  RUN_TEST(test_duplicates_are_counted_once);
+  RUN_TEST(test_swapped_notifications_are_reordered_not_lost);
+  RUN_TEST(test_clock_stall_is_a_timing_gap_not_loss);
+  return UNITY_END();
+}
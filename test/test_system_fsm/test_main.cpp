@@ -0,0 +1,151 @@
+// SystemFsm (system_fsm.h) with FsmEventLatch (fsm_events.h) against a
+// scripted port on a virtual clock: held events, deadlines, latency.
+//   pio test -e native -f test_system_fsm
+#include <unity.h>
+#include <string>
+#include "system_fsm.h"
+#include "fsm_events.h"
+
+// Every port action costs 250 us of virtual time
+static uint32_t s_clock_us = 0;
+static uint32_t vclock() { return s_clock_us; }
+
+class ScriptPort : public ISystemPort {
+public:
+  bool link       = true;
+  bool recBusy    = false;
+  bool poweredOff = false;
+  std::string trail;                                 // "B>I I>S ..." first letters
+  uint32_t lastLatency = 0;
+
+  bool connected() const override { return link; }
+  bool recorderBusy() const override { return recBusy; }
+  void startStreaming() override          { s_clock_us += 250; }
+  void stopStreaming(bool) override       { s_clock_us += 250; }
+  bool startRecording() override          { s_clock_us += 250; recBusy = true; return true; }
+  void stopRecording() override           { s_clock_us += 250; }
+  void beginShutdown() override           { s_clock_us += 250; }
+  void finishShutdown() override          { poweredOff = true; }
+  void onTransition(SystemState f, SystemState t, uint32_t lat) override {
+    if (!trail.empty()) trail += ' ';
+    trail += system_state_name(f)[0];
+    trail += '>';
+    trail += system_state_name(t)[0];
+    lastLatency = lat;
+  }
+};
+
+static ScriptPort    port;
+static SystemFsm     fsm;
+static FsmEventLatch latch;
+
+void setUp() {
+  port = ScriptPort();
+  s_clock_us = 0;
+  uint32_t since;
+  latch.take(since);
+  fsm.begin(&port, &vclock);
+}
+void tearDown() {}
+
+// Raise `ev` at `at_ms`, wake 40 us later and step like System::loop
+static uint32_t run(uint32_t at_ms, uint32_t ev) {
+  s_clock_us = at_ms * 1000;
+  if (ev) latch.raise(ev, s_clock_us);
+  s_clock_us += 40;
+  uint32_t since = 0;
+  const uint32_t e = latch.take(since);
+  return fsm.step(e, since);
+}
+
+static void test_boot_grace_counts_from_begin() {
+  TEST_ASSERT_EQUAL_UINT32(2000000 - 40, run(0, 0));
+  TEST_ASSERT_TRUE(fsm.state() == SystemState::BOOTING);
+}
+
+static void test_subscribe_during_boot_is_held() {
+  TEST_ASSERT_TRUE(run(500, FSM_EV_SUBSCRIBE) > 0);
+  TEST_ASSERT_TRUE(fsm.state() == SystemState::BOOTING);
+  run(2000, 0);                                     // IDLE, then the held subscribe
+  TEST_ASSERT_TRUE(fsm.state() == SystemState::STREAMING);
+  TEST_ASSERT_EQUAL_STRING("B>I I>S", port.trail.c_str());
+}
+
+static void test_buttons_during_boot_are_dropped() {
+  run(500, FSM_EV_BTN_RECORD | FSM_EV_BTN_POWER);
+  run(2000, 0);
+  TEST_ASSERT_TRUE(fsm.state() == SystemState::IDLE);
+  TEST_ASSERT_FALSE(port.recBusy);
+}
+
+static void test_idle_waits_forever() {
+  run(0, 0);
+  TEST_ASSERT_EQUAL_UINT32(SystemFsm::kNever, run(2000, 0));
+}
+
+static void test_latency_covers_wake_and_action() {
+  run(0, 0);
+  run(2000, FSM_EV_SUBSCRIBE);
+  run(3000, FSM_EV_UNSUBSCRIBE);
+  TEST_ASSERT_EQUAL_UINT32(290, port.lastLatency);  // 40 us wake + 250 us action
+}
+
+static void test_recording_yields_to_live_stream() {
+  run(2000, 0);
+  run(4000, FSM_EV_BTN_RECORD);
+  TEST_ASSERT_TRUE(fsm.state() == SystemState::RECORDING);
+  run(5000, FSM_EV_SUBSCRIBE);
+  TEST_ASSERT_TRUE(fsm.state() == SystemState::STREAMING);
+  TEST_ASSERT_EQUAL_STRING("B>I I>R R>I I>S", port.trail.c_str());
+}
+
+static void test_lost_link_ends_streaming() {
+  run(2000, FSM_EV_SUBSCRIBE);
+  port.link = false;
+  run(6000, FSM_EV_LINK);
+  TEST_ASSERT_TRUE(fsm.state() == SystemState::IDLE);
+}
+
+static void test_shutdown_waits_for_window_and_recorder() {
+  run(2000, 0);
+  run(4000, FSM_EV_BTN_RECORD);
+  TEST_ASSERT_EQUAL_UINT32(2000000, run(7000, FSM_EV_BTN_POWER));   // window counts from the action
+  TEST_ASSERT_TRUE(fsm.state() == SystemState::SHUTTING_DOWN);
+  TEST_ASSERT_EQUAL_UINT32(100000, run(9300, 0));                   // recorder still closing
+  TEST_ASSERT_FALSE(port.poweredOff);
+  port.recBusy = false;
+  run(9400, 0);
+  TEST_ASSERT_TRUE(port.poweredOff);
+}
+
+static void test_full_scenario_trail() {
+  run(0, 0);
+  run(500, FSM_EV_SUBSCRIBE);
+  run(2000, 0);
+  run(3000, FSM_EV_UNSUBSCRIBE);
+  run(4000, FSM_EV_BTN_RECORD);
+  run(5000, FSM_EV_SUBSCRIBE);
+  port.link = false;
+  run(6000, FSM_EV_LINK);
+  port.link = true;
+  run(7000, FSM_EV_BTN_POWER);
+  run(9300, 0);
+  port.recBusy = false;
+  run(9400, 0);
+  TEST_ASSERT_TRUE(port.poweredOff);
+  TEST_ASSERT_EQUAL_STRING("B>I I>S S>I I>R R>I I>S S>I I>S S>I", port.trail.c_str());
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_boot_grace_counts_from_begin);
+  RUN_TEST(test_subscribe_during_boot_is_held);
+  RUN_TEST(test_buttons_during_boot_are_dropped);
+  RUN_TEST(test_idle_waits_forever);
+  RUN_TEST(test_latency_covers_wake_and_action);
+  RUN_TEST(test_recording_yields_to_live_stream);
+  RUN_TEST(test_lost_link_ends_streaming);
+  RUN_TEST(test_shutdown_waits_for_window_and_recorder);
+  RUN_TEST(test_full_scenario_trail);
+  return UNITY_END();
+}
@@ -0,0 +1,55 @@
+#!/usr/bin/env python3
+"""Compare two stridera-bench JSON results and flag regressions.
+
+  python3 tools/bench_compare/bench_compare.py baseline.json current.json [--tolerance 0.15]
+
+A stage regresses if its best-repetition ns/sample grows by more than the
+tolerance, its bytes/sample or allocs/sample grow at all, or its correctness
+check fails. Exit code 1 on any regression, so it can gate CI on a Linux box.
+"""
+import argparse
+import json
+import sys
+
+
+def load(path):
+    with open(path) as f:
+        return {s["stage"]: s for s in json.load(f)["stages"]}
+
+
+def main():
+    ap = argparse.ArgumentParser()
+    ap.add_argument("baseline")
+    ap.add_argument("current")
+    ap.add_argument("--tolerance", type=float, default=0.15, help="allowed ns/sample growth (0.15 = +15%%)")
+    args = ap.parse_args()
+
+    base, cur = load(args.baseline), load(args.current)
+    failed = False
+    print(f"{'stage':22} {'base ns':>10} {'cur ns':>10} {'delta':>8}  B/sample  allocs")
+    for name, c in cur.items():
+        b = base.get(name)
+        if b is None:
+            print(f"{name:22} {'-':>10} {c['ns_per_sample_min']:10.2f} {'new':>8}")
+            continue
+        bn, cn = b["ns_per_sample_min"], c["ns_per_sample_min"]
+        delta = (cn - bn) / bn if bn > 0 else 0.0
+        issues = []
+        if delta > args.tolerance:
+            issues.append("slower")
+        if c["bytes_per_sample"] > b["bytes_per_sample"] + 1e-6:
+            issues.append("bigger")
+        if c["allocs_per_sample"] > b["allocs_per_sample"] + 1e-6:
+            issues.append("allocates")
+        if not c["ok"]:
+            issues.append("check failed")
+        failed |= bool(issues)
+        print(f"{name:22} {bn:10.2f} {cn:10.2f} {delta:+7.1%}  {c['bytes_per_sample']:8.3f}  "
+              f"{c['allocs_per_sample']:.4f}  {', '.join(issues)}")
+    for name in base.keys() - cur.keys():
+        print(f"{name:22} missing from current run")
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,73 @@
+// csv2ssn — convert replay CSVs (ts_ms, ax_g, ay_g, az_g) into Stridera session files.
+//
+// Host tool, not part of the firmware build:
+//   g++ -std=c++17 -O2 -Ilib/stridera_proto -Ilib/stridera_replay tools/csv2ssn/csv2ssn.cpp -o csv2ssn
+//   ./csv2ssn snapchat.csv snapchat.ssn [rate_hz=100] [index_stride=256]
+//
+// Uses the same parser as the device (stridera_csv.h), so what converts is
+// exactly what CsvReplay would have played.
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+#include "stridera_csv.h"
+#include "stridera_session.h"
+
+struct StdioSource {
+  FILE* f;
+  size_t read(uint8_t* buf, size_t n) { return fread(buf, 1, n, f); }
+};
+
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    fprintf(stderr, "usage: %s in.csv out.ssn [rate_hz=100] [index_stride=256]\n", argv[0]);
+    return 2;
+  }
+  const uint16_t rate   = argc > 3 ? (uint16_t)atoi(argv[3]) : 100;
+  const uint32_t stride = argc > 4 ? (uint32_t)atoi(argv[4]) : 256;
+
+  StdioSource in{fopen(argv[1], "rb")};
+  if (!in.f) { perror(argv[1]); return 1; }
+  FILE* out = fopen(argv[2], "wb");
+  if (!out) { perror(argv[2]); return 1; }
+
+  StrideraSessionHeader hdr;
+  stridera_session_header_init(hdr, rate, sizeof(hdr), stride);
+  fwrite(&hdr, sizeof(hdr), 1, out);                 // placeholder, rewritten at the end
+
+  static StrideraCsvLineReader<StdioSource, 4096> lines;
+  lines.begin(&in);
+  const char *s, *e;
+  (void)lines.next(s, e);                            // header row
+
+  std::vector<StrideraSessionIndexEntry> index;
+  uint32_t malformed = 0, backwards = 0;
+  StrideraAccelPacket p;
+  while (lines.next(s, e)) {
+    if (s == e || (e - s == 1 && *s == '\r')) continue;
+    if (!stridera_parse_csv_row(s, e, p, 0)) { ++malformed; continue; }
+    if (hdr.record_count && p.ts_ms < hdr.last_ts_ms) ++backwards;   // index assumes monotonic ts
+
+    if (hdr.record_count % hdr.index_stride == 0) {
+      index.push_back(StrideraSessionIndexEntry{p.ts_ms, hdr.record_count});
+    }
+    if (hdr.record_count == 0) hdr.first_ts_ms = p.ts_ms;
+    hdr.last_ts_ms = p.ts_ms;
+
+    const StrideraSessionRecord r = stridera_session_record(p);
+    fwrite(&r, sizeof(r), 1, out);
+    ++hdr.record_count;
+  }
+
+  hdr.index_offset = (uint32_t)ftell(out);
+  hdr.index_count  = (uint32_t)index.size();
+  if (!index.empty()) fwrite(index.data(), sizeof(index[0]), index.size(), out);
+  fseek(out, 0, SEEK_SET);
+  fwrite(&hdr, sizeof(hdr), 1, out);
+  fclose(out);
+  fclose(in.f);
+
+  printf("%u records (%u..%u ms), %u index entries, %u malformed rows skipped\n",
+         hdr.record_count, hdr.first_ts_ms, hdr.last_ts_ms, hdr.index_count, malformed + lines.longLines());
+  if (backwards) fprintf(stderr, "warning: %u rows go back in time; seeking may be inexact\n", backwards);
+  return 0;
+}